@@ -1124,6 +1124,52 @@ void os_relaunch(char *argv[])
 	os_exit(1);
 }
 
+int os_thread_create(void *(*func)(void *arg), void *arg, unsigned long *idp)
+{
+	sigset_t sigs, old;
+	pthread_t tid;
+	int ret;
+
+	/* Leave signals such as SIGALRM and SIGINT to the main thread */
+	sigfillset(&sigs);
+	pthread_sigmask(SIG_SETMASK, &sigs, &old);
+	ret = pthread_create(&tid, NULL, func, arg);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (ret)
+		return -ret;
+	*idp = tid;
+
+	return 0;
+}
+
+int os_thread_join(unsigned long id)
+{
+	return -pthread_join((pthread_t)id, NULL);
+}
+
+static pthread_mutex_t workq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t workq_cond = PTHREAD_COND_INITIALIZER;
+
+void os_workq_lock(void)
+{
+	pthread_mutex_lock(&workq_mutex);
+}
+
+void os_workq_unlock(void)
+{
+	pthread_mutex_unlock(&workq_mutex);
+}
+
+void os_workq_wait(void)
+{
+	pthread_cond_wait(&workq_cond, &workq_mutex);
+}
+
+void os_workq_wake(void)
+{
+	pthread_cond_broadcast(&workq_cond);
+}
+
 #ifdef CONFIG_FUZZ
 static void *fuzzer_thread(void * ptr)
 {
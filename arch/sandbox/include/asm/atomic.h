@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+#ifndef __ASM_SANDBOX_ATOMIC_H
+#define __ASM_SANDBOX_ATOMIC_H
+
+/* U-Boot is single-threaded, so the generic version is enough */
+
+#include <asm/system.h>
+#include <asm-generic/atomic.h>
+
+#endif
@@ -38,6 +38,14 @@ size_t sandbox_serial_written(void);
  */
 void sandbox_serial_endisable(bool enabled);
 
+/**
+ * sandbox_serial_set_busy() - Make the serial port report that it is busy
+ * @busy: true to return -EAGAIN for all output, false to accept it
+ *
+ * This allows tests to check what happens with a slow UART.
+ */
+void sandbox_serial_set_busy(bool busy);
+
 /**
  * struct sandbox_serial_priv - Private data for this driver
  *
@@ -6,11 +6,11 @@
 #ifndef __ASM_SANDBOX_SYSTEM_H
 #define __ASM_SANDBOX_SYSTEM_H
 
-/* Define this as nops for sandbox architecture */
-#define local_irq_save(x)
+/* Define this as nops for sandbox architecture, using the flags variable */
+#define local_irq_save(x)	((x) = 0)
 #define local_irq_enable()
 #define local_irq_disable()
 #define local_save_flags(x)
-#define local_irq_restore(x)
+#define local_irq_restore(x)	((void)(x))
 
 #endif
@@ -123,6 +123,35 @@ long sandbox_i2c_rtc_get_set_base_time(struct udevice *dev, long base_time);
 
 int sandbox_usb_keyb_add_string(struct udevice *dev, const char *str);
 
+/**
+ * sandbox_usb_set_max_xfer_size() - Limit the size of bulk transfers
+ *
+ * @dev:	Sandbox USB controller
+ * @size:	Largest transfer in bytes, or 0 for no limit
+ */
+void sandbox_usb_set_max_xfer_size(struct udevice *dev, size_t size);
+
+/**
+ * sandbox_flash_set_superspeed() - Make a UAS flash stick use SuperSpeed
+ *
+ * The emulator then reports itself as a USB 3 device, with SuperSpeed
+ * companion descriptors which allow streams on the UAS endpoints only. This
+ * must be called before the bus is scanned.
+ *
+ * @dev:	Flash-stick emulator with the "sandbox,uas" property
+ * Return: 0 if OK, -ENOSYS if the emulator does not offer UAS
+ */
+int sandbox_flash_set_superspeed(struct udevice *dev);
+
+/**
+ * sandbox_flash_get_max_queued() - Get the most UAS commands queued at once
+ *
+ * @dev:	Flash-stick emulator
+ * Return: largest number of commands which were waiting on their streams at
+ *	the same time
+ */
+int sandbox_flash_get_max_queued(struct udevice *dev);
+
 /**
  * sandbox_osd_get_mem() - get the internal memory of a sandbox OSD
  *
@@ -775,7 +775,138 @@ int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 	return 0;
 }
 
-static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
+/**
+ * bootdev_hunt_match() - check whether a hunter matches a hunting spec
+ *
+ * @info: Hunter to check
+ * @spec: Name of the uclass to hunt, optionally followed by a number which is
+ *	ignored, or "dhcp" / "pxe" for the network. NULL matches all hunters
+ * @len: Length of @spec to match, excluding any trailing number
+ * Return: true if the hunter should be used
+ */
+static bool bootdev_hunt_match(struct bootdev_hunter *info, const char *spec,
+			       size_t len)
+{
+	const char *name = uclass_get_name(info->uclass);
+
+	log_debug("looking at %.*s for %s\n",
+		  (int)max(strlen(name), len), spec, name);
+	if (spec && strncmp(spec, name, max(strlen(name), len))) {
+		if (info->uclass != UCLASS_ETH ||
+		    (strcmp("dhcp", spec) && strcmp("pxe", spec)))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * bootdev_hunt_done() - record the result of a hunter
+ *
+ * @std: bootstd private info
+ * @seq: Position of the hunter in the linker list
+ * @ret: Result from the hunter
+ * Return: 0 if OK, -ve on error
+ */
+static int bootdev_hunt_done(struct bootstd_priv *std, uint seq, int ret)
+{
+	log_debug("  - hunt result %d\n", ret);
+	if (ret && ret != -ENOENT)
+		return ret;
+	std->hunters_used |= BIT(seq);
+
+	return 0;
+}
+
+/**
+ * bootdev_hunt_poll() - poll the hunters which are still busy
+ *
+ * This gives each busy hunter a turn, so that they make progress together
+ *
+ * @busyp: Bitmask of busy hunters, indexed by their position in the linker
+ *	list. Updated to remove those which have finished
+ * @mask: Bitmask of hunters which may be polled. Hunters which were set off
+ *	early are only polled once their turn has come, so that they finish
+ *	after their "Hunting with" message
+ * @show: true to show information from the hunters
+ * Return: 0 if OK, -ve if a hunter failed
+ */
+static int bootdev_hunt_poll(uint *busyp, uint mask, bool show)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+	int result;
+
+	if (!(*busyp & mask))
+		return 0;
+	result = bootstd_get_priv(&std);
+	if (result)
+		return log_msg_ret("std", result);
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	result = 0;
+
+	for (i = 0; i < n_ent && *busyp; i++) {
+		struct bootdev_hunter *info = start + i;
+		int ret;
+
+		if (!(*busyp & mask & BIT(i)))
+			continue;
+		ret = info->poll(info, show);
+		if (ret == -EAGAIN)
+			continue;
+		*busyp &= ~BIT(i);
+		ret = bootdev_hunt_done(std, i, ret);
+		if (ret)
+			result = ret;
+	}
+
+	return result;
+}
+
+/**
+ * bootdev_hunt_start() - set off a hunter which runs as a state machine
+ *
+ * Nothing is done if the hunter is already busy
+ *
+ * @info: Hunter to start, which must provide a start() method
+ * @seq: Position of the hunter in the linker list
+ * @busyp: Bitmask of busy hunters, updated if the hunter is set off
+ * @show: true to show information from the hunter
+ * Return: 0 if OK (the hunter must be polled), -ve on error
+ */
+static int bootdev_hunt_start(struct bootdev_hunter *info, uint seq,
+			      uint *busyp, bool show)
+{
+	int ret;
+
+	if (*busyp & BIT(seq))
+		return 0;
+	ret = info->start(info, show);
+	if (ret)
+		return ret;
+	*busyp |= BIT(seq);
+
+	return 0;
+}
+
+/**
+ * bootdev_hunt_drv() - run a hunter, if it has not been used already
+ *
+ * A hunter which provides a start() method is only set off here, if it is not
+ * busy already. It is added to @busyp and must be polled with
+ * bootdev_hunt_poll() until it finishes.
+ *
+ * @info: Hunter to run
+ * @seq: Position of the hunter in the linker list
+ * @busyp: Bitmask of busy hunters, updated if the hunter is set off
+ * @show: true to show information from the hunter
+ * Return: 0 if OK, -ve on error
+ */
+static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, uint *busyp,
+			    bool show)
 {
 	const char *name = uclass_get_name(info->uclass);
 	struct bootstd_priv *std;
@@ -790,29 +921,91 @@ static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
 			printf("Hunting with: %s\n",
 			       uclass_get_name(info->uclass));
 		log_debug("Hunting with: %s\n", name);
-		if (info->hunt) {
+		ret = 0;
+		if (info->start) {
+			ret = bootdev_hunt_start(info, seq, busyp, show);
+			if (!ret)
+				return 0;
+		} else if (info->hunt) {
 			ret = info->hunt(info, show);
-			log_debug("  - hunt result %d\n", ret);
-			if (ret && ret != -ENOENT)
-				return ret;
 		}
-		std->hunters_used |= BIT(seq);
+		return bootdev_hunt_done(std, seq, ret);
 	}
 
 	return 0;
 }
 
+/**
+ * bootdev_hunt_start_all() - set off the hunters which run as state machines
+ *
+ * This is done before running the other hunters, so that the waits of these
+ * hunters overlap with the other hunters. Errors are ignored here, since the
+ * hunter is started again, and the error reported, when its turn comes.
+ *
+ * @spec: Hunters to use (see bootdev_hunt_match()), or NULL for all
+ * @len: Length of @spec to match
+ * @prio: Priority of the hunters to start, or -1 for any
+ * @busyp: Bitmask of busy hunters, updated with those which are set off
+ * @show: true to show information from the hunters
+ */
+static void bootdev_hunt_start_all(const char *spec, size_t len, int prio,
+				   uint *busyp, bool show)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+
+	if (bootstd_get_priv(&std))
+		return;
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent; i++) {
+		struct bootdev_hunter *info = start + i;
+
+		if (!info->start || (std->hunters_used & BIT(i)) ||
+		    (prio != -1 && prio != info->prio) ||
+		    !bootdev_hunt_match(info, spec, len))
+			continue;
+		bootdev_hunt_start(info, i, busyp, show);
+	}
+}
+
+/**
+ * bootdev_hunt_finish() - wait for all busy hunters to finish
+ *
+ * @busy: Bitmask of busy hunters
+ * @show: true to show information from the hunters
+ * Return: 0 if OK, -ve if a hunter failed
+ */
+static int bootdev_hunt_finish(uint busy, bool show)
+{
+	int result;
+	int ret;
+
+	result = 0;
+	while (busy) {
+		ret = bootdev_hunt_poll(&busy, ~0U, show);
+		if (ret)
+			result = ret;
+	}
+
+	return result;
+}
+
 int bootdev_hunt(const char *spec, bool show)
 {
 	struct bootdev_hunter *start;
 	const char *end;
 	int n_ent, i;
+	uint busy;
 	int result;
 	size_t len;
+	int ret;
 
 	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
 	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
 	result = 0;
+	busy = 0;
 
 	len = SIZE_MAX;
 	if (spec) {
@@ -820,22 +1013,24 @@ int bootdev_hunt(const char *spec, bool show)
 		len = end - spec;
 	}
 
+	bootdev_hunt_start_all(spec, len, -1, &busy, show);
 	for (i = 0; i < n_ent; i++) {
 		struct bootdev_hunter *info = start + i;
-		const char *name = uclass_get_name(info->uclass);
-		int ret;
 
-		log_debug("looking at %.*s for %s\n",
-			  (int)max(strlen(name), len), spec, name);
-		if (spec && strncmp(spec, name, max(strlen(name), len))) {
-			if (info->uclass != UCLASS_ETH ||
-			    (strcmp("dhcp", spec) && strcmp("pxe", spec)))
-				continue;
-		}
-		ret = bootdev_hunt_drv(info, i, show);
+		if (!bootdev_hunt_match(info, spec, len))
+			continue;
+
+		/* give any busy hunters a turn before running the next one */
+		ret = bootdev_hunt_poll(&busy, BIT(i) - 1, show);
+		if (ret)
+			result = ret;
+		ret = bootdev_hunt_drv(info, i, &busy, show);
 		if (ret)
 			result = ret;
 	}
+	ret = bootdev_hunt_finish(busy, show);
+	if (ret)
+		result = ret;
 
 	return result;
 }
@@ -871,24 +1066,33 @@ int bootdev_hunt_prio(enum bootdev_prio_t prio, bool show)
 {
 	struct bootdev_hunter *start;
 	int n_ent, i;
+	uint busy;
 	int result;
+	int ret;
 
 	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
 	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
 	result = 0;
+	busy = 0;
 
 	log_debug("Hunting for priority %d\n", prio);
+	bootdev_hunt_start_all(NULL, SIZE_MAX, prio, &busy, show);
 	for (i = 0; i < n_ent; i++) {
 		struct bootdev_hunter *info = start + i;
-		int ret;
 
 		if (prio != info->prio)
 			continue;
-		ret = bootdev_hunt_drv(info, i, show);
+		ret = bootdev_hunt_poll(&busy, BIT(i) - 1, show);
+		if (ret)
+			result = ret;
+		ret = bootdev_hunt_drv(info, i, &busy, show);
 		log_debug("bootdev_hunt_drv() return %d\n", ret);
 		if (ret && ret != -ENOENT)
 			result = ret;
 	}
+	ret = bootdev_hunt_finish(busy, show);
+	if (ret)
+		result = ret;
 	log_debug("exit %d\n", result);
 
 	return result;
@@ -9,11 +9,14 @@
 #include <bootdev.h>
 #include <bootflow.h>
 #include <bootmeth.h>
+#include <bootstage.h>
 #include <bootstd.h>
 #include <dm.h>
+#include <env.h>
 #include <env_internal.h>
 #include <malloc.h>
 #include <serial.h>
+#include <time.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 
@@ -388,6 +391,7 @@ int bootflow_scan_first(struct udevice *dev, const char *label,
 	if (dev || label)
 		flags |= BOOTFLOWIF_SKIP_GLOBAL;
 	bootflow_iter_init(iter, flags);
+	iter->start = get_timer(0);
 
 	/*
 	 * Set up the ordering of bootmeths. This sets iter->doing_global and
@@ -532,6 +536,9 @@ int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 	if (IS_ENABLED(CONFIG_OF_HAS_PRIOR_STAGE) &&
 	    (bflow->flags & BOOTFLOWF_USE_PRIOR_FDT))
 		printf("Using prior-stage device tree\n");
+	if (CONFIG_IS_ENABLED(BOOTFLOW_REMEMBER) &&
+	    bflow->state == BOOTFLOWST_READY)
+		bootflow_remember(iter, bflow);
 	ret = bootflow_boot(bflow);
 	if (!IS_ENABLED(CONFIG_BOOTSTD_FULL)) {
 		printf("Boot failed (err=%d)\n", ret);
@@ -567,6 +574,176 @@ int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(BOOTFLOW_REMEMBER)
+/**
+ * struct bootflow_last - bootflow recorded by bootflow_remember()
+ *
+ * This is parsed from the "bootflow_last" environment variable, which has the
+ * form "<bootdev> <part> <bootmeth> <scan_ms> <fname>"
+ *
+ * @buf: Copy of the variable, which the strings below point into
+ * @dev_name: Name of the bootdev
+ * @part: Partition number
+ * @method_name: Name of the bootmeth
+ * @scan_ms: Time taken by the scan which found the bootflow
+ * @fname: Filename of the bootflow
+ */
+struct bootflow_last {
+	char buf[256];
+	const char *dev_name;
+	int part;
+	const char *method_name;
+	ulong scan_ms;
+	const char *fname;
+};
+
+/**
+ * bootflow_last_get() - Read the bootflow recorded by bootflow_remember()
+ *
+ * @last: Returns the bootflow
+ * Return: 0 if OK, -ENOENT if there is none, -EINVAL if it is not valid
+ */
+static int bootflow_last_get(struct bootflow_last *last)
+{
+	const char *val = env_get("bootflow_last");
+	char *str, *part, *scan_ms;
+
+	if (!val)
+		return -ENOENT;
+	strlcpy(last->buf, val, sizeof(last->buf));
+	str = last->buf;
+	last->dev_name = strsep(&str, " ");
+	part = strsep(&str, " ");
+	last->method_name = strsep(&str, " ");
+	scan_ms = strsep(&str, " ");
+	last->fname = str;
+	if (!last->fname || !*last->fname)
+		return log_msg_ret("blv", -EINVAL);
+	last->part = simple_strtoul(part, NULL, 10);
+	last->scan_ms = simple_strtoul(scan_ms, NULL, 10);
+
+	return 0;
+}
+
+int bootflow_remember(const struct bootflow_iter *iter,
+		      const struct bootflow *bflow)
+{
+	struct bootflow_last last;
+	char str[sizeof(last.buf)];
+	ulong scan_ms;
+	bool found;
+	int ret;
+
+	if (!bflow->dev || !bflow->fname)
+		return 0;
+
+	/* Keep the time of the original scan if nothing has changed */
+	found = !bootflow_last_get(&last);
+	if (found && !strcmp(last.dev_name, bflow->dev->name) &&
+	    last.part == bflow->part &&
+	    !strcmp(last.method_name, bflow->method->name) &&
+	    !strcmp(last.fname, bflow->fname))
+		return 0;
+
+	/*
+	 * bootflow_scan_remembered() does not scan, so keep the time of the
+	 * original scan if only the filename has changed
+	 */
+	if (iter && iter->start)
+		scan_ms = get_timer(iter->start);
+	else
+		scan_ms = found ? last.scan_ms : 0;
+	snprintf(str, sizeof(str), "%s %d %s %lu %s", bflow->dev->name,
+		 bflow->part, bflow->method->name, scan_ms, bflow->fname);
+	ret = env_set("bootflow_last", str);
+	if (ret)
+		return log_msg_ret("bls", ret);
+
+	/* This only happens when the bootflow changes, so rarely */
+	if (IS_ENABLED(CONFIG_BOOTFLOW_REMEMBER_SAVE)) {
+		ret = env_save();
+		if (ret)
+			log_warning("Cannot save environment (err=%d)\n", ret);
+	}
+
+	return 0;
+}
+
+int bootflow_scan_remembered(struct bootflow_iter *iter,
+			     struct bootflow *bflow, ulong *scan_msp)
+{
+	struct bootflow_last last;
+	struct udevice *dev, *meth;
+	int ret;
+
+	bootflow_iter_init(iter, BOOTFLOWIF_SINGLE_DEV | BOOTFLOWIF_SKIP_GLOBAL |
+			   BOOTFLOWIF_SINGLE_PARTITION);
+	ret = bootflow_last_get(&last);
+	if (ret)
+		return ret;
+
+	/* Only use a bootdev which already exists, to avoid any hunting */
+	ret = uclass_find_device_by_name(UCLASS_BOOTDEV, last.dev_name, &dev);
+	if (ret)
+		return log_msg_ret("bld", ret);
+	ret = uclass_get_device_by_name(UCLASS_BOOTMETH, last.method_name,
+					&meth);
+	if (ret)
+		return log_msg_ret("blm", ret);
+	ret = device_probe(dev);
+	if (ret)
+		return log_msg_ret("blp", ret);
+
+	iter->method_order = calloc(1, sizeof(struct udevice *));
+	if (!iter->method_order)
+		return log_msg_ret("blo", -ENOMEM);
+	iter->method_order[0] = meth;
+	iter->num_methods = 1;
+	iter->method = meth;
+	iter->part = last.part;
+	bootflow_iter_set_dev(iter, dev, 0);
+
+	bootflow_init(bflow, dev, meth);
+	ret = bootflow_check(iter, bflow);
+	if (ret) {
+		bootflow_free(bflow);
+		return log_msg_ret("blc", ret);
+	}
+	if (strcmp(bflow->fname, last.fname))
+		log_debug("Bootflow file changed from '%s' to '%s'\n",
+			  last.fname, bflow->fname);
+	*scan_msp = last.scan_ms;
+
+	return 0;
+}
+
+int bootflow_boot_remembered(struct bootflow_tried *tried)
+{
+	struct bootflow_iter iter;
+	struct bootflow bflow;
+	ulong start, scan_ms;
+	int ret;
+
+	tried->dev = NULL;
+	start = get_timer(0);
+	bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTFLOW_LAST, "bootflow_last");
+	ret = bootflow_scan_remembered(&iter, &bflow, &scan_ms);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTFLOW_LAST);
+	if (!ret) {
+		printf("Using last bootflow '%s', found in %lu ms (scan took %lu ms)\n",
+		       bflow.name, get_timer(start), scan_ms);
+		tried->dev = bflow.dev;
+		tried->method = bflow.method;
+		tried->part = bflow.part;
+		ret = bootflow_run_boot(&iter, &bflow);
+		bootflow_free(&bflow);
+	}
+	bootflow_iter_uninit(&iter);
+
+	return ret;
+}
+#endif /* BOOTFLOW_REMEMBER */
+
 int bootflow_iter_check_blk(const struct bootflow_iter *iter)
 {
 	const struct udevice *media = dev_get_parent(iter->dev);
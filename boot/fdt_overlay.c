@@ -0,0 +1,1033 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Apply a series of device-tree overlays using indexes of the base tree
+ *
+ * Based on libfdt's fdt_overlay.c:
+ * Copyright (C) 2016 Free Electrons
+ * Copyright (C) 2016 NextThing Co.
+ *
+ * This follows the same steps as fdt_overlay_apply() in libfdt, making the
+ * same changes to the base tree in the same order, so the result is identical.
+ * The difference is in how the base tree is searched. libfdt scans the whole
+ * tree for the largest phandle and for each phandle target, and scans the
+ * __symbols__ node for each fixup. Here these use indexes which are built
+ * once and kept up to date as each overlay is merged:
+ *
+ * - phandle to node offset, sorted by phandle, which also gives the largest
+ * - absolute path to node offset, filled in as paths are looked up
+ * - symbol label to phandle, filled in as labels are resolved
+ *
+ * Node offsets move as properties and nodes are added. All changes to the
+ * base tree go through ov_setprop() and friends, which adjust the offsets in
+ * the indexes after each change. Anything unusual, such as an overlay changing
+ * the phandle of an existing node, drops the indexes so that they are rebuilt.
+ * If they cannot be built, the libfdt functions are used instead.
+ *
+ * The overlay-side steps are the same as libfdt's fdt_overlay.c
+ */
+
+#include <alist.h>
+#include <fdt_support.h>
+#include <malloc.h>
+#include <sort.h>
+#include <vsprintf.h>
+#include <linux/libfdt.h>
+#include <linux/string.h>
+
+/**
+ * struct ov_phandle - Entry in the phandle index
+ *
+ * @phandle: phandle of the node
+ * @offset: Offset of the node in the base tree
+ */
+struct ov_phandle {
+	u32 phandle;
+	int offset;
+};
+
+/**
+ * struct ov_path - Entry in the path index
+ *
+ * @path: Absolute path of the node (allocated)
+ * @offset: Offset of the node in the base tree
+ */
+struct ov_path {
+	char *path;
+	int offset;
+};
+
+/**
+ * struct ov_symbol - Entry in the symbol index
+ *
+ * @label: Label in the /__symbols__ node (allocated)
+ * @phandle: phandle of the node it refers to
+ */
+struct ov_symbol {
+	char *label;
+	u32 phandle;
+};
+
+static void ov_drop(struct fdt_overlay_batch *batch)
+{
+	struct ov_symbol *sym;
+	struct ov_path *path;
+
+	alist_for_each(path, &batch->paths)
+		free(path->path);
+	alist_for_each(sym, &batch->symbols)
+		free(sym->label);
+	alist_empty(&batch->phandles);
+	alist_empty(&batch->paths);
+	alist_empty(&batch->symbols);
+	batch->valid = false;
+}
+
+static int h_cmp_phandle(const void *v1, const void *v2)
+{
+	const struct ov_phandle *p1 = v1, *p2 = v2;
+
+	if (p1->phandle != p2->phandle)
+		return p1->phandle < p2->phandle ? -1 : 1;
+
+	return p1->offset - p2->offset;
+}
+
+/**
+ * ov_build() - Build the phandle index for the base tree
+ *
+ * @batch: Batch to update
+ * @fdt: Base tree
+ * Return: true if OK, false if the index could not be built
+ */
+static bool ov_build(struct fdt_overlay_batch *batch, const void *fdt)
+{
+	int node;
+
+	ov_drop(batch);
+	for (node = fdt_next_node(fdt, -1, NULL); node >= 0;
+	     node = fdt_next_node(fdt, node, NULL)) {
+		struct ov_phandle ph;
+
+		ph.phandle = fdt_get_phandle(fdt, node);
+		ph.offset = node;
+		if (ph.phandle && !alist_add(&batch->phandles, ph))
+			break;
+	}
+	if (node != -FDT_ERR_NOTFOUND) {
+		ov_drop(batch);
+		return false;
+	}
+	qsort(batch->phandles.data, batch->phandles.count,
+	      sizeof(struct ov_phandle), h_cmp_phandle);
+	batch->struct_size = fdt_size_dt_struct(fdt);
+	batch->valid = true;
+
+	return true;
+}
+
+static bool ov_ready(struct fdt_overlay_batch *batch, const void *fdt)
+{
+	return batch->valid || ov_build(batch, fdt);
+}
+
+/* Find the first phandle entry which is not less than @phandle */
+static uint ov_phandle_pos(struct fdt_overlay_batch *batch, u32 phandle)
+{
+	const struct ov_phandle *ph = batch->phandles.data;
+	uint lo = 0, hi = batch->phandles.count;
+
+	while (lo < hi) {
+		uint mid = (lo + hi) / 2;
+
+		if (ph[mid].phandle < phandle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* Find the symbol entry for @label, or where it should be inserted */
+static uint ov_symbol_pos(struct fdt_overlay_batch *batch, const char *label,
+			  bool *foundp)
+{
+	const struct ov_symbol *sym = batch->symbols.data;
+	uint lo = 0, hi = batch->symbols.count;
+
+	*foundp = false;
+	while (lo < hi) {
+		uint mid = (lo + hi) / 2;
+		int cmp = strcmp(sym[mid].label, label);
+
+		if (!cmp) {
+			*foundp = true;
+			return mid;
+		}
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * ov_insert() - Insert an entry into a sorted alist
+ *
+ * @lst: List to update
+ * @pos: Index to insert at
+ * @obj: Object to insert
+ * Return: true if OK, false if out of memory
+ */
+static bool ov_insert(struct alist *lst, uint pos, const void *obj)
+{
+	void *ptr;
+
+	if (!alist_add_placeholder(lst))
+		return false;
+	ptr = lst->data + pos * lst->obj_size;
+	memmove(ptr + lst->obj_size, ptr, (lst->count - 1 - pos) * lst->obj_size);
+	memcpy(ptr, obj, lst->obj_size);
+
+	return true;
+}
+
+/**
+ * ov_shift() - Adjust the indexes after a change to the base tree
+ *
+ * Properties and subnodes are added or resized inside @node, before its first
+ * subnode, so every node after @node moves by the same amount.
+ *
+ * @batch: Batch to update
+ * @node: Node which was changed
+ * @delta: Change in the size of the structure block
+ */
+static void ov_shift(struct fdt_overlay_batch *batch, int node, int delta)
+{
+	struct ov_phandle *ph;
+	struct ov_path *path;
+
+	if (!delta)
+		return;
+	alist_for_each(ph, &batch->phandles) {
+		if (ph->offset > node)
+			ph->offset += delta;
+	}
+	alist_for_each(path, &batch->paths) {
+		if (path->offset > node)
+			path->offset += delta;
+	}
+}
+
+static int ov_max_phandle(struct fdt_overlay_batch *batch, const void *fdt,
+			  u32 *phandlep)
+{
+	const struct alist *lst = &batch->phandles;
+
+	if (!ov_ready(batch, fdt))
+		return fdt_find_max_phandle(fdt, phandlep);
+	*phandlep = lst->count ?
+		alist_get(lst, lst->count - 1, struct ov_phandle)->phandle : 0;
+
+	return 0;
+}
+
+static int ov_node_by_phandle(struct fdt_overlay_batch *batch, const void *fdt,
+			      u32 phandle)
+{
+	const struct ov_phandle *ph;
+	uint pos;
+
+	if (!phandle || phandle == (u32)-1)
+		return -FDT_ERR_BADPHANDLE;
+	if (!ov_ready(batch, fdt))
+		return fdt_node_offset_by_phandle(fdt, phandle);
+	pos = ov_phandle_pos(batch, phandle);
+	ph = alist_get(&batch->phandles, pos, struct ov_phandle);
+	if (!ph || ph->phandle != phandle)
+		return -FDT_ERR_NOTFOUND;
+
+	return ph->offset;
+}
+
+static int ov_path_offset(struct fdt_overlay_batch *batch, const void *fdt,
+			  const char *path)
+{
+	struct ov_path *entry, new;
+	int offset;
+
+	/* Aliases can change as overlays are applied, so are not indexed */
+	if (*path != '/' || !ov_ready(batch, fdt))
+		return fdt_path_offset(fdt, path);
+	alist_for_each(entry, &batch->paths) {
+		if (!strcmp(entry->path, path))
+			return entry->offset;
+	}
+
+	offset = fdt_path_offset(fdt, path);
+	if (offset >= 0) {
+		new.path = strdup(path);
+		new.offset = offset;
+		if (!new.path || !alist_add(&batch->paths, new)) {
+			free(new.path);
+			ov_drop(batch);
+		}
+	}
+
+	return offset;
+}
+
+/* Forget a symbol, since it is being changed */
+static void ov_forget_symbol(struct fdt_overlay_batch *batch, const char *label)
+{
+	struct ov_symbol *sym;
+	bool found;
+	uint pos;
+
+	pos = ov_symbol_pos(batch, label, &found);
+	if (!found)
+		return;
+	sym = alist_getw(&batch->symbols, pos, struct ov_symbol);
+	free(sym->label);
+	memmove(sym, sym + 1, (batch->symbols.count - 1 - pos) * sizeof(*sym));
+	batch->symbols.count--;
+}
+
+/**
+ * ov_symbol_phandle() - Get the phandle of the node a symbol refers to
+ *
+ * @batch: Batch to use
+ * @fdt: Base tree
+ * @symbols_off: Offset of the /__symbols__ node in @fdt
+ * @label: Symbol to look up
+ * @phandlep: Returns the phandle
+ * Return: 0 if OK, -ve on error
+ */
+static int ov_symbol_phandle(struct fdt_overlay_batch *batch, const void *fdt,
+			     int symbols_off, const char *label, u32 *phandlep)
+{
+	const char *symbol_path;
+	struct ov_symbol sym;
+	int symbol_off;
+	int prop_len;
+	bool found;
+	uint pos;
+
+	if (symbols_off < 0)
+		return symbols_off;
+
+	if (batch->valid) {
+		pos = ov_symbol_pos(batch, label, &found);
+		if (found) {
+			*phandlep = alist_get(&batch->symbols, pos,
+					      struct ov_symbol)->phandle;
+			return 0;
+		}
+	}
+
+	symbol_path = fdt_getprop(fdt, symbols_off, label, &prop_len);
+	if (!symbol_path)
+		return prop_len;
+
+	symbol_off = ov_path_offset(batch, fdt, symbol_path);
+	if (symbol_off < 0)
+		return symbol_off;
+
+	*phandlep = fdt_get_phandle(fdt, symbol_off);
+	if (!*phandlep)
+		return -FDT_ERR_NOTFOUND;
+
+	if (batch->valid) {
+		pos = ov_symbol_pos(batch, label, &found);
+		sym.label = strdup(label);
+		sym.phandle = *phandlep;
+		if (!sym.label || !ov_insert(&batch->symbols, pos, &sym)) {
+			free(sym.label);
+			ov_drop(batch);
+		}
+	}
+
+	return 0;
+}
+
+static bool ov_is_phandle(const char *name)
+{
+	return !strcmp(name, "phandle") || !strcmp(name, "linux,phandle");
+}
+
+/**
+ * ov_phandle_changed() - Update the phandle index after a phandle is set
+ *
+ * @batch: Batch to update
+ * @fdt: Base tree
+ * @node: Node whose phandle property was set
+ * @old: phandle of the node before it was set, or 0 if none
+ */
+static void ov_phandle_changed(struct fdt_overlay_batch *batch, const void *fdt,
+			       int node, u32 old)
+{
+	struct ov_phandle ph;
+	uint pos;
+
+	if (!batch->valid)
+		return;
+	ph.phandle = fdt_get_phandle(fdt, node);
+	ph.offset = node;
+	if (ph.phandle == old)
+		return;
+
+	/* Changing an existing phandle is unusual, so just start again */
+	if (old) {
+		ov_drop(batch);
+		return;
+	}
+
+	pos = ov_phandle_pos(batch, ph.phandle);
+	while (pos < batch->phandles.count &&
+	       h_cmp_phandle(alist_get(&batch->phandles, pos,
+				       struct ov_phandle), &ph) < 0)
+		pos++;
+	if (!ov_insert(&batch->phandles, pos, &ph))
+		ov_drop(batch);
+}
+
+static int ov_setprop(struct fdt_overlay_batch *batch, void *fdt, int node,
+		      const char *name, const void *val, int len)
+{
+	int size = fdt_size_dt_struct(fdt);
+	bool is_phandle = ov_is_phandle(name);
+	u32 old = 0;
+	int ret;
+
+	if (is_phandle)
+		old = fdt_get_phandle(fdt, node);
+	ret = fdt_setprop(fdt, node, name, val, len);
+	ov_shift(batch, node, fdt_size_dt_struct(fdt) - size);
+	if (!ret && is_phandle)
+		ov_phandle_changed(batch, fdt, node, old);
+
+	/* A fragment may target /__symbols__ directly */
+	if (batch->symbols.count && ov_path_offset(batch, fdt,
+						   "/__symbols__") == node)
+		ov_forget_symbol(batch, name);
+
+	return ret;
+}
+
+static int ov_add_subnode(struct fdt_overlay_batch *batch, void *fdt,
+			  int parent, const char *name)
+{
+	int size = fdt_size_dt_struct(fdt);
+	int ret;
+
+	ret = fdt_add_subnode(fdt, parent, name);
+	ov_shift(batch, parent, fdt_size_dt_struct(fdt) - size);
+
+	return ret;
+}
+
+static int ov_setprop_placeholder(struct fdt_overlay_batch *batch, void *fdt,
+				  int node, const char *name, int len,
+				  void **prop_data)
+{
+	int size = fdt_size_dt_struct(fdt);
+	int ret;
+
+	ret = fdt_setprop_placeholder(fdt, node, name, len, prop_data);
+	ov_shift(batch, node, fdt_size_dt_struct(fdt) - size);
+	ov_forget_symbol(batch, name);
+
+	return ret;
+}
+
+/* The functions below follow those in libfdt's fdt_overlay.c */
+
+static u32 overlay_get_target_phandle(const void *fdto, int fragment)
+{
+	const fdt32_t *val;
+	int len;
+
+	val = fdt_getprop(fdto, fragment, "target", &len);
+	if (!val)
+		return 0;
+
+	if (len != sizeof(*val) || fdt32_to_cpu(*val) == (u32)-1)
+		return (u32)-1;
+
+	return fdt32_to_cpu(*val);
+}
+
+static int overlay_get_target(struct fdt_overlay_batch *batch, const void *fdt,
+			      const void *fdto, int fragment,
+			      const char **pathp)
+{
+	const char *path = NULL;
+	int path_len = 0, ret;
+	u32 phandle;
+
+	phandle = overlay_get_target_phandle(fdto, fragment);
+	if (phandle == (u32)-1)
+		return -FDT_ERR_BADPHANDLE;
+
+	if (!phandle) {
+		path = fdt_getprop(fdto, fragment, "target-path", &path_len);
+		if (path)
+			ret = ov_path_offset(batch, fdt, path);
+		else
+			ret = path_len;
+	} else {
+		ret = ov_node_by_phandle(batch, fdt, phandle);
+	}
+
+	if (ret < 0 && path_len == -FDT_ERR_NOTFOUND)
+		ret = -FDT_ERR_BADOVERLAY;
+	if (ret < 0)
+		return ret;
+	if (pathp)
+		*pathp = path;
+
+	return ret;
+}
+
+static int overlay_phandle_add_offset(void *fdto, int node, const char *name,
+				      u32 delta)
+{
+	const fdt32_t *val;
+	u32 adj_val;
+	int len;
+
+	val = fdt_getprop(fdto, node, name, &len);
+	if (!val)
+		return len;
+
+	if (len != sizeof(*val))
+		return -FDT_ERR_BADPHANDLE;
+
+	adj_val = fdt32_to_cpu(*val);
+	if (adj_val + delta < adj_val)
+		return -FDT_ERR_NOPHANDLES;
+
+	adj_val += delta;
+	if (adj_val == (u32)-1)
+		return -FDT_ERR_NOPHANDLES;
+
+	return fdt_setprop_inplace_u32(fdto, node, name, adj_val);
+}
+
+static int overlay_adjust_node_phandles(void *fdto, int node, u32 delta)
+{
+	int child;
+	int ret;
+
+	ret = overlay_phandle_add_offset(fdto, node, "phandle", delta);
+	if (ret && ret != -FDT_ERR_NOTFOUND)
+		return ret;
+
+	ret = overlay_phandle_add_offset(fdto, node, "linux,phandle", delta);
+	if (ret && ret != -FDT_ERR_NOTFOUND)
+		return ret;
+
+	fdt_for_each_subnode(child, fdto, node) {
+		ret = overlay_adjust_node_phandles(fdto, child, delta);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int overlay_update_local_node_references(void *fdto, int tree_node,
+						int fixup_node, u32 delta)
+{
+	int fixup_prop;
+	int fixup_child;
+	int ret;
+
+	fdt_for_each_property_offset(fixup_prop, fdto, fixup_node) {
+		const fdt32_t *fixup_val;
+		const char *tree_val;
+		const char *name;
+		int fixup_len;
+		int tree_len;
+		int i;
+
+		fixup_val = fdt_getprop_by_offset(fdto, fixup_prop, &name,
+						  &fixup_len);
+		if (!fixup_val)
+			return fixup_len;
+
+		if (fixup_len % sizeof(u32))
+			return -FDT_ERR_BADOVERLAY;
+		fixup_len /= sizeof(u32);
+
+		tree_val = fdt_getprop(fdto, tree_node, name, &tree_len);
+		if (!tree_val) {
+			if (tree_len == -FDT_ERR_NOTFOUND)
+				return -FDT_ERR_BADOVERLAY;
+
+			return tree_len;
+		}
+
+		for (i = 0; i < fixup_len; i++) {
+			fdt32_t adj_val;
+			u32 poffset;
+
+			poffset = fdt32_to_cpu(fixup_val[i]);
+
+			/* phandles to fix up can be unaligned */
+			memcpy(&adj_val, tree_val + poffset, sizeof(adj_val));
+			adj_val = cpu_to_fdt32(fdt32_to_cpu(adj_val) + delta);
+
+			ret = fdt_setprop_inplace_namelen_partial(fdto,
+					tree_node, name, strlen(name), poffset,
+					&adj_val, sizeof(adj_val));
+			if (ret == -FDT_ERR_NOSPACE)
+				return -FDT_ERR_BADOVERLAY;
+			if (ret)
+				return ret;
+		}
+	}
+
+	fdt_for_each_subnode(fixup_child, fdto, fixup_node) {
+		const char *fixup_child_name = fdt_get_name(fdto, fixup_child,
+							    NULL);
+		int tree_child;
+
+		tree_child = fdt_subnode_offset(fdto, tree_node,
+						fixup_child_name);
+		if (tree_child == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_BADOVERLAY;
+		if (tree_child < 0)
+			return tree_child;
+
+		ret = overlay_update_local_node_references(fdto, tree_child,
+							   fixup_child, delta);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int overlay_update_local_references(void *fdto, u32 delta)
+{
+	int fixups;
+
+	fixups = fdt_path_offset(fdto, "/__local_fixups__");
+	if (fixups < 0) {
+		if (fixups == -FDT_ERR_NOTFOUND)
+			return 0;
+
+		return fixups;
+	}
+
+	return overlay_update_local_node_references(fdto, 0, fixups, delta);
+}
+
+static int overlay_fixup_phandle(struct fdt_overlay_batch *batch, void *fdt,
+				 void *fdto, int symbols_off, int property)
+{
+	const char *value;
+	const char *label;
+	int len;
+
+	value = fdt_getprop_by_offset(fdto, property, &label, &len);
+	if (!value) {
+		if (len == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_INTERNAL;
+
+		return len;
+	}
+
+	do {
+		const char *path, *name, *fixup_end;
+		const char *fixup_str = value;
+		u32 path_len, name_len;
+		fdt32_t phandle_prop;
+		u32 fixup_len;
+		char *sep, *endptr;
+		int poffset, fixup_off, ret;
+		u32 phandle;
+
+		fixup_end = memchr(value, '\0', len);
+		if (!fixup_end)
+			return -FDT_ERR_BADOVERLAY;
+		fixup_len = fixup_end - fixup_str;
+
+		len -= fixup_len + 1;
+		value += fixup_len + 1;
+
+		path = fixup_str;
+		sep = memchr(fixup_str, ':', fixup_len);
+		if (!sep || *sep != ':')
+			return -FDT_ERR_BADOVERLAY;
+
+		path_len = sep - path;
+		if (path_len == fixup_len - 1)
+			return -FDT_ERR_BADOVERLAY;
+
+		fixup_len -= path_len + 1;
+		name = sep + 1;
+		sep = memchr(name, ':', fixup_len);
+		if (!sep || *sep != ':')
+			return -FDT_ERR_BADOVERLAY;
+
+		name_len = sep - name;
+		if (!name_len)
+			return -FDT_ERR_BADOVERLAY;
+
+		poffset = simple_strtoul(sep + 1, &endptr, 10);
+		if (*endptr != '\0' || endptr <= sep + 1)
+			return -FDT_ERR_BADOVERLAY;
+
+		ret = ov_symbol_phandle(batch, fdt, symbols_off, label,
+					&phandle);
+		if (ret)
+			return ret;
+
+		fixup_off = fdt_path_offset_namelen(fdto, path, path_len);
+		if (fixup_off == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_BADOVERLAY;
+		if (fixup_off < 0)
+			return fixup_off;
+
+		phandle_prop = cpu_to_fdt32(phandle);
+		ret = fdt_setprop_inplace_namelen_partial(fdto, fixup_off,
+							  name, name_len,
+							  poffset,
+							  &phandle_prop,
+							  sizeof(phandle_prop));
+		if (ret)
+			return ret;
+	} while (len > 0);
+
+	return 0;
+}
+
+static int overlay_fixup_phandles(struct fdt_overlay_batch *batch, void *fdt,
+				  void *fdto)
+{
+	int fixups_off, symbols_off;
+	int property;
+
+	fixups_off = fdt_path_offset(fdto, "/__fixups__");
+	if (fixups_off == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (fixups_off < 0)
+		return fixups_off;
+
+	symbols_off = ov_path_offset(batch, fdt, "/__symbols__");
+	if (symbols_off < 0 && symbols_off != -FDT_ERR_NOTFOUND)
+		return symbols_off;
+
+	fdt_for_each_property_offset(property, fdto, fixups_off) {
+		int ret;
+
+		ret = overlay_fixup_phandle(batch, fdt, fdto, symbols_off,
+					    property);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int overlay_apply_node(struct fdt_overlay_batch *batch, void *fdt,
+			      int target, void *fdto, int node)
+{
+	int property;
+	int subnode;
+
+	fdt_for_each_property_offset(property, fdto, node) {
+		const char *name;
+		const void *prop;
+		int prop_len;
+		int ret;
+
+		prop = fdt_getprop_by_offset(fdto, property, &name, &prop_len);
+		if (prop_len == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_INTERNAL;
+		if (prop_len < 0)
+			return prop_len;
+
+		ret = ov_setprop(batch, fdt, target, name, prop, prop_len);
+		if (ret)
+			return ret;
+	}
+
+	fdt_for_each_subnode(subnode, fdto, node) {
+		const char *name = fdt_get_name(fdto, subnode, NULL);
+		int nnode;
+		int ret;
+
+		nnode = ov_add_subnode(batch, fdt, target, name);
+		if (nnode == -FDT_ERR_EXISTS) {
+			nnode = fdt_subnode_offset(fdt, target, name);
+			if (nnode == -FDT_ERR_NOTFOUND)
+				return -FDT_ERR_INTERNAL;
+		}
+		if (nnode < 0)
+			return nnode;
+
+		ret = overlay_apply_node(batch, fdt, nnode, fdto, subnode);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int overlay_merge(struct fdt_overlay_batch *batch, void *fdt,
+			 void *fdto)
+{
+	int fragment;
+
+	fdt_for_each_subnode(fragment, fdto, 0) {
+		int overlay;
+		int target;
+		int ret;
+
+		overlay = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (overlay == -FDT_ERR_NOTFOUND)
+			continue;
+		if (overlay < 0)
+			return overlay;
+
+		target = overlay_get_target(batch, fdt, fdto, fragment, NULL);
+		if (target < 0)
+			return target;
+
+		ret = overlay_apply_node(batch, fdt, target, fdto, overlay);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int get_path_len(const void *fdt, int nodeoffset)
+{
+	int len = 0, namelen;
+	const char *name;
+
+	for (;;) {
+		name = fdt_get_name(fdt, nodeoffset, &namelen);
+		if (!name)
+			return namelen;
+
+		/* root? we're done */
+		if (!namelen)
+			break;
+
+		nodeoffset = fdt_parent_offset(fdt, nodeoffset);
+		if (nodeoffset < 0)
+			return nodeoffset;
+		len += namelen + 1;
+	}
+
+	/* in case of root pretend it's "/" */
+	if (!len)
+		len++;
+
+	return len;
+}
+
+static int overlay_symbol_update(struct fdt_overlay_batch *batch, void *fdt,
+				 void *fdto)
+{
+	int root_sym, ov_sym, prop, path_len, fragment, target;
+	int len, frag_name_len, ret, rel_path_len;
+	const char *s, *e;
+	const char *path;
+	const char *name;
+	const char *frag_name;
+	const char *rel_path;
+	const char *target_path;
+	char *buf;
+	void *p;
+
+	ov_sym = fdt_subnode_offset(fdto, 0, "__symbols__");
+	if (ov_sym < 0)
+		return 0;
+
+	root_sym = fdt_subnode_offset(fdt, 0, "__symbols__");
+	if (root_sym == -FDT_ERR_NOTFOUND)
+		root_sym = ov_add_subnode(batch, fdt, 0, "__symbols__");
+	if (root_sym < 0)
+		return root_sym;
+
+	fdt_for_each_property_offset(prop, fdto, ov_sym) {
+		path = fdt_getprop_by_offset(fdto, prop, &name, &path_len);
+		if (!path)
+			return path_len;
+
+		/* verify it's a string property (terminated by a single \0) */
+		if (path_len < 1 ||
+		    memchr(path, '\0', path_len) != &path[path_len - 1])
+			return -FDT_ERR_BADVALUE;
+
+		/* keep end marker to avoid strlen() */
+		e = path + path_len;
+
+		if (*path != '/')
+			return -FDT_ERR_BADVALUE;
+
+		/* get fragment name first */
+		s = strchr(path + 1, '/');
+		if (!s)
+			continue;
+
+		frag_name = path + 1;
+		frag_name_len = s - path - 1;
+
+		len = sizeof("/__overlay__/") - 1;
+		if (e - s > len && !memcmp(s, "/__overlay__/", len)) {
+			/* /<fragment-name>/__overlay__/<relative-subnode-path> */
+			rel_path = s + len;
+			rel_path_len = e - rel_path;
+		} else if (e - s == len &&
+			   !memcmp(s, "/__overlay__", len - 1)) {
+			/* /<fragment-name>/__overlay__ */
+			rel_path = "";
+			rel_path_len = 1; /* Include NUL character */
+		} else {
+			continue;
+		}
+
+		ret = fdt_subnode_offset_namelen(fdto, 0, frag_name,
+						 frag_name_len);
+		if (ret < 0)
+			return -FDT_ERR_BADOVERLAY;
+		fragment = ret;
+
+		ret = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (ret < 0)
+			return -FDT_ERR_BADOVERLAY;
+
+		ret = overlay_get_target(batch, fdt, fdto, fragment,
+					 &target_path);
+		if (ret < 0)
+			return ret;
+		target = ret;
+
+		if (!target_path) {
+			ret = get_path_len(fdt, target);
+			if (ret < 0)
+				return ret;
+			len = ret;
+		} else {
+			len = strlen(target_path);
+		}
+
+		ret = ov_setprop_placeholder(batch, fdt, root_sym, name,
+					     len + (len > 1) + rel_path_len,
+					     &p);
+		if (ret < 0)
+			return ret;
+
+		if (!target_path) {
+			/* again in case setprop_placeholder changed it */
+			ret = overlay_get_target(batch, fdt, fdto, fragment,
+						 &target_path);
+			if (ret < 0)
+				return ret;
+			target = ret;
+		}
+
+		buf = p;
+		if (len > 1) { /* target is not root */
+			if (!target_path) {
+				ret = fdt_get_path(fdt, target, buf, len + 1);
+				if (ret < 0)
+					return ret;
+			} else {
+				memcpy(buf, target_path, len + 1);
+			}
+		} else {
+			len--;
+		}
+
+		buf[len] = '/';
+		memcpy(buf + len + 1, rel_path, rel_path_len);
+	}
+
+	return 0;
+}
+
+void fdt_overlay_batch_init(struct fdt_overlay_batch *batch)
+{
+	alist_init_struct(&batch->phandles, struct ov_phandle);
+	alist_init_struct(&batch->paths, struct ov_path);
+	alist_init_struct(&batch->symbols, struct ov_symbol);
+	batch->struct_size = 0;
+	batch->valid = false;
+}
+
+int fdt_overlay_batch_apply(struct fdt_overlay_batch *batch, void *fdt,
+			    void *fdto)
+{
+	u32 delta;
+	int ret;
+
+	ret = fdt_check_header(fdt);
+	if (!ret)
+		ret = fdt_check_header(fdto);
+	if (ret)
+		return ret;
+
+	/*
+	 * The caller may only resize the tree between overlays, so this is
+	 * just a sanity check. A change which keeps the same size is not
+	 * noticed, which is why the contents must be left alone.
+	 */
+	if (batch->valid && fdt_size_dt_struct(fdt) != batch->struct_size)
+		ov_drop(batch);
+
+	ret = ov_max_phandle(batch, fdt, &delta);
+	if (ret)
+		goto err;
+
+	ret = overlay_adjust_node_phandles(fdto, 0, delta);
+	if (ret)
+		goto err;
+
+	ret = overlay_update_local_references(fdto, delta);
+	if (ret)
+		goto err;
+
+	ret = overlay_fixup_phandles(batch, fdt, fdto);
+	if (ret)
+		goto err;
+
+	ret = overlay_merge(batch, fdt, fdto);
+	if (ret)
+		goto err;
+
+	ret = overlay_symbol_update(batch, fdt, fdto);
+	if (ret)
+		goto err;
+
+	/* The overlay has been damaged, erase its magic */
+	fdt_set_magic(fdto, ~0);
+	batch->struct_size = fdt_size_dt_struct(fdt);
+
+	return 0;
+
+err:
+	/* Both trees might have been damaged, erase their magic */
+	fdt_set_magic(fdto, ~0);
+	fdt_set_magic(fdt, ~0);
+	ov_drop(batch);
+
+	return ret;
+}
+
+void fdt_overlay_batch_uninit(struct fdt_overlay_batch *batch)
+{
+	ov_drop(batch);
+	alist_uninit(&batch->phandles);
+	alist_uninit(&batch->paths);
+	alist_uninit(&batch->symbols);
+}
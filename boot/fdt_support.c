@@ -2157,6 +2157,12 @@ int fdt_fixup_display(void *blob, const char *path, const char *display)
  * in the case of an error
  */
 int fdt_overlay_apply_verbose(void *fdt, void *fdto)
+{
+	return fdt_overlay_batch_apply_verbose(NULL, fdt, fdto);
+}
+
+int fdt_overlay_batch_apply_verbose(struct fdt_overlay_batch *batch,
+				    void *fdt, void *fdto)
 {
 	int err;
 	bool has_symbols;
@@ -2164,7 +2170,10 @@ int fdt_overlay_apply_verbose(void *fdt, void *fdto)
 	err = fdt_path_offset(fdt, "/__symbols__");
 	has_symbols = err >= 0;
 
-	err = fdt_overlay_apply(fdt, fdto);
+	if (batch)
+		err = fdt_overlay_batch_apply(batch, fdt, fdto);
+	else
+		err = fdt_overlay_apply(fdt, fdto);
 	if (err < 0) {
 		printf("failed on fdt_overlay_apply(): %s\n",
 				fdt_strerror(err));
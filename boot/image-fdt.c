@@ -8,7 +8,10 @@
  * Wolfgang Denk, DENX Software Engineering, wd@denx.de.
  */
 
+#include <abuf.h>
+#include <bootstage.h>
 #include <command.h>
+#include <event.h>
 #include <fdt_support.h>
 #include <fdtdec.h>
 #include <env.h>
@@ -20,6 +23,7 @@
 #include <asm/global_data.h>
 #include <linux/libfdt.h>
 #include <mapmem.h>
+#include <of_live.h>
 #include <asm/io.h>
 #include <dm/ofnode.h>
 #include <tee/optee.h>
@@ -566,12 +570,87 @@ __weak int arch_fixup_fdt(void *blob)
 	return 0;
 }
 
+/**
+ * fdt_fixup_live() - Send the fixup event using a live tree
+ *
+ * The ofnode API cannot access a flat tree when OF_LIVE is active, so the
+ * blob is unflattened, the fixups are applied to the live tree and then the
+ * result is flattened back into the blob in one go. This also avoids moving
+ * the rest of the blob around for each property or node which is added.
+ *
+ * The memory reservations and boot CPU are copied across from the original
+ * blob, since the live tree does not hold them.
+ *
+ * @images: Images being booted
+ * @blob: Flat tree to update, whose fdt_totalsize() is the space available
+ * Return: 0 if OK, -ENOSPC if the updated tree does not fit, other -ve on error
+ */
+static int fdt_fixup_live(struct bootm_headers *images, void *blob)
+{
+	int space = fdt_totalsize(blob);
+	struct event_ft_fixup fixup;
+	struct device_node *root;
+	int ret, num_rsv, i;
+	struct abuf buf;
+	void *fdt;
+
+	ret = unflatten_device_tree(blob, &root);
+	if (ret)
+		return log_msg_ret("unf", ret);
+	abuf_init(&buf);
+	fixup.tree = oftree_from_np(root);
+	fixup.images = images;
+	ret = event_notify(EVT_FT_FIXUP, &fixup, sizeof(fixup));
+	if (!ret)
+		ret = of_live_flatten(root, &buf);
+	oftree_dispose(fixup.tree);
+	if (ret)
+		goto err;
+
+	/* Add the memory reservations, which of_live_flatten() drops */
+	num_rsv = fdt_num_mem_rsv(blob);
+	ret = -ENOMEM;
+	if (!abuf_realloc_inc(&buf, num_rsv * sizeof(struct fdt_reserve_entry)))
+		goto err;
+	fdt = abuf_data(&buf);
+	ret = fdt_open_into(fdt, fdt, abuf_size(&buf));
+	for (i = 0; !ret && i < num_rsv; i++) {
+		u64 addr, size;
+
+		ret = fdt_get_mem_rsv(blob, i, &addr, &size);
+		if (!ret)
+			ret = fdt_add_mem_rsv(fdt, addr, size);
+	}
+	if (ret) {
+		log_debug("Failed to copy reservations (err=%d)\n", ret);
+		ret = -EINVAL;
+		goto err;
+	}
+	fdt_set_boot_cpuid_phys(fdt, fdt_boot_cpuid_phys(blob));
+
+	/* Write it back, keeping the same space for later fixups */
+	ret = fdt_open_into(fdt, blob, space);
+	if (ret) {
+		log_debug("Failed to copy tree (err=%d)\n", ret);
+		ret = ret == -FDT_ERR_NOSPACE ? -ENOSPC : -EINVAL;
+		goto err;
+	}
+	abuf_uninit(&buf);
+
+	return 0;
+err:
+	abuf_uninit(&buf);
+
+	return log_msg_ret("fix", ret);
+}
+
 int image_setup_libfdt(struct bootm_headers *images, void *blob, bool lmb)
 {
 	ulong *initrd_start = &images->initrd_start;
 	ulong *initrd_end = &images->initrd_end;
 	int ret, fdt_ret, of_size;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_FDT_FIXUP, "fdt_fixup");
 	if (IS_ENABLED(CONFIG_OF_ENV_SETUP)) {
 		const char *fdt_fixup;
 
@@ -650,7 +729,13 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob, bool lmb)
 		goto err;
 
 	/* after here we are using a livetree */
-	if (!of_live_active() && CONFIG_IS_ENABLED(EVENT)) {
+	if (of_live_active() && CONFIG_IS_ENABLED(EVENT)) {
+		ret = fdt_fixup_live(images, blob);
+		if (ret) {
+			printf("ERROR: fdt fixup event failed: %d\n", ret);
+			goto err;
+		}
+	} else if (CONFIG_IS_ENABLED(EVENT)) {
 		struct event_ft_fixup fixup;
 
 		fixup.tree = oftree_from_fdt(blob);
@@ -682,9 +767,11 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob, bool lmb)
 	if (IS_ENABLED(CONFIG_OF_BOARD_SETUP))
 		ft_board_setup_ex(blob, gd->bd);
 #endif
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 
 	return 0;
 err:
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 	printf(" - must RESET the board to recover.\n\n");
 
 	return ret;
@@ -2367,6 +2367,7 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 	 * Instead, let's be lazy and use void *.
 	 */
 	char *of_flat_tree;
+	struct fdt_overlay_batch batch = {};
 	void *base, *ov, *ovcopy = NULL;
 	int i, err, noffset, ov_noffset;
 #endif
@@ -2424,6 +2425,7 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 	load = (ulong)of_flat_tree;
 
 	/* apply extra configs in FIT first, followed by args */
+	fdt_overlay_batch_init(&batch);
 	for (i = 1; ; i++) {
 		if (i < count) {
 			noffset = fit_conf_get_prop_node_index(fit, cfg_noffset,
@@ -2491,7 +2493,7 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 		}
 
 		/* the verbose method prints out messages on error */
-		err = fdt_overlay_apply_verbose(base, ovcopy);
+		err = fdt_overlay_batch_apply_verbose(&batch, base, ovcopy);
 		if (err < 0) {
 			fdt_noffset = err;
 			goto out;
@@ -2516,6 +2518,7 @@ out:
 
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
 	free(ovcopy);
+	fdt_overlay_batch_uninit(&batch);
 #endif
 	free(fit_uname_config_copy);
 	return fdt_noffset;
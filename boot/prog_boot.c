@@ -30,6 +30,7 @@ static void show_bootmeths(void)
 
 int bootstd_prog_boot(void)
 {
+	struct bootflow_tried tried = {};
 	struct bootflow_iter iter;
 	struct bootflow bflow;
 	int ret, flags, i;
@@ -39,10 +40,12 @@ int bootstd_prog_boot(void)
 	flags = BOOTFLOWIF_HUNT | BOOTFLOWIF_SHOW | BOOTFLOWIF_SKIP_GLOBAL;
 
 	bootstd_clear_glob();
+	if (CONFIG_IS_ENABLED(BOOTFLOW_REMEMBER))
+		bootflow_boot_remembered(&tried);
 	for (i = 0, ret = bootflow_scan_first(NULL, NULL, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
 	     i++, ret = bootflow_scan_next(&iter, &bflow)) {
-		if (!bflow.err)
+		if (!bflow.err && !bootflow_was_tried(&tried, &bflow))
 			bootflow_run_boot(&iter, &bflow);
 		bootflow_free(&bflow);
 	}
@@ -6,6 +6,7 @@
 
 #define LOG_CATEGORY	LOGC_BOOT
 
+#include <arena.h>
 #include <bootflow.h>
 #include <command.h>
 #include <dm.h>
@@ -218,49 +219,16 @@ static int get_relfile_envaddr(struct pxe_context *ctx, const char *file_path,
 /**
  * label_create() - crate a new PXE label
  *
- * Allocates memory for and initializes a pxe_label. This uses malloc, so the
- * result must be free()'d to reclaim the memory.
+ * Allocates memory for and initializes a pxe_label. The memory comes from the
+ * menu's arena, so it is freed along with everything else in the menu by
+ * destroy_pxe_menu()
  *
+ * @cfg: Menu which will hold the label
  * Returns a pointer to the label, or NULL if out of memory
  */
-static struct pxe_label *label_create(void)
+static struct pxe_label *label_create(struct pxe_menu *cfg)
 {
-	struct pxe_label *label;
-
-	label = malloc(sizeof(struct pxe_label));
-	if (!label)
-		return NULL;
-
-	memset(label, 0, sizeof(struct pxe_label));
-
-	return label;
-}
-
-/**
- * label_destroy() - free the memory used by a pxe_label
- *
- * This frees @label itself as well as memory used by its name,
- * kernel, config, append, initrd, fdt, fdtdir and fdtoverlay members, if
- * they're non-NULL.
- *
- * So - be sure to only use dynamically allocated memory for the members of
- * the pxe_label struct, unless you want to clean it up first. These are
- * currently only created by the pxe file parsing code.
- *
- * @label: Label to free
- */
-static void label_destroy(struct pxe_label *label)
-{
-	free(label->name);
-	free(label->kernel_label);
-	free(label->kernel);
-	free(label->config);
-	free(label->append);
-	free(label->initrd);
-	free(label->fdt);
-	free(label->fdtdir);
-	free(label->fdtoverlays);
-	free(label);
+	return arena_zalloc(&cfg->arena, sizeof(struct pxe_label));
 }
 
 /**
@@ -353,6 +321,7 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 {
 	char *fdtoverlay = label->fdtoverlays;
 	struct fdt_header *working_fdt;
+	struct fdt_overlay_batch batch;
 	char *fdtoverlay_addr_env;
 	ulong fdtoverlay_addr;
 	ulong fdt_addr;
@@ -375,6 +344,7 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 	fdtoverlay_addr = hextoul(fdtoverlay_addr_env, NULL);
 
 	/* Cycle over the overlay files and apply them in order */
+	fdt_overlay_batch_init(&batch);
 	do {
 		struct fdt_header *blob;
 		char *overlayfile;
@@ -418,7 +388,7 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 			goto skip_overlay;
 		}
 
-		err = fdt_overlay_apply_verbose(working_fdt, blob);
+		err = fdt_overlay_batch_apply_verbose(&batch, working_fdt, blob);
 		if (err) {
 			printf("Failed to apply overlay %s, skipping\n",
 			       overlayfile);
@@ -429,6 +399,7 @@ skip_overlay:
 		if (end)
 			free(overlayfile);
 	} while ((fdtoverlay = strstr(fdtoverlay, " ")));
+	fdt_overlay_batch_uninit(&batch);
 }
 #endif
 
@@ -847,9 +818,9 @@ enum lex_state {
  * The location of *p is updated to point to the first character after the end
  * of the token - the ending delimiter.
  *
- * Memory for t->val is allocated using malloc and must be free()'d to reclaim
- * it.
+ * Memory for t->val is allocated from @arena and is freed when the arena is.
  *
+ * @arena: Arena to allocate the string from
  * @p: Points to a pointer to the current position in the input being processed.
  *	Updated to point at the first character after the current token
  * @t: Pointers to a token to fill in
@@ -857,7 +828,7 @@ enum lex_state {
  * @lower: true to convert the string to lower case when storing
  * Returns the new value of t->val, on success, NULL if out of memory
  */
-static char *get_string(char **p, struct token *t, char delim, int lower)
+static char *get_string(struct arena *arena, char **p, struct token *t, char delim, int lower)
 {
 	char *b, *e;
 	size_t len, i;
@@ -882,7 +853,7 @@ static char *get_string(char **p, struct token *t, char delim, int lower)
 	 * Allocate memory to hold the string, and copy it in, converting
 	 * characters to lowercase if lower is != 0.
 	 */
-	t->val = malloc(len + 1);
+	t->val = arena_alloc(arena, len + 1);
 	if (!t->val)
 		return NULL;
 
@@ -929,7 +900,7 @@ static void get_keyword(struct token *t)
  * @p: Points to a pointer to the current position in the input being processed.
  *	Updated to point at the first character after the current token
  */
-static void get_token(char **p, struct token *t, enum lex_state state)
+static void get_token(struct arena *arena, char **p, struct token *t, enum lex_state state)
 {
 	char *c = *p;
 
@@ -955,7 +926,7 @@ static void get_token(char **p, struct token *t, enum lex_state state)
 		t->type = T_EOF;
 		c++;
 	} else if (state == L_SLITERAL) {
-		get_string(&c, t, '\n', 0);
+		get_string(arena, &c, t, '\n', 0);
 	} else if (state == L_KEYWORD) {
 		/*
 		 * when we expect a keyword, we first get the next string
@@ -964,7 +935,7 @@ static void get_token(char **p, struct token *t, enum lex_state state)
 		 * converted to a keyword token of the appropriate type, and
 		 * if not, it remains a string token.
 		 */
-		get_string(&c, t, ' ', 1);
+		get_string(arena, &c, t, ' ', 1);
 		get_keyword(t);
 	}
 
@@ -996,12 +967,12 @@ static void eol_or_eof(char **c)
  * Parse a string literal and store a pointer it at *dst. String literals
  * terminate at the end of the line.
  */
-static int parse_sliteral(char **c, char **dst)
+static int parse_sliteral(struct arena *arena, char **c, char **dst)
 {
 	struct token t;
 	char *s = *c;
 
-	get_token(c, &t, L_SLITERAL);
+	get_token(arena, c, &t, L_SLITERAL);
 
 	if (t.type != T_STRING) {
 		printf("Expected string literal: %.*s\n", (int)(*c - s), s);
@@ -1016,12 +987,12 @@ static int parse_sliteral(char **c, char **dst)
 /*
  * Parse a base 10 (unsigned) integer and store it at *dst.
  */
-static int parse_integer(char **c, int *dst)
+static int parse_integer(struct arena *arena, char **c, int *dst)
 {
 	struct token t;
 	char *s = *c;
 
-	get_token(c, &t, L_SLITERAL);
+	get_token(arena, c, &t, L_SLITERAL);
 	if (t.type != T_STRING) {
 		printf("Expected string: %.*s\n", (int)(*c - s), s);
 		return -EINVAL;
@@ -1029,8 +1000,6 @@ static int parse_integer(char **c, int *dst)
 
 	*dst = simple_strtol(t.val, NULL, 10);
 
-	free(t.val);
-
 	return 1;
 }
 
@@ -1054,7 +1023,7 @@ static int handle_include(struct pxe_context *ctx, char **c, unsigned long base,
 	char *buf;
 	int ret;
 
-	err = parse_sliteral(c, &include_path);
+	err = parse_sliteral(&cfg->arena, c, &include_path);
 	if (err < 0) {
 		printf("Expected include path: %.*s\n", (int)(*c - s), s);
 		return err;
@@ -1090,11 +1059,11 @@ static int parse_menu(struct pxe_context *ctx, char **c, struct pxe_menu *cfg,
 	char *s = *c;
 	int err = 0;
 
-	get_token(c, &t, L_KEYWORD);
+	get_token(&cfg->arena, c, &t, L_KEYWORD);
 
 	switch (t.type) {
 	case T_TITLE:
-		err = parse_sliteral(c, &cfg->title);
+		err = parse_sliteral(&cfg->arena, c, &cfg->title);
 
 		break;
 
@@ -1103,7 +1072,7 @@ static int parse_menu(struct pxe_context *ctx, char **c, struct pxe_menu *cfg,
 		break;
 
 	case T_BACKGROUND:
-		err = parse_sliteral(c, &cfg->bmp);
+		err = parse_sliteral(&cfg->arena, c, &cfg->bmp);
 		break;
 
 	default:
@@ -1129,19 +1098,19 @@ static int parse_label_menu(char **c, struct pxe_menu *cfg,
 
 	s = *c;
 
-	get_token(c, &t, L_KEYWORD);
+	get_token(&cfg->arena, c, &t, L_KEYWORD);
 
 	switch (t.type) {
 	case T_DEFAULT:
 		if (!cfg->default_label)
-			cfg->default_label = strdup(label->name);
+			cfg->default_label = arena_strdup(&cfg->arena, label->name);
 
 		if (!cfg->default_label)
 			return -ENOMEM;
 
 		break;
 	case T_LABEL:
-		parse_sliteral(c, &label->menu);
+		parse_sliteral(&cfg->arena, c, &label->menu);
 		break;
 	default:
 		printf("Ignoring malformed menu command: %.*s\n",
@@ -1157,17 +1126,17 @@ static int parse_label_menu(char **c, struct pxe_menu *cfg,
  * Handles parsing a 'kernel' label.
  * expecting "filename" or "<fit_filename>#cfg"
  */
-static int parse_label_kernel(char **c, struct pxe_label *label)
+static int parse_label_kernel(struct arena *arena, char **c, struct pxe_label *label)
 {
 	char *s;
 	int err;
 
-	err = parse_sliteral(c, &label->kernel);
+	err = parse_sliteral(arena, c, &label->kernel);
 	if (err < 0)
 		return err;
 
 	/* copy the kernel label to compare with FDT / INITRD when FIT is used */
-	label->kernel_label = strdup(label->kernel);
+	label->kernel_label = arena_strdup(arena, label->kernel);
 	if (!label->kernel_label)
 		return -ENOMEM;
 
@@ -1175,7 +1144,7 @@ static int parse_label_kernel(char **c, struct pxe_label *label)
 	if (!s)
 		return 1;
 
-	label->config = strdup(s);
+	label->config = arena_strdup(arena, s);
 	if (!label->config)
 		return -ENOMEM;
 
@@ -1200,14 +1169,13 @@ static int parse_label(char **c, struct pxe_menu *cfg)
 	struct pxe_label *label;
 	int err;
 
-	label = label_create();
+	label = label_create(cfg);
 	if (!label)
 		return -ENOMEM;
 
-	err = parse_sliteral(c, &label->name);
+	err = parse_sliteral(&cfg->arena, c, &label->name);
 	if (err < 0) {
 		printf("Expected label name: %.*s\n", (int)(*c - s), s);
-		label_destroy(label);
 		return -EINVAL;
 	}
 
@@ -1215,7 +1183,7 @@ static int parse_label(char **c, struct pxe_menu *cfg)
 
 	while (1) {
 		s = *c;
-		get_token(c, &t, L_KEYWORD);
+		get_token(&cfg->arena, c, &t, L_KEYWORD);
 
 		err = 0;
 		switch (t.type) {
@@ -1225,51 +1193,49 @@ static int parse_label(char **c, struct pxe_menu *cfg)
 
 		case T_KERNEL:
 		case T_LINUX:
-			err = parse_label_kernel(c, label);
+			err = parse_label_kernel(&cfg->arena, c, label);
 			break;
 
 		case T_APPEND:
-			err = parse_sliteral(c, &label->append);
+			err = parse_sliteral(&cfg->arena, c, &label->append);
 			if (label->initrd)
 				break;
 			s = strstr(label->append, "initrd=");
 			if (!s)
 				break;
 			s += 7;
-			len = (int)(strchr(s, ' ') - s);
-			label->initrd = malloc(len + 1);
-			strncpy(label->initrd, s, len);
-			label->initrd[len] = '\0';
+			len = strcspn(s, " ");
+			label->initrd = arena_strndup(&cfg->arena, s, len);
 
 			break;
 
 		case T_INITRD:
 			if (!label->initrd)
-				err = parse_sliteral(c, &label->initrd);
+				err = parse_sliteral(&cfg->arena, c, &label->initrd);
 			break;
 
 		case T_FDT:
 			if (!label->fdt)
-				err = parse_sliteral(c, &label->fdt);
+				err = parse_sliteral(&cfg->arena, c, &label->fdt);
 			break;
 
 		case T_FDTDIR:
 			if (!label->fdtdir)
-				err = parse_sliteral(c, &label->fdtdir);
+				err = parse_sliteral(&cfg->arena, c, &label->fdtdir);
 			break;
 
 		case T_FDTOVERLAYS:
 			if (!label->fdtoverlays)
-				err = parse_sliteral(c, &label->fdtoverlays);
+				err = parse_sliteral(&cfg->arena, c, &label->fdtoverlays);
 			break;
 
 		case T_LOCALBOOT:
 			label->localboot = 1;
-			err = parse_integer(c, &label->localboot_val);
+			err = parse_integer(&cfg->arena, c, &label->localboot_val);
 			break;
 
 		case T_IPAPPEND:
-			err = parse_integer(c, &label->ipappend);
+			err = parse_integer(&cfg->arena, c, &label->ipappend);
 			break;
 
 		case T_KASLRSEED:
@@ -1325,7 +1291,7 @@ static int parse_pxefile_top(struct pxe_context *ctx, char *p, unsigned long bas
 	while (1) {
 		s = p;
 
-		get_token(&p, &t, L_KEYWORD);
+		get_token(&cfg->arena, &p, &t, L_KEYWORD);
 
 		err = 0;
 		switch (t.type) {
@@ -1337,7 +1303,7 @@ static int parse_pxefile_top(struct pxe_context *ctx, char *p, unsigned long bas
 			break;
 
 		case T_TIMEOUT:
-			err = parse_integer(&p, &cfg->timeout);
+			err = parse_integer(&cfg->arena, &p, &cfg->timeout);
 			break;
 
 		case T_LABEL:
@@ -1346,26 +1312,18 @@ static int parse_pxefile_top(struct pxe_context *ctx, char *p, unsigned long bas
 
 		case T_DEFAULT:
 		case T_ONTIMEOUT:
-			err = parse_sliteral(&p, &label_name);
-
-			if (label_name) {
-				if (cfg->default_label)
-					free(cfg->default_label);
+			err = parse_sliteral(&cfg->arena, &p, &label_name);
 
+			if (label_name)
 				cfg->default_label = label_name;
-			}
 
 			break;
 
 		case T_FALLBACK:
-			err = parse_sliteral(&p, &label_name);
-
-			if (label_name) {
-				if (cfg->fallback_label)
-					free(cfg->fallback_label);
+			err = parse_sliteral(&cfg->arena, &p, &label_name);
 
+			if (label_name)
 				cfg->fallback_label = label_name;
-			}
 
 			break;
 
@@ -1376,7 +1334,7 @@ static int parse_pxefile_top(struct pxe_context *ctx, char *p, unsigned long bas
 			break;
 
 		case T_PROMPT:
-			err = parse_integer(&p, &cfg->prompt);
+			err = parse_integer(&cfg->arena, &p, &cfg->prompt);
 			// Do not fail if prompt configuration is undefined
 			if (err <  0)
 				eol_or_eof(&p);
@@ -1403,19 +1361,8 @@ static int parse_pxefile_top(struct pxe_context *ctx, char *p, unsigned long bas
  */
 void destroy_pxe_menu(struct pxe_menu *cfg)
 {
-	struct list_head *pos, *n;
-	struct pxe_label *label;
-
-	free(cfg->title);
-	free(cfg->default_label);
-	free(cfg->fallback_label);
-
-	list_for_each_safe(pos, n, &cfg->labels) {
-		label = list_entry(pos, struct pxe_label, list);
-
-		label_destroy(label);
-	}
-
+	/* the labels and all strings are in the arena */
+	arena_uninit(&cfg->arena);
 	free(cfg);
 }
 
@@ -1432,6 +1379,7 @@ struct pxe_menu *parse_pxefile(struct pxe_context *ctx, unsigned long menucfg)
 	memset(cfg, 0, sizeof(struct pxe_menu));
 
 	INIT_LIST_HEAD(&cfg->labels);
+	arena_init(&cfg->arena, 0);
 
 	buf = map_sysmem(menucfg, 0);
 	r = parse_pxefile_top(ctx, buf, menucfg, cfg, 1);
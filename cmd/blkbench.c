@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Command for measuring block-device performance
+ */
+
+#include <blk.h>
+#include <blkbench.h>
+#include <command.h>
+#include <mapmem.h>
+#include <part.h>
+#include <vsprintf.h>
+
+static int do_blk_bench(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	struct blk_bench_params params = {};
+	struct blk_bench_result result;
+	struct blk_desc *desc;
+	ulong addr;
+	void *buf;
+	int ret;
+
+	if (argc < 9 || argc > 10)
+		return CMD_RET_USAGE;
+
+	if (!strcmp(argv[3], "write"))
+		params.flags |= BLK_BENCH_WRITE;
+	else if (strcmp(argv[3], "read"))
+		return CMD_RET_USAGE;
+
+	if (!strcmp(argv[4], "rand"))
+		params.flags |= BLK_BENCH_RANDOM;
+	else if (strcmp(argv[4], "seq"))
+		return CMD_RET_USAGE;
+
+	if (argc == 10) {
+		if (strcmp(argv[9], "nocache"))
+			return CMD_RET_USAGE;
+		params.flags |= BLK_BENCH_NOCACHE;
+	}
+
+	if (blk_get_device_by_str(argv[1], argv[2], &desc) < 0)
+		return CMD_RET_FAILURE;
+
+	addr = hextoul(argv[5], NULL);
+	params.start = hextoul(argv[6], NULL);
+	params.blocks = hextoul(argv[7], NULL);
+	params.count = dectoul(argv[8], NULL);
+
+	buf = map_sysmem(addr, params.blocks * desc->blksz);
+	ret = blk_bench_run(desc, &params, buf, &result);
+	unmap_sysmem(buf);
+	if (ret == -EINVAL) {
+		printf("Invalid parameters: device has " LBAFU " blocks\n",
+		       desc->lba);
+		return CMD_RET_FAILURE;
+	}
+	blk_bench_show(desc, &params, &result);
+	if (ret) {
+		printf("Failed after %u transfers (err=%d)\n", result.ops, ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD_WITH_SUBCMDS(
+	blk, "Block-device utilities",
+	"bench <interface> <dev[.hwpart]> read|write seq|rand <addr> <blk#> <cnt> <count> [nocache]\n"
+	"    - make <count> transfers of <cnt> blocks each, starting at <blk#>\n"
+	"      and using the buffer at <addr>; show throughput and latency\n"
+	"      (write destroys the data on the device)",
+	U_BOOT_SUBCMD_MKENT(bench, 10, 0, do_blk_bench));
@@ -129,6 +129,7 @@ __maybe_unused static int bootflow_handle_menu(struct bootstd_priv *std,
 static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 			    char *const argv[])
 {
+	struct bootflow_tried tried = {};
 	struct bootstd_priv *std;
 	struct bootflow_iter iter;
 	struct udevice *dev = NULL;
@@ -200,6 +201,15 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		bootstd_clear_bootflows_for_bootdev(dev);
 	else
 		bootstd_clear_glob();
+
+	/*
+	 * Try the bootflow used last time, falling back to a full scan which
+	 * skips it
+	 */
+	if (CONFIG_IS_ENABLED(BOOTFLOW_REMEMBER) && boot && !menu && !list &&
+	    !all && !dev && !label)
+		bootflow_boot_remembered(&tried);
+
 	for (i = 0,
 	     ret = bootflow_scan_first(dev, label, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
@@ -214,7 +224,8 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		}
 		if (list)
 			show_bootflow(i, &bflow, errors);
-		if (!menu && boot && !bflow.err)
+		if (!menu && boot && !bflow.err &&
+		    !bootflow_was_tried(&tried, &bflow))
 			bootflow_run_boot(&iter, &bflow);
 	}
 	bootflow_iter_uninit(&iter);
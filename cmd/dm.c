@@ -6,6 +6,7 @@
  * Marek Vasut <marex@denx.de>
  */
 
+#include <bootprof.h>
 #include <command.h>
 #include <dm/root.h>
 #include <dm/util.h>
@@ -47,6 +48,16 @@ static int do_dm_dump_mem(struct cmd_tbl *cmdtp, int flag, int argc,
 }
 #endif /* DM_STATS */
 
+#if CONFIG_IS_ENABLED(BOOTPROF)
+static int do_dm_profile(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	bootprof_report();
+
+	return 0;
+}
+#endif /* BOOTPROF */
+
 static int do_dm_dump_static_driver_info(struct cmd_tbl *cmdtp, int flag,
 					 int argc, char * const argv[])
 {
@@ -111,11 +122,20 @@ static int do_dm_dump_uclass(struct cmd_tbl *cmdtp, int flag, int argc,
 #define DM_MEM
 #endif
 
+#if CONFIG_IS_ENABLED(BOOTPROF)
+#define DM_PROFILE_HELP	"dm profile       Show time spent in each driver and uclass\n"
+#define DM_PROFILE	U_BOOT_SUBCMD_MKENT(profile, 1, 1, do_dm_profile),
+#else
+#define DM_PROFILE_HELP
+#define DM_PROFILE
+#endif
+
 U_BOOT_LONGHELP(dm,
 	"compat        Dump list of drivers with compatibility strings\n"
 	"dm devres        Dump list of device resources for each device\n"
 	"dm drivers       Dump list of drivers with uclass and instances\n"
 	DM_MEM_HELP
+	DM_PROFILE_HELP
 	"dm static        Dump list of drivers with static platform data\n"
 	"dm tree [-s][-e][name]   Dump tree of driver model devices (-s=sort)\n"
 	"dm uclass [-e][name]     Dump list of instances for each uclass");
@@ -125,6 +145,7 @@ U_BOOT_CMD_WITH_SUBCMDS(dm, "Driver model low level access", dm_help_text,
 	U_BOOT_SUBCMD_MKENT(devres, 1, 1, do_dm_dump_devres),
 	U_BOOT_SUBCMD_MKENT(drivers, 1, 1, do_dm_dump_drivers),
 	DM_MEM
+	DM_PROFILE
 	U_BOOT_SUBCMD_MKENT(static, 1, 1, do_dm_dump_static_driver_info),
 	U_BOOT_SUBCMD_MKENT(tree, 4, 1, do_dm_dump_tree),
 	U_BOOT_SUBCMD_MKENT(uclass, 3, 1, do_dm_dump_uclass));
@@ -14,8 +14,10 @@
 #include <part.h>
 #include <sparse_format.h>
 #include <image-sparse.h>
+#include <time.h>
 #include <vsprintf.h>
 #include <linux/ctype.h>
+#include <linux/math64.h>
 
 static int curr_device = -1;
 
@@ -346,11 +348,32 @@ static int do_mmcrpmb(struct cmd_tbl *cmdtp, int flag,
 }
 #endif
 
+/**
+ * print_mmc_rate() - Show how long a transfer took, finishing the line
+ *
+ * @mmc: MMC device used for the transfer
+ * @cnt: Number of blocks transferred
+ * @us: Time taken in microseconds
+ */
+static void print_mmc_rate(struct mmc *mmc, u32 cnt, ulong us)
+{
+	u64 bytes = (u64)cnt * mmc_get_blk_desc(mmc)->blksz;
+
+	printf(", %llu bytes in %lu us", bytes, us);
+	if (us) {
+		puts(" (");
+		print_size(div_u64(bytes * 1000000, us), "/s");
+		puts(")");
+	}
+	puts("\n");
+}
+
 static int do_mmc_read(struct cmd_tbl *cmdtp, int flag,
 		       int argc, char *const argv[])
 {
 	struct mmc *mmc;
 	u32 blk, cnt, n;
+	ulong start;
 	void *ptr;
 
 	if (argc != 4)
@@ -367,8 +390,14 @@ static int do_mmc_read(struct cmd_tbl *cmdtp, int flag,
 	printf("MMC read: dev # %d, block # %d, count %d ... ",
 	       curr_device, blk, cnt);
 
+	start = timer_get_us();
 	n = blk_dread(mmc_get_blk_desc(mmc), blk, cnt, ptr);
-	printf("%d blocks read: %s\n", n, (n == cnt) ? "OK" : "ERROR");
+	start = timer_get_us() - start;
+	printf("%d blocks read: %s", n, (n == cnt) ? "OK" : "ERROR");
+	if (n == cnt)
+		print_mmc_rate(mmc, n, start);
+	else
+		puts("\n");
 	unmap_sysmem(ptr);
 
 	return (n == cnt) ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
@@ -445,6 +474,7 @@ static int do_mmc_write(struct cmd_tbl *cmdtp, int flag,
 {
 	struct mmc *mmc;
 	u32 blk, cnt, n;
+	ulong start;
 	void *ptr;
 
 	if (argc != 4)
@@ -465,8 +495,14 @@ static int do_mmc_write(struct cmd_tbl *cmdtp, int flag,
 		printf("Error: card is write protected!\n");
 		return CMD_RET_FAILURE;
 	}
+	start = timer_get_us();
 	n = blk_dwrite(mmc_get_blk_desc(mmc), blk, cnt, ptr);
-	printf("%d blocks written: %s\n", n, (n == cnt) ? "OK" : "ERROR");
+	start = timer_get_us() - start;
+	printf("%d blocks written: %s", n, (n == cnt) ? "OK" : "ERROR");
+	if (n == cnt)
+		print_mmc_rate(mmc, n, start);
+	else
+		puts("\n");
 	unmap_sysmem(ptr);
 
 	return (n == cnt) ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
@@ -14,6 +14,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <spi.h>
+#include <spi-mem.h>
 #include <time.h>
 #include <spi_flash.h>
 #include <asm/cache.h>
@@ -585,6 +586,85 @@ static int do_spi_flash_test(int argc, char *const argv[])
 	return 0;
 }
 
+/**
+ * spi_flash_read_path() - Describe how reads are sent to the SPI flash
+ *
+ * @flash: SPI flash to check
+ * Return: "dirmap" if the controller's direct-mapped window is used,
+ *	"dirmap (emulated)" if the dirmap API is used but falls back to
+ *	ordinary operations, or "spi-mem ops" otherwise
+ */
+static const char *spi_flash_read_path(struct spi_flash *flash)
+{
+	if (!CONFIG_IS_ENABLED(SPI_DIRMAP) || !flash->dirmap.rdesc)
+		return "spi-mem ops";
+
+	return flash->dirmap.rdesc->nodirmap ? "dirmap (emulated)" : "dirmap";
+}
+
+static int do_spi_flash_bench(int argc, char *const argv[])
+{
+	loff_t offset, len, maxsize;
+	ulong addr, start, delta;
+	uint64_t speed;	/* KiB/s */
+	int dev = 0;
+	int count = 1;
+	char *endp;
+	void *buf;
+	int i, ret;
+
+	if (argc < 4)
+		return CMD_RET_USAGE;
+
+	addr = hextoul(argv[1], &endp);
+	if (*argv[1] == 0 || *endp != 0)
+		return CMD_RET_USAGE;
+
+	if (mtd_arg_off_size(2, &argv[2], &dev, &offset, &len, &maxsize,
+			     MTD_DEV_TYPE_NOR, flash->size))
+		return CMD_RET_FAILURE;
+
+	if (argc > 4)
+		count = max(1UL, dectoul(argv[4], NULL));
+
+	if (CONFIG_IS_ENABLED(LMB) && lmb_read_check(addr, len)) {
+		printf("ERROR: trying to overwrite reserved memory...\n");
+		return CMD_RET_FAILURE;
+	}
+
+	buf = map_physmem(addr, len, MAP_WRBACK);
+	if (!buf && addr) {
+		puts("Failed to map physical memory\n");
+		return CMD_RET_FAILURE;
+	}
+
+	start = timer_get_us();
+	for (i = 0; i < count; i++) {
+		ret = spi_flash_read(flash, offset, len, buf);
+		if (ret) {
+			printf("Read failed (err = %d)\n", ret);
+			unmap_physmem(buf, len);
+			return CMD_RET_FAILURE;
+		}
+	}
+	delta = max(timer_get_us() - start, 1UL);
+	unmap_physmem(buf, len);
+
+	printf("Read path: opcode %#02x, %d-%d-%d, %s, %u Hz\n",
+	       flash->read_opcode,
+	       spi_nor_get_protocol_inst_nbits(flash->read_proto),
+	       spi_nor_get_protocol_addr_nbits(flash->read_proto),
+	       spi_nor_get_protocol_data_nbits(flash->read_proto),
+	       spi_flash_read_path(flash), flash->spi->max_hz);
+
+	speed = (uint64_t)len * count * 1000000;
+	do_div(speed, (uint64_t)delta * 1024);
+	printf("%d x %#llx bytes in %lu us: %llu KiB/s\n", count,
+	       (unsigned long long)len, delta, speed);
+
+	return CMD_RET_SUCCESS;
+}
+
 static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 			char *const argv[])
 {
@@ -617,6 +697,8 @@ static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 		ret = do_spi_protect(argc, argv);
 	else if (IS_ENABLED(CONFIG_CMD_SF_TEST) && !strcmp(cmd, "test"))
 		ret = do_spi_flash_test(argc, argv);
+	else if (IS_ENABLED(CONFIG_CMD_SF_BENCH) && !strcmp(cmd, "bench"))
+		ret = do_spi_flash_bench(argc, argv);
 	else
 		ret = CMD_RET_USAGE;
 
@@ -644,6 +726,11 @@ U_BOOT_LONGHELP(sf,
 #endif
 #ifdef CONFIG_CMD_SF_TEST
 	"\nsf test offset len		- run a very basic destructive test"
+#endif
+#ifdef CONFIG_CMD_SF_BENCH
+	"\nsf bench addr offset|partition len [count]\n"
+	"					- read `len' bytes to `addr' `count'\n"
+	"					  times and report the throughput"
 #endif
 	);
 
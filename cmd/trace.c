@@ -8,6 +8,7 @@
 #include <mapmem.h>
 #include <trace.h>
 #include <vsprintf.h>
+#include <linux/errno.h>
 #include <asm/io.h>
 
 static int get_args(int argc, char *const argv[], char **buff,
@@ -76,12 +77,54 @@ static int create_call_list(int argc, char *const argv[])
 	return 0;
 }
 
+static int create_sample_list(int argc, char *const argv[])
+{
+	size_t buff_size, avail, buff_ptr, needed, used;
+	char *buff;
+	int err;
+
+	if (get_args(argc, argv, &buff, &buff_ptr, &buff_size))
+		return -1;
+
+	avail = buff_size - buff_ptr;
+	err = trace_list_samples(buff + buff_ptr, avail, &needed);
+	if (err == -ENOENT) {
+		printf("Sampling is disabled\n");
+		return 0;
+	}
+	if (err)
+		printf("Error: truncated (%#zx bytes needed)\n", needed);
+	used = min(avail, (size_t)needed);
+	printf("Samples dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
+	env_set_hex("profbase", map_to_sysmem(buff));
+	env_set_hex("profsize", buff_size);
+	env_set_hex("profoffset", buff_ptr + used);
+
+	return 0;
+}
+
 int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
 
 	if (!cmd)
 		return cmd_usage(cmdtp);
+	if (IS_ENABLED(CONFIG_TRACE_SAMPLE)) {
+		if (!strcmp(cmd, "samples")) {
+			if (create_sample_list(argc, argv))
+				return cmd_usage(cmdtp);
+			return 0;
+		}
+		if (!IS_ENABLED(CONFIG_TRACE)) {
+			if (!strcmp(cmd, "stats")) {
+				trace_sample_print_stats();
+				return 0;
+			}
+			return CMD_RET_USAGE;
+		}
+	}
 	switch (*cmd) {
 	case 'p':
 		trace_set_enabled(0);
@@ -99,6 +142,8 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		break;
 	case 's':
 		trace_print_stats();
+		if (IS_ENABLED(CONFIG_TRACE_SAMPLE))
+			trace_sample_print_stats();
 		break;
 	case 'w':
 		if (trace_wipe())
@@ -114,11 +159,17 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 U_BOOT_CMD(
 	trace,	4,	1,	do_trace,
 	"trace utility commands",
-	"stats                        - display tracing statistics\n"
-	"trace pause                        - pause tracing\n"
+	"stats                        - display tracing statistics"
+#ifdef CONFIG_TRACE
+	"\ntrace pause                        - pause tracing\n"
 	"trace resume                       - resume tracing\n"
 	"trace wipe                         - wipe traces\n"
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
 		"- dump function call trace into buffer"
+#endif
+#ifdef CONFIG_TRACE_SAMPLE
+	"\ntrace samples [<addr> <size>]      "
+		"- dump profiler samples into buffer"
+#endif
 );
@@ -73,6 +73,10 @@ static void display_ubi_info(struct ubi_device *ubi)
 	ubi_msg("number of PEBs reserved for bad PEB handling: %d",
 			ubi->beb_rsvd_pebs);
 	ubi_msg("max/mean erase counter: %d/%d", ubi->max_ec, ubi->mean_ec);
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	ubi_msg("fastmap:                    %s",
+		ubi->fm_disabled ? "disabled" : ubi->fm ? "present" : "none");
+#endif
 }
 
 static int ubi_info(int layout)
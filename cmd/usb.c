@@ -19,6 +19,7 @@
 #include <memalign.h>
 #include <asm/byteorder.h>
 #include <asm/unaligned.h>
+#include <linux/math64.h>
 #include <part.h>
 #include <usb.h>
 
@@ -596,6 +597,53 @@ static void usb_show_info(struct usb_device *udev)
 }
 #endif
 
+#if CONFIG_IS_ENABLED(USB_EP_STATS)
+/* shows the bulk-transfer statistics of each endpoint which has been used */
+static void usb_show_ep_stats(struct usb_device *udev)
+{
+	struct usb_ep_stats *stats;
+	int dir, ep;
+
+	for (dir = 0; dir < 2; dir++) {
+		for (ep = 0; ep < USB_MAXENDPOINTS; ep++) {
+			stats = &udev->ep_stats[dir][ep];
+			if (!stats->xfers)
+				continue;
+			printf("%3d  %2d %-3s %10u %6u %12llu %10llu %8llu  %s\n",
+			       udev->devnum, ep, dir ? "out" : "in",
+			       stats->xfers, stats->errors, stats->bytes,
+			       stats->time_us, stats->time_us ?
+			       div64_u64(stats->bytes * 1000000,
+					 stats->time_us * 1024) : 0,
+			       udev->prod);
+		}
+	}
+}
+
+static void usb_show_stats(struct usb_device *udev)
+{
+#ifdef CONFIG_DM_USB
+	struct udevice *child;
+
+	usb_show_ep_stats(udev);
+	for (device_find_first_child(udev->dev, &child);
+	     child;
+	     device_find_next_child(&child)) {
+		if (device_active(child) &&
+		    (device_get_uclass_id(child) != UCLASS_BOOTDEV) &&
+		    (device_get_uclass_id(child) != UCLASS_USB_EMUL) &&
+		    (device_get_uclass_id(child) != UCLASS_BLK)) {
+			udev = dev_get_parent_priv(child);
+			if (udev)
+				usb_show_stats(udev);
+		}
+	}
+#else
+	usb_show_ep_stats(udev);
+#endif
+}
+#endif
+
 /******************************************************************************
  * usb command intepreter
  */
@@ -671,6 +719,22 @@ static int do_usb(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		}
 		return 0;
 	}
+#if CONFIG_IS_ENABLED(USB_EP_STATS)
+	if (strncmp(argv[1], "stats", 5) == 0) {
+		puts("Dev  EP Dir  Transfers Errors        Bytes    Time us    KiB/s  Product\n");
+#ifdef CONFIG_DM_USB
+		usb_for_each_root_dev(usb_show_stats);
+#else
+		for (i = 0; i < USB_MAX_DEVICE; i++) {
+			udev = usb_get_dev_index(i);
+			if (!udev)
+				break;
+			usb_show_stats(udev);
+		}
+#endif
+		return 0;
+	}
+#endif
 	if (strncmp(argv[1], "test", 4) == 0) {
 		if (argc < 5)
 			return CMD_RET_USAGE;
@@ -701,6 +765,9 @@ U_BOOT_CMD(
 	"usb stop [f] - stop USB [f]=force stop\n"
 	"usb tree - show USB device tree\n"
 	"usb info [dev] - show available USB devices\n"
+#if CONFIG_IS_ENABLED(USB_EP_STATS)
+	"usb stats - show bulk-transfer statistics for each endpoint\n"
+#endif
 	"usb test [dev] [port] [mode] - set USB 2.0 test mode\n"
 	"    (specify port 0 to indicate the device's upstream port)\n"
 	"    Available modes: J, K, S[E0_NAK], P[acket], F[orce_Enable]\n"
@@ -8,8 +8,10 @@
 
 #include <command.h>
 #include <dm.h>
+#include <time.h>
 #include <video.h>
 #include <video_console.h>
+#include <linux/math64.h>
 
 static int do_video_setcursor(struct cmd_tbl *cmdtp, int flag, int argc,
 			      char *const argv[])
@@ -47,6 +49,45 @@ static int do_video_puts(struct cmd_tbl *cmdtp, int flag, int argc,
 	return ret ? CMD_RET_FAILURE : 0;
 }
 
+static ulong video_rate(ulong bytes, ulong ms)
+{
+	return ms ? div_u64((u64)bytes * 1000, ms) : 0;
+}
+
+static int do_video_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	struct video_stats *stats;
+	struct udevice *dev;
+	ulong ms;
+
+	if (uclass_first_device_err(UCLASS_VIDEO, &dev))
+		return CMD_RET_FAILURE;
+	if (argc > 1) {
+		if (strcmp(argv[1], "-r"))
+			return CMD_RET_USAGE;
+		video_reset_stats(dev);
+		return 0;
+	}
+
+	stats = video_get_stats(dev);
+	ms = get_timer(stats->start);
+	printf("Time:     %lu ms\n", ms);
+	printf("Syncs:    %lu\n", stats->syncs);
+	printf("Synced:   %lu bytes, %lu bytes/s\n", stats->sync_bytes,
+	       video_rate(stats->sync_bytes, ms));
+	printf("Copied:   %lu bytes, %lu bytes/s\n", stats->copy_bytes,
+	       video_rate(stats->copy_bytes, ms));
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(video,
+	"stats [-r]  - show statistics about display updates (-r to reset)");
+
+U_BOOT_CMD_WITH_SUBCMDS(video, "Video commands", video_help_text,
+	U_BOOT_SUBCMD_MKENT(stats, 2, 1, do_video_stats));
+
 U_BOOT_CMD(
 	setcurs, 3,	1,	do_video_setcursor,
 	"set cursor position within screen",
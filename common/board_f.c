@@ -470,6 +470,14 @@ static int reserve_trace(void)
 	debug("Reserving %luk for trace data at: %08lx\n",
 	      (unsigned long)CONFIG_TRACE_BUFFER_SIZE >> 10, gd->relocaddr);
 #endif
+#ifdef CONFIG_TRACE_SAMPLE
+	gd->relocaddr -= CONFIG_TRACE_SAMPLE_BUFFER_SIZE;
+	gd->sample_buff = map_sysmem(gd->relocaddr,
+				     CONFIG_TRACE_SAMPLE_BUFFER_SIZE);
+	debug("Reserving %luk for trace samples at: %08lx\n",
+	      (unsigned long)CONFIG_TRACE_SAMPLE_BUFFER_SIZE >> 10,
+	      gd->relocaddr);
+#endif
 
 	return 0;
 }
@@ -92,6 +92,9 @@ static int initr_trace(void)
 #ifdef CONFIG_TRACE
 	trace_init(gd->trace_buff, CONFIG_TRACE_BUFFER_SIZE);
 #endif
+#ifdef CONFIG_TRACE_SAMPLE
+	trace_sample_init(gd->sample_buff, CONFIG_TRACE_SAMPLE_BUFFER_SIZE);
+#endif
 
 	return 0;
 }
@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Boot-time profiler
+ *
+ * Each driver phase (bind, of_to_plat, probe), initcall and command is timed
+ * and the time added to a record for the driver and its uclass, or for the
+ * call. Phases nest, e.g. probing a device probes its parent first, so the
+ * 'self' time of each phase excludes the time of any phases run inside it.
+ * This is worked out without a stack, by keeping a running total of the self
+ * time recorded so far: whatever was added to it while a phase was running
+ * belongs to nested phases.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <bloblist.h>
+#include <bootprof.h>
+#include <log.h>
+#include <malloc.h>
+#include <sort.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <asm/global_data.h>
+#include <dm/device.h>
+#include <dm/lists.h>
+#include <dm/uclass.h>
+#include <linux/string.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static const char *const phase_name[BOOTPROFP_COUNT] = {
+	"bind", "of_to_plat", "probe",
+};
+
+/**
+ * bootprof_get() - Get the profile data, creating it if needed
+ *
+ * Return: profile header, or NULL if there is no bloblist or no space in it
+ */
+static struct bootprof_hdr *bootprof_get(void)
+{
+	struct bootprof_hdr *hdr;
+	int size;
+
+	if (!gd_bloblist())
+		return NULL;
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_PROF, 0);
+	if (hdr)
+		return hdr->version == BOOTPROF_VERSION ? hdr : NULL;
+
+	size = sizeof(*hdr) +
+		CONFIG_BOOTPROF_RECORDS * sizeof(struct bootprof_rec);
+	if (bloblist_ensure_size(BLOBLISTT_U_BOOT_PROF, size, 3, (void **)&hdr))
+		return NULL;
+	if (hdr->version != BOOTPROF_VERSION ||
+	    hdr->max != CONFIG_BOOTPROF_RECORDS) {
+		memset(hdr, '\0', size);
+		hdr->version = BOOTPROF_VERSION;
+		hdr->max = CONFIG_BOOTPROF_RECORDS;
+	}
+
+	return hdr;
+}
+
+/**
+ * bootprof_ready() - Check whether phases can be timed
+ *
+ * The timer must not be used while the timer device is being set up, since
+ * reading it would try to set it up again
+ *
+ * Return: true if the timer is available
+ */
+static bool bootprof_ready(void)
+{
+	return !CONFIG_IS_ENABLED(TIMER) || IS_ENABLED(CONFIG_TIMER_EARLY) ||
+		gd->timer;
+}
+
+/**
+ * bootprof_find() - Find a record, adding it if needed
+ *
+ * Drivers and commands are found by name, since the driver index is not the
+ * same in each phase. Other records are found by key. If @name is NULL, a new
+ * record has an empty name, so the caller can fill it in.
+ *
+ * @hdr: Profile header
+ * @type: Record type
+ * @key: Key of the record
+ * @name: Name of the record, or NULL
+ * Return: record, or NULL if there is no space
+ */
+static struct bootprof_rec *bootprof_find(struct bootprof_hdr *hdr,
+					  enum bootprof_type type, ulong key,
+					  const char *name)
+{
+	struct bootprof_rec *rec = (struct bootprof_rec *)(hdr + 1);
+	int i;
+
+	for (i = 0; i < hdr->count; i++, rec++) {
+		if (rec->type != type)
+			continue;
+		if (type == BOOTPROFT_DRIVER || type == BOOTPROFT_CMD ?
+		    !strncmp(rec->name, name, BOOTPROF_NAME_LEN - 1) :
+		    rec->key == (u32)key)
+			return rec;
+	}
+	if (hdr->count == hdr->max) {
+		hdr->dropped++;
+		return NULL;
+	}
+	hdr->count++;
+	memset(rec, '\0', sizeof(*rec));
+	rec->type = type;
+	rec->key = key;
+	if (name)
+		strlcpy(rec->name, name, BOOTPROF_NAME_LEN);
+
+	return rec;
+}
+
+/**
+ * bootprof_add() - Add the time for a phase to a record
+ *
+ * @rec: Record to update, or NULL to do nothing
+ * @phase: Phase to update
+ * @time: Total time of the phase in microseconds
+ * @self: Self time of the phase in microseconds
+ */
+static void bootprof_add(struct bootprof_rec *rec, enum bootprof_phase phase,
+			 u32 time, u32 self)
+{
+	struct bootprof_stat *stat;
+
+	if (!rec)
+		return;
+	stat = &rec->stat[phase];
+	stat->count++;
+	stat->time_us += time;
+	stat->self_us += self;
+}
+
+void bootprof_start(struct bootprof_ctx *ctx)
+{
+	struct bootprof_hdr *hdr;
+
+	ctx->active = false;
+	if (!bootprof_ready())
+		return;
+	hdr = bootprof_get();
+	if (!hdr)
+		return;
+	ctx->acc_us = hdr->acc_us;
+	ctx->start_us = timer_get_us();
+	ctx->active = true;
+}
+
+/**
+ * bootprof_end() - Finish timing a phase
+ *
+ * @ctx: Context passed to bootprof_start()
+ * @timep: Returns the total time of the phase in microseconds
+ * @selfp: Returns the self time of the phase in microseconds
+ * Return: profile header, or NULL if the phase was not timed
+ */
+static struct bootprof_hdr *bootprof_end(struct bootprof_ctx *ctx, u32 *timep,
+					 u32 *selfp)
+{
+	struct bootprof_hdr *hdr;
+	u32 time, nested;
+
+	if (!ctx->active)
+		return NULL;
+	time = timer_get_us() - ctx->start_us;
+
+	/* the bloblist may have moved, e.g. on relocation */
+	hdr = bootprof_get();
+	if (!hdr)
+		return NULL;
+	nested = hdr->acc_us - ctx->acc_us;
+	*timep = time;
+	*selfp = time > nested ? time - nested : 0;
+	hdr->acc_us += *selfp;
+
+	return hdr;
+}
+
+void bootprof_end_dev(struct bootprof_ctx *ctx, enum bootprof_phase phase,
+		      const struct driver *drv)
+{
+	struct bootprof_hdr *hdr;
+	struct bootprof_rec *rec;
+	u32 time, self;
+
+	hdr = bootprof_end(ctx, &time, &self);
+	if (!hdr || !drv)
+		return;
+
+	rec = bootprof_find(hdr, BOOTPROFT_DRIVER,
+			    drv - ll_entry_start(struct driver, driver),
+			    drv->name);
+	if (rec)
+		rec->uclass_id = drv->id;
+	bootprof_add(rec, phase, time, self);
+
+	rec = bootprof_find(hdr, BOOTPROFT_UCLASS, drv->id, NULL);
+	if (rec && !*rec->name) {
+		struct uclass_driver *uc_drv = lists_uclass_lookup(drv->id);
+
+		strlcpy(rec->name, uc_drv ? uc_drv->name : "?",
+			BOOTPROF_NAME_LEN);
+		rec->uclass_id = drv->id;
+	}
+	bootprof_add(rec, phase, time, self);
+}
+
+void bootprof_end_call(struct bootprof_ctx *ctx, enum bootprof_type type,
+		       ulong key, const char *name)
+{
+	struct bootprof_hdr *hdr;
+	struct bootprof_rec *rec;
+	u32 time, self;
+
+	hdr = bootprof_end(ctx, &time, &self);
+	if (!hdr)
+		return;
+
+	rec = bootprof_find(hdr, type, key, name);
+	if (rec && !*rec->name)
+		snprintf(rec->name, BOOTPROF_NAME_LEN, "%lx", key);
+	bootprof_add(rec, BOOTPROFP_CALL, time, self);
+}
+
+static u32 bootprof_self(const struct bootprof_rec *rec)
+{
+	u32 total = 0;
+	int i;
+
+	for (i = 0; i < BOOTPROFP_COUNT; i++)
+		total += rec->stat[i].self_us;
+
+	return total;
+}
+
+static int h_cmp_self(const void *v1, const void *v2)
+{
+	const struct bootprof_rec *const *rec1 = v1, *const *rec2 = v2;
+	u32 self1 = bootprof_self(*rec1), self2 = bootprof_self(*rec2);
+
+	return self1 < self2 ? 1 : self1 > self2 ? -1 : 0;
+}
+
+/**
+ * show_devs() - Show the driver or uclass records, most expensive first
+ *
+ * @hdr: Profile header
+ * @type: BOOTPROFT_DRIVER or BOOTPROFT_UCLASS
+ * @list: Space for a pointer to each record
+ */
+static void show_devs(struct bootprof_hdr *hdr, enum bootprof_type type,
+		      struct bootprof_rec **list)
+{
+	struct bootprof_rec *rec = (struct bootprof_rec *)(hdr + 1);
+	int i, j, count;
+
+	for (i = 0, count = 0; i < hdr->count; i++, rec++) {
+		if (rec->type == type)
+			list[count++] = rec;
+	}
+	qsort(list, count, sizeof(*list), h_cmp_self);
+
+	printf("%-20s %10s", type == BOOTPROFT_DRIVER ? "Driver" : "Uclass",
+	       "self us");
+	for (j = 0; j < BOOTPROFP_COUNT; j++)
+		printf(" %10s", phase_name[j]);
+	printf("\n");
+	for (i = 0; i < count; i++) {
+		rec = list[i];
+		printf("%-20.20s %10u", rec->name, bootprof_self(rec));
+		for (j = 0; j < BOOTPROFP_COUNT; j++)
+			printf(" %10u", rec->stat[j].self_us);
+		printf("\n");
+	}
+	printf("\n");
+}
+
+void bootprof_report(void)
+{
+	struct bootprof_hdr *hdr;
+	struct bootprof_rec *rec, **list;
+	int i;
+
+	hdr = bootprof_get();
+	if (!hdr) {
+		printf("No profile data\n");
+		return;
+	}
+	list = calloc(hdr->count, sizeof(*list));
+	if (hdr->count && !list) {
+		printf("No memory\n");
+		return;
+	}
+	show_devs(hdr, BOOTPROFT_DRIVER, list);
+	show_devs(hdr, BOOTPROFT_UCLASS, list);
+	free(list);
+
+	printf("%-8s %-20s %6s %10s %10s\n", "Type", "Name", "count", "us",
+	       "self us");
+	rec = (struct bootprof_rec *)(hdr + 1);
+	for (i = 0; i < hdr->count; i++, rec++) {
+		struct bootprof_stat *stat = &rec->stat[BOOTPROFP_CALL];
+		const char *type;
+
+		if (rec->type == BOOTPROFT_INITCALL)
+			type = "initcall";
+		else if (rec->type == BOOTPROFT_EVENT)
+			type = "event";
+		else if (rec->type == BOOTPROFT_CMD)
+			type = "cmd";
+		else
+			continue;
+		printf("%-8s %-20.20s %6u %10u %10u\n", type, rec->name,
+		       stat->count, stat->time_us, stat->self_us);
+	}
+	printf("\n%d records, %d dropped\n", hdr->count, hdr->dropped);
+}
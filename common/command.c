@@ -9,6 +9,7 @@
  */
 
 #include <config.h>
+#include <bootprof.h>
 #include <compiler.h>
 #include <command.h>
 #include <console.h>
@@ -577,9 +578,12 @@ int cmd_discard_repeatable(struct cmd_tbl *cmdtp, int flag, int argc,
 static int cmd_call(struct cmd_tbl *cmdtp, int flag, int argc,
 		    char *const argv[], int *repeatable)
 {
+	struct bootprof_ctx ctx;
 	int result;
 
+	bootprof_start(&ctx);
 	result = cmdtp->cmd_rep(cmdtp, flag, argc, argv, repeatable);
+	bootprof_end_call(&ctx, BOOTPROFT_CMD, 0, cmdtp->name);
 	if (result)
 		debug("Command failed, result=%d\n", result);
 	return result;
@@ -12,6 +12,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <time.h>
+#include <trace.h>
 #include <linux/errno.h>
 #include <linux/list.h>
 #include <asm/global_data.h>
@@ -42,7 +43,7 @@ void cyclic_register(struct cyclic_info *cyclic, cyclic_func_t func,
 
 void cyclic_unregister(struct cyclic_info *cyclic)
 {
-	hlist_del(&cyclic->list);
+	hlist_del_init(&cyclic->list);
 }
 
 static void cyclic_run(void)
@@ -98,8 +99,12 @@ void schedule(void)
 	 * schedule() might get called very early before the cyclic IF is
 	 * ready. Make sure to only call cyclic_run() when it's initalized.
 	 */
-	if (gd)
+	if (gd) {
+		if (IS_ENABLED(CONFIG_TRACE_SAMPLE))
+			trace_sample((uintptr_t)__builtin_return_address(0),
+				     __builtin_frame_address(0));
 		cyclic_run();
+	}
 }
 
 int cyclic_unregister_all(void)
@@ -234,10 +234,26 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 	list_for_each_entry(ldev, &gd->log_head, sibling_node) {
 		if ((ldev->flags & LOGDF_ENABLE) &&
 		    log_passes_filters(ldev, rec)) {
+			/* Let the device store the arguments without formatting */
+			if (ldev->flags & LOGDF_RAW) {
+				va_list raw_args;
+
+				va_copy(raw_args, args);
+				rec->fmt = fmt;
+				rec->args = &raw_args;
+				ldev->drv->emit(ldev, rec);
+				va_end(raw_args);
+				rec->args = NULL;
+				continue;
+			}
 			if (!rec->msg) {
+				va_list fmt_args;
 				int len;
 
-				len = vsnprintf(buf, sizeof(buf), fmt, args);
+				/* Leave @args for any later LOGDF_RAW device */
+				va_copy(fmt_args, args);
+				len = vsnprintf(buf, sizeof(buf), fmt, fmt_args);
+				va_end(fmt_args);
 				rec->msg = buf;
 				gd->log_cont = len && buf[len - 1] != '\n';
 			}
@@ -274,6 +290,8 @@ int _log(enum log_category_t cat, enum log_level_t level, const char *file,
 	rec.line = line;
 	rec.func = func;
 	rec.msg = NULL;
+	rec.fmt = NULL;
+	rec.args = NULL;
 
 	if (!(gd->flags & GD_FLG_LOG_READY)) {
 		gd->log_drop_count++;
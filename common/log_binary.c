@@ -0,0 +1,351 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Log to a binary buffer in the bloblist
+ *
+ * Records are stored without formatting them: just the time, the location of
+ * the format string and the raw arguments. This is much faster than printing
+ * the message, so detailed logging can be left enabled. The messages are
+ * rebuilt on the host by tools/logdecode.py, using the U-Boot ELF file.
+ */
+
+#include <bloblist.h>
+#include <errno.h>
+#include <log.h>
+#include <log_binary.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <asm/global_data.h>
+#include <asm/sections.h>
+#include <linux/build_bug.h>
+#include <linux/ctype.h>
+#include <linux/kernel.h>
+#include <linux/string.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+const char log_bin_anchor[] = "log_bin_anchor";
+
+/* Buffer found by log_bin_get(), kept once U-Boot has relocated */
+static struct log_bin_hdr *log_bin_hdr;
+
+/* Bloblist in which log_bin_hdr was found */
+static struct bloblist_hdr *log_bin_bloblist;
+
+/**
+ * log_bin_in_image() - Check if a string is in the U-Boot image
+ *
+ * Only strings in the text and read-only data of the image can be found in the
+ * ELF file by tools/logdecode.py. The writable data and BSS follow these, so
+ * this checks that @str is before the BSS, in the same way as the trace code
+ * finds the start of the image.
+ *
+ * @str: String to check
+ * Return: true if @str is in the image, false if it is elsewhere, e.g. on the
+ *	stack or in the malloc() heap
+ */
+static bool log_bin_in_image(const char *str)
+{
+	ulong addr = (ulong)str;
+	ulong start;
+
+#ifdef CONFIG_SANDBOX
+	start = (ulong)_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		start = gd->relocaddr;
+	else
+		start = CONFIG_TEXT_BASE;
+#endif
+
+	return addr >= start && addr < (ulong)__bss_start;
+}
+
+/**
+ * log_bin_offset() - Get the offset of a string from log_bin_anchor
+ *
+ * @str: String to check
+ * Return: offset, or 0 if @str is NULL, is not in the image or is too far away
+ */
+static s32 log_bin_offset(const char *str)
+{
+	long offset;
+
+	if (!str || !log_bin_in_image(str))
+		return 0;
+	offset = str - log_bin_anchor;
+
+	return offset == (s32)offset ? offset : 0;
+}
+
+/**
+ * log_bin_encode() - Store the arguments for a format string
+ *
+ * This follows the conversions in @fmt in the same way as vsnprintf(), but
+ * stores the arguments instead of formatting them
+ *
+ * @buf: Place to put the arguments
+ * @size: Size of @buf in bytes, a multiple of 8
+ * @fmt: Format string
+ * @args: Arguments for @fmt
+ * @truncp: Set to true if @buf is too small for all the arguments
+ * Return: number of bytes used in @buf, or -ENOTSUPP if @fmt has a conversion
+ *	which cannot be stored, such as %pU, since it refers to other memory
+ */
+static int log_bin_encode(u64 *buf, int size, const char *fmt, va_list args,
+			  bool *truncp)
+{
+	u64 *ptr = buf, *end = buf + size / sizeof(u64);
+	const char *p;
+
+	for (p = fmt; *p; p++) {
+		int prec = -1;
+		char qual = 0;
+		u64 val;
+
+		if (*p != '%' || *++p == '%')
+			continue;
+		while (*p && strchr("-+ #0", *p))
+			p++;
+		if (*p == '*') {
+			if (ptr == end)
+				goto trunc;
+			*ptr++ = va_arg(args, int);
+			p++;
+		}
+		while (isdigit(*p))
+			p++;
+		if (*p == '.') {
+			if (*++p == '*') {
+				prec = va_arg(args, int);
+				if (ptr == end)
+					goto trunc;
+				*ptr++ = prec;
+				p++;
+			} else {
+				for (prec = 0; isdigit(*p); p++)
+					prec = prec * 10 + *p - '0';
+			}
+		}
+		if (*p && strchr("hlLqzZt", *p)) {
+			qual = *p++;
+			if (qual == 'l' && *p == 'l') {
+				qual = 'L';
+				p++;
+			} else if (qual == 'h' && *p == 'h') {
+				p++;
+			}
+		}
+
+		switch (*p) {
+		case 's': {
+			const char *str = va_arg(args, const char *);
+			int len, space;
+
+			if (!str)
+				str = "<NULL>";
+			space = (end - ptr) * sizeof(u64);
+			if (!space)
+				goto trunc;
+			len = strnlen(str, prec >= 0 ? min(prec, space - 1) :
+				      space - 1);
+			ptr[len / sizeof(u64)] = 0;
+			memcpy(ptr, str, len);
+			((char *)ptr)[len] = '\0';
+			ptr += len / sizeof(u64) + 1;
+			continue;
+		}
+		case 'p':
+			if (isalnum(p[1]))
+				return -ENOTSUPP;
+			val = (ulong)va_arg(args, void *);
+			break;
+		case 'c':
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			switch (qual) {
+			case 'L':
+			case 'q':
+				val = va_arg(args, long long);
+				break;
+			case 'l':
+				val = va_arg(args, long);
+				break;
+			case 'z':
+			case 'Z':
+				val = va_arg(args, size_t);
+				break;
+			case 't':
+				val = va_arg(args, ptrdiff_t);
+				break;
+			default:
+				val = va_arg(args, int);
+				break;
+			}
+			break;
+		case '\0':
+			p--;
+			continue;
+		default:
+			continue;
+		}
+		if (ptr == end)
+			goto trunc;
+		*ptr++ = val;
+	}
+
+	return (ptr - buf) * sizeof(u64);
+trunc:
+	*truncp = true;
+
+	return (ptr - buf) * sizeof(u64);
+}
+
+/* Drop the oldest record in the ring */
+static void log_bin_drop(struct log_bin_hdr *hdr)
+{
+	u8 *ring = (u8 *)(hdr + 1);
+	struct log_bin_rec *brec = (struct log_bin_rec *)(ring + hdr->tail);
+
+	hdr->tail += brec->size;
+	hdr->count--;
+	hdr->dropped++;
+	brec = (struct log_bin_rec *)(ring + hdr->tail);
+	if (hdr->tail == hdr->size || (hdr->count && !brec->size))
+		hdr->tail = 0;
+}
+
+/**
+ * log_bin_write() - Add a record to the ring, dropping old ones if needed
+ *
+ * @hdr: Buffer header
+ * @brec: Record to add, with its size set
+ */
+static void log_bin_write(struct log_bin_hdr *hdr, struct log_bin_rec *brec)
+{
+	u8 *ring = (u8 *)(hdr + 1);
+	uint size = brec->size;
+
+	/* If the record does not fit at the end, skip to the start */
+	if (hdr->head + size > hdr->size) {
+		while (hdr->count && hdr->tail >= hdr->head)
+			log_bin_drop(hdr);
+		if (hdr->head < hdr->size)
+			((struct log_bin_rec *)(ring + hdr->head))->size = 0;
+		hdr->head = 0;
+	}
+
+	/* Drop the oldest records where they overlap the new one */
+	while (hdr->count && hdr->tail >= hdr->head &&
+	       hdr->tail < hdr->head + size)
+		log_bin_drop(hdr);
+	if (!hdr->count)
+		hdr->tail = hdr->head;
+
+	memcpy(ring + hdr->head, brec, size);
+	hdr->head += size;
+	hdr->count++;
+}
+
+/**
+ * log_bin_get() - Get the buffer, adding it to the bloblist if needed
+ *
+ * The buffer is only looked up again if the bloblist has moved, e.g. when it
+ * is relocated. Before relocation nothing is kept, since static variables
+ * may not be writable.
+ *
+ * Return: buffer header, or NULL if there is no room in the bloblist
+ */
+static struct log_bin_hdr *log_bin_get(void)
+{
+	struct bloblist_hdr *blist = gd_bloblist();
+	bool reloc = gd->flags & GD_FLG_RELOC;
+	struct log_bin_hdr *hdr;
+
+	/* A new bloblist at the same address does not hold the buffer yet */
+	if (reloc && log_bin_hdr && log_bin_bloblist == blist &&
+	    (void *)log_bin_hdr < (void *)blist + blist->used_size)
+		return log_bin_hdr;
+
+	if (bloblist_ensure_size(BLOBLISTT_U_BOOT_LOG,
+				 sizeof(*hdr) + CONFIG_LOG_BINARY_SIZE, 3,
+				 (void **)&hdr))
+		return NULL;
+	if (hdr->magic != LOG_BIN_MAGIC || hdr->version != LOG_BIN_VERSION ||
+	    hdr->size != CONFIG_LOG_BINARY_SIZE) {
+		memset(hdr, '\0', sizeof(*hdr));
+		hdr->magic = LOG_BIN_MAGIC;
+		hdr->version = LOG_BIN_VERSION;
+		hdr->size = CONFIG_LOG_BINARY_SIZE;
+	}
+	if (reloc) {
+		log_bin_hdr = hdr;
+		log_bin_bloblist = blist;
+	}
+
+	return hdr;
+}
+
+static int log_binary_emit(struct log_device *ldev, struct log_rec *rec)
+{
+	u64 buf[LOG_BIN_MAX_REC / sizeof(u64)];
+	struct log_bin_rec *brec = (struct log_bin_rec *)buf;
+	int space = sizeof(buf) - sizeof(*brec);
+	struct log_bin_hdr *hdr;
+	bool trunc = false;
+	va_list args;
+	int len;
+
+	BUILD_BUG_ON(sizeof(*brec) % sizeof(u64));
+	BUILD_BUG_ON(CONFIG_LOG_BINARY_SIZE % sizeof(u64));
+
+	hdr = log_bin_get();
+	if (!hdr) {
+		/* There is no room in the bloblist, so give up */
+		ldev->flags &= ~LOGDF_ENABLE;
+		return -ENOSPC;
+	}
+
+	brec->level = rec->level;
+	brec->flags = rec->flags;
+	brec->cat = rec->cat;
+	brec->line = rec->line;
+	brec->seq = hdr->seq++;
+	brec->time_us = timer_get_us();
+	brec->file = log_bin_offset(rec->file);
+	brec->func = log_bin_offset(rec->func);
+	brec->fmt = log_bin_offset(rec->fmt);
+
+	len = -ENOTSUPP;
+	if (brec->fmt) {
+		va_copy(args, *rec->args);
+		len = log_bin_encode(buf + sizeof(*brec) / sizeof(u64), space,
+				     rec->fmt, args, &trunc);
+		va_end(args);
+	}
+	if (len < 0) {
+		/* Fall back to storing the message */
+		memset(brec + 1, '\0', space);
+		va_copy(args, *rec->args);
+		len = vsnprintf((char *)(brec + 1), space, rec->fmt, args);
+		va_end(args);
+		len = min(len + 1, space);
+		brec->fmt = 0;
+		brec->flags |= LOG_BINF_MSG;
+	}
+	if (trunc)
+		brec->flags |= LOG_BINF_TRUNC;
+	brec->size = sizeof(*brec) + ALIGN(len, sizeof(u64));
+	log_bin_write(hdr, brec);
+
+	return 0;
+}
+
+LOG_DRIVER(binary) = {
+	.name	= "binary",
+	.emit	= log_binary_emit,
+	.flags	= LOGDF_ENABLE | LOGDF_RAW,
+};
@@ -18,14 +18,51 @@
 #include <asm/io.h>
 #include <linux/libfdt.h>
 #include <linux/printk.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+enum {
+	/* Maximum number of images considered when planning reads */
+	SPL_FIT_MAX_PLAN	= 16,
+
+	/* Largest gap between two images which is still read in one go */
+	SPL_FIT_COALESCE_GAP	= SZ_4K,
+};
+
+/**
+ * struct spl_fit_run - a range of the FIT read with a single call
+ *
+ * @offset: Offset of the range from the start of the FIT, aligned to the
+ *	block length of the boot medium
+ * @size: Size of the range in bytes, aligned to the block length
+ * @count: Number of images with their data in this range
+ * @buf: Buffer holding the data once read, NULL if not read yet
+ */
+struct spl_fit_run {
+	ulong offset;
+	ulong size;
+	int count;
+	void *buf;
+};
+
+/**
+ * struct spl_fit_plan - plan for reading the external data of a FIT
+ *
+ * @runs: Ranges holding more than one image, sorted by offset
+ * @count: Number of runs
+ */
+struct spl_fit_plan {
+	struct spl_fit_run runs[SPL_FIT_MAX_PLAN];
+	int count;
+};
+
 struct spl_fit_info {
 	const void *fit;	/* Pointer to a valid FIT blob */
 	size_t ext_data_offset;	/* Offset to FIT external data (end of FIT) */
 	int images_node;	/* FDT offset to "/images" node */
 	int conf_node;		/* FDT offset to selected configuration node */
+	struct spl_fit_plan *plan;	/* Coalesced reads, or NULL if none */
 };
 
 __weak ulong board_spl_fit_size_align(ulong size)
@@ -187,6 +224,259 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
 	return ALIGN(data_size, spl_get_bl_len(info));
 }
 
+/**
+ * spl_fit_get_ext_data() - Find the external data of an image
+ *
+ * @ctx:	points to the FIT context structure
+ * @node:	offset of the DT node describing the image
+ * @offsetp:	returns the offset of the data from the start of the FIT
+ * @lenp:	returns the size of the data in bytes
+ * Return:	0 on success, -ENOENT if the image does not use external data
+ */
+static int spl_fit_get_ext_data(const struct spl_fit_info *ctx, int node,
+				int *offsetp, int *lenp)
+{
+	int offset;
+
+	if (fit_image_get_data_position(ctx->fit, node, &offset)) {
+		if (fit_image_get_data_offset(ctx->fit, node, &offset))
+			return -ENOENT;
+		offset += ctx->ext_data_offset;
+	}
+	if (fit_image_get_data_size(ctx->fit, node, lenp))
+		return -ENOENT;
+	*offsetp = offset;
+
+	return 0;
+}
+
+/**
+ * spl_fit_plan_skip() - Check whether SPL skips an image
+ *
+ * This mirrors the checks made when loading, so that the data of an image
+ * which is not loaded is not read as part of a run.
+ *
+ * @ctx:	points to the FIT context structure
+ * @info:	points to information about the device to load data from
+ * @prop:	configuration property listing the image
+ * @index:	index of the image within @prop
+ * @node:	offset of the DT node describing the image
+ * Return:	true if the image is not loaded
+ */
+static bool spl_fit_plan_skip(const struct spl_fit_info *ctx,
+			      struct spl_load_info *info, const char *prop,
+			      int index, int node)
+{
+	if (CONFIG_IS_ENABLED(BOOTMETH_VBE) &&
+	    xpl_get_phase(info) != IH_PHASE_NONE) {
+		enum image_phase_t phase;
+
+		if (!fit_image_get_phase(ctx->fit, node, &phase) &&
+		    phase != xpl_get_phase(info))
+			return true;
+	}
+
+	if (!strcmp(prop, "fpga"))
+		return !IS_ENABLED(CONFIG_SPL_FPGA);
+
+	/* the kernel is only used if there is no firmware */
+	if (!strcmp(prop, FIT_KERNEL_PROP))
+		return !IS_ENABLED(CONFIG_SPL_OS_BOOT) ||
+			spl_fit_get_image_node(ctx, FIT_FIRMWARE_PROP, 0) >= 0;
+
+	/* only the first FDT is loaded, unless overlays are applied */
+	if (!strcmp(prop, FIT_FDT_PROP) && index)
+		return !CONFIG_IS_ENABLED(LOAD_FIT_APPLY_OVERLAY) ||
+			board_spl_fit_append_fdt_skip(fit_get_name(ctx->fit,
+								   node, NULL));
+
+	return false;
+}
+
+/**
+ * spl_fit_plan_reads() - Work out which images can be read together
+ *
+ * Looks at every image which SPL may load for the selected configuration and
+ * sorts them by their position on the boot medium. Images which are adjacent
+ * (or separated by only a small gap) are grouped into runs, so that each run
+ * can be fetched with a single read. An image which SPL skips ends the run it
+ * is in, so its data is not read.
+ *
+ * Only runs holding more than one image are recorded; other images are read
+ * straight to their load address as usual.
+ *
+ * @ctx:	points to the FIT context structure
+ * @info:	points to information about the device to load data from
+ * @plan:	returns the plan
+ */
+static void spl_fit_plan_reads(const struct spl_fit_info *ctx,
+			       struct spl_load_info *info,
+			       struct spl_fit_plan *plan)
+{
+	static const char *const props[] = {
+		FIT_FIRMWARE_PROP, FIT_KERNEL_PROP, FIT_FDT_PROP,
+		FIT_LOADABLE_PROP, "fpga",
+	};
+	struct {
+		ulong start;
+		ulong end;
+		bool skip;
+	} ext[SPL_FIT_MAX_PLAN];
+	ulong limit = CONFIG_IF_ENABLED_INT(LOAD_FIT_COALESCE,
+					    LOAD_FIT_COALESCE_MAX);
+	int i, j, index, node, offset, len, count = 0;
+	struct spl_fit_run *run = NULL;
+	ulong start, end, run_end, total = 0;
+	bool skip;
+
+	for (i = 0; i < ARRAY_SIZE(props); i++) {
+		for (index = 0; count < SPL_FIT_MAX_PLAN; index++) {
+			node = spl_fit_get_image_node(ctx, props[i], index);
+			if (node < 0)
+				break;
+			if (spl_fit_get_ext_data(ctx, node, &offset, &len) ||
+			    !len)
+				continue;
+
+			start = get_aligned_image_offset(info, offset);
+			end = start + get_aligned_image_size(info, len, offset);
+			skip = spl_fit_plan_skip(ctx, info, props[i], index,
+						 node);
+
+			/*
+			 * insert in order of position; an image listed twice
+			 * is skipped only if it is skipped in both places
+			 */
+			for (j = count; j > 0 && ext[j - 1].start > start; j--)
+				;
+			if (j && ext[j - 1].start == start) {
+				ext[j - 1].skip &= skip;
+				continue;
+			}
+			memmove(&ext[j + 1], &ext[j], (count - j) * sizeof(*ext));
+			ext[j].start = start;
+			ext[j].end = end;
+			ext[j].skip = skip;
+			count++;
+		}
+	}
+
+	plan->count = 0;
+	for (i = 0; i < count; i++) {
+		if (ext[i].skip) {
+			/* end the current run */
+			if (run && run->count == 1) {
+				total -= run->size;
+				plan->count--;
+			}
+			run = NULL;
+			continue;
+		}
+		run_end = run ? run->offset + run->size : 0;
+		end = max(ext[i].end, run_end);
+		if (run && ext[i].start <= run_end + SPL_FIT_COALESCE_GAP &&
+		    total + end - run_end <= limit) {
+			total += end - run_end;
+			run->size = end - run->offset;
+			run->count++;
+			continue;
+		}
+
+		/* a run with a single image gains nothing, so reuse it */
+		if (run && run->count == 1) {
+			total -= run->size;
+			plan->count--;
+		}
+		run = &plan->runs[plan->count++];
+		run->offset = ext[i].start;
+		run->size = ext[i].end - ext[i].start;
+		run->count = 1;
+		run->buf = NULL;
+		total += run->size;
+	}
+	if (run && run->count == 1)
+		plan->count--;
+
+	for (i = 0; i < plan->count; i++)
+		log_debug("read run %d: offset %lx size %lx, %d images\n", i,
+			  plan->runs[i].offset, plan->runs[i].size,
+			  plan->runs[i].count);
+}
+
+/**
+ * spl_fit_find_run() - Find the run holding an image's data
+ *
+ * @ctx:	points to the FIT context structure
+ * @offset:	offset of the image data from the start of the FIT
+ * @len:	size of the image data
+ * Return:	run holding the data, or NULL if the image is read on its own
+ */
+static struct spl_fit_run *spl_fit_find_run(const struct spl_fit_info *ctx,
+					    int offset, int len)
+{
+	struct spl_fit_run *run;
+	int i;
+
+	if (!ctx->plan)
+		return NULL;
+
+	for (i = 0; i < ctx->plan->count; i++) {
+		run = &ctx->plan->runs[i];
+		if (offset >= run->offset &&
+		    offset + len <= run->offset + run->size)
+			return run;
+	}
+
+	return NULL;
+}
+
+/**
+ * spl_fit_read_run() - Read a run into a buffer, if not already done
+ *
+ * @info:	points to information about the device to load data from
+ * @fit_offset:	the offset of the FIT image on the device
+ * @run:	run to read
+ * @end:	offset just past the image data which is needed, relative to
+ *		the start of the FIT
+ * Return:	0 on success, -ENOMEM if no buffer is available, -EIO on error
+ */
+static int spl_fit_read_run(struct spl_load_info *info, ulong fit_offset,
+			    struct spl_fit_run *run, ulong end)
+{
+	void *buf;
+
+	if (run->buf)
+		return 0;
+
+	buf = malloc_cache_aligned(run->size);
+	if (!buf)
+		return -ENOMEM;
+
+	log_debug("reading run from offset %lx size %lx to %p\n",
+		  fit_offset + run->offset, run->size, buf);
+	if (info->read(info, fit_offset + run->offset, run->size, buf) <
+	    end - run->offset) {
+		free(buf);
+		return -EIO;
+	}
+	run->buf = buf;
+
+	return 0;
+}
+
+/**
+ * spl_fit_free_plan() - Free the buffers used by a plan
+ *
+ * @plan:	plan to free
+ */
+static void spl_fit_free_plan(struct spl_fit_plan *plan)
+{
+	int i;
+
+	for (i = 0; i < plan->count; i++)
+		free(plan->runs[i].buf);
+}
+
 /**
  * load_simple_fit(): load the image described in a certain FIT node
  * @info:	points to information about the device to load data from
@@ -271,8 +561,10 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	}
 
 	if (external_data) {
+		struct spl_fit_run *run;
 		ulong read_offset;
 		void *src_ptr;
+		int ret;
 
 		/* External data */
 		if (fit_image_get_data_size(fit, node, &len))
@@ -285,12 +577,26 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 			return 0;
 		}
 
+		length = len;
+
+		/* use the coalesced read holding this image, if any */
+		run = spl_fit_find_run(ctx, offset, len);
+		ret = run ? spl_fit_read_run(info, fit_offset, run,
+					     offset + len) : -ENOENT;
+		if (ret == -EIO)
+			return ret;
+		if (!ret) {
+			src = run->buf + offset - run->offset;
+			debug("External data: coalesced, offset=%x, size=%lx\n",
+			      offset, (unsigned long)length);
+			goto verify;
+		}
+
 		if (spl_decompression_enabled() &&
 		    (image_comp == IH_COMP_GZIP || image_comp == IH_COMP_LZMA))
 			src_ptr = map_sysmem(ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN), len);
 		else
 			src_ptr = map_sysmem(ALIGN(load_addr, ARCH_DMA_MINALIGN), len);
-		length = len;
 
 		overhead = get_aligned_image_overhead(info, offset);
 		size = get_aligned_image_size(info, length, offset);
@@ -316,6 +622,7 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		src = (void *)data;	/* cast away const */
 	}
 
+verify:
 	if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
 		printf("## Checking hash(es) for Image %s ... ",
 		       fit_get_name(fit, node, NULL));
@@ -737,32 +1044,27 @@ static int spl_simple_fit_parse(struct spl_fit_info *ctx)
 	return 0;
 }
 
-int spl_load_simple_fit(struct spl_image_info *spl_image,
-			struct spl_load_info *info, ulong offset, void *fit)
+/**
+ * spl_fit_load_images() - Load the images for the selected configuration
+ *
+ * @spl_image:	returns information about the firmware image
+ * @info:	points to information about the device to load data from
+ * @offset:	the offset of the FIT image on the device
+ * @ctx:	points to the FIT context structure, already parsed
+ * Return:	0 on success, or a negative error number
+ */
+static int spl_fit_load_images(struct spl_image_info *spl_image,
+			       struct spl_load_info *info, ulong offset,
+			       struct spl_fit_info *ctx)
 {
 	struct spl_image_info image_info;
-	struct spl_fit_info ctx;
 	int node = -1;
 	int ret;
 	int index = 0;
 	int firmware_node;
 
-	ret = spl_simple_fit_read(&ctx, info, offset, fit);
-	if (ret < 0)
-		return ret;
-
-	/* skip further processing if requested to enable load-only use cases */
-	if (spl_load_simple_fit_skip_processing())
-		return 0;
-
-	ctx.fit = spl_load_simple_fit_fix_load(ctx.fit);
-
-	ret = spl_simple_fit_parse(&ctx);
-	if (ret < 0)
-		return ret;
-
 	if (IS_ENABLED(CONFIG_SPL_FPGA))
-		spl_fit_load_fpga(&ctx, info, offset);
+		spl_fit_load_fpga(ctx, info, offset);
 
 	/*
 	 * Find the U-Boot image using the following search order:
@@ -771,14 +1073,14 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	 *   - fall back to using the first 'loadables' entry
 	 */
 	if (node < 0)
-		node = spl_fit_get_image_node(&ctx, FIT_FIRMWARE_PROP, 0);
+		node = spl_fit_get_image_node(ctx, FIT_FIRMWARE_PROP, 0);
 
 	if (node < 0 && IS_ENABLED(CONFIG_SPL_OS_BOOT))
-		node = spl_fit_get_image_node(&ctx, FIT_KERNEL_PROP, 0);
+		node = spl_fit_get_image_node(ctx, FIT_KERNEL_PROP, 0);
 
 	if (node < 0) {
 		debug("could not find firmware image, trying loadables...\n");
-		node = spl_fit_get_image_node(&ctx, "loadables", 0);
+		node = spl_fit_get_image_node(ctx, "loadables", 0);
 		/*
 		 * If we pick the U-Boot image from "loadables", start at
 		 * the second image when later loading additional images.
@@ -792,7 +1094,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	}
 
 	/* Load the image and set up the spl_image structure */
-	ret = load_simple_fit(info, offset, &ctx, node, spl_image);
+	ret = load_simple_fit(info, offset, ctx, node, spl_image);
 	if (ret)
 		return ret;
 
@@ -800,7 +1102,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	 * For backward compatibility, we treat the first node that is
 	 * as a U-Boot image, if no OS-type has been declared.
 	 */
-	if (!spl_fit_image_get_os(ctx.fit, node, &spl_image->os))
+	if (!spl_fit_image_get_os(ctx->fit, node, &spl_image->os))
 		debug("Image OS is %s\n", genimg_get_os_name(spl_image->os));
 	else if (!IS_ENABLED(CONFIG_SPL_OS_BOOT))
 		spl_image->os = IH_OS_U_BOOT;
@@ -810,7 +1112,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	 * We allow this to fail, as the U-Boot image might embed its FDT.
 	 */
 	if (os_takes_devicetree(spl_image->os)) {
-		ret = spl_fit_append_fdt(spl_image, info, offset, &ctx);
+		ret = spl_fit_append_fdt(spl_image, info, offset, ctx);
 		if (ret < 0 && spl_image->os != IH_OS_U_BOOT)
 			return ret;
 	}
@@ -820,7 +1122,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	for (; ; index++) {
 		uint8_t os_type = IH_OS_INVALID;
 
-		node = spl_fit_get_image_node(&ctx, "loadables", index);
+		node = spl_fit_get_image_node(ctx, "loadables", index);
 		if (node < 0)
 			break;
 
@@ -833,21 +1135,21 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 			continue;
 
 		image_info.load_addr = 0;
-		ret = load_simple_fit(info, offset, &ctx, node, &image_info);
+		ret = load_simple_fit(info, offset, ctx, node, &image_info);
 		if (ret < 0 && ret != -EPERM) {
 			printf("%s: can't load image loadables index %d (ret = %d)\n",
 			       __func__, index, ret);
 			return ret;
 		}
 
-		if (spl_fit_image_is_fpga(ctx.fit, node))
-			spl_fit_upload_fpga(&ctx, node, &image_info);
+		if (spl_fit_image_is_fpga(ctx->fit, node))
+			spl_fit_upload_fpga(ctx, node, &image_info);
 
-		if (!spl_fit_image_get_os(ctx.fit, node, &os_type))
+		if (!spl_fit_image_get_os(ctx->fit, node, &os_type))
 			debug("Loadable is %s\n", genimg_get_os_name(os_type));
 
 		if (os_takes_devicetree(os_type)) {
-			spl_fit_append_fdt(&image_info, info, offset, &ctx);
+			spl_fit_append_fdt(&image_info, info, offset, ctx);
 			spl_image->fdt_addr = image_info.fdt_addr;
 		}
 
@@ -862,7 +1164,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 		/* Record our loadables into the FDT */
 		if (!CONFIG_IS_ENABLED(FIT_IMAGE_TINY) &&
 		    xpl_get_fdt_update(info) && spl_image->fdt_addr)
-			spl_fit_record_loadable(&ctx, index,
+			spl_fit_record_loadable(ctx, index,
 						spl_image->fdt_addr,
 						&image_info);
 	}
@@ -876,12 +1178,47 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 		spl_image->entry_point = spl_image->load_addr;
 
 	spl_image->flags |= SPL_FIT_FOUND;
-	upl_set_fit_info(map_to_sysmem(ctx.fit), ctx.conf_node,
+	upl_set_fit_info(map_to_sysmem(ctx->fit), ctx->conf_node,
 			 spl_image->entry_point);
 
 	return 0;
 }
 
+int spl_load_simple_fit(struct spl_image_info *spl_image,
+			struct spl_load_info *info, ulong offset, void *fit)
+{
+	struct spl_fit_plan plan;
+	struct spl_fit_info ctx;
+	int ret;
+
+	ctx.plan = NULL;
+	ret = spl_simple_fit_read(&ctx, info, offset, fit);
+	if (ret < 0)
+		return ret;
+
+	/* skip further processing if requested to enable load-only use cases */
+	if (spl_load_simple_fit_skip_processing())
+		return 0;
+
+	ctx.fit = spl_load_simple_fit_fix_load(ctx.fit);
+
+	ret = spl_simple_fit_parse(&ctx);
+	if (ret < 0)
+		return ret;
+
+	if (CONFIG_IS_ENABLED(LOAD_FIT_COALESCE)) {
+		spl_fit_plan_reads(&ctx, info, &plan);
+		ctx.plan = &plan;
+	}
+
+	ret = spl_fit_load_images(spl_image, info, offset, &ctx);
+
+	if (ctx.plan)
+		spl_fit_free_plan(ctx.plan);
+
+	return ret;
+}
+
 /* Parse and load full fitImage in SPL */
 int spl_load_fit_image(struct spl_image_info *spl_image,
 		       const struct legacy_img_hdr *header)
@@ -31,6 +31,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <memalign.h>
+#include <time.h>
 #include <asm/processor.h>
 #include <linux/compiler.h>
 #include <linux/ctype.h>
@@ -267,6 +268,29 @@ int usb_control_msg(struct usb_device *dev, unsigned int pipe,
 	return dev->act_len;
 }
 
+/*
+ * records bulk transfers in the endpoint's statistics, if enabled. start is
+ * the time when the transfers were submitted, from usb_ep_stats_start().
+ */
+static ulong usb_ep_stats_start(void)
+{
+	return CONFIG_IS_ENABLED(USB_EP_STATS) ? timer_get_us() : 0;
+}
+
+static void usb_ep_stats_add(struct usb_device *dev, unsigned int pipe,
+			     int xfers, int errors, int bytes, ulong start)
+{
+#if CONFIG_IS_ENABLED(USB_EP_STATS)
+	struct usb_ep_stats *stats;
+
+	stats = &dev->ep_stats[!usb_pipein(pipe)][usb_pipeendpoint(pipe)];
+	stats->xfers += xfers;
+	stats->errors += errors;
+	stats->bytes += bytes;
+	stats->time_us += timer_get_us() - start;
+#endif
+}
+
 /*-------------------------------------------------------------------
  * submits bulk message, and waits for completion. returns 0 if Ok or
  * negative if Error.
@@ -275,23 +299,116 @@ int usb_control_msg(struct usb_device *dev, unsigned int pipe,
 int usb_bulk_msg(struct usb_device *dev, unsigned int pipe,
 			void *data, int len, int *actual_length, int timeout)
 {
+	return usb_bulk_msg_stream(dev, pipe, 0, data, len, actual_length,
+				   timeout);
+}
+
+/*
+ * submits a bulk message on a stream (SuperSpeed only), and waits for
+ * completion. Stream 0 is the endpoint without streams.
+ */
+int usb_bulk_msg_stream(struct usb_device *dev, unsigned int pipe,
+			unsigned int stream, void *data, int len,
+			int *actual_length, int timeout)
+{
+	ulong start;
+	int ret;
+
 	if (len < 0)
 		return -EINVAL;
 	dev->status = USB_ST_NOT_PROC; /*not yet processed */
-	if (submit_bulk_msg(dev, pipe, data, len) < 0)
+	start = usb_ep_stats_start();
+#if CONFIG_IS_ENABLED(DM_USB)
+	if (stream)
+		ret = submit_bulk_stream_msg(dev, pipe, stream, data, len);
+	else
+#endif
+		ret = submit_bulk_msg(dev, pipe, data, len);
+	if (ret < 0) {
+		usb_ep_stats_add(dev, pipe, 1, 1, 0, start);
 		return -EIO;
+	}
 	while (timeout--) {
 		if (!((volatile unsigned long)dev->status & USB_ST_NOT_PROC))
 			break;
 		mdelay(1);
 	}
 	*actual_length = dev->act_len;
+	usb_ep_stats_add(dev, pipe, 1, dev->status != 0, dev->act_len, start);
 	if (dev->status == 0)
 		return 0;
 	else
 		return -EIO;
 }
 
+/*
+ * queues several bulk messages with the controller, if it can do that, and
+ * records the result. Returns -ENOSYS if it cannot.
+ */
+static int usb_bulk_queue_submit(struct usb_device *dev, unsigned int pipe,
+				 struct usb_bulk_xfer *xfers, int count,
+				 int timeout)
+{
+#if CONFIG_IS_ENABLED(DM_USB)
+	int done = 0, errors = 0, bytes = 0;
+	ulong start;
+	int i, ret;
+
+	dev->status = USB_ST_NOT_PROC; /*not yet processed */
+	start = usb_ep_stats_start();
+	ret = submit_bulk_queue(dev, pipe, xfers, count, timeout);
+	if (ret == -ENOSYS)
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		if (xfers[i].status == USB_ST_NOT_PROC)
+			continue;
+		done++;
+		errors += xfers[i].status != 0;
+		bytes += xfers[i].actual_length;
+	}
+	usb_ep_stats_add(dev, pipe, done, errors, bytes, start);
+	if (ret < 0 || errors || done != count)
+		return -EIO;
+
+	return 0;
+#else
+	return -ENOSYS;
+#endif
+}
+
+/*
+ * submits several bulk messages on one endpoint. If the controller can queue
+ * them they go together, else one at a time. Stops at the first failure.
+ */
+int usb_bulk_msg_queue(struct usb_device *dev, unsigned int pipe,
+		       struct usb_bulk_xfer *xfers, int count, int timeout)
+{
+	int i, ret;
+
+	if (count < 1 || count > USB_BULK_QUEUE_MAX)
+		return -EINVAL;
+	for (i = 0; i < count; i++) {
+		if (xfers[i].len < 0)
+			return -EINVAL;
+		xfers[i].actual_length = 0;
+		xfers[i].status = USB_ST_NOT_PROC;
+	}
+	ret = usb_bulk_queue_submit(dev, pipe, xfers, count, timeout);
+	if (ret != -ENOSYS)
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		ret = usb_bulk_msg(dev, pipe, xfers[i].data, xfers[i].len,
+				   &xfers[i].actual_length, timeout);
+		xfers[i].status = dev->status;
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
 /*-------------------------------------------------------------------
  * Max Packet stuff
  */
@@ -675,6 +792,7 @@ int usb_set_interface(struct usb_device *dev, int interface, int alternate)
 				USB_CNTL_TIMEOUT * 5);
 	if (ret < 0)
 		return ret;
+	if_face->act_altsetting = alternate;
 
 	return 0;
 }
@@ -60,6 +60,12 @@ struct usb_device_scan {
 
 static LIST_HEAD(usb_scan_list);
 
+/* true if hub ports are left on usb_scan_list for usb_hub_scan_poll() */
+static bool usb_scan_deferred;
+
+/* Number of ports removed from usb_scan_list, to tell when a pass did work */
+static uint usb_scan_removed;
+
 __weak void usb_hub_reset_devices(struct usb_hub_device *hub, int port)
 {
 	return;
@@ -438,6 +444,14 @@ int usb_hub_port_connect_change(struct usb_device *dev, int port)
 	return ret;
 }
 
+/* Remove a port from the scanning list, once it is done with */
+static void usb_scan_remove(struct usb_device_scan *usb_scan)
+{
+	list_del(&usb_scan->list);
+	free(usb_scan);
+	usb_scan_removed++;
+}
+
 static int usb_scan_port(struct usb_device_scan *usb_scan)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
@@ -466,8 +480,7 @@ static int usb_scan_port(struct usb_device_scan *usb_scan)
 			debug("devnum=%d port=%d: timeout\n",
 			      dev->devnum, i + 1);
 			/* Remove this device from scanning list */
-			list_del(&usb_scan->list);
-			free(usb_scan);
+			usb_scan_remove(usb_scan);
 			return 0;
 		}
 		return 0;
@@ -490,8 +503,7 @@ static int usb_scan_port(struct usb_device_scan *usb_scan)
 			debug("devnum=%d port=%d: timeout\n",
 			      dev->devnum, i + 1);
 			/* Remove this device from scanning list */
-			list_del(&usb_scan->list);
-			free(usb_scan);
+			usb_scan_remove(usb_scan);
 			return 0;
 		}
 		return 0;
@@ -560,41 +572,61 @@ static int usb_scan_port(struct usb_device_scan *usb_scan)
 	 * We're done with this device, so let's remove this device from
 	 * scanning list
 	 */
-	list_del(&usb_scan->list);
-	free(usb_scan);
+	usb_scan_remove(usb_scan);
 
 	return 0;
 }
 
-static int usb_device_list_scan(void)
+int usb_hub_scan_poll(void)
 {
 	struct usb_device_scan *usb_scan;
 	struct usb_device_scan *tmp;
-	static int running;
-	int ret = 0;
-
-	/* Only run this loop once for each controller */
-	if (running)
-		return 0;
-
-	running = 1;
-
-	while (1) {
-		/* We're done, once the list is empty again */
-		if (list_empty(&usb_scan_list))
-			goto out;
+	uint removed;
 
+	/*
+	 * The ports of any hub found are added to the end of the list, so go
+	 * round again while ports are being dealt with, stopping once all
+	 * those left are waiting for their hub
+	 */
+	do {
+		removed = usb_scan_removed;
 		list_for_each_entry_safe(usb_scan, tmp, &usb_scan_list, list) {
 			int ret;
 
 			/* Scan this port */
 			ret = usb_scan_port(usb_scan);
 			if (ret)
-				goto out;
+				return ret;
 		}
-	}
+	} while (removed != usb_scan_removed && !list_empty(&usb_scan_list));
+
+	/* We're done, once the list is empty again */
+	return list_empty(&usb_scan_list) ? 0 : -EAGAIN;
+}
+
+void usb_hub_scan_defer(bool defer)
+{
+	usb_scan_deferred = defer;
+}
+
+static int usb_device_list_scan(void)
+{
+	static int running;
+	int ret;
+
+	/*
+	 * Only run this loop once for each controller. When the scan is
+	 * deferred, the caller polls the list instead.
+	 */
+	if (running || usb_scan_deferred)
+		return 0;
+
+	running = 1;
+
+	do {
+		ret = usb_hub_scan_poll();
+	} while (ret == -EAGAIN);
 
-out:
 	/*
 	 * This USB controller has finished scanning all its connected
 	 * USB devices. Set "running" back to 0, so that other USB controllers
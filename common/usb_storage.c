@@ -42,6 +42,7 @@
 #include <asm/byteorder.h>
 #include <asm/cache.h>
 #include <asm/processor.h>
+#include <asm/unaligned.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <linux/delay.h>
@@ -59,7 +60,7 @@
 static const unsigned char us_direction[256/8] = {
 	0x28, 0x81, 0x14, 0x14, 0x20, 0x01, 0x90, 0x77,
 	0x0C, 0x20, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01,
+	0x00, 0x01, 0x00, 0x40, 0x00, 0x01, 0x00, 0x01,
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
 #define US_DIRECTION(x) ((us_direction[x>>3] >> (x & 7)) & 1)
@@ -101,6 +102,10 @@ struct us_data {
 	trans_cmnd	transport;		/* transport routine */
 	unsigned short	max_xfer_blk;		/* maximum transfer blocks */
 	bool		cmd12;			/* use 12-byte commands (RBC/UFI) */
+	unsigned char	ep_cmd;			/* UAS command pipe */
+	unsigned char	ep_status;		/* UAS status pipe */
+	unsigned char	uas_tags;		/* UAS commands in flight */
+	bool		uas_streams;		/* UAS pipes use streams */
 };
 
 #if !CONFIG_IS_ENABLED(BLK)
@@ -111,6 +116,9 @@ static struct us_data usb_stor[USB_MAX_STOR_DEV];
 #define USB_STOR_TRANSPORT_FAILED -1
 #define USB_STOR_TRANSPORT_ERROR  -2
 
+/* Maximum number of UAS commands in flight, one per stream */
+#define UAS_MAX_TAGS	8
+
 int usb_stor_get_info(struct usb_device *dev, struct us_data *us,
 		      struct blk_desc *dev_desc);
 int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
@@ -750,13 +758,32 @@ static int usb_stor_BBB_transport(struct scsi_cmd *srb, struct us_data *us)
 	if (srb->datalen == 0)
 		goto st;
 	debug("DATA phase\n");
-	if (dir_in)
+	if (dir_in) {
+		/*
+		 * The status follows the data on the same endpoint, so queue
+		 * both together. If the data phase succeeds, go straight to
+		 * checking the status.
+		 */
+		struct usb_bulk_xfer xfers[] = {
+			{ .data = srb->pdata, .len = srb->datalen },
+			{ .data = csw, .len = UMASS_BBB_CSW_SIZE },
+		};
+
 		pipe = pipein;
-	else
+		result = usb_bulk_msg_queue(us->pusb_dev, pipe, xfers,
+					    ARRAY_SIZE(xfers),
+					    USB_CNTL_TIMEOUT * 5);
+		data_actlen = xfers[0].actual_length;
+		if (!xfers[0].status) {
+			retry = 0;
+			goto status;
+		}
+	} else {
 		pipe = pipeout;
-
-	result = usb_bulk_msg(us->pusb_dev, pipe, srb->pdata, srb->datalen,
-			      &data_actlen, USB_CNTL_TIMEOUT * 5);
+		result = usb_bulk_msg(us->pusb_dev, pipe, srb->pdata,
+				      srb->datalen, &data_actlen,
+				      USB_CNTL_TIMEOUT * 5);
+	}
 	/* special handling of STALL in DATA phase */
 	if ((result < 0) && (us->pusb_dev->status & USB_ST_STALLED)) {
 		debug("DATA:stall\n");
@@ -785,7 +812,7 @@ again:
 	debug("STATUS phase\n");
 	result = usb_bulk_msg(us->pusb_dev, pipein, csw, UMASS_BBB_CSW_SIZE,
 				&actlen, USB_CNTL_TIMEOUT*5);
-
+status:
 	/* special handling of STALL in STATUS phase */
 	if ((result < 0) && (retry < 1) &&
 	    (us->pusb_dev->status & USB_ST_STALLED)) {
@@ -952,6 +979,256 @@ do_retry:
 	return USB_STOR_TRANSPORT_FAILED;
 }
 
+/*
+ * USB Attached SCSI: each command is sent as a command IU with a tag. Data
+ * moves on the data pipes and the status comes back as a sense IU on the
+ * status pipe. At SuperSpeed each tag has its own stream on these pipes, so
+ * several commands can be in flight. At high speed there are no streams and
+ * the device sends a READ READY or WRITE READY IU before the data instead.
+ */
+static int usb_stor_uas_submit(struct scsi_cmd *srb, struct us_data *us,
+			       u16 tag)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct uas_cmd_iu, iu, 1);
+	struct usb_device *udev = us->pusb_dev;
+	int actlen, ret;
+
+	memset(iu, '\0', sizeof(*iu));
+	iu->id = UAS_IU_COMMAND;
+	iu->tag = cpu_to_be16(tag);
+	iu->lun[1] = srb->lun;
+	memcpy(iu->cdb, srb->cmd, srb->cmdlen);
+	ret = usb_bulk_msg(udev, usb_sndbulkpipe(udev, us->ep_cmd), iu,
+			   sizeof(*iu), &actlen, USB_CNTL_TIMEOUT * 5);
+	if (ret) {
+		debug("UAS command %x failed (err=%d)\n", srb->cmd[0], ret);
+		return USB_STOR_TRANSPORT_ERROR;
+	}
+
+	return USB_STOR_TRANSPORT_GOOD;
+}
+
+static int usb_stor_uas_get_iu(struct us_data *us, u16 tag,
+			       struct uas_sense_iu *iu)
+{
+	struct usb_device *udev = us->pusb_dev;
+	int actlen, ret;
+
+	ret = usb_bulk_msg_stream(udev, usb_rcvbulkpipe(udev, us->ep_status),
+				  us->uas_streams ? tag : 0, iu, sizeof(*iu),
+				  &actlen, USB_CNTL_TIMEOUT * 5);
+	if (ret || actlen < UAS_READY_IU_SIZE || be16_to_cpu(iu->tag) != tag) {
+		debug("UAS status for tag %d failed (err=%d)\n", tag, ret);
+		return USB_STOR_TRANSPORT_ERROR;
+	}
+
+	return USB_STOR_TRANSPORT_GOOD;
+}
+
+static int usb_stor_uas_complete(struct scsi_cmd *srb, struct us_data *us,
+				 u16 tag)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct uas_sense_iu, iu, 1);
+	struct usb_device *udev = us->pusb_dev;
+	bool dir_in = US_DIRECTION(srb->cmd[0]);
+	bool have_status = false;
+	unsigned int pipe;
+	int actlen, ret;
+
+	srb->trans_bytes = 0;
+	if (srb->datalen && !us->uas_streams) {
+		ret = usb_stor_uas_get_iu(us, tag, iu);
+		if (ret)
+			return ret;
+		/* A command which fails at once has no data phase */
+		if (iu->id == UAS_IU_SENSE)
+			have_status = true;
+		else if (iu->id != (dir_in ? UAS_IU_READ_READY :
+				    UAS_IU_WRITE_READY))
+			return USB_STOR_TRANSPORT_ERROR;
+	}
+	if (srb->datalen && !have_status) {
+		pipe = dir_in ? usb_rcvbulkpipe(udev, us->ep_in) :
+			usb_sndbulkpipe(udev, us->ep_out);
+		ret = usb_bulk_msg_stream(udev, pipe, us->uas_streams ? tag : 0,
+					  srb->pdata, srb->datalen, &actlen,
+					  USB_CNTL_TIMEOUT * 5);
+		if (ret) {
+			debug("UAS data for tag %d failed (err=%d)\n", tag,
+			      ret);
+			return USB_STOR_TRANSPORT_ERROR;
+		}
+		srb->trans_bytes = actlen;
+	}
+	if (!have_status) {
+		ret = usb_stor_uas_get_iu(us, tag, iu);
+		if (ret)
+			return ret;
+	}
+	if (iu->id != UAS_IU_SENSE)
+		return USB_STOR_TRANSPORT_ERROR;
+
+	srb->status = iu->status;
+	if (iu->status) {
+		/* The sense data comes with the status, so keep it */
+		memset(srb->sense_buf, '\0', sizeof(srb->sense_buf));
+		memcpy(srb->sense_buf, iu->sense,
+		       min_t(uint, be16_to_cpu(iu->len),
+			     sizeof(srb->sense_buf)));
+		return USB_STOR_TRANSPORT_FAILED;
+	}
+
+	return USB_STOR_TRANSPORT_GOOD;
+}
+
+static int usb_stor_uas_reset(struct us_data *us)
+{
+	struct usb_device *udev = us->pusb_dev;
+
+	usb_clear_halt(udev, usb_sndbulkpipe(udev, us->ep_cmd));
+	usb_clear_halt(udev, usb_rcvbulkpipe(udev, us->ep_status));
+	usb_clear_halt(udev, usb_rcvbulkpipe(udev, us->ep_in));
+	usb_clear_halt(udev, usb_sndbulkpipe(udev, us->ep_out));
+
+	return 0;
+}
+
+static int usb_stor_uas_transport(struct scsi_cmd *srb, struct us_data *us)
+{
+	int ret;
+
+	ret = usb_stor_uas_submit(srb, us, 1);
+	if (!ret)
+		ret = usb_stor_uas_complete(srb, us, 1);
+	if (ret == USB_STOR_TRANSPORT_ERROR)
+		usb_stor_uas_reset(us);
+
+	return ret;
+}
+
+/**
+ * usb_stor_uas_probe() - Set up USB Attached SCSI, if the device has it
+ *
+ * UAS is an alternate setting of the mass-storage interface, with four
+ * endpoints identified by pipe-usage descriptors. Since these are not kept
+ * when the configuration is parsed, the configuration descriptor is read
+ * again here.
+ *
+ * The UAS endpoints usually have the same addresses as the Bulk-Only ones in
+ * alternate setting 0, and the parsed configuration merges all alternate
+ * settings, so the number of streams is taken from the SuperSpeed companion
+ * descriptors read here rather than from the parsed configuration.
+ *
+ * @udev:	USB device
+ * @ss:		Storage device to set up
+ * Return: 0 if UAS is in use, -ve to use the interface's default transport
+ */
+static int usb_stor_uas_probe(struct usb_device *udev, struct us_data *ss)
+{
+	struct usb_interface *iface = &udev->config.if_desc[ss->ifnum];
+	struct usb_interface_descriptor *desc;
+	int streams[UAS_PIPE_DATA_OUT + 1] = {};
+	u8 eps[UAS_PIPE_DATA_OUT + 1] = {};
+	int ep_streams = 0, max_streams;
+	unsigned long pipes[3];
+	int len, pos, ret;
+	int alt = -1;
+	bool in_uas;
+	u8 ep = 0;
+	u8 *buf;
+
+	len = usb_get_configuration_len(udev, 0);
+	if (len < 0)
+		return len;
+	buf = malloc_cache_aligned(len);
+	if (!buf)
+		return -ENOMEM;
+	ret = usb_get_configuration_no(udev, 0, buf, len);
+	if (ret < 0)
+		goto out;
+
+	in_uas = false;
+	for (pos = 0; pos + 2 < len && buf[pos] >= 2; pos += buf[pos]) {
+		switch (buf[pos + 1]) {
+		case USB_DT_INTERFACE:
+			desc = (struct usb_interface_descriptor *)&buf[pos];
+			in_uas = alt == -1 && desc->bInterfaceNumber ==
+				 iface->desc.bInterfaceNumber &&
+				 desc->bInterfaceClass == USB_CLASS_MASS_STORAGE &&
+				 desc->bInterfaceSubClass == US_SC_SCSI &&
+				 desc->bInterfaceProtocol == US_PR_UAS;
+			if (in_uas)
+				alt = desc->bAlternateSetting;
+			break;
+		case USB_DT_ENDPOINT:
+			if (in_uas) {
+				ep = buf[pos + 2];
+				ep_streams = 0;
+			}
+			break;
+		case USB_DT_SS_ENDPOINT_COMP:
+			if (in_uas && buf[pos] >= USB_DT_SS_EP_COMP_SIZE)
+				ep_streams = usb_ss_max_streams(
+					(struct usb_ss_ep_comp_descriptor *)
+					&buf[pos]);
+			break;
+		case USB_DT_PIPE_USAGE:
+			if (in_uas && ep && buf[pos + 2] <= UAS_PIPE_DATA_OUT) {
+				eps[buf[pos + 2]] = ep;
+				streams[buf[pos + 2]] = ep_streams;
+			}
+			break;
+		}
+	}
+	ret = -ENOENT;
+	if (alt == -1 || !eps[UAS_PIPE_CMD] || !eps[UAS_PIPE_STATUS] ||
+	    !eps[UAS_PIPE_DATA_IN] || !eps[UAS_PIPE_DATA_OUT])
+		goto out;
+
+	ss->ep_cmd = eps[UAS_PIPE_CMD] & USB_ENDPOINT_NUMBER_MASK;
+	ss->ep_status = eps[UAS_PIPE_STATUS] & USB_ENDPOINT_NUMBER_MASK;
+	ss->ep_in = eps[UAS_PIPE_DATA_IN] & USB_ENDPOINT_NUMBER_MASK;
+	ss->ep_out = eps[UAS_PIPE_DATA_OUT] & USB_ENDPOINT_NUMBER_MASK;
+	ret = usb_set_interface(udev, iface->desc.bInterfaceNumber, alt);
+	if (ret)
+		goto out;
+
+	/* Streams are required at SuperSpeed and unavailable below it */
+	ss->uas_tags = 1;
+	if (udev->speed >= USB_SPEED_SUPER) {
+		pipes[0] = usb_rcvbulkpipe(udev, ss->ep_status);
+		pipes[1] = usb_rcvbulkpipe(udev, ss->ep_in);
+		pipes[2] = usb_sndbulkpipe(udev, ss->ep_out);
+		max_streams = min3(streams[UAS_PIPE_STATUS],
+				   streams[UAS_PIPE_DATA_IN],
+				   streams[UAS_PIPE_DATA_OUT]);
+		ret = -ENOSYS;
+		if (max_streams > 0)
+			ret = usb_alloc_streams(udev, pipes, ARRAY_SIZE(pipes),
+						min(max_streams, UAS_MAX_TAGS));
+		if (ret < 1) {
+			debug("No UAS streams (err=%d)\n", ret);
+			usb_set_interface(udev, iface->desc.bInterfaceNumber,
+					  0);
+			ret = -ENOSYS;
+			goto out;
+		}
+		ss->uas_streams = true;
+		ss->uas_tags = min(ret, UAS_MAX_TAGS);
+	}
+	ss->subclass = US_SC_SCSI;
+	ss->protocol = US_PR_UAS;
+	ss->transport = usb_stor_uas_transport;
+	ss->transport_reset = usb_stor_uas_reset;
+	debug("UAS endpoints Cmd %d Status %d In %d Out %d, %d tags\n",
+	      ss->ep_cmd, ss->ep_status, ss->ep_in, ss->ep_out, ss->uas_tags);
+	ret = 0;
+out:
+	free(buf);
+
+	return ret;
+}
+
 static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 				      struct us_data *us)
 {
@@ -978,6 +1255,13 @@ static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 	size_t size;
 	int ret;
 
+	/*
+	 * UAS devices are recent enough to cope with large transfers, so
+	 * only the host controller limits them.
+	 */
+	if (us->protocol == US_PR_UAS)
+		blk = USHRT_MAX;
+
 	ret = usb_get_max_xfer_size(udev, (size_t *)&size);
 	if ((ret >= 0) && (size < blk * 512))
 		blk = size / 512;
@@ -1014,6 +1298,10 @@ static int usb_request_sense(struct scsi_cmd *srb, struct us_data *ss)
 {
 	char *ptr;
 
+	/* UAS devices return the sense data along with the status */
+	if (ss->protocol == US_PR_UAS)
+		return 0;
+
 	ptr = (char *)srb->pdata;
 	memset(&srb->cmd[0], 0, 12);
 	srb->cmd[0] = SCSI_REQ_SENSE;
@@ -1079,40 +1367,135 @@ static int usb_read_capacity(struct scsi_cmd *srb, struct us_data *ss)
 	return -1;
 }
 
-static int usb_read_10(struct scsi_cmd *srb, struct us_data *ss,
-		       unsigned long start, unsigned short blocks)
+#ifdef CONFIG_SYS_64BIT_LBA
+static int usb_read_capacity16(struct scsi_cmd *srb, struct us_data *ss)
 {
-	memset(&srb->cmd[0], 0, 12);
-	srb->cmd[0] = SCSI_READ10;
-	srb->cmd[1] = srb->lun << 5;
-	srb->cmd[2] = ((unsigned char) (start >> 24)) & 0xff;
-	srb->cmd[3] = ((unsigned char) (start >> 16)) & 0xff;
-	srb->cmd[4] = ((unsigned char) (start >> 8)) & 0xff;
-	srb->cmd[5] = ((unsigned char) (start)) & 0xff;
-	srb->cmd[7] = ((unsigned char) (blocks >> 8)) & 0xff;
-	srb->cmd[8] = (unsigned char) blocks & 0xff;
-	srb->cmdlen = ss->cmd12 ? 12 : 10;
-	debug("read10: start %lx blocks %x\n", start, blocks);
+	memset(&srb->cmd[0], 0, 16);
+	srb->cmd[0] = SCSI_RD_CAPAC16;
+	srb->cmd[1] = 0x10;		/* service action: read capacity */
+	put_unaligned_be32(32, &srb->cmd[10]);
+	srb->datalen = 32;
+	srb->cmdlen = 16;
+	if (ss->transport(srb, ss) == USB_STOR_TRANSPORT_GOOD)
+		return 0;
+
+	return -1;
+}
+#endif
+
+/*
+ * Set up a READ or WRITE command. The 16-byte form is needed for blocks
+ * beyond 2TiB with 512-byte blocks.
+ */
+static void usb_setup_rw(struct scsi_cmd *srb, struct us_data *ss,
+			 lbaint_t start, unsigned short blocks, bool write)
+{
+	u64 end = (u64)start + blocks;
+
+	memset(&srb->cmd[0], 0, 16);
+	if (upper_32_bits(end) && !ss->cmd12) {
+		srb->cmd[0] = write ? SCSI_WRITE16 : SCSI_READ16;
+		put_unaligned_be64(start, &srb->cmd[2]);
+		put_unaligned_be32(blocks, &srb->cmd[10]);
+		srb->cmdlen = 16;
+	} else {
+		srb->cmd[0] = write ? SCSI_WRITE10 : SCSI_READ10;
+		srb->cmd[1] = srb->lun << 5;
+		put_unaligned_be32(start, &srb->cmd[2]);
+		put_unaligned_be16(blocks, &srb->cmd[7]);
+		srb->cmdlen = ss->cmd12 ? 12 : 10;
+	}
+	debug("%s: start " LBAFU " blocks %x\n", write ? "write" : "read",
+	      start, blocks);
+}
+
+static int usb_read_blocks(struct scsi_cmd *srb, struct us_data *ss,
+			   lbaint_t start, unsigned short blocks)
+{
+	usb_setup_rw(srb, ss, start, blocks, false);
 	return ss->transport(srb, ss);
 }
 
-static int usb_write_10(struct scsi_cmd *srb, struct us_data *ss,
-			unsigned long start, unsigned short blocks)
+static int usb_write_blocks(struct scsi_cmd *srb, struct us_data *ss,
+			    lbaint_t start, unsigned short blocks)
 {
-	memset(&srb->cmd[0], 0, 12);
-	srb->cmd[0] = SCSI_WRITE10;
-	srb->cmd[1] = srb->lun << 5;
-	srb->cmd[2] = ((unsigned char) (start >> 24)) & 0xff;
-	srb->cmd[3] = ((unsigned char) (start >> 16)) & 0xff;
-	srb->cmd[4] = ((unsigned char) (start >> 8)) & 0xff;
-	srb->cmd[5] = ((unsigned char) (start)) & 0xff;
-	srb->cmd[7] = ((unsigned char) (blocks >> 8)) & 0xff;
-	srb->cmd[8] = (unsigned char) blocks & 0xff;
-	srb->cmdlen = ss->cmd12 ? 12 : 10;
-	debug("write10: start %lx blocks %x\n", start, blocks);
+	usb_setup_rw(srb, ss, start, blocks, true);
 	return ss->transport(srb, ss);
 }
 
+/**
+ * usb_stor_uas_rw() - Read or write blocks with several UAS commands in flight
+ *
+ * Commands are sent for as many transfers as there are tags, then each is
+ * completed in turn and the next command is sent, so that the device always
+ * has work queued. Commands in flight are completed even after an error.
+ * If any command, data or status transfer fails, the pipes are reset
+ * afterwards, as the Bulk-Only transport does, so that the next command does
+ * not find a pipe still halted.
+ *
+ * @ss:		Storage device
+ * @desc:	Block device
+ * @start:	First block
+ * @blkcnt:	Number of blocks
+ * @buf_addr:	Buffer address
+ * @write:	true to write, false to read
+ * Return: number of blocks transferred before any error
+ */
+static lbaint_t usb_stor_uas_rw(struct us_data *ss, struct blk_desc *desc,
+				lbaint_t start, lbaint_t blkcnt,
+				uintptr_t buf_addr, bool write)
+{
+	static struct scsi_cmd srbs[UAS_MAX_TAGS] __aligned(ARCH_DMA_MINALIGN);
+	bool stop = false, ok = true, reset = false;
+	lbaint_t queued = 0, done = 0;
+	uint sent = 0, completed = 0;
+	struct scsi_cmd *srb;
+	unsigned short blks;
+	int ret;
+
+	while (true) {
+		while (!stop && queued < blkcnt &&
+		       sent - completed < ss->uas_tags) {
+			srb = &srbs[sent % ss->uas_tags];
+			blks = min_t(lbaint_t, blkcnt - queued,
+				     ss->max_xfer_blk);
+			srb->lun = desc->lun;
+			srb->pdata = (uchar *)buf_addr + queued * desc->blksz;
+			srb->datalen = blks * desc->blksz;
+			usb_setup_rw(srb, ss, start + queued, blks, write);
+			if (usb_stor_uas_submit(srb, ss,
+						sent % ss->uas_tags + 1)) {
+				stop = true;
+				reset = true;
+				break;
+			}
+			queued += blks;
+			sent++;
+		}
+		if (completed == sent)
+			break;
+
+		srb = &srbs[completed % ss->uas_tags];
+		ret = usb_stor_uas_complete(srb, ss,
+					    completed % ss->uas_tags + 1);
+		if (ret) {
+			stop = true;
+			ok = false;
+			/* a command which failed with sense data needs no reset */
+			if (ret == USB_STOR_TRANSPORT_ERROR)
+				reset = true;
+		} else if (ok) {
+			done += srb->datalen / desc->blksz;
+		}
+		completed++;
+		usb_show_progress();
+	}
+	if (reset)
+		usb_stor_uas_reset(ss);
+
+	return done;
+}
+
 #ifdef CONFIG_USB_BIN_FIXUP
 /*
  * Some USB storage devices queried for SCSI identification data respond with
@@ -1182,7 +1565,19 @@ static unsigned long usb_stor_read(struct blk_desc *block_dev, lbaint_t blknr,
 	debug("\nusb_read: dev %d startblk " LBAF ", blccnt " LBAF " buffer %lx\n",
 	      block_dev->devnum, start, blks, buf_addr);
 
-	do {
+	smallblks = 0;
+	if (CONFIG_IS_ENABLED(USB_STORAGE_UAS) && ss->protocol == US_PR_UAS) {
+		lbaint_t done;
+
+		/* Anything left after an error is retried below */
+		done = usb_stor_uas_rw(ss, block_dev, start, blks, buf_addr,
+				       false);
+		start += done;
+		blks -= done;
+		buf_addr += done * block_dev->blksz;
+	}
+
+	while (blks != 0) {
 		/* XXX need some comment here */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
@@ -1195,7 +1590,7 @@ retry_it:
 			usb_show_progress();
 		srb->datalen = block_dev->blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_read_10(srb, ss, start, smallblks)) {
+		if (usb_read_blocks(srb, ss, start, smallblks)) {
 			debug("Read ERROR\n");
 			ss->flags &= ~USB_READY;
 			usb_request_sense(srb, ss);
@@ -1207,7 +1602,7 @@ retry_it:
 		start += smallblks;
 		blks -= smallblks;
 		buf_addr += srb->datalen;
-	} while (blks != 0);
+	}
 
 	debug("usb_read: end startblk " LBAF ", blccnt %x buffer %lx\n",
 	      start, smallblks, buf_addr);
@@ -1267,7 +1662,19 @@ static unsigned long usb_stor_write(struct blk_desc *block_dev, lbaint_t blknr,
 	debug("\nusb_write: dev %d startblk " LBAF ", blccnt " LBAF " buffer %lx\n",
 	      block_dev->devnum, start, blks, buf_addr);
 
-	do {
+	smallblks = 0;
+	if (CONFIG_IS_ENABLED(USB_STORAGE_UAS) && ss->protocol == US_PR_UAS) {
+		lbaint_t done;
+
+		/* Anything left after an error is retried below */
+		done = usb_stor_uas_rw(ss, block_dev, start, blks, buf_addr,
+				       true);
+		start += done;
+		blks -= done;
+		buf_addr += done * block_dev->blksz;
+	}
+
+	while (blks != 0) {
 		/* If write fails retry for max retry count else
 		 * return with number of blocks written successfully.
 		 */
@@ -1282,7 +1689,7 @@ retry_it:
 			usb_show_progress();
 		srb->datalen = block_dev->blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_write_10(srb, ss, start, smallblks)) {
+		if (usb_write_blocks(srb, ss, start, smallblks)) {
 			debug("Write ERROR\n");
 			ss->flags &= ~USB_READY;
 			usb_request_sense(srb, ss);
@@ -1294,7 +1701,7 @@ retry_it:
 		start += smallblks;
 		blks -= smallblks;
 		buf_addr += srb->datalen;
-	} while (blks != 0);
+	}
 
 	debug("usb_write: end startblk " LBAF ", blccnt %x buffer %lx\n",
 	      start, smallblks, buf_addr);
@@ -1341,6 +1748,10 @@ int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
 	ss->subclass = iface->desc.bInterfaceSubClass;
 	ss->protocol = iface->desc.bInterfaceProtocol;
 
+	/* Prefer USB Attached SCSI, falling back to the default transport */
+	if (CONFIG_IS_ENABLED(USB_STORAGE_UAS) && !usb_stor_uas_probe(dev, ss))
+		goto set_class;
+
 	/* set the handler pointers based on the protocol */
 	debug("Transport: ");
 	switch (ss->protocol) {
@@ -1403,6 +1814,7 @@ int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
 		debug("Problems with device\n");
 		return 0;
 	}
+set_class:
 	/* set class specific stuff */
 	/* We only handle certain protocols.  Currently, these are
 	 * the only ones.
@@ -1441,7 +1853,8 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	unsigned char perq, modi;
 	ALLOC_CACHE_ALIGN_BUFFER(u32, cap, 2);
 	ALLOC_CACHE_ALIGN_BUFFER(u8, usb_stor_buf, 36);
-	u32 capacity, blksz;
+	lbaint_t capacity;
+	u32 blksz;
 	struct scsi_cmd *pccb = &usb_ccb;
 
 	pccb->pdata = usb_stor_buf;
@@ -1508,10 +1921,22 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	cap[1] = cpu_to_be32(cap[1]);
 #endif
 
-	capacity = be32_to_cpu(cap[0]) + 1;
+	capacity = (lbaint_t)be32_to_cpu(cap[0]) + 1;
 	blksz = be32_to_cpu(cap[1]);
+#ifdef CONFIG_SYS_64BIT_LBA
+	/* Devices of 2TiB or more need read capacity (16) */
+	if (be32_to_cpu(cap[0]) == 0xffffffff && !ss->cmd12) {
+		ALLOC_CACHE_ALIGN_BUFFER(u8, cap16, 32);
+
+		pccb->pdata = cap16;
+		if (!usb_read_capacity16(pccb, ss)) {
+			capacity = get_unaligned_be64(cap16) + 1;
+			blksz = get_unaligned_be32(&cap16[8]);
+		}
+	}
+#endif
 
-	debug("Capacity = 0x%08x, blocksz = 0x%08x\n", capacity, blksz);
+	debug("Capacity = " LBAFU ", blocksz = 0x%08x\n", capacity, blksz);
 	dev_desc->lba = capacity;
 	dev_desc->blksz = blksz;
 	dev_desc->log2blksz = LOG2(dev_desc->blksz);
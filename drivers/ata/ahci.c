@@ -679,7 +679,7 @@ static int ata_scsiop_read_write(struct ahci_uc_priv *uc_priv,
 	 * WARNING: one or two older ATA drives treat 0 as 0...
 	 */
 	if (pccb->cmd[0] == SCSI_READ16)
-		blocks = (((u16)pccb->cmd[13]) << 8) | ((u16) pccb->cmd[14]);
+		blocks = (((u16)pccb->cmd[12]) << 8) | ((u16) pccb->cmd[13]);
 	else
 		blocks = (((u16)pccb->cmd[7]) << 8) | ((u16) pccb->cmd[8]);
 
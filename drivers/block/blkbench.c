@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Throughput and latency measurement for block devices
+ */
+
+#include <blk.h>
+#include <blkbench.h>
+#include <display_options.h>
+#include <malloc.h>
+#include <rand.h>
+#include <sort.h>
+#include <time.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/math64.h>
+
+static int blk_bench_cmp(const void *a, const void *b)
+{
+	ulong x = *(const ulong *)a, y = *(const ulong *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* Get the nearest-rank percentile from a sorted list of @count values */
+static ulong blk_bench_pct(const ulong *lat, uint count, uint pct)
+{
+	return lat[DIV_ROUND_UP(count * pct, 100) - 1];
+}
+
+int blk_bench_run(struct blk_desc *desc, const struct blk_bench_params *params,
+		  void *buf, struct blk_bench_result *result)
+{
+	lbaint_t region = params->region;
+	uint seed = params->seed ?: 1;
+	ulong *lat, start;
+	lbaint_t blk;
+	uint slots;
+	ulong n;
+	int ret;
+	uint i;
+
+	memset(result, '\0', sizeof(*result));
+	if (params->start >= desc->lba)
+		return -EINVAL;
+	if (!region)
+		region = desc->lba - params->start;
+	if (params->start + region > desc->lba || !params->blocks ||
+	    params->blocks > region || !params->count)
+		return -EINVAL;
+	slots = min_t(u64, div_u64(region, params->blocks), UINT_MAX);
+
+	lat = malloc(params->count * sizeof(ulong));
+	if (!lat)
+		return -ENOMEM;
+
+	ret = 0;
+	for (i = 0; i < params->count; i++) {
+		if (params->flags & BLK_BENCH_RANDOM)
+			blk = rand_r(&seed) % slots;
+		else
+			blk = i % slots;
+		blk = params->start + blk * params->blocks;
+
+		if (params->flags & BLK_BENCH_NOCACHE)
+			blkcache_invalidate(desc->uclass_id, desc->devnum);
+
+		start = timer_get_us();
+		if (params->flags & BLK_BENCH_WRITE)
+			n = blk_dwrite(desc, blk, params->blocks, buf);
+		else
+			n = blk_dread(desc, blk, params->blocks, buf);
+		lat[i] = timer_get_us() - start;
+		if (n != params->blocks) {
+			ret = -EIO;
+			break;
+		}
+		result->ops++;
+		result->total_us += lat[i];
+	}
+	result->bytes = (u64)result->ops * params->blocks * desc->blksz;
+
+	if (result->ops) {
+		qsort(lat, result->ops, sizeof(ulong), blk_bench_cmp);
+		result->min_us = lat[0];
+		result->p50_us = blk_bench_pct(lat, result->ops, 50);
+		result->p90_us = blk_bench_pct(lat, result->ops, 90);
+		result->p99_us = blk_bench_pct(lat, result->ops, 99);
+		result->max_us = lat[result->ops - 1];
+	}
+	free(lat);
+
+	return ret;
+}
+
+void blk_bench_show(struct blk_desc *desc,
+		    const struct blk_bench_params *params,
+		    const struct blk_bench_result *result)
+{
+	printf("%s %d: %s %s%s, %u x %u blocks of %lu bytes\n",
+	       blk_get_uclass_name(desc->uclass_id), desc->devnum,
+	       params->flags & BLK_BENCH_WRITE ? "write" : "read",
+	       params->flags & BLK_BENCH_RANDOM ? "random" : "sequential",
+	       params->flags & BLK_BENCH_NOCACHE ? " (no cache)" : "",
+	       result->ops, params->blocks, desc->blksz);
+	printf("%llu bytes in %lu us", result->bytes, result->total_us);
+	if (result->total_us) {
+		puts(" (");
+		print_size(div_u64(result->bytes * 1000000, result->total_us),
+			   "/s");
+		printf(", %llu IOPS)",
+		       div_u64((u64)result->ops * 1000000, result->total_us));
+	}
+	puts("\n");
+	printf("latency us: min %lu, p50 %lu, p90 %lu, p99 %lu, max %lu\n",
+	       result->min_us, result->p50_us, result->p90_us, result->p99_us,
+	       result->max_us);
+}
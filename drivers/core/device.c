@@ -8,6 +8,7 @@
  * Pavel Herrmann <morpheus.ibis@gmail.com>
  */
 
+#include <bootprof.h>
 #include <cpu_func.h>
 #include <errno.h>
 #include <event.h>
@@ -37,10 +38,9 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-static int device_bind_common(struct udevice *parent, const struct driver *drv,
-			      const char *name, void *plat,
-			      ulong driver_data, ofnode node,
-			      uint of_plat_size, struct udevice **devp)
+static int do_device_bind(struct udevice *parent, const struct driver *drv,
+			  const char *name, void *plat, ulong driver_data,
+			  ofnode node, uint of_plat_size, struct udevice **devp)
 {
 	struct udevice *dev;
 	struct uclass *uc;
@@ -237,6 +237,22 @@ fail_alloc1:
 	return ret;
 }
 
+static int device_bind_common(struct udevice *parent, const struct driver *drv,
+			      const char *name, void *plat,
+			      ulong driver_data, ofnode node,
+			      uint of_plat_size, struct udevice **devp)
+{
+	struct bootprof_ctx ctx;
+	int ret;
+
+	bootprof_start(&ctx);
+	ret = do_device_bind(parent, drv, name, plat, driver_data, node,
+			     of_plat_size, devp);
+	bootprof_end_dev(&ctx, BOOTPROFP_BIND, drv);
+
+	return ret;
+}
+
 int device_bind_with_driver_data(struct udevice *parent,
 				 const struct driver *drv, const char *name,
 				 ulong driver_data, ofnode node,
@@ -386,7 +402,7 @@ static int device_alloc_priv(struct udevice *dev)
 	return 0;
 }
 
-int device_of_to_plat(struct udevice *dev)
+static int do_device_of_to_plat(struct udevice *dev)
 {
 	const struct driver *drv;
 	int ret;
@@ -441,6 +457,24 @@ fail:
 	return ret;
 }
 
+int device_of_to_plat(struct udevice *dev)
+{
+	struct bootprof_ctx ctx;
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	if (dev_get_flags(dev) & DM_FLAG_PLATDATA_VALID)
+		return 0;
+
+	bootprof_start(&ctx);
+	ret = do_device_of_to_plat(dev);
+	bootprof_end_dev(&ctx, BOOTPROFP_OF_TO_PLAT, dev->driver);
+
+	return ret;
+}
+
 /**
  * device_get_dma_constraints() - Populate device's DMA constraints
  *
@@ -478,7 +512,7 @@ static int device_get_dma_constraints(struct udevice *dev)
 	return 0;
 }
 
-int device_probe(struct udevice *dev)
+static int do_device_probe(struct udevice *dev)
 {
 	const struct driver *drv;
 	int ret;
@@ -616,6 +650,24 @@ fail:
 	return ret;
 }
 
+int device_probe(struct udevice *dev)
+{
+	struct bootprof_ctx ctx;
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
+		return 0;
+
+	bootprof_start(&ctx);
+	ret = do_device_probe(dev);
+	bootprof_end_dev(&ctx, BOOTPROFP_PROBE, dev->driver);
+
+	return ret;
+}
+
 void *dev_get_plat(const struct udevice *dev)
 {
 	if (!dev) {
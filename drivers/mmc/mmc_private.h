@@ -17,6 +17,25 @@ int mmc_poll_for_busy(struct mmc *mmc, int timeout);
 
 int mmc_set_blocklen(struct mmc *mmc, int len);
 
+/**
+ * mmc_can_set_block_count() - Check whether CMD23 can be used for a transfer
+ *
+ * @mmc: MMC device
+ * @blkcnt: Number of blocks in the transfer
+ * Return: true if the transfer can be started with CMD23 (SET_BLOCK_COUNT)
+ * and does not need to be ended with CMD12 (STOP_TRANSMISSION)
+ */
+bool mmc_can_set_block_count(struct mmc *mmc, lbaint_t blkcnt);
+
+/**
+ * mmc_set_block_count() - Send CMD23 (SET_BLOCK_COUNT)
+ *
+ * @mmc: MMC device
+ * @blkcnt: Number of blocks in the following transfer
+ * Return: 0 if OK, -ve on error
+ */
+int mmc_set_block_count(struct mmc *mmc, lbaint_t blkcnt);
+
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
@@ -82,6 +82,7 @@
 #include <linux/bug.h>
 #include <linux/err.h>
 #include <linux/printk.h>
+#include <time.h>
 #endif
 
 #include <linux/math64.h>
@@ -94,6 +95,35 @@ static int self_check_ai(struct ubi_device *ubi, struct ubi_attach_info *ai);
 /* Temporary variables used during scanning */
 static struct ubi_ec_hdr *ech;
 static struct ubi_vid_hdr *vidh;
+static void *hdrs;
+static int vid_err;
+
+/**
+ * alloc_hdrs - allocate the buffer used to read PEB headers when scanning.
+ * @ubi: UBI device description object
+ *
+ * Both headers of a PEB are read with one MTD read, so a single buffer covers
+ * the PEB from its start to the end of the VID header. @ech and @vidh point to
+ * the headers in it. Returns zero on success and %-ENOMEM on failure.
+ */
+static int alloc_hdrs(struct ubi_device *ubi)
+{
+	hdrs = kzalloc(ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize, GFP_KERNEL);
+	if (!hdrs)
+		return -ENOMEM;
+
+	ech = hdrs;
+	vidh = hdrs + ubi->vid_hdr_aloffset + ubi->vid_hdr_shift;
+	return 0;
+}
+
+static void free_hdrs(void)
+{
+	kfree(hdrs);
+	hdrs = NULL;
+	ech = NULL;
+	vidh = NULL;
+}
 
 /**
  * add_to_list - add physical eraseblock to a list.
@@ -833,7 +863,7 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		return 0;
 	}
 
-	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	err = ubi_io_read_hdrs(ubi, pnum, hdrs, &vid_err, 0);
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -916,7 +946,7 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 
 	/* OK, we've done with the EC header, let's look at the VID header */
 
-	err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	err = vid_err;
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -1232,23 +1262,17 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	struct ubi_ainf_volume *av;
 	struct ubi_ainf_peb *aeb;
 
-	err = -ENOMEM;
-
-	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
-	if (!ech)
+	err = alloc_hdrs(ubi);
+	if (err)
 		return err;
 
-	vidh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
-	if (!vidh)
-		goto out_ech;
-
 	for (pnum = start; pnum < ubi->peb_count; pnum++) {
 		cond_resched();
 
 		dbg_gen("process PEB %d", pnum);
 		err = scan_peb(ubi, ai, pnum, NULL, NULL);
 		if (err < 0)
-			goto out_vidh;
+			goto out_hdrs;
 	}
 
 	ubi_msg(ubi, "scanning is finished");
@@ -1259,7 +1283,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 
 	err = late_analysis(ubi, ai);
 	if (err)
-		goto out_vidh;
+		goto out_hdrs;
 
 	/*
 	 * In case of unknown erase counter we use the mean erase counter
@@ -1286,17 +1310,14 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 
 	err = self_check_ai(ubi, ai);
 	if (err)
-		goto out_vidh;
+		goto out_hdrs;
 
-	ubi_free_vid_hdr(ubi, vidh);
-	kfree(ech);
+	free_hdrs();
 
 	return 0;
 
-out_vidh:
-	ubi_free_vid_hdr(ubi, vidh);
-out_ech:
-	kfree(ech);
+out_hdrs:
+	free_hdrs();
 	return err;
 }
 
@@ -1341,15 +1362,9 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 	int err, pnum, fm_anchor = -1;
 	unsigned long long max_sqnum = 0;
 
-	err = -ENOMEM;
-
-	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
-	if (!ech)
-		goto out;
-
-	vidh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
-	if (!vidh)
-		goto out_ech;
+	err = alloc_hdrs(ubi);
+	if (err)
+		return err;
 
 	for (pnum = 0; pnum < UBI_FM_MAX_START; pnum++) {
 		int vol_id = -1;
@@ -1359,7 +1374,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 		dbg_gen("process PEB %d", pnum);
 		err = scan_peb(ubi, *ai, pnum, &vol_id, &sqnum);
 		if (err < 0)
-			goto out_vidh;
+			goto out_hdrs;
 
 		if (vol_id == UBI_FM_SB_VOLUME_ID && sqnum > max_sqnum) {
 			max_sqnum = sqnum;
@@ -1367,8 +1382,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 		}
 	}
 
-	ubi_free_vid_hdr(ubi, vidh);
-	kfree(ech);
+	free_hdrs();
 
 	if (fm_anchor < 0)
 		return UBI_NO_FASTMAP;
@@ -1380,11 +1394,8 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 
 	return ubi_scan_fastmap(ubi, *ai, fm_anchor);
 
-out_vidh:
-	ubi_free_vid_hdr(ubi, vidh);
-out_ech:
-	kfree(ech);
-out:
+out_hdrs:
+	free_hdrs();
 	return err;
 }
 
@@ -1402,7 +1413,9 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 {
 	int err;
 	struct ubi_attach_info *ai;
+	ulong start, scan_ms, vtbl_ms, wl_ms, eba_ms;
 
+	start = get_timer(0);
 	ai = alloc_ai();
 	if (!ai)
 		return -ENOMEM;
@@ -1443,18 +1456,27 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 	ubi->max_ec = ai->max_ec;
 	ubi->mean_ec = ai->mean_ec;
 	dbg_gen("max. sequence number:       %llu", ai->max_sqnum);
+	scan_ms = get_timer(start);
 
 	err = ubi_read_volume_table(ubi, ai);
 	if (err)
 		goto out_ai;
+	vtbl_ms = get_timer(start) - scan_ms;
 
 	err = ubi_wl_init(ubi, ai);
 	if (err)
 		goto out_vtbl;
+	wl_ms = get_timer(start) - scan_ms - vtbl_ms;
 
 	err = ubi_eba_init(ubi, ai);
 	if (err)
 		goto out_wl;
+	eba_ms = get_timer(start) - scan_ms - vtbl_ms - wl_ms;
+
+	dbg_gen("attached by %s in %lu ms: scan %lu ms, volume table %lu ms, WL %lu ms, EBA %lu ms",
+		ubi->fm ? "fastmap" : "scanning",
+		scan_ms + vtbl_ms + wl_ms + eba_ms, scan_ms, vtbl_ms, wl_ms,
+		eba_ms);
 
 #ifdef CONFIG_MTD_UBI_FASTMAP
 	if (ubi->fm && ubi_dbg_chk_fastmap(ubi)) {
@@ -38,6 +38,7 @@
 #include <linux/err.h>
 #include <ubi_uboot.h>
 #include <linux/mtd/partitions.h>
+#include <time.h>
 
 #include "ubi.h"
 
@@ -1026,6 +1027,23 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num,
 		goto out_debugfs;
 	}
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	/*
+	 * If the device had to be scanned and fastmap is enabled, write a
+	 * fastmap now rather than at detach time. The OS is usually booted
+	 * without detaching, so otherwise every boot would scan again.
+	 */
+	if (!ubi->fm && !ubi->fm_disabled && !ubi->ro_mode) {
+		unsigned long start = get_timer(0);
+
+		err = ubi_update_fastmap(ubi);
+		if (err)
+			ubi_warn(ubi, "cannot write fastmap, error %d", err);
+		else
+			dbg_gen("fastmap written in %lu ms", get_timer(start));
+	}
+#endif
+
 	ubi_msg(ubi, "attached mtd%d (name \"%s\", size %llu MiB)",
 		mtd->index, mtd->name, ubi->flash_size >> 20);
 	ubi_msg(ubi, "PEB size: %d bytes (%d KiB), LEB size: %d bytes",
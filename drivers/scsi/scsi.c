@@ -47,11 +47,11 @@ void scsi_setup_read16(struct scsi_cmd *pccb, lbaint_t start,
 	pccb->cmd[7] = (unsigned char)(start >> 16) & 0xff;
 	pccb->cmd[8] = (unsigned char)(start >> 8) & 0xff;
 	pccb->cmd[9] = (unsigned char)start & 0xff;
-	pccb->cmd[10] = 0;
-	pccb->cmd[11] = (unsigned char)(blocks >> 24) & 0xff;
-	pccb->cmd[12] = (unsigned char)(blocks >> 16) & 0xff;
-	pccb->cmd[13] = (unsigned char)(blocks >> 8) & 0xff;
-	pccb->cmd[14] = (unsigned char)blocks & 0xff;
+	pccb->cmd[10] = (unsigned char)(blocks >> 24) & 0xff;
+	pccb->cmd[11] = (unsigned char)(blocks >> 16) & 0xff;
+	pccb->cmd[12] = (unsigned char)(blocks >> 8) & 0xff;
+	pccb->cmd[13] = (unsigned char)blocks & 0xff;
+	pccb->cmd[14] = 0;
 	pccb->cmd[15] = 0;
 	pccb->cmdlen = 16;
 	pccb->msgout[0] = SCSI_IDENTIFY; /* NOT USED */
@@ -59,7 +59,7 @@ void scsi_setup_read16(struct scsi_cmd *pccb, lbaint_t start,
 	      pccb->cmd[0], pccb->cmd[1],
 	      pccb->cmd[2], pccb->cmd[3], pccb->cmd[4], pccb->cmd[5],
 	      pccb->cmd[6], pccb->cmd[7], pccb->cmd[8], pccb->cmd[9],
-	      pccb->cmd[11], pccb->cmd[12], pccb->cmd[13], pccb->cmd[14]);
+	      pccb->cmd[10], pccb->cmd[11], pccb->cmd[12], pccb->cmd[13]);
 }
 #endif
 
@@ -5,7 +5,9 @@
 
 #define LOG_CATEGORY UCLASS_SERIAL
 
+#include <bootstage.h>
 #include <config.h>
+#include <cyclic.h>
 #include <dm.h>
 #include <env_internal.h>
 #include <errno.h>
@@ -232,10 +234,167 @@ int serial_initialize(void)
 	return serial_init();
 }
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/* Interval at which the cyclic function drains the TX buffer */
+#define SERIAL_TX_CYCLIC_US	1000
+
+static bool serial_tx_buffered(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	return upriv->tx_active;
+}
+
+/**
+ * serial_tx_drain() - Send characters from the TX buffer to the UART
+ *
+ * @dev: Serial device
+ * @wait: true to wait until the buffer is empty, false to stop as soon as the
+ *	UART is busy
+ * Return: 0 if the buffer is empty, -EAGAIN if the UART is busy and @wait is
+ *	false, -EBUSY if the buffer is already being drained, other -ve on error
+ */
+static int serial_tx_drain(struct udevice *dev, bool wait)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+	bool waited = false;
+	int ret = 0;
+
+	BUILD_BUG_ON_NOT_POWER_OF_2(CONFIG_SERIAL_TX_BUFFER_SIZE);
+
+	/* A driver or cyclic function may print while the UART is written */
+	if (upriv->tx_draining)
+		return -EBUSY;
+	upriv->tx_draining = true;
+
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr) {
+		uint rd = upriv->tx_rd_ptr % CONFIG_SERIAL_TX_BUFFER_SIZE;
+		ssize_t written;
+
+		if (CONFIG_IS_ENABLED(SERIAL_PUTS) && ops->puts) {
+			uint len = min(upriv->tx_wr_ptr - upriv->tx_rd_ptr,
+				       CONFIG_SERIAL_TX_BUFFER_SIZE - rd);
+
+			written = ops->puts(dev, upriv->tx_buf + rd, len);
+		} else {
+			written = ops->putc(dev, upriv->tx_buf[rd]);
+			if (!written)
+				written = 1;
+		}
+
+		if (!written || written == -EAGAIN) {
+			if (!wait)
+				break;
+			if (!waited) {
+				bootstage_start(BOOTSTAGE_ID_ACCUM_SERIAL_TX,
+						"serial_tx");
+				waited = true;
+			}
+			continue;
+		}
+		if (written < 0) {
+			/* Drop whatever the UART cannot send */
+			upriv->tx_rd_ptr = upriv->tx_wr_ptr;
+			ret = written;
+			break;
+		}
+		upriv->tx_rd_ptr += written;
+	}
+	if (waited)
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SERIAL_TX);
+	upriv->tx_draining = false;
+
+	if (!ret && upriv->tx_rd_ptr != upriv->tx_wr_ptr)
+		ret = -EAGAIN;
+
+	return ret;
+}
+
+static void serial_tx_add(struct udevice *dev, char ch)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	/* If the buffer is full, make room by waiting for the UART */
+	if (upriv->tx_wr_ptr - upriv->tx_rd_ptr ==
+	    CONFIG_SERIAL_TX_BUFFER_SIZE && serial_tx_drain(dev, true))
+		return;
+
+	upriv->tx_buf[upriv->tx_wr_ptr++ % CONFIG_SERIAL_TX_BUFFER_SIZE] = ch;
+}
+
+static void serial_tx_putc(struct udevice *dev, char ch)
+{
+	if (ch == '\n')
+		serial_tx_add(dev, '\r');
+	serial_tx_add(dev, ch);
+}
+
+static void serial_tx_cyclic(struct cyclic_info *c)
+{
+	struct serial_dev_priv *upriv;
+
+	upriv = container_of(c, struct serial_dev_priv, tx_cyclic);
+	serial_tx_drain(upriv->tx_dev, false);
+}
+
+static void serial_tx_start(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	/* Output before relocation is lost when the device is bound again */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return;
+
+	upriv->tx_rd_ptr = 0;
+	upriv->tx_wr_ptr = 0;
+	upriv->tx_dev = dev;
+	cyclic_register(&upriv->tx_cyclic, serial_tx_cyclic,
+			SERIAL_TX_CYCLIC_US, dev->name);
+	upriv->tx_active = true;
+}
+
+static void serial_tx_stop(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (!upriv->tx_active)
+		return;
+	serial_tx_drain(dev, true);
+	upriv->tx_active = false;
+	cyclic_unregister(&upriv->tx_cyclic);
+}
+#else /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
+static bool serial_tx_buffered(struct udevice *dev)
+{
+	return false;
+}
+
+static int serial_tx_drain(struct udevice *dev, bool wait)
+{
+	return 0;
+}
+
+static void serial_tx_putc(struct udevice *dev, char ch)
+{
+}
+
+static void serial_tx_start(struct udevice *dev)
+{
+}
+
+static void serial_tx_stop(struct udevice *dev)
+{
+}
+#endif /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
 static void _serial_flush(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	if (serial_tx_buffered(dev))
+		serial_tx_drain(dev, true);
 	if (!ops->pending)
 		return;
 	while (ops->pending(dev, false) > 0)
@@ -247,6 +406,15 @@ static void _serial_putc(struct udevice *dev, char ch)
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 	int err;
 
+	if (serial_tx_buffered(dev)) {
+		serial_tx_putc(dev, ch);
+		if (IS_ENABLED(CONFIG_CONSOLE_FLUSH_ON_NEWLINE) && ch == '\n')
+			_serial_flush(dev);
+		else
+			serial_tx_drain(dev, false);
+		return;
+	}
+
 	if (ch == '\n')
 		_serial_putc(dev, '\r');
 
@@ -278,6 +446,20 @@ static void _serial_puts(struct udevice *dev, const char *str)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	if (serial_tx_buffered(dev)) {
+		bool newline = false;
+
+		for (; *str; str++) {
+			serial_tx_putc(dev, *str);
+			newline |= *str == '\n';
+		}
+		if (IS_ENABLED(CONFIG_CONSOLE_FLUSH_ON_NEWLINE) && newline)
+			_serial_flush(dev);
+		else
+			serial_tx_drain(dev, false);
+		return;
+	}
+
 	if (!CONFIG_IS_ENABLED(SERIAL_PUTS) || !ops->puts) {
 		while (*str)
 			_serial_putc(dev, *str++);
@@ -590,11 +772,15 @@ static int serial_post_probe(struct udevice *dev)
 
 	stdio_register_dev(&sdev, &upriv->sdev);
 #endif
+	serial_tx_start(dev);
+
 	return 0;
 }
 
 static int serial_pre_remove(struct udevice *dev)
 {
+	serial_tx_stop(dev);
+
 #if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER)
 	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
 
@@ -130,6 +130,7 @@ int do_reset(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 	}
 
 	printf("resetting ...\n");
+	flush();
 	mdelay(100);
 
 	sysreset_walk_halt(reset_type);
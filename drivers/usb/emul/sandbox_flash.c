@@ -13,18 +13,31 @@
 #include <scsi.h>
 #include <scsi_emul.h>
 #include <usb.h>
+#include <asm/test.h>
 
 /*
  * This driver emulates a flash stick using the UFI command specification and
  * the BBB (bulk/bulk/bulk) protocol. It supports only a single logical unit
  * number (LUN 0).
+ *
+ * With the "sandbox,uas" property it also offers USB Attached SCSI as a second
+ * alternate setting, with the data endpoints at the same addresses as the
+ * Bulk-Only ones. At high speed there are no streams and one command is
+ * handled at a time. A test can switch the device to SuperSpeed, where the
+ * UAS endpoints have streams: commands are then queued by tag and each is run
+ * when the host asks for its data or status on the tag's stream.
  */
 
 enum {
 	SANDBOX_FLASH_EP_OUT		= 1,	/* endpoints */
 	SANDBOX_FLASH_EP_IN		= 2,
+	SANDBOX_FLASH_EP_CMD		= 3,	/* UAS endpoints */
+	SANDBOX_FLASH_EP_STATUS		= 4,
+	SANDBOX_FLASH_EP_DATA_IN	= SANDBOX_FLASH_EP_IN,
+	SANDBOX_FLASH_EP_DATA_OUT	= SANDBOX_FLASH_EP_OUT,
 	SANDBOX_FLASH_BLOCK_LEN		= 512,
 	SANDBOX_FLASH_BUF_SIZE		= 512,
+	SANDBOX_FLASH_MAX_STREAMS	= 16,	/* UAS streams at SuperSpeed */
 };
 
 enum {
@@ -44,6 +57,12 @@ enum {
  * @fd:		File descriptor of backing file
  * @file_size:	Size of file in bytes
  * @status_buff:	Data buffer for outgoing status
+ * @uas:	true if the UAS alternate setting is selected
+ * @uas_ready:	READY IU to send before the data (UAS), or 0 if none
+ * @streams:	Number of UAS streams set up by the host, 0 if none
+ * @queued:	Bitmask of UAS tags with a command waiting or running
+ * @max_queued:	Most commands which were queued at once
+ * @cdbs:	Command blocks of the queued commands, indexed by tag - 1
  */
 struct sandbox_flash_priv {
 	struct scsi_emul_info eminfo;
@@ -51,13 +70,29 @@ struct sandbox_flash_priv {
 	u32 tag;
 	int fd;
 	struct umass_bbb_csw status;
+	bool uas;
+	u8 uas_ready;
+	int streams;
+	uint queued;
+	int max_queued;
+	u8 cdbs[SANDBOX_FLASH_MAX_STREAMS][16];
 };
 
 struct sandbox_flash_plat {
 	const char *pathname;
+	bool uas;
+	bool superspeed;
 	struct usb_string flash_strings[STRINGID_COUNT];
 };
 
+/* Pipe usage descriptor, which follows each UAS endpoint descriptor */
+struct uas_pipe_usage_desc {
+	u8 bLength;
+	u8 bDescriptorType;
+	u8 bPipeID;
+	u8 reserved;
+} __packed;
+
 static struct usb_device_descriptor flash_device_desc = {
 	.bLength =		sizeof(flash_device_desc),
 	.bDescriptorType =	USB_DT_DEVICE,
@@ -130,6 +165,140 @@ static void *flash_desc_list[] = {
 	NULL,
 };
 
+static struct usb_config_descriptor flash_uas_config0 = {
+	.bLength		= sizeof(flash_uas_config0),
+	.bDescriptorType	= USB_DT_CONFIG,
+
+	/* wTotalLength is set up by usb-emul-uclass */
+	.bNumInterfaces		= 1,
+	.bConfigurationValue	= 0,
+	.iConfiguration		= 0,
+	.bmAttributes		= 1 << 7,
+	.bMaxPower		= 50,
+};
+
+static struct usb_interface_descriptor flash_uas_interface1 = {
+	.bLength		= sizeof(flash_uas_interface1),
+	.bDescriptorType	= USB_DT_INTERFACE,
+
+	.bInterfaceNumber	= 0,
+	.bAlternateSetting	= 1,
+	.bNumEndpoints		= 4,
+	.bInterfaceClass	= USB_CLASS_MASS_STORAGE,
+	.bInterfaceSubClass	= US_SC_SCSI,
+	.bInterfaceProtocol	= US_PR_UAS,
+	.iInterface		= 0,
+};
+
+#define FLASH_UAS_ENDPOINT(_name, _addr)				\
+static struct usb_endpoint_descriptor _name = {				\
+	.bLength		= USB_DT_ENDPOINT_SIZE,			\
+	.bDescriptorType	= USB_DT_ENDPOINT,			\
+	.bEndpointAddress	= _addr,				\
+	.bmAttributes		= USB_ENDPOINT_XFER_BULK,		\
+	.wMaxPacketSize		= __constant_cpu_to_le16(512),		\
+}
+
+#define FLASH_UAS_PIPE(_name, _id)					\
+static struct uas_pipe_usage_desc _name = {				\
+	.bLength		= sizeof(struct uas_pipe_usage_desc),	\
+	.bDescriptorType	= USB_DT_PIPE_USAGE,			\
+	.bPipeID		= _id,					\
+}
+
+FLASH_UAS_ENDPOINT(flash_uas_ep_cmd, SANDBOX_FLASH_EP_CMD);
+FLASH_UAS_PIPE(flash_uas_pipe_cmd, UAS_PIPE_CMD);
+FLASH_UAS_ENDPOINT(flash_uas_ep_status,
+		   SANDBOX_FLASH_EP_STATUS | USB_ENDPOINT_DIR_MASK);
+FLASH_UAS_PIPE(flash_uas_pipe_status, UAS_PIPE_STATUS);
+FLASH_UAS_ENDPOINT(flash_uas_ep_data_in,
+		   SANDBOX_FLASH_EP_DATA_IN | USB_ENDPOINT_DIR_MASK);
+FLASH_UAS_PIPE(flash_uas_pipe_data_in, UAS_PIPE_DATA_IN);
+FLASH_UAS_ENDPOINT(flash_uas_ep_data_out, SANDBOX_FLASH_EP_DATA_OUT);
+FLASH_UAS_PIPE(flash_uas_pipe_data_out, UAS_PIPE_DATA_OUT);
+
+static void *flash_uas_desc_list[] = {
+	&flash_device_desc,
+	&flash_uas_config0,
+	&flash_interface0,
+	&flash_endpoint0_out,
+	&flash_endpoint1_in,
+	&flash_uas_interface1,
+	&flash_uas_ep_cmd,
+	&flash_uas_pipe_cmd,
+	&flash_uas_ep_status,
+	&flash_uas_pipe_status,
+	&flash_uas_ep_data_in,
+	&flash_uas_pipe_data_in,
+	&flash_uas_ep_data_out,
+	&flash_uas_pipe_data_out,
+	NULL,
+};
+
+static struct usb_device_descriptor flash_ss_device_desc = {
+	.bLength =		sizeof(flash_ss_device_desc),
+	.bDescriptorType =	USB_DT_DEVICE,
+
+	.bcdUSB =		__constant_cpu_to_le16(0x0300),
+	.bMaxPacketSize0 =	9,
+
+	.idVendor =		__constant_cpu_to_le16(0x1234),
+	.idProduct =		__constant_cpu_to_le16(0x5678),
+	.iManufacturer =	STRINGID_MANUFACTURER,
+	.iProduct =		STRINGID_PRODUCT,
+	.iSerialNumber =	STRINGID_SERIAL,
+	.bNumConfigurations =	1,
+};
+
+static struct usb_config_descriptor flash_ss_config0 = {
+	.bLength		= sizeof(flash_ss_config0),
+	.bDescriptorType	= USB_DT_CONFIG,
+
+	/* wTotalLength is set up by usb-emul-uclass */
+	.bNumInterfaces		= 1,
+	.bConfigurationValue	= 0,
+	.iConfiguration		= 0,
+	.bmAttributes		= 1 << 7,
+	.bMaxPower		= 50,
+};
+
+/* Companion for an endpoint without streams */
+static struct usb_ss_ep_comp_descriptor flash_ss_ep_comp = {
+	.bLength		= USB_DT_SS_EP_COMP_SIZE,
+	.bDescriptorType	= USB_DT_SS_ENDPOINT_COMP,
+};
+
+/* Companion for a UAS endpoint with streams (2^4) */
+static struct usb_ss_ep_comp_descriptor flash_ss_ep_comp_streams = {
+	.bLength		= USB_DT_SS_EP_COMP_SIZE,
+	.bDescriptorType	= USB_DT_SS_ENDPOINT_COMP,
+	.bmAttributes		= 4,
+};
+
+static void *flash_ss_desc_list[] = {
+	&flash_ss_device_desc,
+	&flash_ss_config0,
+	&flash_interface0,
+	&flash_endpoint0_out,
+	&flash_ss_ep_comp,
+	&flash_endpoint1_in,
+	&flash_ss_ep_comp,
+	&flash_uas_interface1,
+	&flash_uas_ep_cmd,
+	&flash_ss_ep_comp,
+	&flash_uas_pipe_cmd,
+	&flash_uas_ep_status,
+	&flash_ss_ep_comp_streams,
+	&flash_uas_pipe_status,
+	&flash_uas_ep_data_in,
+	&flash_ss_ep_comp_streams,
+	&flash_uas_pipe_data_in,
+	&flash_uas_ep_data_out,
+	&flash_ss_ep_comp_streams,
+	&flash_uas_pipe_data_out,
+	NULL,
+};
+
 static int sandbox_flash_control(struct udevice *dev, struct usb_device *udev,
 				 unsigned long pipe, void *buff, int len,
 				 struct devrequest *setup)
@@ -148,6 +317,18 @@ static int sandbox_flash_control(struct udevice *dev, struct usb_device *udev,
 			debug("request=%x\n", setup->request);
 			break;
 		}
+	} else if (pipe == usb_sndctrlpipe(udev, 0) &&
+		   setup->request == USB_REQ_SET_INTERFACE) {
+		struct sandbox_flash_plat *plat = dev_get_plat(dev);
+		uint alt = le16_to_cpu(setup->value);
+
+		if (alt > plat->uas)
+			return -EINVAL;
+		priv->uas = alt;
+		priv->eminfo.phase = SCSIPH_START;
+		priv->streams = 0;
+		priv->queued = 0;
+		return 0;
 	}
 	debug("pipe=%lx\n", pipe);
 
@@ -207,6 +388,192 @@ static int handle_ufi_command(struct sandbox_flash_priv *priv, const void *buff,
 	return 0;
 }
 
+static int sandbox_flash_data_out(struct sandbox_flash_priv *priv, void *buff,
+				  int len)
+{
+	struct scsi_emul_info *info = &priv->eminfo;
+
+	log_debug("data out, len=%x, info->write_len=%x\n", len,
+		  info->write_len);
+	if (!info->write_len)
+		return 0;
+	if (priv->fd != -1) {
+		ulong bytes_written;
+
+		bytes_written = os_write(priv->fd, buff, len);
+		log_debug("bytes_written=%lx", bytes_written);
+		if (bytes_written != len)
+			return -EIO;
+		info->write_len -= len / info->block_size;
+		if (!info->write_len)
+			info->phase = SCSIPH_STATUS;
+	} else {
+		if (info->alloc_len && len > info->alloc_len)
+			len = info->alloc_len;
+		if (len > SANDBOX_FLASH_BUF_SIZE)
+			len = SANDBOX_FLASH_BUF_SIZE;
+		memcpy(info->buff, buff, len);
+		info->phase = SCSIPH_STATUS;
+	}
+
+	return len;
+}
+
+static int sandbox_flash_data_in(struct sandbox_flash_priv *priv, void *buff,
+				 int len)
+{
+	struct scsi_emul_info *info = &priv->eminfo;
+
+	debug("data in, len=%x, alloc_len=%x, info->read_len=%x\n",
+	      len, info->alloc_len, info->read_len);
+	if (info->read_len) {
+		ulong bytes_read;
+
+		if (priv->fd == -1)
+			return -EIO;
+
+		bytes_read = os_read(priv->fd, buff, len);
+		if (bytes_read != len)
+			return -EIO;
+		info->read_len -= len / info->block_size;
+		if (!info->read_len)
+			info->phase = SCSIPH_STATUS;
+	} else {
+		if (info->alloc_len && len > info->alloc_len)
+			len = info->alloc_len;
+		if (len > SANDBOX_FLASH_BUF_SIZE)
+			len = SANDBOX_FLASH_BUF_SIZE;
+		memcpy(buff, info->buff, len);
+		info->phase = SCSIPH_STATUS;
+	}
+
+	return len;
+}
+
+/**
+ * sandbox_flash_uas_command() - start a UAS command
+ *
+ * Without streams a READY IU is sent on the status pipe before any data
+ *
+ * @priv:	Sandbox flash private data
+ * @tag:	Tag of the command
+ * @cdb:	Command descriptor block, 16 bytes
+ */
+static void sandbox_flash_uas_command(struct sandbox_flash_priv *priv,
+				      u16 tag, const u8 *cdb)
+{
+	struct scsi_emul_info *info = &priv->eminfo;
+	bool data;
+
+	info->alloc_len = 0;
+	info->read_len = 0;
+	info->write_len = 0;
+	priv->tag = tag;
+	handle_ufi_command(priv, cdb, 16);
+	data = info->read_len || info->write_len || info->buff_used;
+	priv->uas_ready = 0;
+	if (priv->status.bCSWStatus == CSWSTATUS_GOOD && data) {
+		if (!priv->streams)
+			priv->uas_ready = info->write_len ?
+				UAS_IU_WRITE_READY : UAS_IU_READ_READY;
+		info->phase = SCSIPH_DATA;
+	} else {
+		info->phase = SCSIPH_STATUS;
+	}
+}
+
+/**
+ * sandbox_flash_uas_bulk() - handle a bulk transfer with UAS selected
+ *
+ * A command IU is followed by a READ READY or WRITE READY IU on the status
+ * pipe if there is data to transfer, then the data, then a sense IU with the
+ * SCSI status. Only one command is accepted at a time.
+ *
+ * With streams, command IUs are queued and there are no READY IUs. Each
+ * command is run when the host first asks for its data or status, on the
+ * stream given by its tag.
+ *
+ * @priv:	Sandbox flash private data
+ * @ep:		Endpoint number
+ * @stream:	Stream ID, or 0 if none
+ * @buff:	Transfer buffer
+ * @len:	Transfer length in bytes
+ * Return: number of bytes transferred, or -ve on error
+ */
+static int sandbox_flash_uas_bulk(struct sandbox_flash_priv *priv, int ep,
+				  uint stream, void *buff, int len)
+{
+	struct scsi_emul_info *info = &priv->eminfo;
+	struct uas_cmd_iu *cmd = buff;
+	struct uas_sense_iu *sense = buff;
+	u16 tag;
+
+	if (priv->streams && ep != SANDBOX_FLASH_EP_CMD) {
+		if (!stream || stream > priv->streams)
+			goto err;
+		if (info->phase == SCSIPH_START) {
+			if (!(priv->queued & BIT(stream)))
+				goto err;
+			sandbox_flash_uas_command(priv, stream,
+						  priv->cdbs[stream - 1]);
+		} else if (priv->tag != stream) {
+			goto err;
+		}
+	}
+
+	switch (ep) {
+	case SANDBOX_FLASH_EP_CMD:
+		if (len < sizeof(*cmd) || cmd->id != UAS_IU_COMMAND)
+			break;
+		tag = be16_to_cpu(cmd->tag);
+		if (priv->streams) {
+			if (!tag || tag > priv->streams ||
+			    (priv->queued & BIT(tag)))
+				break;
+			memcpy(priv->cdbs[tag - 1], cmd->cdb, sizeof(cmd->cdb));
+			priv->queued |= BIT(tag);
+			priv->max_queued = max(priv->max_queued,
+					       (int)hweight32(priv->queued));
+			return len;
+		}
+		if (info->phase != SCSIPH_START)
+			break;
+		sandbox_flash_uas_command(priv, tag, cmd->cdb);
+		return len;
+	case SANDBOX_FLASH_EP_STATUS:
+		if (priv->uas_ready && len >= UAS_READY_IU_SIZE) {
+			memset(buff, '\0', UAS_READY_IU_SIZE);
+			sense->id = priv->uas_ready;
+			sense->tag = cpu_to_be16(priv->tag);
+			priv->uas_ready = 0;
+			return UAS_READY_IU_SIZE;
+		}
+		if (info->phase != SCSIPH_STATUS || len < 16)
+			break;
+		memset(sense, '\0', 16);
+		sense->id = UAS_IU_SENSE;
+		sense->tag = cpu_to_be16(priv->tag);
+		if (priv->status.bCSWStatus != CSWSTATUS_GOOD)
+			sense->status = S_CHECK_COND;
+		info->phase = SCSIPH_START;
+		if (priv->streams)
+			priv->queued &= ~BIT(priv->tag);
+		return 16;
+	case SANDBOX_FLASH_EP_DATA_IN:
+		if (info->phase != SCSIPH_DATA || info->write_len)
+			break;
+		return sandbox_flash_data_in(priv, buff, len);
+	case SANDBOX_FLASH_EP_DATA_OUT:
+		if (info->phase != SCSIPH_DATA || !info->write_len)
+			break;
+		return sandbox_flash_data_out(priv, buff, len);
+	}
+err:
+	debug("%s: Detected transfer error\n", __func__);
+
+	return -EIO;
+}
+
 static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 			      unsigned long pipe, void *buff, int len)
 {
@@ -217,6 +584,8 @@ static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 
 	debug("%s: dev=%s, pipe=%lx, ep=%x, len=%x, phase=%d\n", __func__,
 	      dev->name, pipe, ep, len, info->phase);
+	if (priv->uas)
+		return sandbox_flash_uas_bulk(priv, ep, 0, buff, len);
 	switch (ep) {
 	case SANDBOX_FLASH_EP_OUT:
 		switch (info->phase) {
@@ -237,31 +606,9 @@ static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 			return handle_ufi_command(priv, cbw->CBWCDB,
 						  cbw->bCDBLength);
 		case SCSIPH_DATA:
-			log_debug("data out, len=%x, info->write_len=%x\n", len,
-				  info->write_len);
 			info->transfer_len = cbw->dCBWDataTransferLength;
 			priv->tag = cbw->dCBWTag;
-			if (!info->write_len)
-				return 0;
-			if (priv->fd != -1) {
-				ulong bytes_written;
-
-				bytes_written = os_write(priv->fd, buff, len);
-				log_debug("bytes_written=%lx", bytes_written);
-				if (bytes_written != len)
-					return -EIO;
-				info->write_len -= len / info->block_size;
-				if (!info->write_len)
-					info->phase = SCSIPH_STATUS;
-			} else {
-				if (info->alloc_len && len > info->alloc_len)
-					len = info->alloc_len;
-				if (len > SANDBOX_FLASH_BUF_SIZE)
-					len = SANDBOX_FLASH_BUF_SIZE;
-				memcpy(info->buff, buff, len);
-				info->phase = SCSIPH_STATUS;
-			}
-			return len;
+			return sandbox_flash_data_out(priv, buff, len);
 		default:
 			break;
 		}
@@ -269,29 +616,7 @@ static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 	case SANDBOX_FLASH_EP_IN:
 		switch (info->phase) {
 		case SCSIPH_DATA:
-			debug("data in, len=%x, alloc_len=%x, info->read_len=%x\n",
-			      len, info->alloc_len, info->read_len);
-			if (info->read_len) {
-				ulong bytes_read;
-
-				if (priv->fd == -1)
-					return -EIO;
-
-				bytes_read = os_read(priv->fd, buff, len);
-				if (bytes_read != len)
-					return -EIO;
-				info->read_len -= len / info->block_size;
-				if (!info->read_len)
-					info->phase = SCSIPH_STATUS;
-			} else {
-				if (info->alloc_len && len > info->alloc_len)
-					len = info->alloc_len;
-				if (len > SANDBOX_FLASH_BUF_SIZE)
-					len = SANDBOX_FLASH_BUF_SIZE;
-				memcpy(buff, info->buff, len);
-				info->phase = SCSIPH_STATUS;
-			}
-			return len;
+			return sandbox_flash_data_in(priv, buff, len);
 		case SCSIPH_STATUS:
 			debug("status in, len=%x\n", len);
 			if (len > sizeof(priv->status))
@@ -309,6 +634,67 @@ err:
 	return 0;
 }
 
+static int sandbox_flash_alloc_streams(struct udevice *dev,
+				       struct usb_device *udev,
+				       unsigned long *pipes, int num_pipes,
+				       int num_streams)
+{
+	struct sandbox_flash_plat *plat = dev_get_plat(dev);
+	struct sandbox_flash_priv *priv = dev_get_priv(dev);
+	int i, ep;
+
+	/* As a host controller would, check against the companions */
+	if (!plat->superspeed || !priv->uas || num_streams < 1 ||
+	    num_streams > SANDBOX_FLASH_MAX_STREAMS)
+		return -EINVAL;
+	for (i = 0; i < num_pipes; i++) {
+		ep = usb_pipeendpoint(pipes[i]);
+		if (ep != SANDBOX_FLASH_EP_STATUS &&
+		    ep != SANDBOX_FLASH_EP_DATA_IN &&
+		    ep != SANDBOX_FLASH_EP_DATA_OUT)
+			return -EINVAL;
+	}
+	priv->streams = num_streams;
+	priv->queued = 0;
+
+	return num_streams;
+}
+
+static int sandbox_flash_bulk_stream(struct udevice *dev,
+				     struct usb_device *udev,
+				     unsigned long pipe, unsigned int stream,
+				     void *buff, int len)
+{
+	struct sandbox_flash_priv *priv = dev_get_priv(dev);
+
+	debug("%s: dev=%s, pipe=%lx, stream=%u, len=%x\n", __func__,
+	      dev->name, pipe, stream, len);
+	if (!priv->streams)
+		return -EIO;
+
+	return sandbox_flash_uas_bulk(priv, usb_pipeendpoint(pipe), stream,
+				      buff, len);
+}
+
+int sandbox_flash_set_superspeed(struct udevice *dev)
+{
+	struct sandbox_flash_plat *plat = dev_get_plat(dev);
+
+	if (!plat->uas)
+		return -ENOSYS;
+	plat->superspeed = true;
+
+	return usb_emul_setup_device(dev, plat->flash_strings,
+				     flash_ss_desc_list);
+}
+
+int sandbox_flash_get_max_queued(struct udevice *dev)
+{
+	struct sandbox_flash_priv *priv = dev_get_priv(dev);
+
+	return priv->max_queued;
+}
+
 static int sandbox_flash_of_to_plat(struct udevice *dev)
 {
 	struct sandbox_flash_plat *plat = dev_get_plat(dev);
@@ -331,7 +717,12 @@ static int sandbox_flash_bind(struct udevice *dev)
 	fs[2].id = STRINGID_SERIAL;
 	fs[2].s = dev->name;
 
-	return usb_emul_setup_device(dev, plat->flash_strings, flash_desc_list);
+	/* This is needed before the descriptors are set up */
+	plat->uas = dev_read_bool(dev, "sandbox,uas");
+
+	return usb_emul_setup_device(dev, plat->flash_strings,
+				     plat->uas ? flash_uas_desc_list :
+				     flash_desc_list);
 }
 
 static int sandbox_flash_probe(struct udevice *dev)
@@ -370,6 +761,8 @@ static int sandbox_flash_remove(struct udevice *dev)
 static const struct dm_usb_ops sandbox_usb_flash_ops = {
 	.control	= sandbox_flash_control,
 	.bulk		= sandbox_flash_bulk,
+	.alloc_streams	= sandbox_flash_alloc_streams,
+	.bulk_stream	= sandbox_flash_bulk_stream,
 };
 
 static const struct udevice_id sandbox_usb_flash_ids[] = {
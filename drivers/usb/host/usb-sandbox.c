@@ -7,6 +7,7 @@
 #include <dm.h>
 #include <log.h>
 #include <usb.h>
+#include <asm/test.h>
 #include <dm/root.h>
 #include <linux/usb/gadget.h>
 
@@ -16,8 +17,15 @@ struct sandbox_udc {
 
 struct sandbox_udc *this_controller;
 
+/**
+ * struct sandbox_usb_ctrl - private state for the sandbox USB controller
+ *
+ * @rootdev: Address of the root hub
+ * @max_xfer_size: Largest bulk transfer accepted, in bytes, or 0 for no limit
+ */
 struct sandbox_usb_ctrl {
 	int rootdev;
+	size_t max_xfer_size;
 };
 
 static void usbmon_trace(struct udevice *bus, ulong pipe,
@@ -104,6 +112,86 @@ static int sandbox_submit_bulk(struct udevice *bus, struct usb_device *udev,
 	return ret;
 }
 
+static int sandbox_submit_bulk_queue(struct udevice *bus,
+				     struct usb_device *udev,
+				     unsigned long pipe,
+				     struct usb_bulk_xfer *xfers, int count,
+				     int timeout)
+{
+	struct udevice *emul;
+	int i, ret;
+
+	debug("%s: bus=%s, count=%d\n", __func__, bus->name, count);
+	ret = usb_emul_find(bus, pipe, udev->portnr, &emul);
+	usbmon_trace(bus, pipe, NULL, emul);
+	if (ret)
+		return ret;
+
+	/* The emulator completes each transfer at once, so never times out */
+	for (i = 0; i < count; i++) {
+		ret = usb_emul_bulk(emul, udev, pipe, xfers[i].data,
+				    xfers[i].len);
+		if (ret < 0) {
+			debug("ret=%d\n", ret);
+			xfers[i].status = ret;
+			udev->status = ret;
+			udev->act_len = 0;
+			break;
+		}
+		xfers[i].status = 0;
+		xfers[i].actual_length = ret;
+		udev->status = 0;
+		udev->act_len = ret;
+	}
+
+	return 0;
+}
+
+static int sandbox_alloc_streams(struct udevice *bus, struct usb_device *udev,
+				 unsigned long *pipes, int num_pipes,
+				 int num_streams)
+{
+	struct udevice *emul;
+	int ret;
+
+	debug("%s: bus=%s, num_streams=%d\n", __func__, bus->name,
+	      num_streams);
+	if (udev->speed < USB_SPEED_SUPER)
+		return -ENOSYS;
+	ret = usb_emul_find(bus, pipes[0], udev->portnr, &emul);
+	if (ret)
+		return ret;
+
+	return usb_emul_alloc_streams(emul, udev, pipes, num_pipes,
+				      num_streams);
+}
+
+static int sandbox_submit_bulk_stream(struct udevice *bus,
+				      struct usb_device *udev,
+				      unsigned long pipe, unsigned int stream,
+				      void *buffer, int length)
+{
+	struct udevice *emul;
+	int ret;
+
+	debug("%s: bus=%s, stream=%u\n", __func__, bus->name, stream);
+	ret = usb_emul_find(bus, pipe, udev->portnr, &emul);
+	usbmon_trace(bus, pipe, NULL, emul);
+	if (ret)
+		return ret;
+	ret = usb_emul_bulk_stream(emul, udev, pipe, stream, buffer, length);
+	if (ret < 0) {
+		debug("ret=%d\n", ret);
+		udev->status = ret;
+		udev->act_len = 0;
+	} else {
+		udev->status = 0;
+		udev->act_len = ret;
+	}
+
+	return ret;
+}
+
 static int sandbox_submit_int(struct udevice *bus, struct usb_device *udev,
 			      unsigned long pipe, void *buffer, int length,
 			      int interval, bool nonblock)
@@ -156,6 +244,24 @@ static int sandbox_alloc_device(struct udevice *dev, struct usb_device *udev)
 	return 0;
 }
 
+static int sandbox_get_max_xfer_size(struct udevice *dev, size_t *size)
+{
+	struct sandbox_usb_ctrl *ctrl = dev_get_priv(dev);
+
+	if (!ctrl->max_xfer_size)
+		return -ENOSYS;
+	*size = ctrl->max_xfer_size;
+
+	return 0;
+}
+
+void sandbox_usb_set_max_xfer_size(struct udevice *dev, size_t size)
+{
+	struct sandbox_usb_ctrl *ctrl = dev_get_priv(dev);
+
+	ctrl->max_xfer_size = size;
+}
+
 static int sandbox_usb_probe(struct udevice *dev)
 {
 	return 0;
@@ -164,8 +270,12 @@ static int sandbox_usb_probe(struct udevice *dev)
 static const struct dm_usb_ops sandbox_usb_ops = {
 	.control	= sandbox_submit_control,
 	.bulk		= sandbox_submit_bulk,
+	.bulk_queue	= sandbox_submit_bulk_queue,
 	.interrupt	= sandbox_submit_int,
 	.alloc_device	= sandbox_alloc_device,
+	.get_max_xfer_size = sandbox_get_max_xfer_size,
+	.alloc_streams	= sandbox_alloc_streams,
+	.bulk_stream	= sandbox_submit_bulk_stream,
 };
 
 static const struct udevice_id sandbox_usb_ids[] = {
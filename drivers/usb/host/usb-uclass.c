@@ -20,6 +20,21 @@
 
 static bool asynch_allowed;
 
+/**
+ * struct usb_init_state - progress of a USB scan started by usb_init_start()
+ *
+ * @controllers: number of controllers initialised by usb_init_start()
+ * @companions: true if the companion controllers are being scanned
+ * @busy: true if usb_init_start() has been called and the scan is not done
+ */
+struct usb_init_state {
+	int controllers;
+	bool companions;
+	bool busy;
+};
+
+static struct usb_init_state usb_init_state;
+
 struct usb_uclass_priv {
 	int companion_device_count;
 };
@@ -172,6 +187,42 @@ int usb_get_max_xfer_size(struct usb_device *udev, size_t *size)
 	return ops->get_max_xfer_size(bus, size);
 }
 
+int usb_alloc_streams(struct usb_device *udev, unsigned long *pipes,
+		      int num_pipes, int num_streams)
+{
+	struct udevice *bus = udev->controller_dev;
+	struct dm_usb_ops *ops = usb_get_ops(bus);
+
+	if (!ops->alloc_streams)
+		return -ENOSYS;
+
+	return ops->alloc_streams(bus, udev, pipes, num_pipes, num_streams);
+}
+
+int submit_bulk_stream_msg(struct usb_device *udev, unsigned long pipe,
+			   unsigned int stream, void *buffer, int length)
+{
+	struct udevice *bus = udev->controller_dev;
+	struct dm_usb_ops *ops = usb_get_ops(bus);
+
+	if (!ops->bulk_stream)
+		return -ENOSYS;
+
+	return ops->bulk_stream(bus, udev, pipe, stream, buffer, length);
+}
+
+int submit_bulk_queue(struct usb_device *udev, unsigned long pipe,
+		      struct usb_bulk_xfer *xfers, int count, int timeout)
+{
+	struct udevice *bus = udev->controller_dev;
+	struct dm_usb_ops *ops = usb_get_ops(bus);
+
+	if (!ops->bulk_queue)
+		return -ENOSYS;
+
+	return ops->bulk_queue(bus, udev, pipe, xfers, count, timeout);
+}
+
 int usb_stop(void)
 {
 	struct udevice *bus;
@@ -216,30 +267,61 @@ int usb_stop(void)
 			printf("failed to unhunt USB (err=%dE)\n", ret);
 	}
 	uc_priv->companion_device_count = 0;
+	usb_init_state.busy = false;
+	usb_hub_scan_defer(false);
 	usb_started = 0;
 
 	return err;
 }
 
-static void usb_scan_bus(struct udevice *bus, bool recurse)
+/* Set up the root hub of a bus, leaving its ports to usb_hub_scan_poll() */
+static void usb_scan_bus_start(struct udevice *bus)
 {
-	struct usb_bus_priv *priv;
+	struct usb_bus_priv *priv = dev_get_uclass_priv(bus);
 	struct udevice *dev;
-	int ret;
 
-	priv = dev_get_uclass_priv(bus);
+	debug("scanning bus %s\n", bus->name);
+	priv->scan_err = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
+}
+
+/* Start scanning the active primary or companion controllers */
+static void usb_scan_buses_start(struct uclass *uc, bool companions)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus;
+
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
 
-	assert(recurse);	/* TODO: Support non-recusive */
+		priv = dev_get_uclass_priv(bus);
+		if (priv->companion == companions)
+			usb_scan_bus_start(bus);
+	}
+}
 
-	printf("scanning bus %s for devices... ", bus->name);
-	debug("\n");
-	ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
-	if (ret)
-		printf("failed, error %d\n", ret);
-	else if (priv->next_addr == 0)
-		printf("No USB Device found\n");
-	else
-		printf("%d USB Device(s) found\n", priv->next_addr);
+/* Show the result of scanning the active primary or companion controllers */
+static void usb_show_buses(struct uclass *uc, bool companions)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus;
+
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
+
+		priv = dev_get_uclass_priv(bus);
+		if (priv->companion != companions)
+			continue;
+		printf("Bus %s: scanning bus %s for devices... ", bus->name,
+		       bus->name);
+		if (priv->scan_err)
+			printf("failed, error %d\n", priv->scan_err);
+		else if (priv->next_addr == 0)
+			printf("No USB Device found\n");
+		else
+			printf("%d USB Device(s) found\n", priv->next_addr);
+	}
 }
 
 static void remove_inactive_children(struct uclass *uc, struct udevice *bus)
@@ -280,18 +362,17 @@ static int usb_probe_companion(struct udevice *bus)
 		 * companion as an error. (It may not be enabled on boards
 		 * that have a High-Speed HUB to handle FS and LS traffic).
 		 */
-		printf("Failed to get companion (ret=%d)\n", ret);
+		printf("Bus %s: Failed to get companion (ret=%d)\n", bus->name,
+		       ret);
 		return ret;
 	}
 
 	return 0;
 }
 
-int usb_init(void)
+int usb_init_start(void)
 {
-	int controllers_initialized = 0;
-	struct usb_uclass_priv *uc_priv;
-	struct usb_bus_priv *priv;
+	struct usb_init_state *state = &usb_init_state;
 	struct udevice *bus;
 	struct uclass *uc;
 	int ret;
@@ -302,13 +383,12 @@ int usb_init(void)
 	if (ret)
 		return ret;
 
-	uc_priv = uclass_get_priv(uc);
-
+	memset(state, '\0', sizeof(*state));
 	uclass_foreach_dev(bus, uc) {
-		/* init low_level USB */
-		printf("Bus %s: ", bus->name);
-
 		/*
+		 * init low_level USB. The bus is shown once it has been
+		 * scanned, so only show problems here.
+		 *
 		 * For Sandbox, we need scan the device tree each time when we
 		 * start the USB stack, in order to re-create the emulated USB
 		 * devices and bind drivers for them before we actually do the
@@ -321,20 +401,22 @@ int usb_init(void)
 		    IS_ENABLED(CONFIG_USB_ONBOARD_HUB)) {
 			ret = dm_scan_fdt_dev(bus);
 			if (ret) {
-				printf("USB device scan from fdt failed (%d)", ret);
+				printf("Bus %s: USB device scan from fdt failed (%d)\n",
+				       bus->name, ret);
 				continue;
 			}
 		}
 
 		ret = device_probe(bus);
 		if (ret == -ENODEV) {	/* No such device. */
-			puts("Port not available.\n");
-			controllers_initialized++;
+			printf("Bus %s: Port not available.\n", bus->name);
+			state->controllers++;
 			continue;
 		}
 
 		if (ret) {		/* Other error. */
-			printf("probe failed, error %d\n", ret);
+			printf("Bus %s: probe failed, error %d\n", bus->name,
+			       ret);
 			continue;
 		}
 
@@ -342,40 +424,61 @@ int usb_init(void)
 		if (ret)
 			continue;
 
-		controllers_initialized++;
+		state->controllers++;
 		usb_started = true;
 	}
 
 	/*
-	 * lowlevel init done, now scan the bus for devices i.e. search HUBs
-	 * and configure them, first scan primary controllers.
+	 * lowlevel init done, now set up the root hubs of the primary
+	 * controllers, which powers their ports. The ports are scanned by
+	 * usb_init_poll(), once they are ready.
 	 */
-	uclass_foreach_dev(bus, uc) {
-		if (!device_active(bus))
-			continue;
+	usb_hub_scan_defer(true);
+	usb_scan_buses_start(uc, false);
+	state->busy = true;
 
-		priv = dev_get_uclass_priv(bus);
-		if (!priv->companion)
-			usb_scan_bus(bus, true);
-	}
+	return 0;
+}
+
+int usb_init_poll(void)
+{
+	struct usb_init_state *state = &usb_init_state;
+	struct usb_uclass_priv *uc_priv;
+	struct udevice *bus = NULL;
+	struct uclass *uc;
+	int ret;
+
+	if (!state->busy)
+		return usb_started ? 0 : -ENOENT;
+
+	ret = usb_hub_scan_poll();
+	if (ret == -EAGAIN)
+		return -EAGAIN;
+	if (ret)
+		debug("hub scan failed (err=%d)\n", ret);
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		return ret;
+	uc_priv = uclass_get_priv(uc);
 
 	/*
 	 * Now that the primary controllers have been scanned and have handed
 	 * over any devices they do not understand to their companions, scan
 	 * the companions if necessary.
 	 */
-	if (uc_priv->companion_device_count) {
-		uclass_foreach_dev(bus, uc) {
-			if (!device_active(bus))
-				continue;
-
-			priv = dev_get_uclass_priv(bus);
-			if (priv->companion)
-				usb_scan_bus(bus, true);
-		}
+	if (!state->companions && uc_priv->companion_device_count) {
+		state->companions = true;
+		usb_scan_buses_start(uc, true);
+		return -EAGAIN;
 	}
 
 	debug("scan end\n");
+	usb_hub_scan_defer(false);
+	state->busy = false;
+	usb_show_buses(uc, false);
+	if (state->companions)
+		usb_show_buses(uc, true);
 
 	/* Remove any devices that were not found on this scan */
 	remove_inactive_children(uc, bus);
@@ -386,12 +489,26 @@ int usb_init(void)
 	remove_inactive_children(uc, bus);
 
 	/* if we were not able to find at least one working bus, bail out */
-	if (controllers_initialized == 0)
+	if (state->controllers == 0)
 		printf("No USB controllers found\n");
 
 	return usb_started ? 0 : -ENOENT;
 }
 
+int usb_init(void)
+{
+	int ret;
+
+	ret = usb_init_start();
+	if (ret)
+		return ret;
+	do {
+		ret = usb_init_poll();
+	} while (ret == -EAGAIN);
+
+	return ret;
+}
+
 int usb_setup_ehci_gadget(struct ehci_ctrl **ctlrp)
 {
 	struct usb_plat *plat;
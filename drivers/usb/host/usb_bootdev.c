@@ -19,12 +19,25 @@ static int usb_bootdev_bind(struct udevice *dev)
 	return 0;
 }
 
-static int usb_bootdev_hunt(struct bootdev_hunter *info, bool show)
+static int usb_bootdev_start(struct bootdev_hunter *info, bool show)
 {
 	if (usb_started)
 		return 0;
+	if (!CONFIG_IS_ENABLED(DM_USB)) {
+		/* This cannot be polled, so scan now and report it when polled */
+		usb_init();
+		return 0;
+	}
+
+	return usb_init_start();
+}
+
+static int usb_bootdev_poll(struct bootdev_hunter *info, bool show)
+{
+	if (!CONFIG_IS_ENABLED(DM_USB))
+		return usb_started ? 0 : -ENOENT;
 
-	return usb_init();
+	return usb_init_poll();
 }
 
 struct bootdev_ops usb_bootdev_ops = {
@@ -46,6 +59,7 @@ U_BOOT_DRIVER(usb_bootdev) = {
 BOOTDEV_HUNTER(usb_bootdev_hunter) = {
 	.prio		= BOOTDEVP_5_SCAN_SLOW,
 	.uclass		= UCLASS_USB,
-	.hunt		= usb_bootdev_hunt,
+	.start		= usb_bootdev_start,
+	.poll		= usb_bootdev_poll,
 	.drv		= DM_DRIVER_REF(usb_bootdev),
 };
@@ -22,6 +22,7 @@
 #include <asm/cache.h>
 #include <linux/bug.h>
 #include <linux/errno.h>
+#include <linux/log2.h>
 
 #include <usb/xhci.h>
 
@@ -137,6 +138,33 @@ static void xhci_free_container_ctx(struct xhci_ctrl *ctrl,
 	free(ctx);
 }
 
+/**
+ * Free the stream context array and stream rings of an endpoint
+ *
+ * @ctrl	host controller data structure
+ * @ep		endpoint whose streams are to be freed
+ * Return:	none
+ */
+void xhci_free_stream_info(struct xhci_ctrl *ctrl, struct xhci_virt_ep *ep)
+{
+	unsigned int num_ctxs = roundup_pow_of_two(ep->num_streams + 1);
+	unsigned int i;
+
+	if (!ep->stream_ctx)
+		return;
+
+	for (i = 1; i <= ep->num_streams; i++)
+		xhci_ring_free(ctrl, ep->stream_rings[i]);
+	xhci_dma_unmap(ctrl, ep->stream_ctx_dma,
+		       num_ctxs * sizeof(struct xhci_stream_ctx));
+	free(ep->stream_ctx);
+	free(ep->stream_rings);
+	ep->stream_ctx = NULL;
+	ep->stream_rings = NULL;
+	ep->num_streams = 0;
+	ep->ep_state &= ~EP_HAS_STREAMS;
+}
+
 /**
  * frees the virtual devices for "xhci_ctrl" pointer passed
  *
@@ -160,9 +188,11 @@ static void xhci_free_virt_devices(struct xhci_ctrl *ctrl)
 
 		ctrl->dcbaa->dev_context_ptrs[slot_id] = 0;
 
-		for (i = 0; i < 31; ++i)
+		for (i = 0; i < 31; ++i) {
+			xhci_free_stream_info(ctrl, &virt_dev->eps[i]);
 			if (virt_dev->eps[i].ring)
 				xhci_ring_free(ctrl, virt_dev->eps[i].ring);
+		}
 
 		if (virt_dev->in_ctx)
 			xhci_free_container_ctx(ctrl, virt_dev->in_ctx);
@@ -513,6 +543,46 @@ int xhci_alloc_virt_device(struct xhci_ctrl *ctrl, unsigned int slot_id)
 	return 0;
 }
 
+/**
+ * Allocate a linear stream context array and a transfer ring for each stream
+ * of an endpoint. The array holds a power-of-two number of contexts, of which
+ * the first is reserved (stream ID 0).
+ *
+ * @ctrl	host controller data structure
+ * @ep		endpoint to set up
+ * @num_streams	number of streams to allocate
+ * Return:	0 on success, -ENOMEM if out of memory
+ */
+int xhci_alloc_stream_info(struct xhci_ctrl *ctrl, struct xhci_virt_ep *ep,
+			   unsigned int num_streams)
+{
+	unsigned int num_ctxs = roundup_pow_of_two(num_streams + 1);
+	size_t size = num_ctxs * sizeof(struct xhci_stream_ctx);
+	struct xhci_ring *ring;
+	unsigned int i;
+	u64 deq;
+
+	ep->stream_rings = calloc(num_ctxs, sizeof(struct xhci_ring *));
+	if (!ep->stream_rings)
+		return -ENOMEM;
+	ep->stream_ctx = xhci_malloc(size);
+
+	for (i = 1; i <= num_streams; i++) {
+		ring = xhci_ring_alloc(ctrl, 1, true);
+		ep->stream_rings[i] = ring;
+		deq = xhci_trb_virt_to_dma(ring->enq_seg, ring->enqueue);
+		ep->stream_ctx[i].stream_ring =
+			cpu_to_le64(deq | SCT_FOR_CTX(SCT_PRI_TR) |
+				    ring->cycle_state);
+	}
+	ep->num_streams = num_streams;
+
+	xhci_flush_cache((uintptr_t)ep->stream_ctx, size);
+	ep->stream_ctx_dma = xhci_dma_map(ctrl, ep->stream_ctx, size);
+
+	return 0;
+}
+
 /**
  * Allocates the necessary data structures
  * for XHCI host controller
@@ -286,13 +286,14 @@ static int prepare_ring(struct xhci_ctrl *ctrl, struct xhci_ring *ep_ring,
  *
  * @param ctrl		Host controller data structure
  * @param ptr		Pointer address to write in the first two fields (opt.)
+ * @param field2	Value for the third field, e.g. the stream ID (opt.)
  * @param slot_id	Slot ID to encode in the flags field (opt.)
  * @param ep_index	Endpoint index to encode in the flags field (opt.)
  * @param cmd		Command type to enqueue
  * Return: none
  */
-void xhci_queue_command(struct xhci_ctrl *ctrl, dma_addr_t addr, u32 slot_id,
-			u32 ep_index, trb_type cmd)
+static void queue_command(struct xhci_ctrl *ctrl, dma_addr_t addr, u32 field2,
+			  u32 slot_id, u32 ep_index, trb_type cmd)
 {
 	u32 fields[4];
 
@@ -300,7 +301,7 @@ void xhci_queue_command(struct xhci_ctrl *ctrl, dma_addr_t addr, u32 slot_id,
 
 	fields[0] = lower_32_bits(addr);
 	fields[1] = upper_32_bits(addr);
-	fields[2] = 0;
+	fields[2] = field2;
 	fields[3] = TRB_TYPE(cmd) | SLOT_ID_FOR_TRB(slot_id) |
 		    ctrl->cmd_ring->cycle_state;
 
@@ -317,6 +318,22 @@ void xhci_queue_command(struct xhci_ctrl *ctrl, dma_addr_t addr, u32 slot_id,
 	xhci_writel(&ctrl->dba->doorbell[0], DB_VALUE_HOST);
 }
 
+/**
+ * Queue a command TRB on the command ring, see queue_command()
+ *
+ * @param ctrl		Host controller data structure
+ * @param ptr		Pointer address to write in the first two fields (opt.)
+ * @param slot_id	Slot ID to encode in the flags field (opt.)
+ * @param ep_index	Endpoint index to encode in the flags field (opt.)
+ * @param cmd		Command type to enqueue
+ * Return: none
+ */
+void xhci_queue_command(struct xhci_ctrl *ctrl, dma_addr_t addr, u32 slot_id,
+			u32 ep_index, trb_type cmd)
+{
+	queue_command(ctrl, addr, 0, slot_id, ep_index, cmd);
+}
+
 /*
  * For xHCI 1.0 host controllers, TD size is the number of max packet sized
  * packets remaining in the TD (*not* including this TRB).
@@ -375,12 +392,13 @@ static u32 xhci_td_remainder(struct xhci_ctrl *ctrl, int transferred,
  *
  * @param udev		pointer to the USB device structure
  * @param ep_index	index of the endpoint
+ * @param stream	stream ID, or 0 if the endpoint has no streams
  * @param start_cycle	cycle flag of the first TRB
  * @param start_trb	pionter to the first TRB
  * Return: none
  */
 static void giveback_first_trb(struct usb_device *udev, int ep_index,
-				int start_cycle,
+				unsigned int stream, int start_cycle,
 				struct xhci_generic_trb *start_trb)
 {
 	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
@@ -398,7 +416,7 @@ static void giveback_first_trb(struct usb_device *udev, int ep_index,
 
 	/* Ringing EP doorbell here */
 	xhci_writel(&ctrl->dba->doorbell[udev->slot_id],
-				DB_VALUE(ep_index, 0));
+				DB_VALUE(ep_index, stream));
 
 	return;
 }
@@ -450,15 +468,18 @@ static int event_ready(struct xhci_ctrl *ctrl)
 }
 
 /**
- * Waits for a specific type of event and returns it. Discards unexpected
- * events. Caller *must* call xhci_acknowledge_event() after it is finished
- * processing the event, and must not access the returned pointer afterwards.
+ * Waits for a specific type of event and returns it, giving up after the
+ * timeout. Discards unexpected events. Caller *must* call
+ * xhci_acknowledge_event() after it is finished processing the event, and
+ * must not access the returned pointer afterwards.
  *
  * @param ctrl		Host controller data structure
  * @param expected	TRB type expected from Event TRB
- * Return: pointer to event trb
+ * @param timeout	timeout in milliseconds
+ * Return: pointer to event trb, or NULL on timeout
  */
-union xhci_trb *xhci_wait_for_event(struct xhci_ctrl *ctrl, trb_type expected)
+static union xhci_trb *wait_for_event_timeout(struct xhci_ctrl *ctrl,
+					      trb_type expected, int timeout)
 {
 	trb_type type;
 	unsigned long ts = get_timer(0);
@@ -492,7 +513,7 @@ union xhci_trb *xhci_wait_for_event(struct xhci_ctrl *ctrl, trb_type expected)
 				le32_to_cpu(event->generic.field[3]));
 
 		xhci_acknowledge_event(ctrl);
-	} while (get_timer(ts) < XHCI_TIMEOUT);
+	} while (get_timer(ts) < timeout);
 
 	if (expected == TRB_TRANSFER)
 		return NULL;
@@ -502,16 +523,73 @@ union xhci_trb *xhci_wait_for_event(struct xhci_ctrl *ctrl, trb_type expected)
 	return NULL;
 }
 
+/**
+ * Waits for a specific type of event and returns it. Discards unexpected
+ * events. Caller *must* call xhci_acknowledge_event() after it is finished
+ * processing the event, and must not access the returned pointer afterwards.
+ *
+ * @param ctrl		Host controller data structure
+ * @param expected	TRB type expected from Event TRB
+ * Return: pointer to event trb
+ */
+union xhci_trb *xhci_wait_for_event(struct xhci_ctrl *ctrl, trb_type expected)
+{
+	return wait_for_event_timeout(ctrl, expected, XHCI_TIMEOUT);
+}
+
+/*
+ * Get the transfer ring of an endpoint, or of one of its streams. Once an
+ * endpoint has streams, only stream IDs 1 and up can be used.
+ */
+static struct xhci_ring *get_ep_ring(struct xhci_virt_device *virt_dev,
+				     int ep_index, unsigned int stream)
+{
+	struct xhci_virt_ep *ep = &virt_dev->eps[ep_index];
+
+	if (!(ep->ep_state & EP_HAS_STREAMS))
+		return stream ? NULL : ep->ring;
+	if (!stream || stream > ep->num_streams)
+		return NULL;
+
+	return ep->stream_rings[stream];
+}
+
+/*
+ * Send a set TR dequeue pointer command, moving the xHC's dequeue pointer for
+ * an endpoint (or one of its streams) to our enqueue pointer.
+ */
+static void set_deq(struct usb_device *udev, int ep_index, unsigned int stream,
+		    struct xhci_ring *ring)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	union xhci_trb *event;
+	u64 addr;
+
+	addr = xhci_trb_virt_to_dma(ring->enq_seg,
+		(void *)((uintptr_t)ring->enqueue | ring->cycle_state));
+	if (stream)
+		addr |= SCT_FOR_CTX(SCT_PRI_TR);
+	queue_command(ctrl, addr, STREAM_ID_FOR_TRB(stream), udev->slot_id,
+		      ep_index, TRB_SET_DEQ);
+	event = xhci_wait_for_event(ctrl, TRB_COMPLETION);
+	if (!event)
+		return;
+
+	BUG_ON(TRB_TO_SLOT_ID(le32_to_cpu(event->event_cmd.flags)) != udev->slot_id ||
+	       GET_COMP_CODE(le32_to_cpu(event->event_cmd.status)) != COMP_SUCCESS);
+	xhci_acknowledge_event(ctrl);
+}
+
 /*
  * Send reset endpoint command for given endpoint. This recovers from a
  * halted endpoint (e.g. due to a stall error).
  */
-static void reset_ep(struct usb_device *udev, int ep_index)
+static void reset_ep(struct usb_device *udev, int ep_index, unsigned int stream)
 {
 	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
-	struct xhci_ring *ring =  ctrl->devs[udev->slot_id]->eps[ep_index].ring;
+	struct xhci_ring *ring = get_ep_ring(ctrl->devs[udev->slot_id],
+					     ep_index, stream);
 	union xhci_trb *event;
-	u64 addr;
 	u32 field;
 
 	printf("Resetting EP %d...\n", ep_index);
@@ -524,16 +602,8 @@ static void reset_ep(struct usb_device *udev, int ep_index)
 	BUG_ON(TRB_TO_SLOT_ID(field) != udev->slot_id);
 	xhci_acknowledge_event(ctrl);
 
-	addr = xhci_trb_virt_to_dma(ring->enq_seg,
-		(void *)((uintptr_t)ring->enqueue | ring->cycle_state));
-	xhci_queue_command(ctrl, addr, udev->slot_id, ep_index, TRB_SET_DEQ);
-	event = xhci_wait_for_event(ctrl, TRB_COMPLETION);
-	if (!event)
-		return;
-
-	BUG_ON(TRB_TO_SLOT_ID(le32_to_cpu(event->event_cmd.flags)) != udev->slot_id ||
-	       GET_COMP_CODE(le32_to_cpu(event->event_cmd.status)) != COMP_SUCCESS);
-	xhci_acknowledge_event(ctrl);
+	if (ring)
+		set_deq(udev, ep_index, stream, ring);
 }
 
 /*
@@ -544,14 +614,15 @@ static void reset_ep(struct usb_device *udev, int ep_index)
  * (Careful: This will BUG() when there was no transfer in progress. Shouldn't
  * happen in practice for current uses and is too complicated to fix right now.)
  */
-static void abort_td(struct usb_device *udev, int ep_index)
+static void abort_td(struct usb_device *udev, int ep_index,
+		     unsigned int stream)
 {
 	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
-	struct xhci_ring *ring =  ctrl->devs[udev->slot_id]->eps[ep_index].ring;
+	struct xhci_ring *ring = get_ep_ring(ctrl->devs[udev->slot_id],
+					     ep_index, stream);
 	union xhci_trb *event;
 	xhci_comp_code comp;
 	trb_type type;
-	u64 addr;
 	u32 field;
 
 	xhci_queue_command(ctrl, 0, udev->slot_id, ep_index, TRB_STOP_RING);
@@ -583,16 +654,7 @@ static void abort_td(struct usb_device *udev, int ep_index)
 		(comp != COMP_SUCCESS && comp != COMP_CTX_STATE));
 	xhci_acknowledge_event(ctrl);
 
-	addr = xhci_trb_virt_to_dma(ring->enq_seg,
-		(void *)((uintptr_t)ring->enqueue | ring->cycle_state));
-	xhci_queue_command(ctrl, addr, udev->slot_id, ep_index, TRB_SET_DEQ);
-	event = xhci_wait_for_event(ctrl, TRB_COMPLETION);
-	if (!event)
-		return;
-
-	BUG_ON(TRB_TO_SLOT_ID(le32_to_cpu(event->event_cmd.flags)) != udev->slot_id ||
-	       GET_COMP_CODE(le32_to_cpu(event->event_cmd.status)) != COMP_SUCCESS);
-	xhci_acknowledge_event(ctrl);
+	set_deq(udev, ep_index, stream, ring);
 }
 
 static void record_transfer_result(struct usb_device *udev,
@@ -624,75 +686,32 @@ static void record_transfer_result(struct usb_device *udev,
 }
 
 /**** Bulk and Control transfer methods ****/
+/*
+ * Up to this many TRBs are queued on an endpoint ring at once. The ring is a
+ * single segment whose last TRB is a link TRB, and one more TRB is kept free
+ * so that the enqueue pointer never catches up with the dequeue pointer.
+ */
+#define XHCI_BULK_MAX_TRBS	(TRBS_PER_SEGMENT - 2)
+
 /**
- * Queues up the BULK Request
+ * Works out how many TRBs are needed for a bulk TD
  *
- * @param udev		pointer to the USB device structure
- * @param pipe		contains the DIR_IN or OUT , devnum
+ * XHCI Spec puts restriction( TABLE 49 and 6.4.1 section of XHCI Spec)
+ * that the buffer should not span 64KB boundary. if so
+ * we send request in more than 1 TRB by chaining them.
+ *
+ * @param buf_64	DMA address of the buffer
  * @param length	length of the buffer
- * @param buffer	buffer to be read/written based on the request
- * Return: returns 0 if successful else -1 on failure
+ * Return: number of TRBs
  */
-int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
-			int length, void *buffer)
+static int bulk_td_trbs(u64 buf_64, int length)
 {
 	int num_trbs = 0;
-	struct xhci_generic_trb *start_trb;
-	bool first_trb = false;
-	int start_cycle;
-	u32 field = 0;
-	u32 length_field = 0;
-	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
-	int slot_id = udev->slot_id;
-	int ep_index;
-	struct xhci_virt_device *virt_dev;
-	struct xhci_ep_ctx *ep_ctx;
-	struct xhci_ring *ring;		/* EP transfer ring */
-	union xhci_trb *event;
-
-	int running_total, trb_buff_len;
-	bool more_trbs_coming = true;
-	int maxpacketsize;
-	u64 addr;
-	int ret;
-	u32 trb_fields[4];
-	u64 buf_64 = xhci_dma_map(ctrl, buffer, length);
-	dma_addr_t last_transfer_trb_addr;
-	int available_length;
-
-	debug("dev=%p, pipe=%lx, buffer=%p, length=%d\n",
-		udev, pipe, buffer, length);
-
-	available_length = length;
-	ep_index = usb_pipe_ep_index(pipe);
-	virt_dev = ctrl->devs[slot_id];
-
-	xhci_inval_cache((uintptr_t)virt_dev->out_ctx->bytes,
-			 virt_dev->out_ctx->size);
+	int running_total;
 
-	ep_ctx = xhci_get_ep_ctx(ctrl, virt_dev->out_ctx, ep_index);
-
-	/*
-	 * If the endpoint was halted due to a prior error, resume it before
-	 * the next transfer. It is the responsibility of the upper layer to
-	 * have dealt with whatever caused the error.
-	 */
-	if ((le32_to_cpu(ep_ctx->ep_info) & EP_STATE_MASK) == EP_STATE_HALTED)
-		reset_ep(udev, ep_index);
-
-	ring = virt_dev->eps[ep_index].ring;
-	if (!ring)
-		return -EINVAL;
-
-	/*
-	 * How much data is (potentially) left before the 64KB boundary?
-	 * XHCI Spec puts restriction( TABLE 49 and 6.4.1 section of XHCI Spec)
-	 * that the buffer should not span 64KB boundary. if so
-	 * we send request in more than 1 TRB by chaining them.
-	 */
+	/* How much data is (potentially) left before the 64KB boundary? */
 	running_total = TRB_MAX_BUFF_SIZE -
 			(lower_32_bits(buf_64) & (TRB_MAX_BUFF_SIZE - 1));
-	trb_buff_len = running_total;
 	running_total &= TRB_MAX_BUFF_SIZE - 1;
 
 	/*
@@ -708,44 +727,59 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 		running_total += TRB_MAX_BUFF_SIZE;
 	}
 
-	/*
-	 * XXX: Calling routine prepare_ring() called in place of
-	 * prepare_trasfer() as there in 'Linux' since we are not
-	 * maintaining multiple TDs/transfer at the same time.
-	 */
-	ret = prepare_ring(ctrl, ring,
-			   le32_to_cpu(ep_ctx->ep_info) & EP_STATE_MASK);
-	if (ret < 0)
-		return ret;
+	return num_trbs;
+}
 
-	/*
-	 * Don't give the first TRB to the hardware (by toggling the cycle bit)
-	 * until we've finished creating all the other TRBs.  The ring's cycle
-	 * state may change as we enqueue the other TRBs, so save it too.
-	 */
-	start_trb = &ring->enqueue->generic;
-	start_cycle = ring->cycle_state;
+/**
+ * Queues the TRBs for one bulk TD on an endpoint ring
+ *
+ * If @hold is true the first TRB is not given to the hardware (by toggling
+ * the cycle bit) until giveback_first_trb() is called, so that all the TDs
+ * in a batch can be created first. The ring's cycle state may change as we
+ * enqueue the other TRBs, so it is returned too.
+ *
+ * @param udev		pointer to the USB device structure
+ * @param pipe		contains the DIR_IN or OUT , devnum
+ * @param ring		endpoint ring to use
+ * @param length	length of the buffer
+ * @param buf_64	DMA address of the buffer
+ * @param hold		true to hold back the first TRB of the TD
+ * @param start_trb	returns the first TRB, if @hold is true
+ * @param start_cycle	returns the cycle state of the first TRB
+ * Return: DMA address of the last TRB of the TD
+ */
+static dma_addr_t queue_bulk_td(struct usb_device *udev, unsigned long pipe,
+				struct xhci_ring *ring, int length, u64 buf_64,
+				bool hold, struct xhci_generic_trb **start_trb,
+				int *start_cycle)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	int num_trbs = bulk_td_trbs(buf_64, length);
+	bool more_trbs_coming = true;
+	dma_addr_t last_transfer_trb_addr;
+	int running_total, trb_buff_len;
+	bool first_trb = hold;
+	u32 length_field;
+	u32 trb_fields[4];
+	int maxpacketsize;
+	u32 field;
+	u64 addr;
+
+	if (hold) {
+		*start_trb = &ring->enqueue->generic;
+		*start_cycle = ring->cycle_state;
+	}
 
 	running_total = 0;
 	maxpacketsize = usb_maxpacket(udev, pipe);
 
 	/* How much data is in the first TRB? */
-	/*
-	 * How much data is (potentially) left before the 64KB boundary?
-	 * XHCI Spec puts restriction( TABLE 49 and 6.4.1 section of XHCI Spec)
-	 * that the buffer should not span 64KB boundary. if so
-	 * we send request in more than 1 TRB by chaining them.
-	 */
 	addr = buf_64;
-
+	trb_buff_len = TRB_MAX_BUFF_SIZE -
+		       (lower_32_bits(buf_64) & (TRB_MAX_BUFF_SIZE - 1));
 	if (trb_buff_len > length)
 		trb_buff_len = length;
 
-	first_trb = true;
-
-	/* flush the buffer before use */
-	xhci_flush_cache((uintptr_t)buffer, length);
-
 	/* Queue the first TRB, even if it's zero-length */
 	do {
 		u32 remainder = 0;
@@ -753,7 +787,7 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 		/* Don't change the cycle bit of the first TRB until later */
 		if (first_trb) {
 			first_trb = false;
-			if (start_cycle == 0)
+			if (*start_cycle == 0)
 				field |= TRB_CYCLE;
 		} else {
 			field |= ring->cycle_state;
@@ -801,20 +835,42 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 		schedule();
 	} while (running_total < length);
 
-	giveback_first_trb(udev, ep_index, start_cycle, start_trb);
+	return last_transfer_trb_addr;
+}
+
+/**
+ * Waits for a bulk TD to complete and records its result
+ *
+ * @param udev		pointer to the USB device structure
+ * @param ep_index	index of the endpoint
+ * @param stream	stream ID, or 0 if the endpoint has no streams
+ * @param xfer		transfer to update
+ * @param last_trb	DMA address of the last TRB of the TD
+ * Return: 0 if the TD completed (perhaps with an error), -ETIMEDOUT if it
+ *	   was aborted
+ */
+static int reap_bulk_td(struct usb_device *udev, int ep_index,
+			unsigned int stream, struct usb_bulk_xfer *xfer,
+			dma_addr_t last_trb, int timeout)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	int available_length = xfer->len;
+	union xhci_trb *event;
+	u32 field;
 
 again:
-	event = xhci_wait_for_event(ctrl, TRB_TRANSFER);
+	event = wait_for_event_timeout(ctrl, TRB_TRANSFER, timeout);
 	if (!event) {
 		debug("XHCI bulk transfer timed out, aborting...\n");
-		abort_td(udev, ep_index);
+		abort_td(udev, ep_index, stream);
 		udev->status = USB_ST_NAK_REC;  /* closest thing to a timeout */
 		udev->act_len = 0;
+		xfer->status = udev->status;
 		return -ETIMEDOUT;
 	}
 
 	if ((uintptr_t)(le64_to_cpu(event->trans_event.buffer)) !=
-	    (uintptr_t)last_transfer_trb_addr) {
+	    (uintptr_t)last_trb) {
 		available_length -=
 			(int)EVENT_TRB_LEN(le32_to_cpu(event->trans_event.transfer_len));
 		xhci_acknowledge_event(ctrl);
@@ -822,17 +878,170 @@ again:
 	}
 
 	field = le32_to_cpu(event->trans_event.flags);
-	BUG_ON(TRB_TO_SLOT_ID(field) != slot_id);
+	BUG_ON(TRB_TO_SLOT_ID(field) != udev->slot_id);
 	BUG_ON(TRB_TO_EP_INDEX(field) != ep_index);
 
 	record_transfer_result(udev, event, available_length);
 	xhci_acknowledge_event(ctrl);
-	xhci_inval_cache((uintptr_t)buffer, length);
-	xhci_dma_unmap(ctrl, buf_64, length);
+	xfer->actual_length = udev->act_len;
+	xfer->status = udev->status;
+
+	return 0;
+}
+
+static bool ep_halted(struct xhci_ctrl *ctrl, struct xhci_virt_device *virt_dev,
+		      int ep_index)
+{
+	struct xhci_ep_ctx *ep_ctx;
+
+	xhci_inval_cache((uintptr_t)virt_dev->out_ctx->bytes,
+			 virt_dev->out_ctx->size);
+	ep_ctx = xhci_get_ep_ctx(ctrl, virt_dev->out_ctx, ep_index);
+
+	return (le32_to_cpu(ep_ctx->ep_info) & EP_STATE_MASK) ==
+		EP_STATE_HALTED;
+}
+
+/**
+ * Queues up several BULK Requests on one endpoint
+ *
+ * As many TDs as fit in the endpoint ring are queued before the doorbell is
+ * rung, so the controller moves from one to the next without waiting for
+ * software. Completions are reaped in order. Processing stops at the first
+ * TD which halts the endpoint; the TDs after it are thrown away when the
+ * endpoint is next reset.
+ *
+ * @param udev		pointer to the USB device structure
+ * @param pipe		contains the DIR_IN or OUT , devnum
+ * @param stream	stream ID, or 0 if the endpoint has no streams
+ * @param xfers		transfers to make, updated with their results
+ * @param count		number of transfers (at most USB_BULK_QUEUE_MAX)
+ * @param timeout	time to wait for each transfer to complete, in ms
+ * Return: returns 0 if the transfers were attempted else -ve error; the
+ *	   result of each one is in @xfers
+ */
+int xhci_bulk_queue(struct usb_device *udev, unsigned long pipe,
+		    unsigned int stream, struct usb_bulk_xfer *xfers,
+		    int count, int timeout)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	int slot_id = udev->slot_id;
+	dma_addr_t last_trb[USB_BULK_QUEUE_MAX];
+	u64 buf_64[USB_BULK_QUEUE_MAX];
+	struct xhci_generic_trb *start_trb;
+	struct xhci_virt_device *virt_dev;
+	struct xhci_ep_ctx *ep_ctx;
+	struct xhci_ring *ring;		/* EP transfer ring */
+	int first, last, i, trbs, n;
+	struct usb_bulk_xfer *fail;
+	int ep_index;
+	int start_cycle;
+	int ret;
+
+	debug("dev=%p, pipe=%lx, count=%d\n", udev, pipe, count);
+
+	if (count < 1 || count > USB_BULK_QUEUE_MAX)
+		return -EINVAL;
+	ep_index = usb_pipe_ep_index(pipe);
+	virt_dev = ctrl->devs[slot_id];
+
+	/*
+	 * If the endpoint was halted due to a prior error, resume it before
+	 * the next transfer. It is the responsibility of the upper layer to
+	 * have dealt with whatever caused the error.
+	 */
+	if (ep_halted(ctrl, virt_dev, ep_index))
+		reset_ep(udev, ep_index, stream);
+
+	ring = get_ep_ring(virt_dev, ep_index, stream);
+	if (!ring)
+		return -EINVAL;
+
+	ep_ctx = xhci_get_ep_ctx(ctrl, virt_dev->out_ctx, ep_index);
+	ret = prepare_ring(ctrl, ring,
+			   le32_to_cpu(ep_ctx->ep_info) & EP_STATE_MASK);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		xfers[i].actual_length = 0;
+		xfers[i].status = USB_ST_NOT_PROC;
+		buf_64[i] = xhci_dma_map(ctrl, xfers[i].data, xfers[i].len);
+		/* flush the buffer before use */
+		xhci_flush_cache((uintptr_t)xfers[i].data, xfers[i].len);
+	}
+
+	fail = NULL;
+	for (first = 0; first < count && !fail && !ret; first = last) {
+		/* Queue as many TDs as fit in the ring */
+		for (last = first, trbs = 0; last < count; last++) {
+			n = bulk_td_trbs(buf_64[last], xfers[last].len);
+			if (last > first && trbs + n > XHCI_BULK_MAX_TRBS)
+				break;
+			trbs += n;
+		}
+		for (i = first; i < last; i++)
+			last_trb[i] = queue_bulk_td(udev, pipe, ring,
+						    xfers[i].len, buf_64[i],
+						    i == first, &start_trb,
+						    &start_cycle);
+		giveback_first_trb(udev, ep_index, stream, start_cycle,
+				   start_trb);
+
+		/*
+		 * A TD which fails without halting the endpoint does not stop
+		 * the ones after it, so they must still be reaped
+		 */
+		for (i = first; i < last; i++) {
+			ret = reap_bulk_td(udev, ep_index, stream, &xfers[i],
+					   last_trb[i], timeout);
+			if (ret)
+				break;
+			if (xfers[i].status && !fail)
+				fail = &xfers[i];
+			if (xfers[i].status && ep_halted(ctrl, virt_dev,
+							 ep_index))
+				break;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		xhci_inval_cache((uintptr_t)xfers[i].data, xfers[i].len);
+		xhci_dma_unmap(ctrl, buf_64[i], xfers[i].len);
+	}
+	if (ret)
+		return ret;
+
+	/* Report the first failure, as a single transfer would */
+	if (fail) {
+		udev->status = fail->status;
+		udev->act_len = fail->actual_length;
+	}
 
 	return (udev->status != USB_ST_NOT_PROC) ? 0 : -1;
 }
 
+/**
+ * Queues up the BULK Request
+ *
+ * @param udev		pointer to the USB device structure
+ * @param pipe		contains the DIR_IN or OUT , devnum
+ * @param stream	stream ID, or 0 if the endpoint has no streams
+ * @param length	length of the buffer
+ * @param buffer	buffer to be read/written based on the request
+ * Return: returns 0 if successful else -1 on failure
+ */
+int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
+		 unsigned int stream, int length, void *buffer)
+{
+	struct usb_bulk_xfer xfer = {
+		.data = buffer,
+		.len = length,
+	};
+
+	return xhci_bulk_queue(udev, pipe, stream, &xfer, 1, XHCI_TIMEOUT);
+}
+
 /**
  * Queues up the Control Transfer Request
  *
@@ -1006,7 +1215,7 @@ int xhci_ctrl_tx(struct usb_device *udev, unsigned long pipe,
 
 	queue_trb(ctrl, ep_ring, false, trb_fields);
 
-	giveback_first_trb(udev, ep_index, start_cycle, start_trb);
+	giveback_first_trb(udev, ep_index, 0, start_cycle, start_trb);
 
 	event = xhci_wait_for_event(ctrl, TRB_TRANSFER);
 	if (!event)
@@ -1019,7 +1228,7 @@ int xhci_ctrl_tx(struct usb_device *udev, unsigned long pipe,
 	record_transfer_result(udev, event, length);
 	xhci_acknowledge_event(ctrl);
 	if (udev->status == USB_ST_STALLED) {
-		reset_ep(udev, ep_index);
+		reset_ep(udev, ep_index, 0);
 		return -EPIPE;
 	}
 
@@ -1044,7 +1253,7 @@ int xhci_ctrl_tx(struct usb_device *udev, unsigned long pipe,
 
 abort:
 	debug("XHCI control transfer timed out, aborting...\n");
-	abort_td(udev, ep_index);
+	abort_td(udev, ep_index, 0);
 	udev->status = USB_ST_NAK_REC;
 	udev->act_len = 0;
 	return -ETIMEDOUT;
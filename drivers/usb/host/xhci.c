@@ -35,6 +35,7 @@
 #include <linux/delay.h>
 #include <linux/errno.h>
 #include <linux/iopoll.h>
+#include <linux/log2.h>
 
 static struct descriptor {
 	struct usb_hub_descriptor hub;
@@ -1158,7 +1159,7 @@ static int _xhci_submit_int_msg(struct usb_device *udev, unsigned long pipe,
 	 * (at most) one TD. A TD (comprised of sg list entries) can
 	 * take several service intervals to transmit.
 	 */
-	return xhci_bulk_tx(udev, pipe, length, buffer);
+	return xhci_bulk_tx(udev, pipe, 0, length, buffer);
 }
 
 /**
@@ -1178,7 +1179,7 @@ static int _xhci_submit_bulk_msg(struct usb_device *udev, unsigned long pipe,
 		return -EINVAL;
 	}
 
-	return xhci_bulk_tx(udev, pipe, length, buffer);
+	return xhci_bulk_tx(udev, pipe, 0, length, buffer);
 }
 
 /**
@@ -1428,6 +1429,115 @@ static int xhci_get_max_xfer_size(struct udevice *dev, size_t *size)
 	return 0;
 }
 
+/**
+ * Set up bulk streams on endpoints, as used by USB Attached SCSI. The
+ * endpoints are reconfigured to use a linear stream array, with a transfer
+ * ring for each stream.
+ *
+ * @param dev		USB controller
+ * @param udev		pointer to the USB device structure
+ * @param pipes		bulk pipes of the endpoints to set up
+ * @param num_pipes	number of entries in @pipes
+ * @param num_streams	number of streams wanted on each endpoint, no more
+ *			than their companion descriptors allow
+ * Return: number of streams set up, or -ve on error
+ */
+static int xhci_alloc_streams(struct udevice *dev, struct usb_device *udev,
+			      unsigned long *pipes, int num_pipes,
+			      int num_streams)
+{
+	struct xhci_ctrl *ctrl = dev_get_priv(dev);
+	struct xhci_virt_device *virt_dev = ctrl->devs[udev->slot_id];
+	struct xhci_input_control_ctx *ctrl_ctx;
+	struct xhci_ep_ctx *ep_ctx;
+	struct xhci_virt_ep *ep;
+	u32 hcc, flags = 0;
+	int i, ep_index, ret;
+
+	hcc = xhci_readl(&ctrl->hccr->cr_hccparams);
+	if (!(hcc & (0xf << 12)) || udev->speed < USB_SPEED_SUPER)
+		return -ENOSYS;
+
+	/*
+	 * The caller has limited the streams to what the endpoints support in
+	 * the selected alternate setting, so only the host limit is left
+	 */
+	num_streams = min(num_streams, (int)HCC_MAX_PSA(hcc) - 1);
+	for (i = 0; i < num_pipes; i++) {
+		ep_index = usb_pipe_ep_index(pipes[i]);
+		if (virt_dev->eps[ep_index].ep_state & EP_HAS_STREAMS)
+			return virt_dev->eps[ep_index].num_streams;
+	}
+	if (num_streams < 1)
+		return -ENOSYS;
+
+	xhci_inval_cache((uintptr_t)virt_dev->out_ctx->bytes,
+			 virt_dev->out_ctx->size);
+	xhci_slot_copy(ctrl, virt_dev->in_ctx, virt_dev->out_ctx);
+
+	for (i = 0; i < num_pipes; i++) {
+		ep_index = usb_pipe_ep_index(pipes[i]);
+		ep = &virt_dev->eps[ep_index];
+		ret = xhci_alloc_stream_info(ctrl, ep, num_streams);
+		if (ret)
+			goto err;
+
+		xhci_endpoint_copy(ctrl, virt_dev->in_ctx, virt_dev->out_ctx,
+				   ep_index);
+		ep_ctx = xhci_get_ep_ctx(ctrl, virt_dev->in_ctx, ep_index);
+		ep_ctx->ep_info &= cpu_to_le32(~EP_MAXPSTREAMS_MASK);
+		ep_ctx->ep_info |= cpu_to_le32(EP_HAS_LSA |
+			EP_MAXPSTREAMS(ilog2(roundup_pow_of_two(num_streams + 1)) - 1));
+		ep_ctx->deq = cpu_to_le64(ep->stream_ctx_dma);
+		flags |= 1 << (ep_index + 1);
+	}
+
+	/* Drop and re-add the endpoints, see xHCI spec 4.6.6 */
+	ctrl_ctx = xhci_get_input_control_ctx(virt_dev->in_ctx);
+	ctrl_ctx->add_flags = cpu_to_le32(flags | SLOT_FLAG);
+	ctrl_ctx->drop_flags = cpu_to_le32(flags);
+
+	ret = xhci_configure_endpoints(udev, false);
+	if (ret)
+		goto err;
+
+	for (i = 0; i < num_pipes; i++)
+		virt_dev->eps[usb_pipe_ep_index(pipes[i])].ep_state |=
+			EP_HAS_STREAMS;
+
+	return num_streams;
+err:
+	for (i = 0; i < num_pipes; i++)
+		xhci_free_stream_info(ctrl,
+				      &virt_dev->eps[usb_pipe_ep_index(pipes[i])]);
+
+	return ret;
+}
+
+static int xhci_submit_bulk_stream_msg(struct udevice *dev,
+				       struct usb_device *udev,
+				       unsigned long pipe, unsigned int stream,
+				       void *buffer, int length)
+{
+	debug("%s: dev='%s', udev=%p\n", __func__, dev->name, udev);
+	if (usb_pipetype(pipe) != PIPE_BULK)
+		return -EINVAL;
+
+	return xhci_bulk_tx(udev, pipe, stream, length, buffer);
+}
+
+static int xhci_submit_bulk_queue(struct udevice *dev, struct usb_device *udev,
+				  unsigned long pipe,
+				  struct usb_bulk_xfer *xfers, int count,
+				  int timeout)
+{
+	debug("%s: dev='%s', udev=%p\n", __func__, dev->name, udev);
+	if (usb_pipetype(pipe) != PIPE_BULK)
+		return -EINVAL;
+
+	return xhci_bulk_queue(udev, pipe, 0, xfers, count, timeout);
+}
+
 int xhci_register(struct udevice *dev, struct xhci_hccr *hccr,
 		  struct xhci_hcor *hcor)
 {
@@ -1481,4 +1591,7 @@ struct dm_usb_ops xhci_usb_ops = {
 	.alloc_device = xhci_alloc_device,
 	.update_hub_device = xhci_update_hub_device,
 	.get_max_xfer_size  = xhci_get_max_xfer_size,
+	.alloc_streams = xhci_alloc_streams,
+	.bulk_stream = xhci_submit_bulk_stream_msg,
+	.bulk_queue = xhci_submit_bulk_queue,
 };
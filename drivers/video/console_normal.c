@@ -108,6 +108,7 @@ static int console_set_cursor_visible(struct udevice *dev, bool visible,
 	struct video_fontdata *fontdata = priv->fontdata;
 	int pbytes = VNBYTES(vid_priv->bpix);
 	void *start, *line;
+	int ret;
 
 	/* for now, this is not used outside expo */
 	if (!IS_ENABLED(CONFIG_EXPO))
@@ -116,14 +117,14 @@ static int console_set_cursor_visible(struct udevice *dev, bool visible,
 	x += index * fontdata->width;
 	start = vid_priv->fb + y * vid_priv->line_length + x * pbytes;
 
-	/* place the cursor 1 pixel before the start of the next char */
-	x -= 1;
-
 	line = start;
-	draw_cursor_vertically(&line, vid_priv, vc_priv->y_charsize,
-			       NORMAL_DIRECTION);
+	ret = draw_cursor_vertically(&line, vid_priv, vc_priv->y_charsize,
+				     NORMAL_DIRECTION);
+	if (ret)
+		return ret;
 
-	return 0;
+	return video_sync_copy_area(vid, x, y, VIDCONSOLE_CURSOR_WIDTH,
+				    vc_priv->y_charsize);
 }
 
 struct vidconsole_ops console_ops = {
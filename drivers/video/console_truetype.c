@@ -7,6 +7,7 @@
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
+#include <linux/list.h>
 #include <spl.h>
 #include <video.h>
 #include <video_console.h>
@@ -127,6 +128,65 @@ struct pos_info {
  */
 #define POS_HISTORY_SIZE	(CONFIG_SYS_CBSIZE * 11 / 10)
 
+/* Number of codepoints (from 0) whose advance and kerning are cached */
+#define TT_CACHE_CHARS		0x80
+
+/* Number of hash buckets used to look up glyphs in the cache */
+#define TT_GLYPH_HASH		32
+
+/**
+ * struct console_tt_glyph - A rendered glyph
+ *
+ * @sibling_hash:	Node in the hash bucket for this codepoint
+ * @sibling_lru:	Node in the cache's least-recently-used list
+ * @cp:		Unicode codepoint
+ * @x_shift:	Sub-pixel X offset the glyph was rendered at, 0 <= x_shift < 1.
+ *		This is kept at full precision so that cached glyphs are drawn
+ *		exactly as uncached ones
+ * @width:	Width of the bitmap in pixels
+ * @height:	Height of the bitmap in pixels
+ * @xoff:	X offset of the bitmap from the cursor position
+ * @yoff:	Y offset of the bitmap from the baseline
+ * @data:	8bpp alpha bitmap, or NULL if the glyph is empty (e.g. ' ')
+ */
+struct console_tt_glyph {
+	struct list_head sibling_hash;
+	struct list_head sibling_lru;
+	int cp;
+	double x_shift;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	u8 *data;
+};
+
+/**
+ * struct console_tt_cache - Cache of glyph information for a font / size
+ *
+ * Rendering a glyph from its outline is slow, so the most recently used
+ * glyphs are kept, up to CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE of them.
+ *
+ * @advance:	Advance width of each of the first TT_CACHE_CHARS codepoints,
+ *		in font units. This is filled in when the cache is created
+ * @kern_left:	Codepoint before each of the first TT_CACHE_CHARS codepoints
+ *		when its kerning was last looked up, or -1 if none
+ * @kern:	Kerning between @kern_left and each codepoint, in font units
+ * @hash:	Hash buckets of glyphs, indexed by codepoint
+ * @lru:	List of glyphs, most recently used first
+ * @count:	Number of entries in @glyphs which are in use
+ * @glyphs:	Glyph storage
+ */
+struct console_tt_cache {
+	int advance[TT_CACHE_CHARS];
+	int kern_left[TT_CACHE_CHARS];
+	int kern[TT_CACHE_CHARS];
+	struct list_head hash[TT_GLYPH_HASH];
+	struct list_head lru;
+	int count;
+	struct console_tt_glyph glyphs[];
+};
+
 /**
  * struct console_tt_metrics - Information about a font / size combination
  *
@@ -145,6 +205,7 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @cache:	Glyph cache, or NULL if none
  */
 struct console_tt_metrics {
 	const char *font_name;
@@ -153,6 +214,7 @@ struct console_tt_metrics {
 	stbtt_fontinfo font;
 	int baseline;
 	double scale;
+	struct console_tt_cache *cache;
 };
 
 /**
@@ -187,6 +249,162 @@ struct console_tt_store {
 	struct pos_info cur;
 };
 
+/**
+ * tt_cache_create() - Set up the glyph cache for a font / size
+ *
+ * This looks up the advance width of each of the first TT_CACHE_CHARS
+ * codepoints, so that they are ready when the font is used. If there is not
+ * enough memory, the font is used without a cache.
+ *
+ * @met:	Metrics to update
+ */
+static void tt_cache_create(struct console_tt_metrics *met)
+{
+	struct console_tt_cache *cache;
+	int lsb;
+	int i;
+
+	if (!CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE)
+		return;
+	cache = malloc(sizeof(*cache) + CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE *
+		       sizeof(struct console_tt_glyph));
+	if (!cache) {
+		log_debug("No memory for glyph cache\n");
+		return;
+	}
+	for (i = 0; i < TT_CACHE_CHARS; i++) {
+		stbtt_GetCodepointHMetrics(&met->font, i, &cache->advance[i],
+					   &lsb);
+		cache->kern_left[i] = -1;
+	}
+	for (i = 0; i < TT_GLYPH_HASH; i++)
+		INIT_LIST_HEAD(&cache->hash[i]);
+	INIT_LIST_HEAD(&cache->lru);
+	cache->count = 0;
+	met->cache = cache;
+}
+
+/**
+ * tt_cache_destroy() - Free the glyph cache for a font / size
+ *
+ * @met:	Metrics to update
+ */
+static void tt_cache_destroy(struct console_tt_metrics *met)
+{
+	struct console_tt_cache *cache = met->cache;
+	int i;
+
+	if (!cache)
+		return;
+	for (i = 0; i < cache->count; i++)
+		free(cache->glyphs[i].data);
+	free(cache);
+	met->cache = NULL;
+}
+
+/**
+ * tt_get_advance() - Get the advance width of a codepoint
+ *
+ * @met:	Metrics to use
+ * @cp:		Unicode codepoint
+ * Return: advance width in font units
+ */
+static int tt_get_advance(struct console_tt_metrics *met, int cp)
+{
+	int advance, lsb;
+
+	if (met->cache && cp >= 0 && cp < TT_CACHE_CHARS)
+		return met->cache->advance[cp];
+	stbtt_GetCodepointHMetrics(&met->font, cp, &advance, &lsb);
+
+	return advance;
+}
+
+/**
+ * tt_get_kern() - Get the kerning between two codepoints
+ *
+ * @met:	Metrics to use
+ * @left:	Codepoint on the left
+ * @cp:		Codepoint on the right
+ * Return: kerning adjustment in font units
+ */
+static int tt_get_kern(struct console_tt_metrics *met, int left, int cp)
+{
+	struct console_tt_cache *cache = met->cache;
+	int kern;
+
+	if (cache && cp >= 0 && cp < TT_CACHE_CHARS &&
+	    cache->kern_left[cp] == left)
+		return cache->kern[cp];
+	kern = stbtt_GetCodepointKernAdvance(&met->font, left, cp);
+	if (cache && cp >= 0 && cp < TT_CACHE_CHARS) {
+		cache->kern_left[cp] = left;
+		cache->kern[cp] = kern;
+	}
+
+	return kern;
+}
+
+/**
+ * tt_get_glyph() - Get a glyph rendered at a given sub-pixel offset
+ *
+ * If the glyph is in the cache it is returned from there. Otherwise it is
+ * rendered and added to the cache, replacing the least recently used glyph if
+ * the cache is full. Without a cache, the glyph is rendered into @tmp and the
+ * caller must free @tmp->data
+ *
+ * @met:	Metrics to use
+ * @cp:		Unicode codepoint
+ * @x_shift:	Sub-pixel X offset, 0 <= x_shift < 1
+ * @tmp:	Used to hold the glyph if there is no cache
+ * Return: glyph
+ */
+static struct console_tt_glyph *tt_get_glyph(struct console_tt_metrics *met,
+					     int cp, double x_shift,
+					     struct console_tt_glyph *tmp)
+{
+	struct console_tt_cache *cache = met->cache;
+	struct console_tt_glyph *glyph;
+	struct list_head *head = NULL;
+
+	if (cache) {
+		head = &cache->hash[(uint)cp % TT_GLYPH_HASH];
+		list_for_each_entry(glyph, head, sibling_hash) {
+			if (glyph->cp == cp && glyph->x_shift == x_shift) {
+				list_move(&glyph->sibling_lru, &cache->lru);
+				return glyph;
+			}
+		}
+		if (cache->count < CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE) {
+			glyph = &cache->glyphs[cache->count++];
+		} else {
+			glyph = list_last_entry(&cache->lru,
+						struct console_tt_glyph,
+						sibling_lru);
+			list_del(&glyph->sibling_hash);
+			list_del(&glyph->sibling_lru);
+			free(glyph->data);
+		}
+	} else {
+		glyph = tmp;
+	}
+
+	glyph->cp = cp;
+	glyph->x_shift = x_shift;
+	glyph->data = stbtt_GetCodepointBitmapSubpixel(&met->font, met->scale,
+						       met->scale, x_shift, 0,
+						       cp, &glyph->width,
+						       &glyph->height,
+						       &glyph->xoff,
+						       &glyph->yoff);
+	if (cache) {
+		list_add(&glyph->sibling_hash, head);
+		list_add(&glyph->sibling_lru, &cache->lru);
+	}
+
+	return glyph;
+}
+
 static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 {
 	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
@@ -269,19 +487,18 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
-	stbtt_fontinfo *font = &met->font;
+	struct console_tt_glyph *glyph, tmp;
 	int width, height, xoff, yoff;
 	double xpos, x_shift;
-	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
+	u8 *bits;
 	int advance;
 	void *start, *end, *line;
 	int row, ret;
 
 	/* First get some basic metrics about this character */
-	stbtt_GetCodepointHMetrics(font, cp, &advance, &lsb);
+	advance = tt_get_advance(met, cp);
 
 	/*
 	 * First out our current X position in fractional pixels. If we wrote
@@ -289,8 +506,7 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * this character */
 	xpos = frac(VID_TO_PIXEL((double)x));
 	if (vc_priv->last_ch) {
-		xpos += met->scale * stbtt_GetCodepointKernAdvance(font,
-							vc_priv->last_ch, cp);
+		xpos += met->scale * tt_get_kern(met, vc_priv->last_ch, cp);
 	}
 
 	/*
@@ -319,14 +535,16 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * image of the character. For empty characters, like ' ', data will
 	 * return NULL;
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, met->scale, met->scale,
-						x_shift, 0, cp, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+	glyph = tt_get_glyph(met, cp, x_shift, &tmp);
+	if (!glyph->data)
 		return width_frac;
+	width = glyph->width;
+	height = glyph->height;
+	xoff = glyph->xoff;
+	yoff = glyph->yoff;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
+	bits = glyph->data;
 	start = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
 	linenum = met->baseline + yoff;
@@ -412,16 +630,28 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 			break;
 		}
 		default:
-			free(data);
+			if (glyph == &tmp)
+				free(tmp.data);
 			return -ENOSYS;
 		}
 
 		line += vid_priv->line_length;
 	}
-	ret = vidconsole_sync_copy(dev, start, line);
+	if (glyph == &tmp)
+		free(tmp.data);
+
+	/*
+	 * Only the glyph's own pixels have changed, unless it hangs off the
+	 * edge of the display, in which case it has wrapped onto another row
+	 */
+	xoff += VID_TO_PIXEL(x);
+	if (xoff >= 0 && xoff + width <= vid_priv->xsize)
+		ret = video_sync_copy_area(vid, xoff, y + max(linenum, 0),
+					   width, height);
+	else
+		ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
-	free(data);
 
 	return width_frac;
 }
@@ -618,6 +848,7 @@ static int truetype_add_metrics(struct udevice *dev, const char *font_name,
 	met->scale = stbtt_ScaleForPixelHeight(font, font_size);
 	stbtt_GetFontVMetrics(font, &ascent, 0, 0);
 	met->baseline = (int)(ascent * met->scale);
+	tt_cache_create(met);
 
 	return priv->num_metrics++;
 }
@@ -725,8 +956,6 @@ static int truetype_measure(struct udevice *dev, const char *name, uint size,
 			    const char *text, struct vidconsole_bbox *bbox)
 {
 	struct console_tt_metrics *met;
-	stbtt_fontinfo *font;
-	int lsb, advance;
 	const char *s;
 	int width;
 	int last;
@@ -740,19 +969,16 @@ static int truetype_measure(struct udevice *dev, const char *name, uint size,
 	if (!*text)
 		return 0;
 
-	font = &met->font;
 	width = 0;
 	for (last = 0, s = text; *s; s++) {
 		int ch = *s;
 
 		/* Used kerning to fine-tune the position of this character */
 		if (last)
-			width += stbtt_GetCodepointKernAdvance(font, last, ch);
+			width += tt_get_kern(met, last, ch);
 
 		/* First get some basic metrics about this character */
-		stbtt_GetCodepointHMetrics(font, ch, &advance, &lsb);
-
-		width += advance;
+		width += tt_get_advance(met, ch);
 		last = ch;
 	}
 
@@ -990,6 +1216,17 @@ static int console_truetype_probe(struct udevice *dev)
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	for (i = 0; i < priv->num_metrics; i++)
+		tt_cache_destroy(&priv->metrics[i]);
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -1011,5 +1248,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto	= sizeof(struct console_tt_priv),
 };
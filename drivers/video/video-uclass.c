@@ -171,7 +171,7 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 	void *start, *line;
 	int pixels = xend - xstart;
-	int row, i, ret;
+	int row, i;
 
 	start = priv->fb + ystart * priv->line_length;
 	start += xstart * VNBYTES(priv->bpix);
@@ -210,11 +210,8 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		}
 		line += priv->line_length;
 	}
-	ret = video_sync_copy(dev, start, line);
-	if (ret)
-		return ret;
 
-	return 0;
+	return video_sync_copy_area(dev, xstart, ystart, pixels, yend - ystart);
 }
 
 int video_reserve_from_bloblist(struct video_handoff *ho)
@@ -258,7 +255,7 @@ int video_fill(struct udevice *dev, u32 colour)
 		memset(priv->fb, colour, priv->fb_size);
 		break;
 	}
-	ret = video_sync_copy(dev, priv->fb, priv->fb + priv->fb_size);
+	ret = video_sync_copy_area(dev, 0, 0, priv->xsize, priv->ysize);
 	if (ret)
 		return ret;
 
@@ -367,6 +364,164 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = video_index_to_colour(priv, back);
 }
 
+/**
+ * video_flush_area() - Write an area of the frame buffer back from the cache
+ *
+ * If the area covers whole rows, it is flushed in one go. Otherwise each row
+ * is flushed separately, so that the rest of the row is left alone.
+ *
+ * @vid: Video device
+ * @area: Area to flush, which must not be empty
+ */
+static void video_flush_area(struct udevice *vid, struct video_bbox *area)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int bytes = VNBYTES(priv->bpix);
+	ulong start, end;
+	int row, rows;
+
+	start = (ulong)priv->fb + area->y0 * priv->line_length;
+	if (!area->x0 && area->x1 == priv->xsize) {
+		end = (ulong)priv->fb + area->y1 * priv->line_length;
+		rows = 1;
+	} else {
+		start += area->x0 * bytes;
+		end = start + (area->x1 - area->x0) * bytes;
+		rows = area->y1 - area->y0;
+	}
+
+	for (row = 0; row < rows; row++) {
+		priv->stats.sync_bytes += end - start;
+		/*
+		 * flush_dcache_range() is declared in common.h but it seems
+		 * that some architectures do not actually implement it. Is
+		 * there a way to find out whether it exists? For now, ARM is
+		 * safe.
+		 */
+#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
+		if (priv->flush_dcache) {
+			flush_dcache_range(ALIGN_DOWN(start,
+						      CONFIG_SYS_CACHELINE_SIZE),
+					   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
+		}
+#endif
+		start += priv->line_length;
+		end += priv->line_length;
+	}
+#if defined(CONFIG_VIDEO_SANDBOX_SDL)
+	sandbox_sdl_sync(priv->fb);
+#endif
+}
+
+/**
+ * video_mark_damage() - Add an area to the damage since the last sync
+ *
+ * @priv: Video device's uclass-private data
+ * @x0: Left column
+ * @y0: Top row
+ * @x1: Column after the right edge
+ * @y1: Row after the bottom edge
+ */
+static void video_mark_damage(struct video_priv *priv, int x0, int y0, int x1,
+			      int y1)
+{
+	struct video_bbox *damage = &priv->damage;
+
+	x1 = min(x1, (int)priv->xsize);
+	if (damage->x1 > damage->x0 && damage->y1 > damage->y0) {
+		damage->x0 = min(damage->x0, x0);
+		damage->y0 = min(damage->y0, y0);
+		damage->x1 = max(damage->x1, x1);
+		damage->y1 = max(damage->y1, y1);
+	} else {
+		damage->x0 = x0;
+		damage->y0 = y0;
+		damage->x1 = x1;
+		damage->y1 = y1;
+	}
+}
+
+/**
+ * video_clip_area() - Clip an area to the display
+ *
+ * @priv: Video device's uclass-private data
+ * @area: Returns the clipped area
+ * @x: Left column
+ * @y: Top row
+ * @width: Width in pixels
+ * @height: Height in pixels
+ * Return: true if anything is left, false if the area is off the display
+ */
+static bool video_clip_area(struct video_priv *priv, struct video_bbox *area,
+			    int x, int y, int width, int height)
+{
+	area->x0 = max(x, 0);
+	area->y0 = max(y, 0);
+	area->x1 = min(x + width, (int)priv->xsize);
+	area->y1 = min(y + height, (int)priv->ysize);
+
+	return area->x1 > area->x0 && area->y1 > area->y0;
+}
+
+void video_damage(struct udevice *dev, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_bbox area;
+
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE) &&
+	    video_clip_area(priv, &area, x, y, width, height))
+		video_mark_damage(priv, area.x0, area.y0, area.x1, area.y1);
+}
+
+int video_sync_copy_area(struct udevice *dev, int x, int y, int width,
+			 int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	int bytes = VNBYTES(priv->bpix);
+	struct video_bbox area;
+	long offset;
+	int size, rows, row;
+
+	if (!video_clip_area(priv, &area, x, y, width, height))
+		return 0;
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		video_mark_damage(priv, area.x0, area.y0, area.x1, area.y1);
+	if (!IS_ENABLED(CONFIG_VIDEO_COPY) || !priv->copy_fb)
+		return 0;
+
+	offset = area.y0 * priv->line_length + area.x0 * bytes;
+	if (!area.x0 && area.x1 == priv->xsize) {
+		/* whole rows can be copied in one go */
+		size = (area.y1 - area.y0) * priv->line_length;
+		rows = 1;
+	} else {
+		size = (area.x1 - area.x0) * bytes;
+		rows = area.y1 - area.y0;
+	}
+	for (row = 0; row < rows; row++) {
+		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
+		priv->stats.copy_bytes += size;
+		offset += priv->line_length;
+	}
+
+	return 0;
+}
+
+struct video_stats *video_get_stats(struct udevice *dev)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	return &priv->stats;
+}
+
+void video_reset_stats(struct udevice *dev)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	memset(&priv->stats, '\0', sizeof(priv->stats));
+	priv->stats.start = get_timer(0);
+}
+
 /* Flush video activity to the caches */
 int video_sync(struct udevice *vid, bool force)
 {
@@ -384,20 +539,18 @@ int video_sync(struct udevice *vid, bool force)
 	    get_timer(priv->last_sync) < CONFIG_VIDEO_SYNC_MS)
 		return 0;
 
-	/*
-	 * flush_dcache_range() is declared in common.h but it seems that some
-	 * architectures do not actually implement it. Is there a way to find
-	 * out whether it exists? For now, ARM is safe.
-	 */
-#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE) && !priv->damage_all) {
+		struct video_bbox *damage = &priv->damage;
+
+		if (damage->x1 > damage->x0 && damage->y1 > damage->y0)
+			video_flush_area(vid, damage);
+	} else {
+		struct video_bbox all = { 0, 0, priv->xsize, priv->ysize };
+
+		video_flush_area(vid, &all);
 	}
-#elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	sandbox_sdl_sync(priv->fb);
-#endif
+	memset(&priv->damage, '\0', sizeof(priv->damage));
+	priv->stats.syncs++;
 	priv->last_sync = get_timer(0);
 
 	return 0;
@@ -451,12 +604,11 @@ int video_get_ysize(struct udevice *dev)
 	return priv->ysize;
 }
 
-#ifdef CONFIG_VIDEO_COPY
 int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
-	if (priv->copy_fb) {
+	if (priv->copy_fb || IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
 		long offset, size;
 
 		/* Find the offset of the first byte to copy */
@@ -497,7 +649,27 @@ int video_sync_copy(struct udevice *dev, void *from, void *to)
 			offset = 0;
 		}
 
-		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
+		if (IS_ENABLED(CONFIG_VIDEO_DAMAGE) && size > 0) {
+			int y0 = offset / priv->line_length;
+			int y1 = (offset + size - 1) / priv->line_length + 1;
+
+			/* a region within one row is known exactly */
+			if (y1 - y0 == 1) {
+				int bytes = VNBYTES(priv->bpix);
+				int x0 = offset % priv->line_length / bytes;
+
+				video_mark_damage(priv, x0, y0,
+						  x0 + size / bytes, y1);
+			} else {
+				video_mark_damage(priv, 0, y0, priv->xsize, y1);
+			}
+		}
+
+		if (priv->copy_fb) {
+			memcpy(priv->copy_fb + offset, priv->fb + offset,
+			       size);
+			priv->stats.copy_bytes += size;
+		}
 	}
 
 	return 0;
@@ -512,8 +684,6 @@ int video_sync_copy_all(struct udevice *dev)
 	return 0;
 }
 
-#endif
-
 #define SPLASH_DECL(_name) \
 	extern u8 __splash_ ## _name ## _begin[]; \
 	extern u8 __splash_ ## _name ## _end[]
@@ -595,6 +765,8 @@ static int video_post_probe(struct udevice *dev)
 	if (IS_ENABLED(CONFIG_VIDEO_COPY) && plat->copy_base)
 		priv->copy_fb = map_sysmem(plat->copy_base, plat->size);
 
+	video_reset_stats(dev);
+
 	/* Set up colors  */
 	video_set_default_colors(dev, false);
 
@@ -308,6 +308,20 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+/**
+ * struct fat_cursor - a position in the cluster chain of a file
+ *
+ * This allows a series of reads through a file to continue along the cluster
+ * chain, instead of following it from the start of the file each time.
+ *
+ * @clust:	cluster number, or 0 if not known yet
+ * @pos:	offset in the file of the start of @clust
+ */
+struct fat_cursor {
+	__u32 clust;
+	loff_t pos;
+};
+
 /**
  * get_contents() - read from file
  *
@@ -321,10 +335,14 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
  * @buffer:	buffer into which to read
  * @maxsize:	maximum number of bytes to read
  * @gotsize:	number of bytes actually read
+ * @cursor:	cursor to start searching the cluster chain from, if it is not
+ *		beyond 'pos'; updated to the cluster containing 'pos'. May be
+ *		NULL to search from the start of the file
  * Return:	-1 on error, otherwise 0
  */
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
-			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
+			__u8 *buffer, loff_t maxsize, loff_t *gotsize,
+			struct fat_cursor *cursor)
 {
 	loff_t filesize = FAT2CPU32(dentptr->size);
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
@@ -346,6 +364,10 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 	debug("%llu bytes\n", filesize);
 
 	actsize = bytesperclust;
+	if (cursor && cursor->clust && cursor->pos <= pos) {
+		curclust = cursor->clust;
+		actsize += cursor->pos;
+	}
 
 	/* go to cluster at pos */
 	while (actsize <= pos) {
@@ -357,6 +379,10 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 		}
 		actsize += bytesperclust;
 	}
+	if (cursor) {
+		cursor->clust = curclust;
+		cursor->pos = actsize - bytesperclust;
+	}
 
 	/* actsize > pos */
 	actsize -= bytesperclust;
@@ -1325,7 +1351,7 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	/* For saving default max clustersize memory allocated to malloc pool */
 	dir_entry *dentptr = itr->dent;
 
-	ret = get_contents(&fsdata, dentptr, offset, buf, len, actread);
+	ret = get_contents(&fsdata, dentptr, offset, buf, len, actread, NULL);
 
 out_free_both:
 	free(fsdata.fatbuf);
@@ -1419,6 +1445,84 @@ void fat_closedir(struct fs_dir_stream *dirs)
 	free(dir);
 }
 
+/**
+ * struct fat_file - an open FAT file
+ *
+ * @parent:	common part of the open file
+ * @fsdata:	filesystem information, including the FAT buffer
+ * @dent:	copy of the directory entry for the file
+ * @dev:	block device holding the filesystem
+ * @part_info:	partition holding the filesystem
+ * @cursor:	where the last read started in the cluster chain
+ */
+struct fat_file {
+	struct fs_file parent;
+	fsdata fsdata;
+	dir_entry dent;
+	struct blk_desc *dev;
+	struct disk_partition part_info;
+	struct fat_cursor cursor;
+};
+
+int fat_file_open(const char *filename, struct fs_file **filep)
+{
+	struct fat_file *file;
+	fat_itr *itr;
+	int ret;
+
+	file = calloc(1, sizeof(*file));
+	itr = malloc_cache_aligned(sizeof(fat_itr));
+	if (!file || !itr) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	ret = fat_itr_root(itr, &file->fsdata);
+	if (ret)
+		goto err;
+
+	ret = fat_itr_resolve(itr, filename, TYPE_FILE);
+	if (ret) {
+		free(file->fsdata.fatbuf);
+		goto err;
+	}
+	file->dent = *itr->dent;
+	file->dev = cur_dev;
+	file->part_info = cur_part_info;
+	file->parent.size = FAT2CPU32(file->dent.size);
+	free(itr);
+	*filep = &file->parent;
+
+	return 0;
+err:
+	free(itr);
+	free(file);
+
+	return ret;
+}
+
+int fat_file_read(struct fs_file *fsfile, void *buf, loff_t offset, loff_t len,
+		  loff_t *actread)
+{
+	struct fat_file *file = container_of(fsfile, struct fat_file, parent);
+
+	/* the boot sector was checked when the file was opened */
+	cur_dev = file->dev;
+	cur_part_info = file->part_info;
+
+	debug("reading open file at pos %llu\n", offset);
+
+	return get_contents(&file->fsdata, &file->dent, offset, buf, len,
+			    actread, &file->cursor);
+}
+
+void fat_file_close(struct fs_file *fsfile)
+{
+	struct fat_file *file = container_of(fsfile, struct fat_file, parent);
+
+	free(file->fsdata.fatbuf);
+	free(file);
+}
+
 void fat_close(void)
 {
 }
@@ -133,6 +133,66 @@ static inline int fs_opendir_unsupported(const char *filename,
 	return -EACCES;
 }
 
+static inline int fs_file_open_unsupported(const char *filename,
+					   struct fs_file **filep)
+{
+	return -EACCES;
+}
+
+/**
+ * struct fs_file_generic - Open file for filesystems without their own support
+ *
+ * @parent: Common part of the open file
+ * @path: Full path of the file, which is looked up again on each read
+ */
+struct fs_file_generic {
+	struct fs_file parent;
+	char path[];
+};
+
+/* generic implementation of file_open, in terms of fs_size()/fs_read() */
+__maybe_unused
+static int fs_file_open_generic(const char *filename, struct fs_file **filep)
+{
+	struct fs_file_generic *file;
+	loff_t size;
+	int ret;
+
+	ret = fs_size(filename, &size);
+	if (ret)
+		return ret < 0 ? ret : -ENOENT;
+
+	file = calloc(1, sizeof(*file) + strlen(filename) + 1);
+	if (!file)
+		return -ENOMEM;
+	strcpy(file->path, filename);
+	file->parent.size = size;
+	*filep = &file->parent;
+
+	return 0;
+}
+
+__maybe_unused
+static int fs_file_read_generic(struct fs_file *file, void *buf,
+				loff_t offset, loff_t len, loff_t *actread)
+{
+	struct fs_file_generic *gen;
+	int ret;
+
+	gen = container_of(file, struct fs_file_generic, parent);
+	ret = fs_set_blk_dev_with_part(file->desc, file->part);
+	if (ret)
+		return ret;
+
+	return fs_read(gen->path, map_to_sysmem(buf), offset, len, actread);
+}
+
+__maybe_unused
+static void fs_file_close_generic(struct fs_file *file)
+{
+	free(container_of(file, struct fs_file_generic, parent));
+}
+
 static inline int fs_unlink_unsupported(const char *filename)
 {
 	return -1;
@@ -180,6 +240,16 @@ struct fstype_info {
 	int (*readdir)(struct fs_dir_stream *dirs, struct fs_dirent **dentp);
 	/* see fs_closedir() */
 	void (*closedir)(struct fs_dir_stream *dirs);
+	/*
+	 * Open a file for reading.  On success return 0 and the open file
+	 * via 'filep'.  On error, return -errno.  See fs_file_open().
+	 */
+	int (*file_open)(const char *filename, struct fs_file **filep);
+	/* see fs_file_read() */
+	int (*file_read)(struct fs_file *file, void *buf, loff_t offset,
+			 loff_t len, loff_t *actread);
+	/* see fs_file_close() */
+	void (*file_close)(struct fs_file *file);
 	int (*unlink)(const char *filename);
 	int (*mkdir)(const char *dirname);
 	int (*ln)(const char *filename, const char *target);
@@ -210,6 +280,9 @@ static struct fstype_info fstypes[] = {
 		.opendir = fat_opendir,
 		.readdir = fat_readdir,
 		.closedir = fat_closedir,
+		.file_open = fat_file_open,
+		.file_read = fat_file_read,
+		.file_close = fat_file_close,
 		.ln = fs_ln_unsupported,
 	},
 #endif
@@ -236,6 +309,9 @@ static struct fstype_info fstypes[] = {
 		.opendir = ext4fs_opendir,
 		.readdir = ext4fs_readdir,
 		.closedir = ext4fs_closedir,
+		.file_open = fs_file_open_generic,
+		.file_read = fs_file_read_generic,
+		.file_close = fs_file_close_generic,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 	},
@@ -254,6 +330,7 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_sandbox,
 		.uuid = fs_uuid_unsupported,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -273,6 +350,7 @@ static struct fstype_info fstypes[] = {
 		.write = smh_fs_write,
 		.uuid = fs_uuid_unsupported,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -293,6 +371,7 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_unsupported,
 		.uuid = fs_uuid_unsupported,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -314,6 +393,9 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_unsupported,
 		.uuid = btrfs_uuid,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_generic,
+		.file_read = fs_file_read_generic,
+		.file_close = fs_file_close_generic,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -333,6 +415,9 @@ static struct fstype_info fstypes[] = {
 		.size = sqfs_size,
 		.close = sqfs_close,
 		.closedir = sqfs_closedir,
+		.file_open = fs_file_open_generic,
+		.file_read = fs_file_read_generic,
+		.file_close = fs_file_close_generic,
 		.exists = sqfs_exists,
 		.uuid = fs_uuid_unsupported,
 		.write = fs_write_unsupported,
@@ -354,6 +439,9 @@ static struct fstype_info fstypes[] = {
 		.size = erofs_size,
 		.close = erofs_close,
 		.closedir = erofs_closedir,
+		.file_open = fs_file_open_generic,
+		.file_read = fs_file_read_generic,
+		.file_close = fs_file_close_generic,
 		.exists = erofs_exists,
 		.uuid = fs_uuid_unsupported,
 		.write = fs_write_unsupported,
@@ -375,6 +463,7 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_unsupported,
 		.uuid = fs_uuid_unsupported,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -671,6 +760,46 @@ void fs_closedir(struct fs_dir_stream *dirs)
 	fs_close();
 }
 
+struct fs_file *fs_file_open(const char *filename)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	struct fs_file *file = NULL;
+	int fstype = fs_type;
+	int ret;
+
+	ret = info->file_open(filename, &file);
+	fs_close();
+	if (ret) {
+		errno = -ret;
+		return NULL;
+	}
+
+	file->desc = fs_dev_desc;
+	file->part = fs_dev_part;
+	file->fstype = fstype;
+
+	return file;
+}
+
+int fs_file_read(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread)
+{
+	struct fstype_info *info = fs_get_info(file->fstype);
+
+	return info->file_read(file, buf, offset, len, actread);
+}
+
+void fs_file_close(struct fs_file *file)
+{
+	struct fstype_info *info;
+
+	if (!file)
+		return;
+
+	info = fs_get_info(file->fstype);
+	info->file_close(file);
+}
+
 int fs_unlink(const char *filename)
 {
 	int ret;
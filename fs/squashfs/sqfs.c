@@ -19,6 +19,7 @@
 #include <string.h>
 #include <squashfs.h>
 #include <part.h>
+#include <arena.h>
 
 #include "sqfs_decompressor.h"
 #include "sqfs_filesystem.h"
@@ -251,14 +252,15 @@ static int sqfs_get_tokens_length(char **tokens, int count)
 }
 
 /* Takes a token list and returns a single string with '/' as separator. */
-static char *sqfs_concat_tokens(char **token_list, int token_count)
+static char *sqfs_concat_tokens(struct arena *arena, char **token_list,
+				int token_count)
 {
 	char *result;
 	int i, length = 0, offset = 0;
 
 	length = sqfs_get_tokens_length(token_list, token_count);
 
-	result = malloc(length + 1);
+	result = arena_alloc(arena, length + 1);
 	if (!result)
 		return NULL;
 
@@ -294,67 +296,43 @@ static int sqfs_join(char **strings, char *dest, int start, int end,
 
 /*
  * Fills the given token list using its size (count) and a source string (str)
+ *
+ * The tokens point into a copy of the string held in the arena, so they remain
+ * valid until the arena is freed.
  */
-static int sqfs_tokenize(char **tokens, int count, const char *str)
+static int sqfs_tokenize(struct arena *arena, char **tokens, int count,
+			 const char *str)
 {
-	int i, j, ret = 0;
 	char *aux, *strc;
+	int j;
 
-	strc = strdup(str);
+	strc = arena_strdup(arena, str);
 	if (!strc)
 		return -ENOMEM;
 
 	if (!strcmp(strc, "/")) {
-		tokens[0] = strdup(strc);
-		if (!tokens[0]) {
-			ret = -ENOMEM;
-			goto free_strc;
-		}
+		tokens[0] = strc;
 	} else {
 		for (j = 0; j < count; j++) {
 			aux = strtok(!j ? strc : NULL, "/");
-			tokens[j] = strdup(aux);
-			if (!tokens[j]) {
-				for (i = 0; i < j; i++)
-					free(tokens[i]);
-				ret = -ENOMEM;
-				goto free_strc;
-			}
+			if (!aux)
+				return -EINVAL;
+			tokens[j] = aux;
 		}
 	}
 
-free_strc:
-	free(strc);
-
-	return ret;
-}
-
-/*
- * Remove last 'updir + 1' tokens from the base path tokens list. This leaves us
- * with a token list containing only the tokens needed to form the resolved
- * path, and returns the decremented size of the token list.
- */
-static int sqfs_clean_base_path(char **base, int count, int updir)
-{
-	int i;
-
-	for (i = count - updir - 1; i < count; i++)
-		free(base[i]);
-
-	return count - updir - 1;
+	return 0;
 }
 
 /*
  * Given the base ("current dir.") path and the relative one, generate the
  * absolute path.
  */
-static char *sqfs_get_abs_path(const char *base, const char *rel)
+static char *sqfs_get_abs_path(struct arena *arena, const char *base,
+			       const char *rel)
 {
-	char **base_tokens, **rel_tokens, *resolved = NULL;
 	int ret, bc, rc, i, updir = 0, resolved_size = 0, offset = 0;
-
-	base_tokens = NULL;
-	rel_tokens = NULL;
+	char **base_tokens, **rel_tokens, *resolved;
 
 	/* Memory allocation for the token lists */
 	bc = sqfs_count_tokens(base);
@@ -362,22 +340,19 @@ static char *sqfs_get_abs_path(const char *base, const char *rel)
 	if (bc < 1 || rc < 1)
 		return NULL;
 
-	base_tokens = calloc(bc, sizeof(char *));
-	if (!base_tokens)
+	base_tokens = arena_zalloc(arena, bc * sizeof(char *));
+	rel_tokens = arena_zalloc(arena, rc * sizeof(char *));
+	if (!base_tokens || !rel_tokens)
 		return NULL;
 
-	rel_tokens = calloc(rc, sizeof(char *));
-	if (!rel_tokens)
-		goto out;
-
 	/* Fill token lists */
-	ret = sqfs_tokenize(base_tokens, bc, base);
+	ret = sqfs_tokenize(arena, base_tokens, bc, base);
 	if (ret)
-		goto out;
+		return NULL;
 
-	ret = sqfs_tokenize(rel_tokens, rc, rel);
+	ret = sqfs_tokenize(arena, rel_tokens, rc, rel);
 	if (ret)
-		goto out;
+		return NULL;
 
 	/* count '..' occurrences in target path */
 	for (i = 0; i < rc; i++) {
@@ -385,10 +360,14 @@ static char *sqfs_get_abs_path(const char *base, const char *rel)
 			updir++;
 	}
 
-	/* Remove the last token and the '..' occurrences */
-	bc = sqfs_clean_base_path(base_tokens, bc, updir);
+	/*
+	 * Remove the last token and the '..' occurrences. This leaves us with a
+	 * token list containing only the tokens needed to form the resolved
+	 * path.
+	 */
+	bc -= updir + 1;
 	if (bc < 0)
-		goto out;
+		return NULL;
 
 	/* Calculate resolved path size */
 	if (!bc)
@@ -397,57 +376,37 @@ static char *sqfs_get_abs_path(const char *base, const char *rel)
 	resolved_size += sqfs_get_tokens_length(base_tokens, bc) +
 		sqfs_get_tokens_length(rel_tokens, rc);
 
-	resolved = malloc(resolved_size + 1);
+	resolved = arena_zalloc(arena, resolved_size + 1);
 	if (!resolved)
-		goto out;
+		return NULL;
 
 	/* Set resolved path */
-	memset(resolved, '\0', resolved_size + 1);
 	offset += sqfs_join(base_tokens, resolved + offset, 0, bc, '/');
 	resolved[offset++] = '/';
 	offset += sqfs_join(rel_tokens, resolved + offset, updir, rc, '/');
 
-out:
-	if (rel_tokens)
-		for (i = 0; i < rc; i++)
-			free(rel_tokens[i]);
-	if (base_tokens)
-		for (i = 0; i < bc; i++)
-			free(base_tokens[i]);
-
-	free(rel_tokens);
-	free(base_tokens);
-
 	return resolved;
 }
 
-static char *sqfs_resolve_symlink(struct squashfs_symlink_inode *sym,
+static char *sqfs_resolve_symlink(struct arena *arena,
+				  struct squashfs_symlink_inode *sym,
 				  const char *base_path)
 {
-	char *resolved, *target;
+	char *target;
 	u32 sz;
 
-	if (__builtin_add_overflow(get_unaligned_le32(&sym->symlink_size), 1, &sz))
-		return NULL;
-
-	target = malloc(sz);
-	if (!target)
-		return NULL;
+	sz = get_unaligned_le32(&sym->symlink_size);
 
 	/*
 	 * There is no trailling null byte in the symlink's target path, so a
 	 * copy is made and a '\0' is added at its end.
 	 */
-	target[sz - 1] = '\0';
-	/* Get target name (relative path) */
-	strncpy(target, sym->symlink, sz - 1);
+	target = arena_strndup(arena, sym->symlink, sz);
+	if (!target)
+		return NULL;
 
 	/* Relative -> absolute path conversion */
-	resolved = sqfs_get_abs_path(base_path, target);
-
-	free(target);
-
-	return resolved;
+	return sqfs_get_abs_path(arena, base_path, target);
 }
 
 /*
@@ -455,7 +414,8 @@ static char *sqfs_resolve_symlink(struct squashfs_symlink_inode *sym,
  * elements of m_list. Those metadata blocks come from the compressed directory
  * table.
  */
-static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
+static int sqfs_search_dir(struct arena *arena,
+			   struct squashfs_dir_stream *dirs, char **token_list,
 			   int token_count, u32 *m_list, int m_count)
 {
 	struct squashfs_super_block *sblk = ctxt.sblk;
@@ -468,12 +428,6 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 	struct fs_dirent *dent;
 	unsigned char *table;
 
-	res = NULL;
-	rem = NULL;
-	path = NULL;
-	target = NULL;
-	sym_tokens = NULL;
-
 	dirsp = (struct fs_dir_stream *)dirs;
 
 	/* Start by root inode */
@@ -549,20 +503,20 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 
 			sym = (struct squashfs_symlink_inode *)table;
 			/* Get first j + 1 tokens */
-			path = sqfs_concat_tokens(token_list, j + 1);
+			path = sqfs_concat_tokens(arena, token_list, j + 1);
 			if (!path) {
 				ret = -ENOMEM;
 				goto out;
 			}
 			/* Resolve for these tokens */
-			target = sqfs_resolve_symlink(sym, path);
+			target = sqfs_resolve_symlink(arena, sym, path);
 			if (!target) {
 				ret = -ENOMEM;
 				goto out;
 			}
 			/* Join remaining tokens */
-			rem = sqfs_concat_tokens(token_list + j + 1, token_count -
-						 j - 1);
+			rem = sqfs_concat_tokens(arena, token_list + j + 1,
+						 token_count - j - 1);
 			if (!rem) {
 				ret = -ENOMEM;
 				goto out;
@@ -571,7 +525,7 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 			 * Concatenate remaining tokens and symlink's target.
 			 * Allocate enough space for rem, target, '/' and '\0'.
 			 */
-			res = malloc(strlen(rem) + strlen(target) + 2);
+			res = arena_alloc(arena, strlen(rem) + strlen(target) + 2);
 			if (!res) {
 				ret = -ENOMEM;
 				goto out;
@@ -586,14 +540,15 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 				goto out;
 			}
 
-			sym_tokens = malloc(token_count * sizeof(char *));
+			sym_tokens = arena_alloc(arena,
+						 token_count * sizeof(char *));
 			if (!sym_tokens) {
 				ret = -EINVAL;
 				goto out;
 			}
 
 			/* Fill tokens list */
-			ret = sqfs_tokenize(sym_tokens, token_count, res);
+			ret = sqfs_tokenize(arena, sym_tokens, token_count, res);
 			if (ret) {
 				ret = -EINVAL;
 				goto out;
@@ -601,8 +556,8 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 			free(dirs->entry);
 			dirs->entry = NULL;
 
-			ret = sqfs_search_dir(dirs, sym_tokens, token_count,
-					      m_list, m_count);
+			ret = sqfs_search_dir(arena, dirs, sym_tokens,
+					      token_count, m_list, m_count);
 			goto out;
 		} else if (!sqfs_is_dir(get_unaligned_le16(&dir->inode_type))) {
 			printf("** Cannot find directory. **\n");
@@ -650,11 +605,6 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 		memcpy(&dirs->i_ldir, ldir, sizeof(*ldir));
 
 out:
-	free(res);
-	free(rem);
-	free(path);
-	free(target);
-	free(sym_tokens);
 	return ret;
 }
 
@@ -908,15 +858,19 @@ out:
 static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 {
 	unsigned char *inode_table = NULL, *dir_table = NULL;
-	int j, token_count = 0, ret = 0, metablks_count;
+	int token_count = 0, ret = 0, metablks_count;
 	struct squashfs_dir_stream *dirs;
-	char **token_list = NULL, *path = NULL;
+	char **token_list;
 	u32 *pos_list = NULL;
+	struct arena arena;
 
 	dirs = calloc(1, sizeof(*dirs));
 	if (!dirs)
 		return -EINVAL;
 
+	/* path tokens all share the lifetime of this call */
+	arena_init(&arena, 0);
+
 	/* these should be set to NULL to prevent dangling pointers */
 	dirs->dir_header = NULL;
 	dirs->entry = NULL;
@@ -943,20 +897,14 @@ static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 		goto out;
 	}
 
-	path = strdup(filename);
-	if (!path) {
-		ret = -EINVAL;
-		goto out;
-	}
-
-	token_list = malloc(token_count * sizeof(char *));
+	token_list = arena_alloc(&arena, token_count * sizeof(char *));
 	if (!token_list) {
 		ret = -EINVAL;
 		goto out;
 	}
 
 	/* Fill tokens list */
-	ret = sqfs_tokenize(token_list, token_count, path);
+	ret = sqfs_tokenize(&arena, token_list, token_count, filename);
 	if (ret)
 		goto out;
 	/*
@@ -965,7 +913,7 @@ static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 	 */
 	dirs->inode_table = inode_table;
 	dirs->dir_table = dir_table;
-	ret = sqfs_search_dir(dirs, token_list, token_count, pos_list,
+	ret = sqfs_search_dir(&arena, dirs, token_list, token_count, pos_list,
 			      metablks_count);
 	if (ret)
 		goto out;
@@ -987,11 +935,8 @@ static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 	*dirsp = (struct fs_dir_stream *)dirs;
 
 out:
-	for (j = 0; j < token_count; j++)
-		free(token_list[j]);
-	free(token_list);
+	arena_uninit(&arena);
 	free(pos_list);
-	free(path);
 	if (ret) {
 		free(inode_table);
 		free(dirs);
@@ -1375,6 +1320,7 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 	struct squashfs_base_inode *base;
 	struct squashfs_reg_inode *reg;
 	unsigned long dest_len;
+	struct arena arena;
 	struct fs_dirent *dent;
 	unsigned char *ipos;
 	size_t buf_size;
@@ -1461,9 +1407,10 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 		}
 
 		symlink = (struct squashfs_symlink_inode *)ipos;
-		resolved = sqfs_resolve_symlink(symlink, filename);
+		arena_init(&arena, 0);
+		resolved = sqfs_resolve_symlink(&arena, symlink, filename);
 		ret = sqfs_read_nest(resolved, buf, offset, len, actread);
-		free(resolved);
+		arena_uninit(&arena);
 		goto out;
 	case SQFS_BLKDEV_TYPE:
 	case SQFS_CHRDEV_TYPE:
@@ -1654,6 +1601,7 @@ static int sqfs_size_nest(const char *filename, loff_t *size)
 	struct squashfs_reg_inode *reg;
 	char *dir, *file, *resolved;
 	struct fs_dirent *dent;
+	struct arena arena;
 	unsigned char *ipos;
 	int ret, i_number;
 
@@ -1717,9 +1665,10 @@ static int sqfs_size_nest(const char *filename, loff_t *size)
 		}
 
 		symlink = (struct squashfs_symlink_inode *)ipos;
-		resolved = sqfs_resolve_symlink(symlink, filename);
+		arena_init(&arena, 0);
+		resolved = sqfs_resolve_symlink(&arena, symlink, filename);
 		ret = sqfs_size(resolved, size);
-		free(resolved);
+		arena_uninit(&arena);
 		break;
 	case SQFS_BLKDEV_TYPE:
 	case SQFS_CHRDEV_TYPE:
@@ -721,23 +721,22 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+/**
+ * decompress_block - decompress a data node into a block of the destination
+ * @inode: inode the data node belongs to
+ * @addr: destination, which must hold UBIFS_BLOCK_SIZE bytes
+ * @block: block number, for messages
+ * @dn: data node to decompress
+ *
+ * Return: 0 on success, -EINVAL if the data node is bad
+ */
+static int decompress_block(struct inode *inode, void *addr,
+			    unsigned int block, struct ubifs_data_node *dn)
 {
 	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -768,6 +767,91 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decompress_block(inode, addr, block, dn);
+}
+
+/**
+ * read_bulk - read a run of blocks of a file with one flash read
+ * @c: UBIFS file-system description object
+ * @inode: inode of the file
+ * @addr: destination buffer
+ * @block: first block to read
+ * @count: maximum number of blocks to read, which must all be whole blocks
+ *	   within the file
+ *
+ * Data nodes of a file which is written in one go, such as a kernel image,
+ * mostly follow each other in the same LEB. Look up the keys of as many of
+ * them as fit in the bulk-read buffer with one walk of the TNC, read them with
+ * one UBI read and decompress each one straight into @addr. Holes between the
+ * nodes are zeroed.
+ *
+ * Return: number of blocks read, which is at least 1, or a negative error
+ * code
+ */
+static int read_bulk(struct ubifs_info *c, struct inode *inode, void *addr,
+		     unsigned int block, unsigned int count)
+{
+	struct bu_info *bu = &c->bu;
+	struct ubifs_data_node *dn;
+	unsigned int blk_cnt, i;
+	int err, n, offs;
+
+	mutex_lock(&c->bu_mutex);
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	bu->buf_len = c->max_bu_buf_len;
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err)
+		goto out;
+
+	if (!bu->cnt) {
+		/* There is no more data, so the rest of the file is a hole */
+		memset(addr, 0, count << UBIFS_BLOCK_SHIFT);
+		err = count;
+		goto out;
+	}
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		goto out;
+
+	blk_cnt = min_t(unsigned int, bu->blk_cnt, count);
+	offs = bu->zbranch[0].offs;
+	n = 0;
+	for (i = 0; i < blk_cnt; i++, addr += UBIFS_BLOCK_SIZE) {
+		if (n < bu->cnt &&
+		    key_block(c, &bu->zbranch[n].key) == block + i) {
+			dn = bu->buf + (bu->zbranch[n].offs - offs);
+			err = decompress_block(inode, addr, block + i, dn);
+			if (err)
+				goto out;
+			n++;
+		} else {
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		}
+	}
+	err = blk_cnt;
+
+out:
+	mutex_unlock(&c->bu_mutex);
+	return err;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -944,6 +1028,23 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	page.index = offset / PAGE_SIZE;
 	page.inode = inode;
 	for (i = 0; i < count; i++) {
+		/*
+		 * Read all but the last block in runs, if bulk-read is
+		 * enabled. The last one may need to be shortened.
+		 */
+		if (c->bulk_read && count - i > 1) {
+			err = read_bulk(c, inode, page.addr, page.index,
+					count - i - 1);
+			if (err < 0)
+				break;
+
+			page.addr += err * PAGE_SIZE;
+			page.index += err;
+			i += err - 1;
+			err = 0;
+			continue;
+		}
+
 		/*
 		 * Make sure to not read beyond the requested size
 		 */
@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Bump allocator for groups of allocations which are freed together
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <alist.h>
+#include <stdbool.h>
+#include <linux/bitops.h>
+#include <linux/types.h>
+
+/**
+ * struct arena - scope of allocations which share a lifetime
+ *
+ * An arena hands out memory by bumping a pointer through a chunk obtained from
+ * malloc(). When the chunk is full a new one is allocated. Individual
+ * allocations cannot be freed; instead everything in the arena is released at
+ * once by arena_uninit().
+ *
+ * This suits parsers and path-walkers which create many small temporaries
+ * (tokens, strings, nodes) that all die at the same time. Compared to calling
+ * malloc() for each one, this is faster and avoids fragmenting the heap with
+ * small holes.
+ *
+ * Allocations larger than a quarter of the chunk size are given a chunk of
+ * their own, so that they do not waste the remainder of the current chunk.
+ *
+ * @chunks: List of chunks (void *) allocated by this arena
+ * @ptr: Next free byte in the current chunk
+ * @left: Number of bytes left in the current chunk
+ * @chunk_size: Size of each chunk in bytes, 0 to use ARENA_CHUNK_SIZE
+ * @used: Total number of bytes handed out by the arena (for statistics)
+ * @flags: flags for the arena (ARENAF_...)
+ */
+struct arena {
+	struct alist chunks;
+	void *ptr;
+	size_t left;
+	uint chunk_size;
+	size_t used;
+	uint flags;
+};
+
+/**
+ * enum arena_flags - Flags for the arena
+ *
+ * @ARENAF_FAIL: true if any allocation has failed. The arena can still be used,
+ * but the caller can check this once at the end instead of after each call
+ */
+enum arena_flags {
+	ARENAF_FAIL	= BIT(0),
+};
+
+enum {
+	ARENA_CHUNK_SIZE	= 4096,	/* default chunk size */
+	ARENA_ALIGN		= 2 * sizeof(void *),
+};
+
+/**
+ * arena_init() - Set up a new arena
+ *
+ * No memory is allocated until the first call to arena_alloc()
+ *
+ * @arena: Arena to set up
+ * @chunk_size: Size of each chunk to allocate, or 0 for ARENA_CHUNK_SIZE
+ */
+void arena_init(struct arena *arena, uint chunk_size);
+
+/**
+ * arena_uninit() - Free all memory allocated by the arena
+ *
+ * All pointers previously returned by the arena become invalid. The arena is
+ * left in the initialised state, so can be used again.
+ *
+ * @arena: Arena to free
+ */
+void arena_uninit(struct arena *arena);
+
+/**
+ * arena_alloc() - Allocate memory from an arena
+ *
+ * The memory is aligned to ARENA_ALIGN and is not zeroed
+ *
+ * @arena: Arena to allocate from
+ * @size: Number of bytes to allocate
+ * Return: pointer to the memory, or NULL if out of memory
+ */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/**
+ * arena_zalloc() - Allocate zeroed memory from an arena
+ *
+ * @arena: Arena to allocate from
+ * @size: Number of bytes to allocate
+ * Return: pointer to the memory, or NULL if out of memory
+ */
+void *arena_zalloc(struct arena *arena, size_t size);
+
+/**
+ * arena_strndup() - Copy part of a string into an arena
+ *
+ * Copies up to @len characters of @str and adds a nul terminator
+ *
+ * @arena: Arena to allocate from
+ * @str: String to copy
+ * @len: Maximum number of characters to copy
+ * Return: pointer to the new string, or NULL if out of memory
+ */
+char *arena_strndup(struct arena *arena, const char *str, size_t len);
+
+/**
+ * arena_strdup() - Copy a string into an arena
+ *
+ * @arena: Arena to allocate from
+ * @str: String to copy
+ * Return: pointer to the new string, or NULL if out of memory
+ */
+char *arena_strdup(struct arena *arena, const char *str);
+
+/**
+ * arena_err() - Check if any allocation in the arena has failed
+ *
+ * @arena: Arena to check
+ * Return: false if OK, true if any previous allocation failed
+ */
+static inline bool arena_err(struct arena *arena)
+{
+	return arena->flags & ARENAF_FAIL;
+}
+
+/**
+ * arena_used() - Get the number of bytes handed out by an arena
+ *
+ * @arena: Arena to check
+ * Return: total size of all allocations, including alignment padding
+ */
+static inline size_t arena_used(struct arena *arena)
+{
+	return arena->used;
+}
+
+/**
+ * arena_chunk_count() - Get the number of chunks allocated by an arena
+ *
+ * @arena: Arena to check
+ * Return: number of malloc() allocations made for chunks
+ */
+static inline uint arena_chunk_count(struct arena *arena)
+{
+	return arena->chunks.count;
+}
+
+#endif /* __ARENA_H */
@@ -284,6 +284,15 @@ struct global_data {
 	 */
 	void *trace_buff;
 #endif
+#ifdef CONFIG_TRACE_SAMPLE
+	/**
+	 * @sample_buff: sample buffer
+	 *
+	 * When the sampling profiler is enabled, this field points to the
+	 * buffer recording the samples.
+	 */
+	void *sample_buff;
+#endif
 #if CONFIG_IS_ENABLED(SYS_I2C_LEGACY)
 	/**
 	 * @cur_i2c_bus: currently used I2C bus
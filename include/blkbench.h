@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Throughput and latency measurement for block devices
+ */
+
+#ifndef _BLKBENCH_H
+#define _BLKBENCH_H
+
+#include <blk.h>
+#include <linux/bitops.h>
+
+/**
+ * enum blk_bench_flags - Options for a benchmark run
+ *
+ * @BLK_BENCH_WRITE: Write to the device instead of reading. This destroys the
+ *	contents of the region being tested
+ * @BLK_BENCH_RANDOM: Pick a random aligned offset within the region for each
+ *	transfer, instead of working through it sequentially
+ * @BLK_BENCH_NOCACHE: Drop the block cache before each transfer, so that the
+ *	device itself is measured rather than the cache
+ */
+enum blk_bench_flags {
+	BLK_BENCH_WRITE		= BIT(0),
+	BLK_BENCH_RANDOM	= BIT(1),
+	BLK_BENCH_NOCACHE	= BIT(2),
+};
+
+/**
+ * struct blk_bench_params - Parameters for a benchmark run
+ *
+ * @start: First block of the region to use
+ * @region: Number of blocks in the region, 0 to use the rest of the device
+ * @blocks: Number of blocks in each transfer
+ * @count: Number of transfers to make
+ * @seed: Seed for the random offsets if BLK_BENCH_RANDOM is used, 0 for a
+ *	fixed default so that runs can be compared
+ * @flags: Options for the run (enum blk_bench_flags)
+ */
+struct blk_bench_params {
+	lbaint_t start;
+	lbaint_t region;
+	uint blocks;
+	uint count;
+	uint seed;
+	uint flags;
+};
+
+/**
+ * struct blk_bench_result - Results of a benchmark run
+ *
+ * Latencies are measured for each transfer in microseconds. The percentiles
+ * use the nearest-rank method.
+ *
+ * @ops: Number of transfers completed
+ * @bytes: Number of bytes transferred
+ * @total_us: Total time taken for all transfers
+ * @min_us: Shortest transfer
+ * @p50_us: Median transfer time
+ * @p90_us: 90th-percentile transfer time
+ * @p99_us: 99th-percentile transfer time
+ * @max_us: Longest transfer
+ */
+struct blk_bench_result {
+	uint ops;
+	u64 bytes;
+	ulong total_us;
+	ulong min_us;
+	ulong p50_us;
+	ulong p90_us;
+	ulong p99_us;
+	ulong max_us;
+};
+
+/**
+ * blk_bench_run() - Measure transfers on a block device
+ *
+ * Makes @params->count transfers of @params->blocks blocks each, to or from
+ * @buf, within the region given by @params
+ *
+ * @desc: Block device to test
+ * @params: Parameters for the run
+ * @buf: Buffer of at least @params->blocks * @desc->blksz bytes
+ * @result: Returns the results
+ * Return: 0 if OK, -EINVAL if the parameters do not fit the device, -ENOMEM
+ * if out of memory, -EIO if a transfer failed (in which case @result->ops
+ * indicates how many succeeded)
+ */
+int blk_bench_run(struct blk_desc *desc, const struct blk_bench_params *params,
+		  void *buf, struct blk_bench_result *result);
+
+/**
+ * blk_bench_show() - Show the results of a benchmark run
+ *
+ * @desc: Block device which was tested
+ * @params: Parameters used for the run
+ * @result: Results to show
+ */
+void blk_bench_show(struct blk_desc *desc,
+		    const struct blk_bench_params *params,
+		    const struct blk_bench_result *result);
+
+#endif
@@ -153,6 +153,8 @@ enum bloblist_tag_t {
 	BLOBLISTT_U_BOOT_SPL_HANDOFF	= 0xfff000, /* Hand-off info from SPL */
 	BLOBLISTT_VBE			= 0xfff001, /* VBE per-phase state */
 	BLOBLISTT_U_BOOT_VIDEO		= 0xfff002, /* Video info from SPL */
+	BLOBLISTT_U_BOOT_LOG		= 0xfff003, /* Binary log buffer */
+	BLOBLISTT_U_BOOT_PROF		= 0xfff004, /* Boot-time profile */
 };
 
 /**
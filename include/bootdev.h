@@ -66,7 +66,8 @@ struct bootdev_hunter;
  *
  * @info: Info structure describing this hunter
  * @show: true to show information from the hunter
- * Returns: 0 if OK, -ENOENT on device not found, otherwise -ve on error
+ * Returns: 0 if OK, -ENOENT on device not found, otherwise -ve on error. For
+ * the @poll method, -EAGAIN means that the hunt is still in progress
  */
 typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
 
@@ -77,6 +78,13 @@ typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
  * @uclass: Uclass ID for the media associated with this bootdev
  * @drv: bootdev driver for the things found by this hunter
  * @hunt: Function to call to hunt for bootdevs of this type (NULL if none)
+ * @start: Function to call to start hunting, for hunters which can run
+ *	alongside others (NULL if none). This sets off the hunt without waiting
+ *	for the hardware and returns 0, or returns -ve on error. If this is
+ *	provided, @hunt is not used
+ * @poll: Function to call to continue a hunt set off by @start. It must not
+ *	wait for the hardware, but do what is ready and return -EAGAIN if the
+ *	hunt is still in progress, otherwise a result as @hunt does
  *
  * Some bootdevs are not visible until other devices are enumerated. For
  * example, USB bootdevs only appear when the USB bus is enumerated.
@@ -87,12 +95,20 @@ typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
  *
  * This struct holds information about the bootdev so we can determine the probe
  * order and how to hunt for bootdevs of this type
+ *
+ * Hunting may involve long waits for hardware, such as link training or port
+ * debouncing. A hunter which provides @start and @poll is run as a state
+ * machine, so that the waits of several hunters overlap: bootstd sets it off
+ * before running the other hunters and polls it in between them, rather than
+ * waiting for it to finish.
  */
 struct bootdev_hunter {
 	enum bootdev_prio_t prio;
 	enum uclass_id uclass;
 	struct driver *drv;
 	bootdev_hunter_func hunt;
+	bootdev_hunter_func start;
+	bootdev_hunter_func poll;
 };
 
 /* declare a new bootdev hunter */
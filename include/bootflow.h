@@ -255,6 +255,9 @@ enum bootflow_meth_flags_t {
  *	happens before the normal ones)
  * @method_flags: flags controlling which methods should be used for this @dev
  * (enum bootflow_meth_flags_t)
+ * @start: Time at which the scan started, from get_timer(), or 0 if there was
+ *	no scan. This is recorded by bootflow_remember() so that the time saved
+ *	by not scanning can be reported
  */
 struct bootflow_iter {
 	int flags;
@@ -276,6 +279,7 @@ struct bootflow_iter {
 	struct udevice **method_order;
 	bool doing_global;
 	int method_flags;
+	ulong start;
 };
 
 /**
@@ -416,6 +420,84 @@ int bootflow_read_all(struct bootflow *bflow);
  */
 int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow);
 
+/**
+ * bootflow_remember() - Record a bootflow so that it is tried first next time
+ *
+ * This records the bootdev, partition, bootmeth and filename of @bflow, along
+ * with the time taken by the scan which found it, in the "bootflow_last"
+ * environment variable. If there was no scan, the time already recorded is
+ * kept. If this changes the variable and
+ * CONFIG_BOOTFLOW_REMEMBER_SAVE is enabled, the environment is saved.
+ * Bootflows from global bootmeths are not recorded, since they have no
+ * bootdev.
+ *
+ * @iter: Iterator used to find @bflow, or NULL if none
+ * @bflow: Bootflow which is about to be booted
+ * Return: 0 if OK (including if nothing needed to be recorded), -ve on error
+ */
+int bootflow_remember(const struct bootflow_iter *iter,
+		      const struct bootflow *bflow);
+
+/**
+ * bootflow_scan_remembered() - Get the bootflow recorded by bootflow_remember()
+ *
+ * This looks at only the recorded bootdev, partition and bootmeth, without
+ * hunting or scanning any other bootdevs. The bootdev must already exist, so
+ * this does not help with media which needs hunting, such as USB.
+ *
+ * @iter: Place to store private info (inited by this call), which must be
+ *	freed with bootflow_iter_uninit() even if this fails
+ * @bflow: Returns the bootflow, which must be freed with bootflow_free()
+ * @scan_msp: Returns the time taken by the scan which found the bootflow
+ * Return: 0 if OK, -ENOENT if nothing is recorded, other -ve on error
+ */
+int bootflow_scan_remembered(struct bootflow_iter *iter,
+			     struct bootflow *bflow, ulong *scan_msp);
+
+/**
+ * struct bootflow_tried - identifies a bootflow which has failed to boot
+ *
+ * This is used so that the full scan which follows
+ * bootflow_boot_remembered() does not try the same bootflow again
+ *
+ * @dev: Bootdev of the bootflow, or NULL if none was tried
+ * @method: Bootmeth of the bootflow
+ * @part: Partition number of the bootflow
+ */
+struct bootflow_tried {
+	struct udevice *dev;
+	struct udevice *method;
+	int part;
+};
+
+/**
+ * bootflow_boot_remembered() - Try to boot the bootflow used last time
+ *
+ * This gets the bootflow recorded by bootflow_remember() and boots it, so that
+ * a full scan is only needed if that fails. The time taken is recorded by
+ * bootstage as "bootflow_last".
+ *
+ * @tried: Returns the bootflow which was tried, with @tried->dev set to NULL
+ *	if none was found. Pass this to bootflow_was_tried() while scanning, to
+ *	skip it
+ * Return: does not return if the boot succeeds, else -ve error
+ */
+int bootflow_boot_remembered(struct bootflow_tried *tried);
+
+/**
+ * bootflow_was_tried() - Check if a bootflow was tried already
+ *
+ * @tried: Bootflow tried by bootflow_boot_remembered()
+ * @bflow: Bootflow to check
+ * Return: true if @bflow is the one in @tried, false if not
+ */
+static inline bool bootflow_was_tried(const struct bootflow_tried *tried,
+				      const struct bootflow *bflow)
+{
+	return tried->dev && bflow->dev == tried->dev &&
+		bflow->method == tried->method && bflow->part == tried->part;
+}
+
 /**
  * bootflow_state_get_name() - Get the name of a bootflow state
  *
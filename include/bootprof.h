@@ -0,0 +1,182 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Boot-time profiler, recording the time spent in each driver, uclass,
+ * initcall and command
+ *
+ * The records are kept in the bloblist so that they survive relocation and
+ * can be passed to the OS.
+ */
+
+#ifndef __BOOTPROF_H
+#define __BOOTPROF_H
+
+#include <linux/types.h>
+
+struct driver;
+
+#define BOOTPROF_VERSION	1
+
+/* Maximum length of a record name, including the nul terminator */
+#define BOOTPROF_NAME_LEN	28
+
+/**
+ * enum bootprof_type - type of a profile record
+ *
+ * @BOOTPROFT_DRIVER: Driver, with the time in each enum bootprof_phase
+ * @BOOTPROFT_UCLASS: Uclass, the total of the time for all its drivers
+ * @BOOTPROFT_INITCALL: Function in an initcall list, using BOOTPROFP_CALL
+ * @BOOTPROFT_EVENT: Event in an initcall list, using BOOTPROFP_CALL
+ * @BOOTPROFT_CMD: Command, using BOOTPROFP_CALL
+ */
+enum bootprof_type {
+	BOOTPROFT_DRIVER,
+	BOOTPROFT_UCLASS,
+	BOOTPROFT_INITCALL,
+	BOOTPROFT_EVENT,
+	BOOTPROFT_CMD,
+};
+
+/**
+ * enum bootprof_phase - phase which the time is recorded against
+ *
+ * @BOOTPROFP_BIND: Binding a device (device_bind())
+ * @BOOTPROFP_OF_TO_PLAT: Reading platform data (device_of_to_plat())
+ * @BOOTPROFP_PROBE: Probing a device (device_probe())
+ * @BOOTPROFP_CALL: Running an initcall or command
+ */
+enum bootprof_phase {
+	BOOTPROFP_BIND,
+	BOOTPROFP_OF_TO_PLAT,
+	BOOTPROFP_PROBE,
+
+	BOOTPROFP_COUNT,
+	BOOTPROFP_CALL = 0,
+};
+
+/**
+ * struct bootprof_stat - time spent in one phase
+ *
+ * @count: Number of times the phase was run
+ * @time_us: Total time, in microseconds
+ * @self_us: Time excluding other profiled phases which were run as part of
+ *	this one, e.g. probing a parent device, in microseconds
+ */
+struct bootprof_stat {
+	u32 count;
+	u32 time_us;
+	u32 self_us;
+};
+
+/**
+ * struct bootprof_rec - a profile record
+ *
+ * @name: Name of the driver, uclass, event or command, or the address of the
+ *	initcall function (before relocation), as a hex string
+ * @type: Record type (enum bootprof_type)
+ * @uclass_id: Uclass ID for BOOTPROFT_DRIVER and BOOTPROFT_UCLASS records
+ * @key: Value identifying the record within its type (e.g. driver index)
+ * @stat: Time spent in each phase (enum bootprof_phase)
+ */
+struct bootprof_rec {
+	char name[BOOTPROF_NAME_LEN];
+	u8 type;
+	u8 reserved;
+	u16 uclass_id;
+	u32 key;
+	struct bootprof_stat stat[BOOTPROFP_COUNT];
+};
+
+/**
+ * struct bootprof_hdr - header of the profile data in the bloblist
+ *
+ * The records follow this header
+ *
+ * @version: BOOTPROF_VERSION
+ * @count: Number of records in use
+ * @max: Number of records there is space for
+ * @acc_us: Total self time recorded so far, used to work out the self time of
+ *	nested phases
+ * @dropped: Number of times a record was needed but there was no space
+ */
+struct bootprof_hdr {
+	u32 version;
+	u16 count;
+	u16 max;
+	u32 acc_us;
+	u32 dropped;
+};
+
+/**
+ * struct bootprof_ctx - context for timing a phase
+ *
+ * This is held by the caller between bootprof_start() and bootprof_end...()
+ *
+ * @start_us: Time when the phase started
+ * @acc_us: Value of bootprof_hdr.acc_us when the phase started
+ * @active: true if the phase is being timed
+ */
+struct bootprof_ctx {
+	ulong start_us;
+	u32 acc_us;
+	bool active;
+};
+
+#if CONFIG_IS_ENABLED(BOOTPROF)
+/**
+ * bootprof_start() - Start timing a phase
+ *
+ * @ctx: Context to set up
+ */
+void bootprof_start(struct bootprof_ctx *ctx);
+
+/**
+ * bootprof_end_dev() - Finish timing a driver phase
+ *
+ * This adds the time to the records for the driver and its uclass
+ *
+ * @ctx: Context passed to bootprof_start()
+ * @phase: Phase which was run (BOOTPROFP_BIND, etc.)
+ * @drv: Driver which was used
+ */
+void bootprof_end_dev(struct bootprof_ctx *ctx, enum bootprof_phase phase,
+		      const struct driver *drv);
+
+/**
+ * bootprof_end_call() - Finish timing an initcall, event or command
+ *
+ * @ctx: Context passed to bootprof_start()
+ * @type: Record type (BOOTPROFT_INITCALL, BOOTPROFT_EVENT or BOOTPROFT_CMD)
+ * @key: Function address for an initcall, event type for an event, ignored
+ *	for a command
+ * @name: Name of the event or command, or NULL to use @key
+ */
+void bootprof_end_call(struct bootprof_ctx *ctx, enum bootprof_type type,
+		       ulong key, const char *name);
+
+/**
+ * bootprof_report() - Show the profile records
+ */
+void bootprof_report(void);
+#else
+static inline void bootprof_start(struct bootprof_ctx *ctx)
+{
+}
+
+static inline void bootprof_end_dev(struct bootprof_ctx *ctx,
+				    enum bootprof_phase phase,
+				    const struct driver *drv)
+{
+}
+
+static inline void bootprof_end_call(struct bootprof_ctx *ctx,
+				     enum bootprof_type type, ulong key,
+				     const char *name)
+{
+}
+
+static inline void bootprof_report(void)
+{
+}
+#endif
+
+#endif
@@ -213,6 +213,9 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_BOOTFLOW_LAST,
+	BOOTSTAGE_ID_ACCUM_SERIAL_TX,
+	BOOTSTAGE_ID_ACCUM_FDT_FIXUP,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
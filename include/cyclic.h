@@ -67,6 +67,9 @@ void cyclic_register(struct cyclic_info *cyclic, cyclic_func_t func,
 /**
  * cyclic_unregister - Unregister a cyclic function
  *
+ * This does nothing if the function is not registered, e.g. because it was
+ * already removed by cyclic_unregister_all()
+ *
  * @cyclic: Pointer to cyclic_struct of the function that shall be removed
  */
 void cyclic_unregister(struct cyclic_info *cyclic);
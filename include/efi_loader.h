@@ -16,6 +16,7 @@
 #include <image.h>
 #include <pe.h>
 #include <linux/list.h>
+#include <linux/rbtree.h>
 #include <linux/sizes.h>
 #include <linux/oid_registry.h>
 
@@ -410,12 +411,16 @@ struct efi_open_protocol_info_item {
  * @guid:		GUID of the protocol
  * @protocol_interface:	protocol interface
  * @open_infos:		link to the list of open protocol info items
+ * @handle:		handle on which the protocol is installed
+ * @index_link:		link to the list of interfaces of the same protocol
  */
 struct efi_handler {
 	struct list_head link;
 	const efi_guid_t guid;
 	void *protocol_interface;
 	struct list_head open_infos;
+	efi_handle_t handle;
+	struct list_head index_link;
 };
 
 /**
@@ -439,6 +444,7 @@ enum efi_object_type {
  * struct efi_object - dereferenced EFI handle
  *
  * @link:	pointers to put the handle into a linked list
+ * @node:	node in the tree of handles, used to validate a handle
  * @protocols:	linked list with the protocol interfaces installed on this
  *		handle
  * @type:	image type if the handle relates to an image
@@ -457,6 +463,8 @@ enum efi_object_type {
 struct efi_object {
 	/* Every UEFI object is part of a global object list */
 	struct list_head link;
+	/* Every UEFI object is also in a tree sorted by address */
+	struct rb_node node;
 	/* The list of protocols */
 	struct list_head protocols;
 	enum efi_object_type type;
@@ -725,6 +733,8 @@ efi_status_t EFIAPI efi_start_image(efi_handle_t image_handle,
 				    u16 **exit_data);
 /* Unload image */
 efi_status_t EFIAPI efi_unload_image(efi_handle_t image_handle);
+/* Get the list of interfaces of a protocol on all handles */
+struct list_head *efi_protocol_handlers(const efi_guid_t *protocol);
 /* Find a protocol on a handle */
 efi_status_t efi_search_protocol(const efi_handle_t handle,
 				 const efi_guid_t *protocol_guid,
@@ -102,6 +102,12 @@ efi_status_t efi_query_variable_info_int(u32 attributes,
  */
 #define EFI_VAR_FILE_MAGIC 0x0161566966456255 /* UbEfiVa, version 1 */
 
+/*
+ * This constant identifies a journal record appended to the file for storing
+ * UEFI variables, see struct efi_var_journal.
+ */
+#define EFI_VAR_JOURNAL_MAGIC 0x016a566966456255 /* UbEfiVj, version 1 */
+
 /**
  * struct efi_var_entry - UEFI variable file entry
  *
@@ -136,6 +142,26 @@ struct efi_var_file {
 	struct efi_var_entry var[];
 };
 
+/**
+ * struct efi_var_journal - journal record for the file storing UEFI variables
+ *
+ * When a variable is changed, a record holding its new value is appended to
+ * the file instead of rewriting the whole file. A deleted variable is recorded
+ * with no data. The file consists of a struct efi_var_file, whose length
+ * covers only the variables it holds, followed by any number of records.
+ *
+ * @magic:	identifies the record, takes value %EFI_VAR_JOURNAL_MAGIC
+ * @length:	length including header, multiple of 8
+ * @crc32:	CRC32 without header
+ * @var:	variable
+ */
+struct efi_var_journal {
+	u64 magic;
+	u32 length;
+	u32 crc32;
+	struct efi_var_entry var[];
+};
+
 /**
  * efi_var_to_file() - save non-volatile variables as file
  *
@@ -145,6 +171,19 @@ struct efi_var_file {
  */
 efi_status_t efi_var_to_file(void);
 
+/**
+ * efi_var_log_to_file() - save a changed non-volatile variable to file
+ *
+ * A journal record for the variable is appended to file ubootefi.var. The
+ * whole file is written instead if it has not been read or written yet, or
+ * if the journal has grown too large.
+ *
+ * @name:	name of the variable
+ * @guid:	vendor GUID of the variable
+ * Return:	status code
+ */
+efi_status_t efi_var_log_to_file(const u16 *name, const efi_guid_t *guid);
+
 /**
  * efi_var_collect() - collect variables in buffer
  *
@@ -12,6 +12,7 @@
 #include <asm/u-boot.h>
 #include <linux/libfdt.h>
 #include <abuf.h>
+#include <alist.h>
 
 /**
  * arch_fixup_fdt() - write arch-specific information to fdt
@@ -459,6 +460,92 @@ int fdt_add_fb_mem_rsv(void *blob);
 
 int fdt_overlay_apply_verbose(void *fdt, void *fdto);
 
+/**
+ * struct fdt_overlay_batch - Indexes of a base tree for applying overlays
+ *
+ * This allows a series of overlays to be applied to the same base tree without
+ * scanning the whole tree for each one. See boot/fdt_overlay.c
+ *
+ * @phandles: Index of phandles (struct ov_phandle), sorted by phandle
+ * @paths: Index of absolute paths (struct ov_path)
+ * @symbols: Index of symbols (struct ov_symbol), sorted by label
+ * @struct_size: Size of the structure block after the last overlay, used to
+ *	check that the tree has not been changed between overlays
+ * @valid: true if the indexes are up to date
+ */
+struct fdt_overlay_batch {
+	struct alist phandles;
+	struct alist paths;
+	struct alist symbols;
+	int struct_size;
+	bool valid;
+};
+
+#if CONFIG_IS_ENABLED(OF_LIBFDT_OVERLAY_BATCH)
+/**
+ * fdt_overlay_batch_init() - Set up to apply a series of overlays
+ *
+ * The indexes are built when the first overlay is applied
+ *
+ * @batch: Batch to set up
+ */
+void fdt_overlay_batch_init(struct fdt_overlay_batch *batch);
+
+/**
+ * fdt_overlay_batch_apply() - Apply an overlay as part of a series
+ *
+ * This gives the same result as fdt_overlay_apply() but uses indexes of the
+ * base tree which are kept for the next overlay. Between calls the caller may
+ * resize the base tree, e.g. with fdt_open_into(), fdt_pack() or
+ * fdt_shrink_to_minimum(), but must not change its contents, since the indexes
+ * would then be out of date. The FIT and PXE/extlinux callers only resize the
+ * tree between overlays. To change the tree, finish the batch with
+ * fdt_overlay_batch_uninit() and start a new one.
+ *
+ * @batch: Batch to use
+ * @fdt: Base tree
+ * @fdto: Overlay to apply; this is damaged, as with fdt_overlay_apply()
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+int fdt_overlay_batch_apply(struct fdt_overlay_batch *batch, void *fdt,
+			    void *fdto);
+
+/**
+ * fdt_overlay_batch_uninit() - Free the memory used by a batch
+ *
+ * @batch: Batch to free
+ */
+void fdt_overlay_batch_uninit(struct fdt_overlay_batch *batch);
+#else
+static inline void fdt_overlay_batch_init(struct fdt_overlay_batch *batch)
+{
+}
+
+static inline int fdt_overlay_batch_apply(struct fdt_overlay_batch *batch,
+					  void *fdt, void *fdto)
+{
+	return fdt_overlay_apply(fdt, fdto);
+}
+
+static inline void fdt_overlay_batch_uninit(struct fdt_overlay_batch *batch)
+{
+}
+#endif
+
+/**
+ * fdt_overlay_batch_apply_verbose() - Apply an overlay in a series, with errors
+ *
+ * This is the same as fdt_overlay_apply_verbose() but uses the indexes in
+ * @batch
+ *
+ * @batch: Batch to use, or NULL to use fdt_overlay_apply()
+ * @fdt: Base tree
+ * @fdto: Overlay to apply
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+int fdt_overlay_batch_apply_verbose(struct fdt_overlay_batch *batch,
+				    void *fdt, void *fdto);
+
 int fdt_valid(struct fdt_header **blobp);
 
 /**
@@ -252,6 +252,59 @@ struct fs_dirent *fs_readdir(struct fs_dir_stream *dirs);
  */
 void fs_closedir(struct fs_dir_stream *dirs);
 
+/**
+ * struct fs_file - Structure representing an opened file
+ *
+ * Struct fs_file should be treated opaque to the user of fs layer, except
+ * for @size. The fields @desc, @part and @fstype are used by the fs layer.
+ * File system drivers pass additional private fields with the pointers
+ * to this structure, e.g. to avoid looking up the path again on each read.
+ *
+ * @desc:	block device descriptor
+ * @part:	partition number
+ * @fstype:	filesystem type (FS_TYPE_...)
+ * @size:	size of the file in bytes, when it was opened
+ */
+struct fs_file {
+	struct blk_desc *desc;
+	int part;
+	int fstype;
+	loff_t size;
+};
+
+/**
+ * fs_file_open() - Open a file for reading
+ *
+ * The path is looked up once and the resulting handle can then be used for
+ * any number of reads, without the filesystem needing to be set up again.
+ * The handle does not notice changes made to the file after it is opened.
+ *
+ * @filename:	full path of the file to open
+ * Return:
+ * A pointer to the open file or NULL on error and errno set appropriately
+ */
+struct fs_file *fs_file_open(const char *filename);
+
+/**
+ * fs_file_read() - Read from an open file
+ *
+ * @file:	the open file
+ * @buf:	buffer to read into
+ * @offset:	offset in the file from which to start reading
+ * @len:	the number of bytes to read. Use 0 to read the whole file
+ * @actread:	returns the actual number of bytes read
+ * Return:	0 if OK with valid @actread, -ve on error
+ */
+int fs_file_read(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread);
+
+/**
+ * fs_file_close() - Close an open file
+ *
+ * @file:	the open file, or NULL to do nothing
+ */
+void fs_file_close(struct fs_file *file);
+
 /**
  * fs_unlink - delete a file or directory
  *
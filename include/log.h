@@ -408,6 +408,9 @@ enum log_rec_flags {
  * @file: Name of file where the log record was generated (not allocated)
  * @func: Function where the log record was generated (not allocated)
  * @msg: Log message (allocated)
+ * @fmt: Format string for the message (not allocated). This and @args are
+ *	only valid for devices with LOGDF_RAW set
+ * @args: Arguments for @fmt
  */
 struct log_rec {
 	enum log_category_t cat;
@@ -417,12 +420,15 @@ struct log_rec {
 	const char *file;
 	const char *func;
 	const char *msg;
+	const char *fmt;
+	va_list *args;
 };
 
 struct log_device;
 
 enum log_device_flags {
 	LOGDF_ENABLE		= BIT(0),	/* Device is enabled */
+	LOGDF_RAW		= BIT(1),	/* Device uses fmt/args, not msg */
 };
 
 /**
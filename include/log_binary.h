@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Binary log buffer, decoded on the host by tools/logdecode.py
+ */
+
+#ifndef __LOG_BINARY_H
+#define __LOG_BINARY_H
+
+#include <linux/types.h>
+
+/* Magic number at the start of the buffer: 'LOGB' */
+#define LOG_BIN_MAGIC		0x42474f4c
+#define LOG_BIN_VERSION		1
+
+/* Largest record, including its arguments */
+#define LOG_BIN_MAX_REC		256
+
+/**
+ * struct log_bin_hdr - header of the binary log buffer
+ *
+ * The buffer is a ring of records which follows this header. Records are in
+ * order from @tail to @head and are never split across the end of the ring. If
+ * a record does not fit at the end, a record with a size of 0 marks the rest
+ * of the ring as unused and the record is written at the start. When the ring
+ * is full the oldest records are dropped.
+ *
+ * @magic: LOG_BIN_MAGIC
+ * @version: LOG_BIN_VERSION
+ * @size: Size of the ring in bytes
+ * @head: Offset in the ring where the next record is written
+ * @tail: Offset in the ring of the oldest record
+ * @count: Number of records in the ring
+ * @seq: Sequence number of the next record
+ * @dropped: Number of records dropped to make room for newer ones
+ */
+struct log_bin_hdr {
+	u32 magic;
+	u32 version;
+	u32 size;
+	u32 head;
+	u32 tail;
+	u32 count;
+	u32 seq;
+	u32 dropped;
+};
+
+/**
+ * enum log_bin_flags - flags for a binary log record
+ *
+ * These are in addition to the flags in enum log_rec_flags
+ *
+ * @LOG_BINF_MSG: The record holds the formatted message as a single string
+ *	argument, because the format string could not be stored
+ * @LOG_BINF_TRUNC: Some arguments were dropped since the record was too large
+ */
+enum log_bin_flags {
+	LOG_BINF_MSG	= BIT(6),
+	LOG_BINF_TRUNC	= BIT(7),
+};
+
+/**
+ * struct log_bin_rec - a record in the binary log buffer
+ *
+ * The arguments follow this header, in the order used by the format string.
+ * Each integer or pointer argument, including a '*' width or precision, is
+ * stored in 8 bytes. A string argument is stored as a nul-terminated string
+ * padded to a multiple of 8 bytes.
+ *
+ * The strings are given as offsets from log_bin_anchor so that they can be
+ * found in the U-Boot ELF file, wherever U-Boot is relocated to.
+ *
+ * @size: Size of the record in bytes, including its arguments, a multiple of
+ *	8, or 0 to mark the rest of the ring as unused
+ * @level: Log level (enum log_level_t)
+ * @flags: Flags (enum log_rec_flags and enum log_bin_flags)
+ * @cat: Log category (enum log_category_t)
+ * @line: Line number where the record was generated
+ * @seq: Sequence number of the record
+ * @fmt: Offset of the format string, or 0 if LOG_BINF_MSG is set
+ * @time_us: Time when the record was generated, in microseconds
+ * @file: Offset of the file name, or 0 if not known
+ * @func: Offset of the function name, or 0 if not known
+ */
+struct log_bin_rec {
+	u16 size;
+	u8 level;
+	u8 flags;
+	u16 cat;
+	u16 line;
+	u32 seq;
+	s32 fmt;
+	u64 time_us;
+	s32 file;
+	s32 func;
+};
+
+/* Symbol which the string offsets in struct log_bin_rec are relative to */
+extern const char log_bin_anchor[];
+
+#endif
@@ -548,4 +548,51 @@ long os_get_time_offset(void);
  */
 void os_set_time_offset(long offset);
 
+/**
+ * os_thread_create() - start a host thread
+ *
+ * The thread runs with all signals blocked, so that they continue to be
+ * handled by the main thread.
+ *
+ * @func:	function for the thread to run
+ * @arg:	argument to pass to @func
+ * @idp:	returns the ID of the thread, for os_thread_join()
+ * Return:	0 if OK, -errno on error
+ */
+int os_thread_create(void *(*func)(void *arg), void *arg, unsigned long *idp);
+
+/**
+ * os_thread_join() - wait for a host thread to exit
+ *
+ * @id:		ID of the thread, as returned by os_thread_create()
+ * Return:	0 if OK, -errno on error
+ */
+int os_thread_join(unsigned long id);
+
+/**
+ * os_workq_lock() - take the lock of the work queue
+ *
+ * This lock and its condition variable are used by the work-queue (see
+ * workq.h) to hand jobs to host threads.
+ */
+void os_workq_lock(void);
+
+/**
+ * os_workq_unlock() - release the lock of the work queue
+ */
+void os_workq_unlock(void);
+
+/**
+ * os_workq_wait() - wait for the work queue to change
+ *
+ * The lock must be held. It is released while waiting and taken again before
+ * returning.
+ */
+void os_workq_wait(void);
+
+/**
+ * os_workq_wake() - wake all threads waiting in os_workq_wait()
+ */
+void os_workq_wake(void);
+
 #endif
@@ -3,6 +3,7 @@
 #ifndef __PXE_UTILS_H
 #define __PXE_UTILS_H
 
+#include <arena.h>
 #include <bootflow.h>
 #include <linux/list.h>
 
@@ -26,7 +27,8 @@
 /*
  * Describes a single label given in a pxe file.
  *
- * Create these with the 'label_create' function given below.
+ * Create these with the 'label_create' function given below. They are
+ * allocated from the arena of the pxe_menu which holds them.
  *
  * name - the name of the menu as given on the 'menu label' line.
  * kernel_label - the kernel label, including FIT config if present.
@@ -71,6 +73,8 @@ struct pxe_label {
  *          interrupted.  If 1, always prompt for a choice regardless of
  *          timeout.
  * labels - a list of labels defined for the menu.
+ * arena - holds the labels and all strings parsed from the pxe file, so they
+ *         can be freed together by destroy_pxe_menu().
  */
 struct pxe_menu {
 	char *title;
@@ -80,6 +84,7 @@ struct pxe_menu {
 	int timeout;
 	int prompt;
 	struct list_head labels;
+	struct arena arena;
 };
 
 struct pxe_context;
@@ -1,6 +1,7 @@
 #ifndef __SERIAL_H__
 #define __SERIAL_H__
 
+#include <cyclic.h>
 #include <post.h>
 
 struct serial_device {
@@ -295,6 +296,14 @@ struct dm_serial_ops {
  * @buf:	Pointer to the RX buffer
  * @rd_ptr:	Read pointer in the RX buffer
  * @wr_ptr:	Write pointer in the RX buffer
+ *
+ * @tx_buf:	TX buffer
+ * @tx_rd_ptr:	Read pointer in the TX buffer
+ * @tx_wr_ptr:	Write pointer in the TX buffer
+ * @tx_dev:	Device which owns this TX buffer
+ * @tx_cyclic:	Cyclic function which drains the TX buffer
+ * @tx_active:	true if output goes through the TX buffer
+ * @tx_draining: true while the TX buffer is being drained
  */
 struct serial_dev_priv {
 	struct stdio_dev *sdev;
@@ -304,6 +313,15 @@ struct serial_dev_priv {
 	uint rd_ptr;
 	uint wr_ptr;
 #endif
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	char tx_buf[CONFIG_SERIAL_TX_BUFFER_SIZE];
+	uint tx_rd_ptr;
+	uint tx_wr_ptr;
+	struct udevice *tx_dev;
+	struct cyclic_info tx_cyclic;
+	bool tx_active;
+	bool tx_draining;
+#endif
 };
 
 /* Access the serial operations for a device */
@@ -28,12 +28,16 @@ enum {
 	 */
 	FUNC_SITE_SIZE	= 16,	/* distance between function sites */
 
+	/* Maximum number of return addresses recorded in a sample */
+	TRACE_SAMPLE_DEPTH	= 16,
+
 	TRACE_VERSION	= 1,
 };
 
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_SAMPLES,
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -89,6 +93,53 @@ struct trace_call {
 
 int trace_list_calls(void *buff, size_t buff_size, size_t *needed);
 
+/* A sample from the sampling profiler */
+struct trace_sample {
+	uint32_t time_us;	/* Time since the previous sample */
+	uint32_t depth;		/* Number of valid entries in pc[] */
+	uint32_t pc[TRACE_SAMPLE_DEPTH];	/* Code offsets, innermost first */
+};
+
+/**
+ * trace_sample() - Take a sample for the sampling profiler
+ *
+ * This does nothing until the sampling period has passed since the last
+ * sample
+ *
+ * @pc: Return address into the function being sampled
+ * @frame: Frame address of the function which holds @pc as its return
+ *	address, used to find the call chain with CONFIG_TRACE_SAMPLE_FP
+ */
+void trace_sample(uintptr_t pc, const void *frame);
+
+/**
+ * trace_list_samples() - Dump the samples into a buffer
+ *
+ * The buffer holds a struct trace_output_hdr followed by the samples, oldest
+ * first
+ *
+ * @buff: Buffer in which to place data
+ * @buff_size: Size of buffer
+ * @needed: Returns number of bytes used / needed
+ * Return: 0 if OK, -ENOSPC if space was exhausted, -ENOENT if sampling is
+ *	not set up
+ */
+int trace_list_samples(void *buff, size_t buff_size, size_t *needed);
+
+/* Print statistics about the samples */
+void trace_sample_print_stats(void);
+
+/**
+ * trace_sample_init() - Set up the sampling profiler
+ *
+ * This should be called after relocation
+ *
+ * @buff: Pointer to sample buffer
+ * @buff_size: Size of sample buffer
+ * Return: 0 if OK, -ENOSPC if the buffer is too small
+ */
+int trace_sample_init(void *buff, size_t buff_size);
+
 /**
  * Turn function tracing on and off
  *
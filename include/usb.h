@@ -97,6 +97,41 @@ enum {
 	PACKET_SIZE_64  = 3,
 };
 
+/* Maximum number of transfers in one call to usb_bulk_msg_queue() */
+#define USB_BULK_QUEUE_MAX	8
+
+/**
+ * struct usb_bulk_xfer - one transfer in a queue of bulk transfers
+ *
+ * @data:		Data to send or buffer to receive into
+ * @len:		Length of the transfer in bytes
+ * @actual_length:	Returns the number of bytes transferred
+ * @status:		Returns the status of the transfer, as for
+ *			struct usb_device, or USB_ST_NOT_PROC if it was not
+ *			carried out
+ */
+struct usb_bulk_xfer {
+	void *data;
+	int len;
+	int actual_length;
+	unsigned long status;
+};
+
+/**
+ * struct usb_ep_stats - transfer statistics for an endpoint
+ *
+ * @xfers:	Number of transfers made
+ * @errors:	Number of transfers which failed
+ * @bytes:	Number of bytes transferred
+ * @time_us:	Time spent on the transfers, in microseconds
+ */
+struct usb_ep_stats {
+	u32 xfers;
+	u32 errors;
+	u64 bytes;
+	u64 time_us;
+};
+
 /**
  * struct usb_device - information about a USB device
  *
@@ -157,6 +192,10 @@ struct usb_device {
 #endif
 	/* slot_id - for xHCI enabled devices */
 	unsigned int slot_id;
+#if CONFIG_IS_ENABLED(USB_EP_STATS)
+	/* bulk transfer statistics for each endpoint ([0] = IN, [1] = OUT) */
+	struct usb_ep_stats ep_stats[2][USB_MAXENDPOINTS];
+#endif
 #if CONFIG_IS_ENABLED(DM_USB)
 	struct udevice *dev;		/* Pointer to associated device */
 	struct udevice *controller_dev;	/* Pointer to associated controller */
@@ -263,6 +302,29 @@ int usb_host_eth_scan(int mode);
  */
 int usb_init(void);
 
+/**
+ * usb_init_start() - start initialising the USB controllers
+ *
+ * This probes the controllers and sets up their root hubs, so that their
+ * ports are powered, but does not wait for the ports. Call usb_init_poll()
+ * until it stops returning -EAGAIN to finish the job, doing other things in
+ * between as needed. This is only available with driver model.
+ *
+ * Return: 0 if OK, -ve on error
+ */
+int usb_init_start(void);
+
+/**
+ * usb_init_poll() - continue initialising the USB controllers
+ *
+ * Each call looks at the ports which are ready, using usb_hub_scan_poll(). The
+ * buses are shown once they have all been scanned.
+ *
+ * Return: -EAGAIN if there is more to do, 0 if done, -ENOENT if there are no
+ * USB devices
+ */
+int usb_init_poll(void);
+
 int usb_stop(void); /* stop the USB Controller */
 int usb_detect_change(void); /* detect if a USB device has been (un)plugged */
 
@@ -277,6 +339,27 @@ int usb_bulk_msg(struct usb_device *dev, unsigned int pipe,
 			void *data, int len, int *actual_length, int timeout);
 int usb_int_msg(struct usb_device *dev, unsigned long pipe,
 		void *buffer, int transfer_len, int interval, bool nonblock);
+int usb_bulk_msg_stream(struct usb_device *dev, unsigned int pipe,
+			unsigned int stream, void *data, int len,
+			int *actual_length, int timeout);
+
+/**
+ * usb_bulk_msg_queue() - Make several bulk transfers on one endpoint
+ *
+ * The transfers are made in order. Where the controller supports it they are
+ * all queued at once, so that there is no gap between them; otherwise they
+ * are made one at a time. This stops at the first transfer which fails.
+ *
+ * @dev:	USB device
+ * @pipe:	Bulk pipe to use
+ * @xfers:	Transfers to make, updated with the result of each
+ * @count:	Number of transfers, at most USB_BULK_QUEUE_MAX
+ * @timeout:	Timeout for each transfer in milliseconds
+ * Return: 0 if all the transfers completed, -EIO if one failed, in which case
+ *	@dev->status is set from the failed transfer, other -ve on error
+ */
+int usb_bulk_msg_queue(struct usb_device *dev, unsigned int pipe,
+		       struct usb_bulk_xfer *xfers, int count, int timeout);
 int usb_lock_async(struct usb_device *dev, int lock);
 int usb_disable_asynch(int disable);
 int usb_maxpacket(struct usb_device *dev, unsigned long pipe);
@@ -658,11 +741,14 @@ struct usb_dev_plat {
  *		so this will be false.
  * @companion:  True if this is a companion controller to another USB
  *		controller
+ * @scan_err:	Result of setting up the root hub, shown once the bus has
+ *		been scanned
  */
 struct usb_bus_priv {
 	int next_addr;
 	bool desc_before_addr;
 	bool companion;
+	int scan_err;
 };
 
 /**
@@ -809,6 +895,52 @@ struct dm_usb_ops {
 	 * driver to do just that.
 	 */
 	int (*lock_async)(struct udevice *udev, int lock);
+
+	/**
+	 * alloc_streams() - Set up bulk streams on some endpoints
+	 *
+	 * SuperSpeed bulk endpoints can carry a number of independent
+	 * streams of transfers, selected by a stream ID. This is used by
+	 * USB Attached SCSI to have several commands outstanding at once.
+	 *
+	 * @pipes: Bulk pipes of the endpoints to set up
+	 * @num_pipes: Number of entries in @pipes
+	 * @num_streams: Number of streams wanted on each endpoint. This must
+	 *	not be more than the SuperSpeed companion descriptors of the
+	 *	endpoints allow, in the alternate setting which is in use
+	 * @return number of streams set up (stream IDs 1 to this number),
+	 *	which may be fewer than requested, -ve on error
+	 */
+	int (*alloc_streams)(struct udevice *bus, struct usb_device *udev,
+			     unsigned long *pipes, int num_pipes,
+			     int num_streams);
+
+	/**
+	 * bulk_stream() - Send a bulk message on a stream
+	 *
+	 * This is the same as bulk() but uses one of the streams set up by
+	 * alloc_streams(), given by @stream
+	 */
+	int (*bulk_stream)(struct udevice *bus, struct usb_device *udev,
+			   unsigned long pipe, unsigned int stream,
+			   void *buffer, int length);
+
+	/**
+	 * bulk_queue() - Make several bulk transfers on one endpoint
+	 *
+	 * The transfers should be queued together and completed in order,
+	 * stopping at one which halts the endpoint. The result of each is
+	 * recorded in @xfers. @udev->status and @udev->act_len are set as
+	 * for bulk(), from the first transfer which failed if any.
+	 *
+	 * @xfers: Transfers to make
+	 * @count: Number of transfers, at most USB_BULK_QUEUE_MAX
+	 * @timeout: Time to wait for each transfer to complete, in milliseconds
+	 * @return 0 if the transfers were attempted, -ve on error
+	 */
+	int (*bulk_queue)(struct udevice *bus, struct usb_device *udev,
+			  unsigned long pipe, struct usb_bulk_xfer *xfers,
+			  int count, int timeout);
 };
 
 #define usb_get_ops(dev)	((struct dm_usb_ops *)(dev)->driver->ops)
@@ -941,6 +1073,29 @@ bool usb_device_has_child_on_port(struct usb_device *parent, int port);
 int usb_hub_probe(struct usb_device *dev, int ifnum);
 void usb_hub_reset(void);
 
+/**
+ * usb_hub_scan_defer() - Leave hub ports to be scanned by usb_hub_scan_poll()
+ *
+ * Normally configuring a hub waits until all its ports, and those of any hubs
+ * found on them, have been scanned. While this is deferred, configuring a hub
+ * just powers its ports and adds them to the list to be scanned.
+ *
+ * @defer:	true to defer scanning, false to scan when configuring a hub
+ */
+void usb_hub_scan_defer(bool defer);
+
+/**
+ * usb_hub_scan_poll() - Look at each hub port which is waiting to be scanned
+ *
+ * This does not wait for the ports: those whose power is not yet stable are
+ * skipped. A port with a new device has it enumerated and empty ports are
+ * dropped once the connect timeout has expired.
+ *
+ * Return: -EAGAIN if some ports are still waiting, 0 if all are done, other
+ * -ve on error
+ */
+int usb_hub_scan_poll(void);
+
 /*
  * usb_find_usb2_hub_address_port() - Get hub address and port for TT setting
  *
@@ -998,6 +1153,48 @@ int usb_update_hub_device(struct usb_device *dev);
  */
 int usb_get_max_xfer_size(struct usb_device *dev, size_t *size);
 
+/**
+ * usb_alloc_streams() - Set up bulk streams on some endpoints
+ *
+ * @dev:		USB device
+ * @pipes:		Bulk pipes of the endpoints to set up
+ * @num_pipes:		Number of entries in @pipes
+ * @num_streams:	Number of streams wanted on each endpoint, no more than
+ *			their companion descriptors allow in the alternate
+ *			setting which is in use
+ * Return: number of streams set up, which may be fewer than requested,
+ *	-ENOSYS if the controller does not support streams, other -ve on error
+ */
+int usb_alloc_streams(struct usb_device *dev, unsigned long *pipes,
+		      int num_pipes, int num_streams);
+
+/**
+ * submit_bulk_stream_msg() - Send a bulk message on a stream
+ *
+ * @dev:		USB device
+ * @pipe:		Bulk pipe to use
+ * @stream:		Stream ID, as set up by usb_alloc_streams()
+ * @buffer:		Data to send or buffer to receive into
+ * @length:		Length of the transfer in bytes
+ * Return: 0 if OK, -ve on error
+ */
+int submit_bulk_stream_msg(struct usb_device *dev, unsigned long pipe,
+			   unsigned int stream, void *buffer, int length);
+
+/**
+ * submit_bulk_queue() - Make several bulk transfers on one endpoint
+ *
+ * @dev:		USB device
+ * @pipe:		Bulk pipe to use
+ * @xfers:		Transfers to make, updated with their results
+ * @count:		Number of transfers
+ * @timeout:		Time to wait for each transfer, in milliseconds
+ * Return: 0 if the transfers were attempted, -ENOSYS if the controller cannot
+ *	queue transfers, other -ve on error
+ */
+int submit_bulk_queue(struct usb_device *dev, unsigned long pipe,
+		      struct usb_bulk_xfer *xfers, int count, int timeout);
+
 /**
  * usb_emul_setup_device() - Set up a new USB device emulation
  *
@@ -1038,6 +1235,29 @@ int usb_emul_control(struct udevice *emul, struct usb_device *udev,
 int usb_emul_bulk(struct udevice *emul, struct usb_device *udev,
 		  unsigned long pipe, void *buffer, int length);
 
+/**
+ * usb_emul_alloc_streams() - Set up bulk streams on an emulator
+ *
+ * @emul:	Emulator device
+ * @udev:	USB device (which the emulator is causing to appear)
+ * See struct dm_usb_ops for details on other parameters
+ * Return: number of streams set up, or -ve on error
+ */
+int usb_emul_alloc_streams(struct udevice *emul, struct usb_device *udev,
+			   unsigned long *pipes, int num_pipes, int num_streams);
+
+/**
+ * usb_emul_bulk_stream() - Send a bulk packet on a stream to an emulator
+ *
+ * @emul:	Emulator device
+ * @udev:	USB device (which the emulator is causing to appear)
+ * See struct dm_usb_ops for details on other parameters
+ * Return: 0 if OK, -ve on error
+ */
+int usb_emul_bulk_stream(struct udevice *emul, struct usb_device *udev,
+			 unsigned long pipe, unsigned int stream, void *buffer,
+			 int length);
+
 /**
  * usb_emul_int() - Send an interrupt packet to an emulator
  *
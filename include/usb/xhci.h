@@ -665,6 +665,25 @@ struct xhci_ep_ctx {
 /* deq bitmasks */
 #define EP_CTX_CYCLE_MASK		(1 << 0)
 
+/**
+ * struct xhci_stream_ctx
+ * Stream context; see section 6.2.4.1.
+ *
+ * @stream_ring:	dequeue pointer of the stream's transfer ring, with the
+ *			cycle state in bit 0 and the stream context type in
+ *			bits 3:1
+ */
+struct xhci_stream_ctx {
+	__le64	stream_ring;
+	/* offset 0x08 - 0x0f reserved for HC internal use */
+	__le32	reserved[2];
+};
+
+/* Stream Context Type, in stream contexts and Set TR Dequeue commands */
+#define SCT_FOR_CTX(p)		(((p) & 0x7) << 1)
+/* Primary stream, with the dequeue pointer pointing to a transfer ring */
+#define	SCT_PRI_TR		1
+
 /* reserved[0] bitmasks, MediaTek xHCI used */
 #define EP_BPKTS(p)	(((p) & 0x7f) << 0)
 #define EP_BBM(p)	(((p) & 0x1) << 11)
@@ -1067,6 +1086,11 @@ struct xhci_virt_ep {
 #define EP_HAS_STREAMS		(1 << 4)
 /* Transitioning the endpoint to not using streams, don't enqueue URBs */
 #define EP_GETTING_NO_STREAMS	(1 << 5)
+	/* Linear stream array and rings, indexed by stream ID (0 is unused) */
+	struct xhci_stream_ctx		*stream_ctx;
+	dma_addr_t			stream_ctx_dma;
+	struct xhci_ring		**stream_rings;
+	unsigned int			num_streams;
 };
 
 #define CTX_SIZE(_hcc) (HCC_64BYTE_CONTEXT(_hcc) ? 64 : 32)
@@ -1254,7 +1278,10 @@ void xhci_queue_command(struct xhci_ctrl *ctrl, dma_addr_t addr,
 void xhci_acknowledge_event(struct xhci_ctrl *ctrl);
 union xhci_trb *xhci_wait_for_event(struct xhci_ctrl *ctrl, trb_type expected);
 int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
-		 int length, void *buffer);
+		 unsigned int stream, int length, void *buffer);
+int xhci_bulk_queue(struct usb_device *udev, unsigned long pipe,
+		    unsigned int stream, struct usb_bulk_xfer *xfers,
+		    int count, int timeout);
 int xhci_ctrl_tx(struct usb_device *udev, unsigned long pipe,
 		 struct devrequest *req, int length, void *buffer);
 int xhci_check_maxpacket(struct usb_device *udev);
@@ -1264,6 +1291,9 @@ void xhci_cleanup(struct xhci_ctrl *ctrl);
 struct xhci_ring *xhci_ring_alloc(struct xhci_ctrl *ctrl, unsigned int num_segs,
 				  bool link_trbs);
 int xhci_alloc_virt_device(struct xhci_ctrl *ctrl, unsigned int slot_id);
+int xhci_alloc_stream_info(struct xhci_ctrl *ctrl, struct xhci_virt_ep *ep,
+			   unsigned int num_streams);
+void xhci_free_stream_info(struct xhci_ctrl *ctrl, struct xhci_virt_ep *ep);
 int xhci_mem_init(struct xhci_ctrl *ctrl, struct xhci_hccr *hccr,
 		  struct xhci_hcor *hcor);
 
@@ -44,6 +44,7 @@
 #define US_PR_CB               1		/* Control/Bulk w/o interrupt */
 #define US_PR_CBI              0		/* Control/Bulk/Interrupt */
 #define US_PR_BULK             0x50		/* bulk only */
+#define US_PR_UAS              0x62		/* USB Attached SCSI */
 
 /* USB types */
 #define USB_TYPE_STANDARD   (0x00 << 5)
@@ -391,4 +392,48 @@ struct umass_bbb_csw {
 #define US_BBB_RESET		0xff
 #define US_BBB_GET_MAX_LUN	0xfe
 
+/*
+ * USB Attached SCSI
+ */
+
+/* Pipe usage IDs, from the pipe usage descriptor after each endpoint */
+#define UAS_PIPE_CMD		1
+#define UAS_PIPE_STATUS		2
+#define UAS_PIPE_DATA_IN	3
+#define UAS_PIPE_DATA_OUT	4
+
+/* Command IU, sent on the command pipe */
+struct uas_cmd_iu {
+	__u8		id;
+#	define UAS_IU_COMMAND		0x01
+#	define UAS_IU_SENSE		0x03
+#	define UAS_IU_RESPONSE		0x04
+#	define UAS_IU_READ_READY	0x06
+#	define UAS_IU_WRITE_READY	0x07
+	__u8		rsvd1;
+	__be16		tag;
+	__u8		prio_attr;
+	__u8		rsvd5;
+	__u8		add_cdb_len;
+	__u8		rsvd7;
+	__u8		lun[8];
+	__u8		cdb[16];
+} __packed;
+
+/*
+ * Sense IU, received on the status pipe. READ READY and WRITE READY IUs are
+ * just the first four bytes of this.
+ */
+struct uas_sense_iu {
+	__u8		id;
+	__u8		rsvd1;
+	__be16		tag;
+	__be16		status_qual;
+	__u8		status;
+	__u8		rsvd7[7];
+	__be16		len;
+	__u8		sense[96];
+} __packed;
+#define UAS_READY_IU_SIZE	4
+
 #endif /*_USB_DEFS_H_ */
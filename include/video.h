@@ -69,6 +69,39 @@ enum video_format {
 	VIDEO_X2R10G10B10,
 };
 
+/**
+ * struct video_bbox - A rectangle within the display
+ *
+ * The rectangle is empty if @x1 <= @x0 or @y1 <= @y0
+ *
+ * @x0:	Left column, in pixels
+ * @y0:	Top row, in pixels
+ * @x1:	Column after the right edge, in pixels
+ * @y1:	Row after the bottom edge, in pixels
+ */
+struct video_bbox {
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+};
+
+/**
+ * struct video_stats - Statistics about updates to the display
+ *
+ * @start:	Time when collection started, in milliseconds
+ * @syncs:	Number of times the display was synced
+ * @sync_bytes:	Number of bytes written back from the cache, or passed to the
+ *		host display on sandbox, when syncing
+ * @copy_bytes:	Number of bytes copied to the copy framebuffer
+ */
+struct video_stats {
+	ulong start;
+	ulong syncs;
+	ulong sync_bytes;
+	ulong copy_bytes;
+};
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
@@ -95,6 +128,12 @@ enum video_format {
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
  * @last_sync:	Monotonic time of last video sync
+ * @damage:	Area of the frame buffer changed since the last sync, used if
+ *		CONFIG_VIDEO_DAMAGE is enabled
+ * @damage_all:	true to sync the whole frame buffer, ignoring @damage, since
+ *		something outside U-Boot's drawing code may write to it
+ *		directly, e.g. an EFI application using the GOP
+ * @stats:	Statistics about updates to the display
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -120,6 +159,9 @@ struct video_priv {
 	u8 fg_col_idx;
 	u8 bg_col_idx;
 	ulong last_sync;
+	struct video_bbox damage;
+	bool damage_all;
+	struct video_stats stats;
 };
 
 /**
@@ -343,13 +385,68 @@ void video_set_default_colors(struct udevice *dev, bool invert);
  */
 int video_default_font_height(struct udevice *dev);
 
-#ifdef CONFIG_VIDEO_COPY
+/**
+ * video_damage() - Record that part of the frame buffer has been updated
+ *
+ * This marks the area as needing to be written back from the cache at the next
+ * video_sync(). It does nothing unless CONFIG_VIDEO_DAMAGE is enabled. It is
+ * only needed by code which writes to the frame buffer without calling
+ * video_sync_copy() or video_sync_copy_area(), since those record the damage
+ * too.
+ *
+ * The area is clipped to the display.
+ *
+ * @dev: Video device being updated
+ * @x: Left column of the area, in pixels
+ * @y: Top row of the area, in pixels
+ * @width: Width of the area, in pixels
+ * @height: Height of the area, in pixels
+ */
+void video_damage(struct udevice *dev, int x, int y, int width, int height);
+
+/**
+ * video_sync_copy_area() - Sync an area back to the copy framebuffer
+ *
+ * This is like video_sync_copy() but copies only the given area, rather than
+ * everything between two addresses. Use it when the area drawn is known.
+ *
+ * The area is clipped to the display.
+ *
+ * @dev: Video device being updated
+ * @x: Left column of the area, in pixels
+ * @y: Top row of the area, in pixels
+ * @width: Width of the area, in pixels
+ * @height: Height of the area, in pixels
+ * Return: 0 (always)
+ */
+int video_sync_copy_area(struct udevice *dev, int x, int y, int width,
+			 int height);
+
+/**
+ * video_get_stats() - Get statistics about updates to the display
+ *
+ * @dev: Video device to check
+ * Return: statistics since the device was probed or video_reset_stats() was
+ *	last called
+ */
+struct video_stats *video_get_stats(struct udevice *dev);
+
+/**
+ * video_reset_stats() - Reset the statistics about updates to the display
+ *
+ * @dev: Video device to update
+ */
+void video_reset_stats(struct udevice *dev);
+
 /**
  * vidconsole_sync_copy() - Sync back to the copy framebuffer
  *
  * This ensures that the copy framebuffer has the same data as the framebuffer
  * for a particular region. It should be called after the framebuffer is updated
  *
+ * With CONFIG_VIDEO_DAMAGE, the rows covered by the region are also marked as
+ * needing to be written back from the cache at the next video_sync().
+ *
  * @from and @to can be in either order. The region between them is synced.
  *
  * @dev: Vidconsole device being updated
@@ -367,18 +464,6 @@ int video_sync_copy(struct udevice *dev, void *from, void *to);
  * Return: 0 (always)
  */
 int video_sync_copy_all(struct udevice *dev);
-#else
-static inline int video_sync_copy(struct udevice *dev, void *from, void *to)
-{
-	return 0;
-}
-
-static inline int video_sync_copy_all(struct udevice *dev)
-{
-	return 0;
-}
-
-#endif
 
 /**
  * video_is_active() - Test if one video device it active
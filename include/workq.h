@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Work queue for running jobs concurrently
+ */
+
+#ifndef __WORKQ_H
+#define __WORKQ_H
+
+#include <stdbool.h>
+
+/**
+ * struct workq_job - a job to run on the work queue
+ *
+ * The caller owns the job and must keep it valid until workq_wait() returns
+ * for it.
+ *
+ * @func: function to run
+ * @arg: argument to pass to @func
+ * @next: next job in the queue (internal)
+ * @done: true once @func has returned (internal)
+ */
+struct workq_job {
+	void (*func)(void *arg);
+	void *arg;
+	struct workq_job *next;
+	bool done;
+};
+
+enum {
+	WORKQ_MAX_THREADS	= 16,	/* maximum number of worker threads */
+};
+
+/**
+ * workq_job_init() - set up a job
+ *
+ * @job: job to set up
+ * @func: function to run
+ * @arg: argument to pass to @func
+ */
+static inline void workq_job_init(struct workq_job *job,
+				  void (*func)(void *arg), void *arg)
+{
+	job->func = func;
+	job->arg = arg;
+	job->next = NULL;
+	job->done = false;
+}
+
+/**
+ * workq_init() - start the work queue
+ *
+ * On sandbox this starts @threads host threads to run jobs. Elsewhere, or if
+ * @threads is 0, there are no threads and each job runs in workq_submit().
+ *
+ * If this is not called, the first call to workq_submit() starts the queue
+ * with CONFIG_SANDBOX_WORKQ_THREADS threads on sandbox.
+ *
+ * U-Boot itself is not thread-safe. Jobs which run on a thread must only work
+ * on memory they are given, e.g. to decompress, hash or copy it. They must not
+ * allocate memory, print or use driver model.
+ *
+ * @threads: number of threads to start, at most WORKQ_MAX_THREADS
+ * Return: number of threads started, -EALREADY if the queue is already
+ * started, or other -ve on error
+ */
+int workq_init(int threads);
+
+/**
+ * workq_uninit() - stop the work queue
+ *
+ * This waits for all submitted jobs to finish and stops the threads. The queue
+ * can then be started again with workq_init().
+ */
+void workq_uninit(void);
+
+/**
+ * workq_threads() - get the number of threads running jobs
+ *
+ * Return: number of threads, or 0 if jobs run in workq_submit()
+ */
+int workq_threads(void);
+
+/**
+ * workq_submit() - submit a job to run
+ *
+ * The job runs on the next free thread, or straight away if there are no
+ * threads. Call workq_wait() to wait for it to finish.
+ *
+ * @job: job to run, as set up by workq_job_init()
+ */
+void workq_submit(struct workq_job *job);
+
+/**
+ * workq_wait() - wait for a job to finish
+ *
+ * @job: job to wait for, which must have been submitted
+ */
+void workq_wait(struct workq_job *job);
+
+/**
+ * workq_run_all() - run a function once on each thread and wait for it
+ *
+ * This submits one call of @func for each thread, like firmware starting
+ * secondary CPUs, so they run at the same time if the threads are idle. Each
+ * call is given a different CPU number, from 0. If there are no threads,
+ * @func is called once with CPU 0.
+ *
+ * @func: function to run
+ * @arg: argument to pass to @func
+ * Return: number of times @func was called
+ */
+int workq_run_all(void (*func)(void *arg, int cpu), void *arg);
+
+#endif
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Bump allocator for groups of allocations which are freed together
+ */
+
+#include <alist.h>
+#include <arena.h>
+#include <malloc.h>
+#include <string.h>
+#include <linux/kernel.h>
+
+void arena_init(struct arena *arena, uint chunk_size)
+{
+	memset(arena, '\0', sizeof(struct arena));
+	alist_init_struct(&arena->chunks, void *);
+	arena->chunk_size = chunk_size ?: ARENA_CHUNK_SIZE;
+}
+
+void arena_uninit(struct arena *arena)
+{
+	void **chunkp;
+	uint chunk_size = arena->chunk_size;
+
+	alist_for_each(chunkp, &arena->chunks)
+		free(*chunkp);
+	alist_uninit(&arena->chunks);
+
+	arena_init(arena, chunk_size);
+}
+
+/**
+ * arena_add_chunk() - Allocate a new chunk and add it to the arena
+ *
+ * @arena: Arena to update
+ * @size: Size of chunk to allocate
+ * Return: pointer to the chunk, or NULL if out of memory
+ */
+static void *arena_add_chunk(struct arena *arena, size_t size)
+{
+	void *chunk;
+
+	chunk = malloc(size);
+	if (!chunk)
+		goto err;
+	if (!alist_add(&arena->chunks, chunk)) {
+		free(chunk);
+		goto err;
+	}
+
+	return chunk;
+err:
+	arena->flags |= ARENAF_FAIL;
+
+	return NULL;
+}
+
+void *arena_alloc(struct arena *arena, size_t size)
+{
+	void *ptr;
+
+	size = ALIGN(size ?: 1, ARENA_ALIGN);
+	if (size <= arena->left) {
+		ptr = arena->ptr;
+		arena->ptr += size;
+		arena->left -= size;
+	} else if (size > arena->chunk_size / 4) {
+		/* keep using the current chunk for small allocations */
+		ptr = arena_add_chunk(arena, size);
+		if (!ptr)
+			return NULL;
+	} else {
+		ptr = arena_add_chunk(arena, arena->chunk_size);
+		if (!ptr)
+			return NULL;
+		arena->ptr = ptr + size;
+		arena->left = arena->chunk_size - size;
+	}
+	arena->used += size;
+
+	return ptr;
+}
+
+void *arena_zalloc(struct arena *arena, size_t size)
+{
+	void *ptr;
+
+	ptr = arena_alloc(arena, size);
+	if (ptr)
+		memset(ptr, '\0', size);
+
+	return ptr;
+}
+
+char *arena_strndup(struct arena *arena, const char *str, size_t len)
+{
+	char *ptr;
+
+	len = strnlen(str, len);
+	ptr = arena_alloc(arena, len + 1);
+	if (!ptr)
+		return NULL;
+	memcpy(ptr, str, len);
+	ptr[len] = '\0';
+
+	return ptr;
+}
+
+char *arena_strdup(struct arena *arena, const char *str)
+{
+	return arena_strndup(arena, str, strlen(str));
+}
@@ -23,6 +23,7 @@
 #include <asm/global_data.h>
 #include <asm/setjmp.h>
 #include <linux/libfdt_env.h>
+#include <linux/rbtree.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -32,6 +33,27 @@ static efi_uintn_t efi_tpl = TPL_APPLICATION;
 /* This list contains all the EFI objects our payload has access to */
 LIST_HEAD(efi_obj_list);
 
+/* Tree of all EFI objects sorted by address, for validating handles */
+static struct rb_root efi_obj_tree = RB_ROOT;
+
+/**
+ * struct efi_protocol_index - interfaces of one protocol on all handles
+ *
+ * @node:	node in the tree of protocols sorted by GUID
+ * @guid:	GUID of the protocol
+ * @handlers:	list of the interfaces, linked by &struct efi_handler.index_link
+ * @count:	number of interfaces in @handlers
+ */
+struct efi_protocol_index {
+	struct rb_node node;
+	efi_guid_t guid;
+	struct list_head handlers;
+	efi_uintn_t count;
+};
+
+/* Tree of the protocols installed on any handle */
+static struct rb_root efi_protocol_tree = RB_ROOT;
+
 /* List of all events */
 __efi_runtime_data LIST_HEAD(efi_events);
 
@@ -235,6 +257,7 @@ static efi_status_t efi_purge_handle(efi_handle_t handle)
 		}
 	}
 	/* The last protocol has been removed, delete the handle. */
+	rb_erase(&handle->node, &efi_obj_tree);
 	list_del(&handle->link);
 	free(handle);
 
@@ -546,10 +569,23 @@ static efi_status_t EFIAPI efi_free_pool_ext(void *buffer)
  */
 void efi_add_handle(efi_handle_t handle)
 {
+	struct rb_node **link = &efi_obj_tree.rb_node;
+	struct rb_node *parent = NULL;
+
 	if (!handle)
 		return;
 	INIT_LIST_HEAD(&handle->protocols);
 	list_add_tail(&handle->link, &efi_obj_list);
+
+	while (*link) {
+		parent = *link;
+		if (handle < rb_entry(parent, struct efi_object, node))
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&handle->node, parent, link);
+	rb_insert_color(&handle->node, &efi_obj_tree);
 }
 
 /**
@@ -572,6 +608,104 @@ efi_status_t efi_create_handle(efi_handle_t *handle)
 	return EFI_SUCCESS;
 }
 
+/**
+ * efi_protocol_find() - find the index entry of a protocol
+ *
+ * @protocol:	GUID of the protocol
+ * @link:	if not NULL, returns where a new entry for @protocol belongs
+ * @parent:	if not NULL, returns the parent of a new entry for @protocol
+ * Return:	index entry or NULL if the protocol is not installed anywhere
+ */
+static struct efi_protocol_index *efi_protocol_find(const efi_guid_t *protocol,
+						    struct rb_node ***link,
+						    struct rb_node **parent)
+{
+	struct rb_node **pos = &efi_protocol_tree.rb_node;
+	struct rb_node *prev = NULL;
+
+	while (*pos) {
+		struct efi_protocol_index *idx;
+		int cmp;
+
+		prev = *pos;
+		idx = rb_entry(prev, struct efi_protocol_index, node);
+		cmp = guidcmp(protocol, &idx->guid);
+		if (!cmp)
+			return idx;
+		pos = cmp < 0 ? &prev->rb_left : &prev->rb_right;
+	}
+	if (link)
+		*link = pos;
+	if (parent)
+		*parent = prev;
+
+	return NULL;
+}
+
+/**
+ * efi_protocol_index_add() - add a protocol interface to the index
+ *
+ * @handler:	protocol interface, already installed on its handle
+ * Return:	status code
+ */
+static efi_status_t efi_protocol_index_add(struct efi_handler *handler)
+{
+	struct efi_protocol_index *idx;
+	struct rb_node **link;
+	struct rb_node *parent;
+
+	idx = efi_protocol_find(&handler->guid, &link, &parent);
+	if (!idx) {
+		idx = calloc(1, sizeof(*idx));
+		if (!idx)
+			return EFI_OUT_OF_RESOURCES;
+		guidcpy(&idx->guid, &handler->guid);
+		INIT_LIST_HEAD(&idx->handlers);
+		rb_link_node(&idx->node, parent, link);
+		rb_insert_color(&idx->node, &efi_protocol_tree);
+	}
+	list_add_tail(&handler->index_link, &idx->handlers);
+	idx->count++;
+
+	return EFI_SUCCESS;
+}
+
+/**
+ * efi_protocol_index_del() - remove a protocol interface from the index
+ *
+ * @handler:	protocol interface
+ */
+static void efi_protocol_index_del(struct efi_handler *handler)
+{
+	struct efi_protocol_index *idx;
+
+	idx = efi_protocol_find(&handler->guid, NULL, NULL);
+	list_del(&handler->index_link);
+	if (!--idx->count) {
+		rb_erase(&idx->node, &efi_protocol_tree);
+		free(idx);
+	}
+}
+
+/**
+ * efi_protocol_handlers() - get the interfaces of a protocol on all handles
+ *
+ * The entries of the list are linked by &struct efi_handler.index_link, in
+ * the order in which they were installed.
+ *
+ * @protocol:	GUID of the protocol
+ * Return:	list of interfaces, empty if the protocol is not installed
+ */
+struct list_head *efi_protocol_handlers(const efi_guid_t *protocol)
+{
+	static LIST_HEAD(none);
+	struct efi_protocol_index *idx;
+
+	idx = efi_protocol_find(protocol, NULL, NULL);
+
+	return idx ? &idx->handlers : &none;
+}
+
 /**
  * efi_search_protocol() - find a protocol on a handle.
  * @handle:        handle
@@ -625,6 +759,7 @@ static efi_status_t efi_remove_protocol(const efi_handle_t handle,
 		return ret;
 	if (handler->protocol_interface != protocol_interface)
 		return EFI_NOT_FOUND;
+	efi_protocol_index_del(handler);
 	list_del(&handler->link);
 	free(handler);
 	return EFI_SUCCESS;
@@ -1110,14 +1245,21 @@ static efi_status_t EFIAPI efi_check_event(struct efi_event *event)
  */
 struct efi_object *efi_search_obj(const efi_handle_t handle)
 {
-	struct efi_object *efiobj;
+	struct rb_node *node = efi_obj_tree.rb_node;
 
 	if (!handle)
 		return NULL;
 
-	list_for_each_entry(efiobj, &efi_obj_list, link) {
-		if (efiobj == handle)
+	while (node) {
+		struct efi_object *efiobj;
+
+		efiobj = rb_entry(node, struct efi_object, node);
+		if (handle == efiobj)
 			return efiobj;
+		if (handle < efiobj)
+			node = node->rb_left;
+		else
+			node = node->rb_right;
 	}
 	return NULL;
 }
@@ -1185,7 +1327,13 @@ efi_status_t efi_add_protocol(const efi_handle_t handle,
 		return EFI_OUT_OF_RESOURCES;
 	memcpy((void *)&handler->guid, protocol, sizeof(efi_guid_t));
 	handler->protocol_interface = protocol_interface;
+	handler->handle = efiobj;
 	INIT_LIST_HEAD(&handler->open_infos);
+	ret = efi_protocol_index_add(handler);
+	if (ret != EFI_SUCCESS) {
+		free(handler);
+		return ret;
+	}
 	list_add_tail(&handler->link, &efiobj->protocols);
 
 	/* Notify registered events */
@@ -1195,6 +1343,7 @@ efi_status_t efi_add_protocol(const efi_handle_t handle,
 
 			notif = calloc(1, sizeof(*notif));
 			if (!notif) {
+				efi_protocol_index_del(handler);
 				list_del(&handler->link);
 				free(handler);
 				return EFI_OUT_OF_RESOURCES;
@@ -1508,34 +1657,6 @@ out:
 	return EFI_EXIT(ret);
 }
 
-/**
- * efi_search() - determine if an EFI handle implements a protocol
- *
- * @search_type: selection criterion
- * @protocol:    GUID of the protocol
- * @handle:      handle
- *
- * See the documentation of the LocateHandle service in the UEFI specification.
- *
- * Return: 0 if the handle implements the protocol
- */
-static int efi_search(enum efi_locate_search_type search_type,
-		      const efi_guid_t *protocol, efi_handle_t handle)
-{
-	efi_status_t ret;
-
-	switch (search_type) {
-	case ALL_HANDLES:
-		return 0;
-	case BY_PROTOCOL:
-		ret = efi_search_protocol(handle, protocol, NULL);
-		return (ret != EFI_SUCCESS);
-	default:
-		/* Invalid search type */
-		return -1;
-	}
-}
-
 /**
  * efi_check_register_notify_event() - check if registration key is valid
  *
@@ -1580,6 +1701,8 @@ static efi_status_t efi_locate_handle(
 	efi_uintn_t size = 0;
 	struct efi_register_notify_event *event;
 	struct efi_protocol_notification *handle = NULL;
+	struct efi_protocol_index *idx = NULL;
+	struct efi_handler *handler;
 
 	/* Check parameters */
 	switch (search_type) {
@@ -1610,11 +1733,14 @@ static efi_status_t efi_locate_handle(
 					  link);
 		efiobj = handle->handle;
 		size += sizeof(void *);
+	} else if (search_type == BY_PROTOCOL) {
+		idx = efi_protocol_find(protocol, NULL, NULL);
+		if (!idx)
+			return EFI_NOT_FOUND;
+		size = idx->count * sizeof(void *);
 	} else {
-		list_for_each_entry(efiobj, &efi_obj_list, link) {
-			if (!efi_search(search_type, protocol, efiobj))
-				size += sizeof(void *);
-		}
+		list_for_each_entry(efiobj, &efi_obj_list, link)
+			size += sizeof(void *);
 		if (size == 0)
 			return EFI_NOT_FOUND;
 	}
@@ -1637,11 +1763,12 @@ static efi_status_t efi_locate_handle(
 	if (search_type == BY_REGISTER_NOTIFY) {
 		*buffer = efiobj;
 		list_del(&handle->link);
+	} else if (search_type == BY_PROTOCOL) {
+		list_for_each_entry(handler, &idx->handlers, index_link)
+			*buffer++ = handler->handle;
 	} else {
-		list_for_each_entry(efiobj, &efi_obj_list, link) {
-			if (!efi_search(search_type, protocol, efiobj))
-				*buffer++ = efiobj;
-		}
+		list_for_each_entry(efiobj, &efi_obj_list, link)
+			*buffer++ = efiobj;
 	}
 
 	return EFI_SUCCESS;
@@ -2232,6 +2359,7 @@ static efi_status_t EFIAPI efi_exit_boot_services(efi_handle_t image_handle,
 	}
 
 	if (!efi_st_keep_devices) {
+		flush();
 		bootm_disable_interrupts();
 		if (IS_ENABLED(CONFIG_USB_DEVICE))
 			udc_disconnect();
@@ -2657,10 +2785,12 @@ static efi_status_t EFIAPI efi_locate_protocol(const efi_guid_t *protocol,
 		if (ret == EFI_SUCCESS)
 			goto found;
 	} else {
-		list_for_each_entry(efiobj, &efi_obj_list, link) {
-			ret = efi_search_protocol(efiobj, protocol, &handler);
-			if (ret == EFI_SUCCESS)
-				goto found;
+		struct list_head *handlers = efi_protocol_handlers(protocol);
+
+		if (!list_empty(handlers)) {
+			handler = list_first_entry(handlers, struct efi_handler,
+						   index_link);
+			goto found;
 		}
 	}
 not_found:
@@ -40,12 +40,22 @@ struct file_handle {
 	struct fs_dir_stream *dirs;
 	struct fs_dirent *dent;
 
+	/* for reading a file: */
+	struct fs_file *file;
+	uint file_gen;	/* value of file_gen when @file was opened */
+
 	char path[0];
 };
 #define to_fh(x) container_of(x, struct file_handle, base)
 
 static const struct efi_file_handle efi_file_handle_protocol;
 
+/*
+ * Incremented whenever a file is created, written or deleted, so that open
+ * files (which do not notice such changes) are opened again
+ */
+static uint file_gen;
+
 static char *basename(struct file_handle *fh)
 {
 	char *s = strrchr(fh->path, '/');
@@ -59,6 +69,33 @@ static int set_blk_dev(struct file_handle *fh)
 	return fs_set_blk_dev_with_part(fh->fs->desc, fh->fs->part);
 }
 
+/**
+ * get_file() - make sure that a file is open for reading
+ *
+ * The file is opened on first use and then kept open while the handle is,
+ * so that each read does not need to set up the filesystem and look up the
+ * path again. It is opened again if any file has been changed since.
+ *
+ * @fh:		file handle
+ * Return:	status code
+ */
+static efi_status_t get_file(struct file_handle *fh)
+{
+	if (fh->file && fh->file_gen == file_gen)
+		return EFI_SUCCESS;
+
+	fs_file_close(fh->file);
+	fh->file = NULL;
+	if (set_blk_dev(fh))
+		return EFI_DEVICE_ERROR;
+	fh->file = fs_file_open(fh->path);
+	if (!fh->file)
+		return EFI_DEVICE_ERROR;
+	fh->file_gen = file_gen;
+
+	return EFI_SUCCESS;
+}
+
 /**
  * is_dir() - check if file handle points to directory
  *
@@ -153,6 +190,7 @@ static int efi_create_file(struct file_handle *fh, u64 attributes)
 	loff_t actwrite;
 	void *buffer = &actwrite;
 
+	file_gen++;
 	if (attributes & EFI_FILE_DIRECTORY)
 		return fs_mkdir(fh->path);
 	else
@@ -368,6 +406,7 @@ out:
 static efi_status_t file_close(struct file_handle *fh)
 {
 	fs_closedir(fh->dirs);
+	fs_file_close(fh->file);
 	free(fh);
 	return EFI_SUCCESS;
 }
@@ -392,6 +431,7 @@ static efi_status_t EFIAPI efi_file_delete(struct efi_file_handle *file)
 
 	EFI_ENTRY("%p", file);
 
+	file_gen++;
 	if (set_blk_dev(fh) || fs_unlink(fh->path))
 		ret = EFI_WARN_DELETE_FAILURE;
 
@@ -409,6 +449,15 @@ static efi_status_t EFIAPI efi_file_delete(struct efi_file_handle *file)
 static efi_status_t efi_get_file_size(struct file_handle *fh,
 				      loff_t *file_size)
 {
+	efi_status_t ret;
+
+	if (!fh->isdir) {
+		ret = get_file(fh);
+		if (ret == EFI_SUCCESS)
+			*file_size = fh->file->size;
+		return ret;
+	}
+
 	if (set_blk_dev(fh))
 		return EFI_DEVICE_ERROR;
 
@@ -477,10 +526,10 @@ static efi_status_t file_read(struct file_handle *fh, u64 *buffer_size,
 		return ret;
 	}
 
-	if (set_blk_dev(fh))
-		return EFI_DEVICE_ERROR;
-	if (fs_read(fh->path, map_to_sysmem(buffer), fh->offset,
-		    *buffer_size, &actread))
+	/* reading nothing would read the whole file */
+	if (!*buffer_size)
+		return EFI_SUCCESS;
+	if (fs_file_read(fh->file, buffer, fh->offset, *buffer_size, &actread))
 		return EFI_DEVICE_ERROR;
 
 	*buffer_size = actread;
@@ -677,6 +726,7 @@ static efi_status_t efi_file_write_int(struct efi_file_handle *this,
 	if (!*buffer_size)
 		goto out;
 
+	file_gen++;
 	if (set_blk_dev(fh)) {
 		ret = EFI_DEVICE_ERROR;
 		goto out;
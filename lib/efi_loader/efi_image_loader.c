@@ -87,17 +87,14 @@ static efi_status_t efi_print_image_info(struct efi_loaded_image_obj *obj,
  */
 void efi_print_image_infos(void *pc)
 {
-	struct efi_object *efiobj;
 	struct efi_handler *handler;
 
-	list_for_each_entry(efiobj, &efi_obj_list, link) {
-		list_for_each_entry(handler, &efiobj->protocols, link) {
-			if (!guidcmp(&handler->guid, &efi_guid_loaded_image)) {
-				efi_print_image_info(
-					(struct efi_loaded_image_obj *)efiobj,
-					handler->protocol_interface, pc);
-			}
-		}
+	list_for_each_entry(handler,
+			    efi_protocol_handlers(&efi_guid_loaded_image),
+			    index_link) {
+		efi_print_image_info(
+			(struct efi_loaded_image_obj *)handler->handle,
+			handler->protocol_interface, pc);
 	}
 }
 
@@ -17,7 +17,7 @@
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/sections.h>
-#include <linux/list_sort.h>
+#include <linux/rbtree.h>
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -27,8 +27,19 @@ DECLARE_GLOBAL_DATA_PTR;
 
 efi_uintn_t efi_memory_map_key;
 
+/**
+ * struct efi_mem_list - memory map entry
+ *
+ * @link:	entry in efi_mem, in descending address order
+ * @node:	node in efi_mem_tree, keyed by the start address
+ * @desc:	memory descriptor
+ *
+ * Entries never overlap, so the tree can be used to find the entries covering
+ * an address in O(log n), while the list gives the order of the memory map.
+ */
 struct efi_mem_list {
 	struct list_head link;
+	struct rb_node node;
 	struct efi_mem_desc desc;
 };
 
@@ -39,6 +50,8 @@ struct efi_mem_list {
 
 /* This list contains all memory map items */
 static LIST_HEAD(efi_mem);
+/* This tree contains the same items, for lookup by address */
+static struct rb_root efi_mem_tree = RB_ROOT;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 void *efi_bounce_buffer;
@@ -47,13 +60,16 @@ void *efi_bounce_buffer;
 /**
  * struct efi_pool_allocation - memory block allocated from pool
  *
- * @num_pages:	number of pages allocated
+ * @num_pages:	number of pages allocated, 0 if allocated from a slab
+ * @next:	next free object in the slab, while the object is free
+ * @slab:	slab containing the allocation, NULL for page allocations
  * @checksum:	checksum
  * @data:	allocated pool memory
  *
- * U-Boot services each UEFI AllocatePool() request as a separate
+ * U-Boot services larger UEFI AllocatePool() requests as a separate
  * (multiple) page allocation. We have to track the number of pages
- * to be able to free the correct amount later.
+ * to be able to free the correct amount later. Small requests are served
+ * from a slab, see struct efi_pool_slab.
  *
  * The checksum calculated in function checksum() is used in FreePool() to avoid
  * freeing memory not allocated by AllocatePool() and duplicate freeing.
@@ -62,11 +78,48 @@ void *efi_bounce_buffer;
  * prepend each allocation with these header fields.
  */
 struct efi_pool_allocation {
-	u64 num_pages;
+	union {
+		u64 num_pages;
+		struct efi_pool_allocation *next;
+	};
+	struct efi_pool_slab *slab;
 	u64 checksum;
 	char data[] __aligned(ARCH_DMA_MINALIGN);
 };
 
+/* Number of pages in each slab */
+#define EFI_POOL_SLAB_PAGES	4
+/* Size of the largest object, including its header, served from a slab */
+#define EFI_POOL_OBJ_MAX	(EFI_POOL_SLAB_PAGES * EFI_PAGE_SIZE / 8)
+
+/**
+ * struct efi_pool_slab - pages shared by small pool allocations
+ *
+ * @link:	entry in efi_pool_slabs, while the slab has free objects
+ * @free:	first free object
+ * @type:	memory type of the pages
+ * @size:	size of each object, including its header
+ * @used:	number of objects allocated
+ *
+ * Giving each AllocatePool() request its own pages wastes most of a page for
+ * small requests and adds an entry to the memory map for each of them, which
+ * slows down later allocations and GetMemoryMap(). Instead, requests up to
+ * EFI_POOL_OBJ_MAX bytes are rounded up to a power of two and served from a
+ * slab of EFI_POOL_SLAB_PAGES pages holding objects of that size and memory
+ * type. This header sits at the start of the first page, followed by the
+ * objects. A slab is released once all of its objects are freed.
+ */
+struct efi_pool_slab {
+	struct list_head link;
+	struct efi_pool_allocation *free;
+	enum efi_memory_type type;
+	u32 size;
+	u32 used;
+};
+
+/* Slabs with at least one free object */
+static LIST_HEAD(efi_pool_slabs);
+
 /**
  * checksum() - calculate checksum for memory allocated from pool
  *
@@ -77,96 +130,156 @@ static u64 checksum(struct efi_pool_allocation *alloc)
 {
 	u64 addr = (uintptr_t)alloc;
 	u64 ret = (addr >> 32) ^ (addr << 32) ^ alloc->num_pages ^
-		  EFI_ALLOC_POOL_MAGIC;
+		  (uintptr_t)alloc->slab ^ EFI_ALLOC_POOL_MAGIC;
 	if (!ret)
 		++ret;
 	return ret;
 }
 
 /**
- * efi_mem_cmp() - comparator function for sorting memory map
+ * desc_get_end() - get end address of memory area
  *
- * Sorts the memory list from highest address to lowest address
+ * @desc:	memory descriptor
+ * Return:	end address + 1
+ */
+static uint64_t desc_get_end(struct efi_mem_desc *desc)
+{
+	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
+}
+
+/**
+ * efi_mem_find() - find the first memory area ending above an address
  *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
+ * @addr:	address
+ * Return:	the memory area containing @addr, else the lowest area above
+ *		@addr, or NULL if there is none
+ */
+static struct efi_mem_list *efi_mem_find(u64 addr)
+{
+	struct rb_node *node = efi_mem_tree.rb_node;
+	struct efi_mem_list *found = NULL;
+
+	while (node) {
+		struct efi_mem_list *lmem;
+
+		lmem = rb_entry(node, struct efi_mem_list, node);
+		if (desc_get_end(&lmem->desc) > addr) {
+			found = lmem;
+			node = node->rb_left;
+		} else {
+			node = node->rb_right;
+		}
+	}
+
+	return found;
+}
+
+/**
+ * efi_mem_next() - get the next memory area in ascending address order
  *
- * @priv:	unused
- * @a:		first memory area
- * @b:		second memory area
- * Return:	1 if @a is before @b, -1 if @b is before @a, 0 if equal
+ * @lmem:	memory area
+ * Return:	next memory area or NULL if @lmem is the highest
  */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
+static struct efi_mem_list *efi_mem_next(struct efi_mem_list *lmem)
 {
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
+	return rb_entry_safe(rb_next(&lmem->node), struct efi_mem_list, node);
+}
 
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
+/**
+ * efi_mem_prev() - get the previous memory area in ascending address order
+ *
+ * @lmem:	memory area
+ * Return:	previous memory area or NULL if @lmem is the lowest
+ */
+static struct efi_mem_list *efi_mem_prev(struct efi_mem_list *lmem)
+{
+	return rb_entry_safe(rb_prev(&lmem->node), struct efi_mem_list, node);
 }
 
 /**
- * desc_get_end() - get end address of memory area
+ * efi_mem_insert() - add a memory area to the map
  *
- * @desc:	memory descriptor
- * Return:	end address + 1
+ * The area must not overlap any other area in the map.
+ *
+ * @new:	memory area to add
  */
-static uint64_t desc_get_end(struct efi_mem_desc *desc)
+static void efi_mem_insert(struct efi_mem_list *new)
 {
-	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
+	struct rb_node **link = &efi_mem_tree.rb_node;
+	struct rb_node *parent = NULL;
+	struct efi_mem_list *next;
+
+	while (*link) {
+		struct efi_mem_list *lmem;
+
+		parent = *link;
+		lmem = rb_entry(parent, struct efi_mem_list, node);
+		if (new->desc.physical_start < lmem->desc.physical_start)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&new->node, parent, link);
+	rb_insert_color(&new->node, &efi_mem_tree);
+
+	/* The list is in descending order, so go after the next higher area */
+	next = efi_mem_next(new);
+	list_add(&new->link, next ? &next->link : &efi_mem);
 }
 
 /**
- * efi_mem_sort() - sort memory map
+ * efi_mem_remove() - remove a memory area from the map and free it
  *
- * Sort the memory map and then try to merge adjacent memory areas.
+ * @lmem:	memory area
  */
-static void efi_mem_sort(void)
+static void efi_mem_remove(struct efi_mem_list *lmem)
 {
-	struct efi_mem_list *lmem;
-	struct efi_mem_list *prevmem = NULL;
-	bool merge_again = true;
-
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
-
-	/* Now merge entries that can be merged */
-	while (merge_again) {
-		merge_again = false;
-		list_for_each_entry(lmem, &efi_mem, link) {
-			struct efi_mem_desc *prev;
-			struct efi_mem_desc *cur;
-			uint64_t pages;
-
-			if (!prevmem) {
-				prevmem = lmem;
-				continue;
-			}
+	rb_erase(&lmem->node, &efi_mem_tree);
+	list_del(&lmem->link);
+	free(lmem);
+}
 
-			cur = &lmem->desc;
-			prev = &prevmem->desc;
-
-			if ((desc_get_end(cur) == prev->physical_start) &&
-			    (prev->type == cur->type) &&
-			    (prev->attribute == cur->attribute)) {
-				/* There is an existing map before, reuse it */
-				pages = cur->num_pages;
-				prev->num_pages += pages;
-				prev->physical_start -= pages << EFI_PAGE_SHIFT;
-				prev->virtual_start -= pages << EFI_PAGE_SHIFT;
-				list_del(&lmem->link);
-				free(lmem);
-
-				merge_again = true;
-				break;
-			}
+/**
+ * efi_mem_mergeable() - check whether two memory areas can be merged
+ *
+ * @lower:	lower memory area
+ * @upper:	upper memory area
+ * Return:	true if @upper directly follows @lower and has the same type
+ *		and attributes
+ */
+static bool efi_mem_mergeable(struct efi_mem_desc *lower,
+			      struct efi_mem_desc *upper)
+{
+	return desc_get_end(lower) == upper->physical_start &&
+	       lower->type == upper->type &&
+	       lower->attribute == upper->attribute;
+}
 
-			prevmem = lmem;
-		}
+/**
+ * efi_mem_merge() - merge a memory area with its neighbours
+ *
+ * Other areas are already merged where possible, so only the neighbours of a
+ * newly added area need to be considered.
+ *
+ * @lmem:	memory area which was added
+ */
+static void efi_mem_merge(struct efi_mem_list *lmem)
+{
+	struct efi_mem_list *other;
+
+	other = efi_mem_prev(lmem);
+	if (other && efi_mem_mergeable(&other->desc, &lmem->desc)) {
+		/* Moving the start down keeps the tree in order */
+		lmem->desc.physical_start = other->desc.physical_start;
+		lmem->desc.virtual_start = other->desc.virtual_start;
+		lmem->desc.num_pages += other->desc.num_pages;
+		efi_mem_remove(other);
+	}
+
+	other = efi_mem_next(lmem);
+	if (other && efi_mem_mergeable(&lmem->desc, &other->desc)) {
+		lmem->desc.num_pages += other->desc.num_pages;
+		efi_mem_remove(other);
 	}
 }
 
@@ -221,8 +334,7 @@ static s64 efi_mem_carve_out(struct efi_mem_list *map,
 	if (carve_start == map_start) {
 		if (map_end == carve_end) {
 			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
+			efi_mem_remove(map);
 		} else {
 			map->desc.physical_start = carve_end;
 			map->desc.virtual_start = carve_end;
@@ -248,11 +360,10 @@ static s64 efi_mem_carve_out(struct efi_mem_list *map,
 	newmap->desc.physical_start = carve_start;
 	newmap->desc.virtual_start = carve_start;
 	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
 
 	/* Shrink the map to [ map_start ... carve_start ] */
 	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
+	efi_mem_insert(newmap);
 
 	return EFI_CARVE_LOOP_AGAIN;
 }
@@ -275,6 +386,7 @@ efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 {
 	struct efi_mem_list *lmem;
 	struct efi_mem_list *newlist;
+	u64 end = start + (pages << EFI_PAGE_SHIFT);
 	bool carve_again;
 	uint64_t carved_pages = 0;
 	struct efi_event *evt;
@@ -314,7 +426,10 @@ efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 	/* Add our new map */
 	do {
 		carve_again = false;
-		list_for_each_entry(lmem, &efi_mem, link) {
+		/* Only visit the areas which overlap the new one */
+		for (lmem = efi_mem_find(start);
+		     lmem && lmem->desc.physical_start < end;
+		     lmem = efi_mem_next(lmem)) {
 			s64 r;
 
 			r = efi_mem_carve_out(lmem, &newlist->desc,
@@ -363,11 +478,9 @@ efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 		return EFI_NO_MAPPING;
 	}
 
-	/* Add our new map */
-        list_add_tail(&newlist->link, &efi_mem);
-
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	/* Add our new map, merging it with its neighbours */
+	efi_mem_insert(newlist);
+	efi_mem_merge(newlist);
 
 	/* Notify that the memory map was changed */
 	list_for_each_entry(evt, &efi_events, link) {
@@ -423,17 +536,13 @@ static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
 {
 	struct efi_mem_list *item;
 
-	list_for_each_entry(item, &efi_mem, link) {
-		u64 start = item->desc.physical_start;
-		u64 end = start + (item->desc.num_pages << EFI_PAGE_SHIFT);
-
-		if (addr >= start && addr < end) {
-			if (must_be_allocated ^
-			    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
-				return EFI_SUCCESS;
-			else
-				return EFI_NOT_FOUND;
-		}
+	item = efi_mem_find(addr);
+	if (item && addr >= item->desc.physical_start) {
+		if (must_be_allocated ^
+		    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
+			return EFI_SUCCESS;
+		else
+			return EFI_NOT_FOUND;
 	}
 
 	return EFI_NOT_FOUND;
@@ -606,6 +715,113 @@ void *efi_alloc_aligned_pages(u64 len, int memory_type, size_t align)
 	return (void *)(uintptr_t)aligned_mem;
 }
 
+/**
+ * efi_pool_slab_objs() - get the offset of the first object in a slab
+ *
+ * Return:	offset in bytes from the start of the slab
+ */
+static inline size_t efi_pool_slab_objs(void)
+{
+	return ALIGN(sizeof(struct efi_pool_slab), ARCH_DMA_MINALIGN);
+}
+
+/**
+ * efi_pool_slab_alloc() - allocate a small block from a slab
+ *
+ * @pool_type:	type of the pool from which memory is to be allocated
+ * @size:	number of bytes to be allocated, including the header
+ * Return:	allocation header or NULL if out of memory
+ */
+static struct efi_pool_allocation *
+efi_pool_slab_alloc(enum efi_memory_type pool_type, efi_uintn_t size)
+{
+	struct efi_pool_allocation *alloc;
+	struct efi_pool_slab *slab;
+	u32 obj_size;
+	u64 addr;
+	int i;
+
+	for (obj_size = 2 * sizeof(*alloc); obj_size < size; obj_size <<= 1)
+		;
+
+	list_for_each_entry(slab, &efi_pool_slabs, link) {
+		if (slab->type == pool_type && slab->size == obj_size)
+			goto found;
+	}
+
+	if (efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES, pool_type,
+			       EFI_POOL_SLAB_PAGES, &addr) != EFI_SUCCESS)
+		return NULL;
+	slab = (struct efi_pool_slab *)(uintptr_t)addr;
+	slab->type = pool_type;
+	slab->size = obj_size;
+	slab->used = 0;
+	slab->free = NULL;
+	/* Build the free list so that objects are handed out in order */
+	for (i = (EFI_POOL_SLAB_PAGES * EFI_PAGE_SIZE - efi_pool_slab_objs()) /
+		 obj_size; i--; ) {
+		alloc = (void *)slab + efi_pool_slab_objs() + i * obj_size;
+		alloc->next = slab->free;
+		alloc->checksum = 0;
+		slab->free = alloc;
+	}
+	list_add(&slab->link, &efi_pool_slabs);
+
+found:
+	alloc = slab->free;
+	slab->free = alloc->next;
+	if (!slab->free)
+		list_del(&slab->link);
+	slab->used++;
+	alloc->num_pages = 0;
+	alloc->slab = slab;
+
+	return alloc;
+}
+
+/**
+ * efi_pool_slab_free() - free a small block back to its slab
+ *
+ * The slab is released when its last object is freed.
+ *
+ * @alloc:	allocation header
+ * Return:	status code
+ */
+static efi_status_t efi_pool_slab_free(struct efi_pool_allocation *alloc)
+{
+	struct efi_pool_slab *slab = alloc->slab;
+
+	if (!slab->free)
+		list_add(&slab->link, &efi_pool_slabs);
+	alloc->next = slab->free;
+	slab->free = alloc;
+	if (--slab->used)
+		return EFI_SUCCESS;
+
+	list_del(&slab->link);
+
+	return efi_free_pages((uintptr_t)slab, EFI_POOL_SLAB_PAGES);
+}
+
+/**
+ * efi_pool_slab_owns() - check that a block lies on an object boundary
+ *
+ * @alloc:	allocation header
+ * Return:	true if @alloc is an object of the slab it claims to be in
+ */
+static bool efi_pool_slab_owns(struct efi_pool_allocation *alloc)
+{
+	struct efi_pool_slab *slab = alloc->slab;
+	size_t ofs = (void *)alloc - (void *)slab;
+
+	if ((uintptr_t)slab & EFI_PAGE_MASK ||
+	    (void *)alloc < (void *)slab + efi_pool_slab_objs() ||
+	    ofs + slab->size > EFI_POOL_SLAB_PAGES * EFI_PAGE_SIZE)
+		return false;
+
+	return !((ofs - efi_pool_slab_objs()) % slab->size);
+}
+
 /**
  * efi_allocate_pool - allocate memory from pool
  *
@@ -630,11 +846,26 @@ efi_status_t efi_allocate_pool(enum efi_memory_type pool_type, efi_uintn_t size,
 		return EFI_SUCCESS;
 	}
 
+	/* Only use slabs for the types which UEFI defines for pool memory */
+	if (size <= EFI_POOL_OBJ_MAX - sizeof(struct efi_pool_allocation) &&
+	    pool_type >= EFI_LOADER_CODE &&
+	    pool_type <= EFI_RUNTIME_SERVICES_DATA) {
+		alloc = efi_pool_slab_alloc(pool_type,
+					    size + sizeof(*alloc));
+		if (!alloc)
+			return EFI_OUT_OF_RESOURCES;
+		alloc->checksum = checksum(alloc);
+		*buffer = alloc->data;
+
+		return EFI_SUCCESS;
+	}
+
 	r = efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES, pool_type, num_pages,
 			       &addr);
 	if (r == EFI_SUCCESS) {
 		alloc = (struct efi_pool_allocation *)(uintptr_t)addr;
 		alloc->num_pages = num_pages;
+		alloc->slab = NULL;
 		alloc->checksum = checksum(alloc);
 		*buffer = alloc->data;
 	}
@@ -685,15 +916,19 @@ efi_status_t efi_free_pool(void *buffer)
 	alloc = container_of(buffer, struct efi_pool_allocation, data);
 
 	/* Check that this memory was allocated by efi_allocate_pool() */
-	if (((uintptr_t)alloc & EFI_PAGE_MASK) ||
-	    alloc->checksum != checksum(alloc)) {
+	if (alloc->checksum != checksum(alloc) ||
+	    (alloc->slab ? !efi_pool_slab_owns(alloc) :
+	     ((uintptr_t)alloc & EFI_PAGE_MASK))) {
 		printf("%s: illegal free 0x%p\n", __func__, buffer);
 		return EFI_INVALID_PARAMETER;
 	}
 	/* Avoid double free */
 	alloc->checksum = 0;
 
-	ret = efi_free_pages((uintptr_t)alloc, alloc->num_pages);
+	if (alloc->slab)
+		ret = efi_pool_slab_free(alloc);
+	else
+		ret = efi_free_pages((uintptr_t)alloc, alloc->num_pages);
 
 	return ret;
 }
@@ -25,6 +25,11 @@
 
 static const efi_guid_t shim_lock_guid = SHIM_LOCK_GUID;
 
+/* Length of ubootefi.var, or 0 if not known */
+static loff_t __maybe_unused efi_var_file_len;
+/* Length of the variables at the start of ubootefi.var, before the journal */
+static loff_t __maybe_unused efi_var_file_vars;
+
 /**
  * efi_set_blk_dev_to_system_partition() - select EFI system partition
  *
@@ -82,12 +87,18 @@ efi_status_t efi_var_to_file(void)
 	once = false;
 
 	r = fs_write(EFI_VAR_FILE_NAME, map_to_sysmem(buf), 0, len, &actlen);
-	if (r || len != actlen)
+	if (r || len != actlen) {
 		ret = EFI_DEVICE_ERROR;
+	} else {
+		efi_var_file_len = len;
+		efi_var_file_vars = len;
+	}
 
 error:
-	if (ret != EFI_SUCCESS)
+	if (ret != EFI_SUCCESS) {
+		efi_var_file_len = 0;
 		log_err("Failed to persist EFI variables\n");
+	}
 out:
 	free(buf);
 	return ret;
@@ -96,6 +107,92 @@ out:
 #endif
 }
 
+efi_status_t efi_var_log_to_file(const u16 *name, const efi_guid_t *guid)
+{
+#ifdef CONFIG_EFI_VARIABLE_FILE_JOURNAL
+	struct efi_var_journal *rec;
+	struct efi_var_entry *var;
+	loff_t size, actlen;
+	u32 len;
+	int r;
+
+	var = efi_var_mem_find(guid, name, NULL);
+	if (var)
+		len = efi_var_entry_len(var);
+	else
+		len = ALIGN(sizeof(*var) + sizeof(u16) * (u16_strlen(name) + 1),
+			    8);
+
+	/*
+	 * Rewrite the whole file if its length is not known, or to keep the
+	 * journal smaller than the variables before it, which bounds the
+	 * time taken to replay it
+	 */
+	if (!efi_var_file_len ||
+	    efi_var_file_len + sizeof(*rec) + len > EFI_VAR_BUF_SIZE ||
+	    efi_var_file_len - efi_var_file_vars + sizeof(*rec) + len >
+	    efi_var_file_vars)
+		return efi_var_to_file();
+
+	rec = calloc(1, sizeof(*rec) + len);
+	if (!rec)
+		return efi_var_to_file();
+	rec->magic = EFI_VAR_JOURNAL_MAGIC;
+	rec->length = sizeof(*rec) + len;
+	if (var) {
+		memcpy(rec->var, var, len);
+	} else {
+		/* A deleted variable is recorded without any data */
+		rec->var->attr = EFI_VARIABLE_NON_VOLATILE;
+		guidcpy(&rec->var->guid, guid);
+		u16_strcpy(rec->var->name, name);
+	}
+	rec->crc32 = crc32(0, (u8 *)rec->var, len);
+
+	/* Check that the file is still the one we know about */
+	if (efi_set_blk_dev_to_system_partition() != EFI_SUCCESS ||
+	    fs_size(EFI_VAR_FILE_NAME, &size) || size != efi_var_file_len ||
+	    efi_set_blk_dev_to_system_partition() != EFI_SUCCESS) {
+		free(rec);
+		return efi_var_to_file();
+	}
+
+	r = fs_write(EFI_VAR_FILE_NAME, map_to_sysmem(rec), efi_var_file_len,
+		     rec->length, &actlen);
+	if (r || actlen != rec->length) {
+		/* The filesystem may not support writing at an offset */
+		free(rec);
+		efi_var_file_len = 0;
+		return efi_var_to_file();
+	}
+	efi_var_file_len += rec->length;
+	free(rec);
+
+	return EFI_SUCCESS;
+#else
+	return efi_var_to_file();
+#endif
+}
+
+/**
+ * efi_var_is_restorable() - check whether a variable may be restored
+ *
+ * Secure boot related and volatile variables shall only be restored from
+ * U-Boot's preseed.
+ *
+ * @var:	variable
+ * @safe:	restoring from tamper-resistant storage
+ * Return:	true if the variable may be restored
+ */
+static bool efi_var_is_restorable(struct efi_var_entry *var, bool safe)
+{
+	return safe ||
+	       (efi_auth_var_get_type(var->name, &var->guid) ==
+		EFI_AUTH_VAR_NONE &&
+		guidcmp(&var->guid, &shim_lock_guid) &&
+		(var->attr & EFI_VARIABLE_NON_VOLATILE));
+}
+
 efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 {
 	struct efi_var_entry *var, *last_var;
@@ -116,15 +213,7 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 
 		data = var->name + u16_strlen(var->name) + 1;
 
-		/*
-		 * Secure boot related and volatile variables shall only be
-		 * restored from U-Boot's preseed.
-		 */
-		if (!safe &&
-		    (efi_auth_var_get_type(var->name, &var->guid) !=
-		     EFI_AUTH_VAR_NONE ||
-		     !guidcmp(&var->guid, &shim_lock_guid) ||
-		     !(var->attr & EFI_VARIABLE_NON_VOLATILE)))
+		if (!efi_var_is_restorable(var, safe))
 			continue;
 		if (!var->length)
 			continue;
@@ -139,6 +228,64 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 	return EFI_SUCCESS;
 }
 
+/**
+ * efi_var_replay() - apply the journal in a variables file
+ *
+ * The records following the variables in @buf are applied in order. Replay
+ * stops at the first damaged record, e.g. one which was only partly written.
+ *
+ * @buf:	buffer holding the file
+ * @len:	length of the file
+ * Return:	length of the file up to the end of the last valid record
+ */
+static loff_t __maybe_unused efi_var_replay(struct efi_var_file *buf,
+					    loff_t len)
+{
+	struct efi_var_entry *var, *old;
+	struct efi_var_journal *rec;
+	efi_status_t ret;
+	loff_t pos;
+	u16 *data;
+	u32 max;
+
+	for (pos = buf->length; pos < len; pos += rec->length) {
+		rec = (void *)buf + pos;
+		var = rec->var;
+		if (len - pos < sizeof(*rec) + sizeof(*var) ||
+		    rec->magic != EFI_VAR_JOURNAL_MAGIC ||
+		    rec->length < sizeof(*rec) + sizeof(*var) ||
+		    rec->length > len - pos || rec->length % 8 ||
+		    rec->crc32 != crc32(0, (u8 *)var,
+					rec->length - sizeof(*rec)))
+			break;
+		max = (rec->length - sizeof(*rec) - sizeof(*var)) / sizeof(u16);
+		if (u16_strnlen(var->name, max) == max)
+			break;
+		data = var->name + u16_strlen(var->name) + 1;
+		if ((void *)data + var->length > (void *)rec + rec->length)
+			break;
+
+		if (!efi_var_is_restorable(var, false))
+			continue;
+		old = efi_var_mem_find(&var->guid, var->name, NULL);
+		if (var->length) {
+			ret = efi_var_mem_ins(var->name, &var->guid, var->attr,
+					      var->length, data, 0, NULL,
+					      var->time);
+			if (ret != EFI_SUCCESS) {
+				log_err("Failed to set EFI variable %ls\n",
+					var->name);
+				continue;
+			}
+		}
+		efi_var_mem_del(old);
+	}
+	if (pos != len)
+		log_err("Invalid EFI variables journal\n");
+
+	return pos;
+}
+
 /**
  * efi_var_from_file() - read variables from file
  *
@@ -176,8 +323,19 @@ efi_status_t efi_var_from_file(void)
 		log_err("Failed to load EFI variables\n");
 		goto error;
 	}
-	if (buf->length != len || efi_var_restore(buf, false) != EFI_SUCCESS)
+	if (buf->length > len || efi_var_restore(buf, false) != EFI_SUCCESS) {
 		log_err("Invalid EFI variables file\n");
+		goto error;
+	}
+
+	/*
+	 * Records can only be appended to the file if the journal is intact,
+	 * so rewrite it on the next change otherwise
+	 */
+	if (efi_var_replay(buf, len) == len) {
+		efi_var_file_len = len;
+		efi_var_file_vars = buf->length;
+	}
 error:
 	free(buf);
 #endif
@@ -9,8 +9,16 @@
 
 #include <efi_loader.h>
 #include <efi_variable.h>
+#include <linux/log2.h>
 #include <u-boot/crc.h>
 
+/*
+ * Number of slots in the index of variables. Each variable takes at least 40
+ * bytes of the buffer, so the index never fills up.
+ */
+#define EFI_VAR_IDX_SLOTS	roundup_pow_of_two(EFI_VAR_BUF_SIZE / 32)
+#define EFI_VAR_IDX_OFS		ALIGN(EFI_VAR_BUF_SIZE, 8)
+
 /*
  * The variables efi_var_file and efi_var_entry must be static to avoid
  * referencing them via the global offset table (section .got). The GOT
@@ -21,6 +29,77 @@ static struct efi_var_file __efi_runtime_data *efi_var_buf;
 static struct efi_var_entry __efi_runtime_data *efi_current_var;
 static const u16 __efi_runtime_rodata vtf[] = u"VarToFile";
 
+/**
+ * efi_var_idx() - get the index of variables
+ *
+ * The index is a hash table with linear probing, kept in the same pages as
+ * efi_var_buf so that it moves with it in SetVirtualAddressMap(). Each slot
+ * holds the offset of a variable from the start of efi_var_buf, or 0 if the
+ * slot is empty.
+ *
+ * Return:	first slot of the index
+ */
+static u32 __efi_runtime *efi_var_idx(void)
+{
+	return (u32 *)((uintptr_t)efi_var_buf + EFI_VAR_IDX_OFS);
+}
+
+/**
+ * efi_var_hash() - calculate the hash of a variable's GUID and name
+ *
+ * @guid:	vendor GUID
+ * @name:	variable name
+ * Return:	hash value (FNV-1a)
+ */
+static u32 __efi_runtime efi_var_hash(const efi_guid_t *guid, const u16 *name)
+{
+	const u8 *p = (const u8 *)guid;
+	u32 hash = 2166136261;
+	int i;
+
+	for (i = 0; i < sizeof(efi_guid_t); i++)
+		hash = (hash ^ p[i]) * 16777619;
+	for (; *name; name++)
+		hash = (hash ^ *name) * 16777619;
+
+	return hash;
+}
+
+/**
+ * efi_var_idx_add() - add a variable to the index
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_idx_add(struct efi_var_entry *var)
+{
+	u32 *idx = efi_var_idx();
+	u32 i;
+
+	i = efi_var_hash(&var->guid, var->name) & (EFI_VAR_IDX_SLOTS - 1);
+	while (idx[i])
+		i = (i + 1) & (EFI_VAR_IDX_SLOTS - 1);
+	idx[i] = (uintptr_t)var - (uintptr_t)efi_var_buf;
+}
+
+/**
+ * efi_var_idx_rebuild() - rebuild the index after variables have moved
+ */
+static void __efi_runtime efi_var_idx_rebuild(void)
+{
+	struct efi_var_entry *var, *last;
+	u32 *idx = efi_var_idx();
+	u32 i;
+
+	for (i = 0; i < EFI_VAR_IDX_SLOTS; i++)
+		idx[i] = 0;
+
+	last = (struct efi_var_entry *)
+	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	for (var = efi_var_buf->var; var < last;
+	     var = (void *)var + efi_var_entry_len(var))
+		efi_var_idx_add(var);
+}
+
 /**
  * efi_var_mem_compare() - compare GUID and name with a variable
  *
@@ -86,6 +165,8 @@ struct efi_var_entry __efi_runtime
 		  struct efi_var_entry **next)
 {
 	struct efi_var_entry *var, *last;
+	u32 *idx = efi_var_idx();
+	u32 i;
 
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
@@ -105,21 +186,15 @@ struct efi_var_entry __efi_runtime
 		return efi_current_var;
 	}
 
-	var = efi_var_buf->var;
-	if (var < last) {
-		for (; var;) {
-			struct efi_var_entry *pos;
-			bool match;
-
-			match = efi_var_mem_compare(var, guid, name, &pos);
-			if (pos >= last)
-				pos = NULL;
-			if (match) {
-				if (next)
-					*next = pos;
-				return var;
-			}
-			var = pos;
+	for (i = efi_var_hash(guid, name) & (EFI_VAR_IDX_SLOTS - 1); idx[i];
+	     i = (i + 1) & (EFI_VAR_IDX_SLOTS - 1)) {
+		struct efi_var_entry *pos;
+
+		var = (struct efi_var_entry *)((uintptr_t)efi_var_buf + idx[i]);
+		if (efi_var_mem_compare(var, guid, name, &pos)) {
+			if (next)
+				*next = pos < last ? pos : NULL;
+			return var;
 		}
 	}
 	if (next)
@@ -152,6 +227,7 @@ void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 	efi_var_buf->crc32 = crc32(0, (u8 *)efi_var_buf->var,
 				   efi_var_buf->length -
 				   sizeof(struct efi_var_file));
+	efi_var_idx_rebuild();
 }
 
 efi_status_t __efi_runtime efi_var_mem_ins(
@@ -183,6 +259,7 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 			   sizeof(u16) * var_name_len);
 	efi_memcpy_runtime(data, data1, size1);
 	efi_memcpy_runtime((u8 *)data + size1, data2, size2);
+	efi_var_idx_add(var);
 
 	var = (struct efi_var_entry *)
 	      ALIGN((uintptr_t)data + var->length, 8);
@@ -225,12 +302,15 @@ efi_status_t efi_var_mem_init(void)
 
 	ret = efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
 				 EFI_RUNTIME_SERVICES_DATA,
-				 efi_size_in_pages(EFI_VAR_BUF_SIZE),
+				 efi_size_in_pages(EFI_VAR_IDX_OFS +
+						   EFI_VAR_IDX_SLOTS *
+						   sizeof(u32)),
 				 &memory);
 	if (ret != EFI_SUCCESS)
 		return ret;
 	efi_var_buf = (struct efi_var_file *)(uintptr_t)memory;
-	memset(efi_var_buf, 0, EFI_VAR_BUF_SIZE);
+	memset(efi_var_buf, 0, EFI_VAR_IDX_OFS +
+	       EFI_VAR_IDX_SLOTS * sizeof(u32));
 	efi_var_buf->magic = EFI_VAR_FILE_MAGIC;
 	efi_var_buf->length = (uintptr_t)efi_var_buf->var -
 			      (uintptr_t)efi_var_buf;
@@ -399,4 +479,6 @@ skip:
 void efi_var_buf_update(struct efi_var_file *var_buf)
 {
 	memcpy(efi_var_buf, var_buf, EFI_VAR_BUF_SIZE);
+	efi_current_var = NULL;
+	efi_var_idx_rebuild();
 }
@@ -401,7 +401,7 @@ efi_status_t efi_set_variable_int(const u16 *variable_name,
 	 * TODO: check if a value change has occured to avoid superfluous writes
 	 */
 	if (attributes & EFI_VARIABLE_NON_VOLATILE)
-		efi_var_to_file();
+		efi_var_log_to_file(variable_name, vendor);
 
 	return EFI_SUCCESS;
 }
@@ -598,10 +598,15 @@ efi_status_t efi_init_variables(void)
 	if (ret != EFI_SUCCESS)
 		return ret;
 	if (IS_ENABLED(CONFIG_EFI_VARIABLES_PRESEED)) {
-		ret = efi_var_restore((struct efi_var_file *)
-				      __efi_var_file_begin, true);
+		struct efi_var_file *seed;
+
+		seed = (struct efi_var_file *)__efi_var_file_begin;
+		ret = efi_var_restore(seed, true);
 		if (ret != EFI_SUCCESS)
 			log_err("Invalid EFI variable seed\n");
+		else if (seed->length != __efi_var_file_end -
+					 __efi_var_file_begin)
+			log_warning("Ignoring journal in EFI variable seed\n");
 	}
 
 	return efi_init_secure_state();
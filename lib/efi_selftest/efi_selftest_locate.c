@@ -0,0 +1,410 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * efi_selftest_locate
+ *
+ * This unit test checks the following boottime services:
+ * LocateHandle, LocateHandleBuffer, LocateProtocol
+ *
+ * Many handles are created, as firmware with several block devices,
+ * partitions and network interfaces does. A protocol is installed on all of
+ * them and another on only two of them. The handles and interfaces located
+ * are checked as protocols are uninstalled and installed again.
+ *
+ * The time taken by LocateHandleBuffer for each protocol is printed, but not
+ * checked, since it varies between boards.
+ */
+
+#include <efi_selftest.h>
+#include <time.h>
+
+#define EFI_ST_LOCATE_HANDLES 256
+#define EFI_ST_LOCATE_RARE 3
+#define EFI_ST_LOCATE_LOOPS 1000
+
+static const efi_guid_t guid_common =
+	EFI_GUID(0x8f7a61b5, 0x5d4c, 0x4e4b,
+		 0x9b, 0x0c, 0x41, 0x95, 0x1a, 0x6d, 0x2e, 0x01);
+static const efi_guid_t guid_rare =
+	EFI_GUID(0x8f7a61b5, 0x5d4c, 0x4e4b,
+		 0x9b, 0x0c, 0x41, 0x95, 0x1a, 0x6d, 0x2e, 0x02);
+static const efi_guid_t guid_missing =
+	EFI_GUID(0x8f7a61b5, 0x5d4c, 0x4e4b,
+		 0x9b, 0x0c, 0x41, 0x95, 0x1a, 0x6d, 0x2e, 0x03);
+
+static struct efi_boot_services *boottime;
+static efi_handle_t handles[EFI_ST_LOCATE_HANDLES];
+static u8 interfaces[EFI_ST_LOCATE_HANDLES];
+/* guid_rare is installed on handles[EFI_ST_LOCATE_RARE] and the last handle */
+static u8 interface_rare[2];
+
+/**
+ * setup() - setup unit test
+ *
+ * Install guid_common on all handles and guid_rare on two of them.
+ *
+ * @handle:	handle of the loaded image
+ * @systable:	system table
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int setup(const efi_handle_t handle,
+		 const struct efi_system_table *systable)
+{
+	efi_status_t ret;
+	int i;
+
+	boottime = systable->boottime;
+
+	for (i = 0; i < EFI_ST_LOCATE_HANDLES; i++) {
+		ret = boottime->install_protocol_interface
+				(&handles[i], &guid_common,
+				 EFI_NATIVE_INTERFACE, &interfaces[i]);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("InstallProtocolInterface failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	ret = boottime->install_protocol_interface
+			(&handles[EFI_ST_LOCATE_RARE], &guid_rare,
+			 EFI_NATIVE_INTERFACE, &interface_rare[0]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("InstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->install_protocol_interface
+			(&handles[EFI_ST_LOCATE_HANDLES - 1], &guid_rare,
+			 EFI_NATIVE_INTERFACE, &interface_rare[1]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("InstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * teardown() - tear down unit test
+ *
+ * Uninstalling the last protocol of a handle deletes the handle.
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int teardown(void)
+{
+	efi_status_t ret;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(interface_rare); i++) {
+		efi_handle_t handle;
+
+		handle = handles[i ? EFI_ST_LOCATE_HANDLES - 1 :
+				 EFI_ST_LOCATE_RARE];
+		if (!handle)
+			continue;
+		ret = boottime->uninstall_protocol_interface
+				(handle, &guid_rare, &interface_rare[i]);
+		if (ret != EFI_SUCCESS && ret != EFI_NOT_FOUND) {
+			efi_st_error("UninstallProtocolInterface failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	for (i = 0; i < EFI_ST_LOCATE_HANDLES; i++) {
+		if (!handles[i])
+			continue;
+		ret = boottime->uninstall_protocol_interface
+				(handles[i], &guid_common, &interfaces[i]);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("UninstallProtocolInterface failed\n");
+			return EFI_ST_FAILURE;
+		}
+		handles[i] = NULL;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * check_buffer() - check that a buffer holds exactly the expected handles
+ *
+ * The order of the handles is not defined.
+ *
+ * @buffer:	handles found
+ * @count:	number of handles found
+ * @expected:	expected handles, NULL entries are skipped
+ * @size:	number of entries in @expected
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int check_buffer(efi_handle_t *buffer, efi_uintn_t count,
+			efi_handle_t *expected, efi_uintn_t size)
+{
+	efi_uintn_t i, j, matches;
+
+	for (i = 0, matches = 0; i < size; i++) {
+		if (!expected[i])
+			continue;
+		for (j = 0; j < count && buffer[j] != expected[i]; j++)
+			;
+		if (j == count) {
+			efi_st_error("Handle %u not found\n", (u32)i);
+			return EFI_ST_FAILURE;
+		}
+		matches++;
+	}
+	if (count != matches) {
+		efi_st_error("Found %u handles, expected %u\n", (u32)count,
+			     (u32)matches);
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * locate() - locate the handles of a protocol and check them
+ *
+ * Both LocateHandle and LocateHandleBuffer are checked.
+ *
+ * @guid:	protocol to locate
+ * @expected:	expected handles, NULL entries are skipped
+ * @size:	number of entries in @expected
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int locate(const efi_guid_t *guid, efi_handle_t *expected,
+		  efi_uintn_t size)
+{
+	efi_uintn_t i, count, found, buffer_size;
+	efi_handle_t *buffer;
+	efi_status_t ret;
+
+	for (i = 0, count = 0; i < size; i++)
+		count += expected[i] ? 1 : 0;
+
+	ret = boottime->locate_handle_buffer(BY_PROTOCOL, guid, NULL,
+					     &found, &buffer);
+	if (!count) {
+		if (ret != EFI_NOT_FOUND) {
+			efi_st_error("LocateHandleBuffer found a protocol which is not installed\n");
+			return EFI_ST_FAILURE;
+		}
+	} else {
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("LocateHandleBuffer failed\n");
+			return EFI_ST_FAILURE;
+		}
+		ret = check_buffer(buffer, found, expected, size);
+		boottime->free_pool(buffer);
+		if (ret != EFI_ST_SUCCESS)
+			return EFI_ST_FAILURE;
+	}
+
+	buffer_size = 0;
+	ret = boottime->locate_handle(BY_PROTOCOL, guid, NULL, &buffer_size,
+				      NULL);
+	if (!count) {
+		if (ret != EFI_NOT_FOUND) {
+			efi_st_error("LocateHandle found a protocol which is not installed\n");
+			return EFI_ST_FAILURE;
+		}
+		return EFI_ST_SUCCESS;
+	}
+	if (ret != EFI_BUFFER_TOO_SMALL ||
+	    buffer_size != count * sizeof(efi_handle_t)) {
+		efi_st_error("LocateHandle did not return the buffer size\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->allocate_pool(EFI_LOADER_DATA, buffer_size,
+				      (void **)&buffer);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("AllocatePool failed\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->locate_handle(BY_PROTOCOL, guid, NULL, &buffer_size,
+				      buffer);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("LocateHandle failed\n");
+		boottime->free_pool(buffer);
+		return EFI_ST_FAILURE;
+	}
+	ret = check_buffer(buffer, buffer_size / sizeof(efi_handle_t),
+			   expected, size);
+	boottime->free_pool(buffer);
+
+	return ret;
+}
+
+/**
+ * locate_rare() - check the handles and interface located for guid_rare
+ *
+ * @first:	whether guid_rare is expected on handles[EFI_ST_LOCATE_RARE]
+ * @last:	whether guid_rare is expected on the last handle
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int locate_rare(bool first, bool last)
+{
+	efi_handle_t expected[2];
+	efi_status_t ret;
+	void *interface;
+
+	expected[0] = first ? handles[EFI_ST_LOCATE_RARE] : NULL;
+	expected[1] = last ? handles[EFI_ST_LOCATE_HANDLES - 1] : NULL;
+	if (locate(&guid_rare, expected, ARRAY_SIZE(expected)) !=
+	    EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	ret = boottime->locate_protocol(&guid_rare, NULL, &interface);
+	if (!first && !last) {
+		if (ret != EFI_NOT_FOUND) {
+			efi_st_error("LocateProtocol found uninstalled protocol\n");
+			return EFI_ST_FAILURE;
+		}
+		return EFI_ST_SUCCESS;
+	}
+	if (ret != EFI_SUCCESS ||
+	    !((first && interface == &interface_rare[0]) ||
+	      (last && interface == &interface_rare[1]))) {
+		efi_st_error("LocateProtocol returned the wrong interface\n");
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * bench() - measure the time taken by LocateHandleBuffer
+ *
+ * @guid:	protocol to locate
+ * @name:	description of the handles located, to print
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int bench(const efi_guid_t *guid, const char *name)
+{
+	efi_handle_t *buffer;
+	efi_uintn_t count;
+	efi_status_t ret;
+	ulong start;
+	int i;
+
+	start = timer_get_us();
+	for (i = 0; i < EFI_ST_LOCATE_LOOPS; i++) {
+		ret = boottime->locate_handle_buffer(BY_PROTOCOL, guid, NULL,
+						     &count, &buffer);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("LocateHandleBuffer failed\n");
+			return EFI_ST_FAILURE;
+		}
+		ret = boottime->free_pool(buffer);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("FreePool failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	efi_st_printf("LocateHandleBuffer (%s): %u ns\n", name,
+		      (u32)((u64)(timer_get_us() - start) * 1000 /
+			    EFI_ST_LOCATE_LOOPS));
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * execute() - execute unit test
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int execute(void)
+{
+	efi_status_t ret;
+	void *interface;
+
+	if (locate(&guid_common, handles, EFI_ST_LOCATE_HANDLES) !=
+	    EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	if (locate_rare(true, true) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	if (locate(&guid_missing, NULL, 0) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	ret = boottime->locate_protocol(&guid_missing, NULL, &interface);
+	if (ret != EFI_NOT_FOUND) {
+		efi_st_error("LocateProtocol found a protocol which is not installed\n");
+		return EFI_ST_FAILURE;
+	}
+
+	efi_st_printf("%u handles\n", EFI_ST_LOCATE_HANDLES);
+	if (bench(&guid_common, "all handles") != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	if (bench(&guid_rare, "two handles") != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Uninstalling from one handle leaves the other */
+	ret = boottime->uninstall_protocol_interface
+			(handles[EFI_ST_LOCATE_RARE], &guid_rare,
+			 &interface_rare[0]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("UninstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (locate_rare(false, true) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Uninstalling the only protocol of a handle deletes the handle */
+	ret = boottime->uninstall_protocol_interface(handles[0], &guid_common,
+						     &interfaces[0]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("UninstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+	handles[0] = NULL;
+	if (locate(&guid_common, handles, EFI_ST_LOCATE_HANDLES) !=
+	    EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Installing again creates a new handle, which is found too */
+	ret = boottime->install_protocol_interface(&handles[0], &guid_common,
+						   EFI_NATIVE_INTERFACE,
+						   &interfaces[0]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("InstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (locate(&guid_common, handles, EFI_ST_LOCATE_HANDLES) !=
+	    EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Reinstalling on the first handle makes it visible again */
+	ret = boottime->install_protocol_interface
+			(&handles[EFI_ST_LOCATE_RARE], &guid_rare,
+			 EFI_NATIVE_INTERFACE, &interface_rare[0]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("InstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (locate_rare(true, true) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* After uninstalling both, the protocol must not be found any more */
+	ret = boottime->uninstall_protocol_interface
+			(handles[EFI_ST_LOCATE_RARE], &guid_rare,
+			 &interface_rare[0]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("UninstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->uninstall_protocol_interface
+			(handles[EFI_ST_LOCATE_HANDLES - 1], &guid_rare,
+			 &interface_rare[1]);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("UninstallProtocolInterface failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (locate_rare(false, false) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* The common protocol is still found on all handles */
+	return locate(&guid_common, handles, EFI_ST_LOCATE_HANDLES);
+}
+
+EFI_UNIT_TEST(locate) = {
+	.name = "locate handles",
+	.phase = EFI_EXECUTE_BEFORE_BOOTTIME_EXIT,
+	.setup = setup,
+	.execute = execute,
+	.teardown = teardown,
+};
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * efi_selftest_pool
+ *
+ * This unit test checks the following boottime services:
+ * AllocatePool, FreePool
+ *
+ * Many small pool allocations are made, as EFI applications like GRUB do.
+ * Their effect on the size of the memory map is compared with using one page
+ * for each allocation. The time taken by each is printed but not checked,
+ * since it varies between boards.
+ */
+
+#include <efi_selftest.h>
+#include <time.h>
+
+#define EFI_ST_POOL_COUNT 512
+
+static struct efi_boot_services *boottime;
+static void *bufs[EFI_ST_POOL_COUNT];
+
+/**
+ * setup() - setup unit test
+ *
+ * @handle:	handle of the loaded image
+ * @systable:	system table
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int setup(const efi_handle_t handle,
+		 const struct efi_system_table *systable)
+{
+	boottime = systable->boottime;
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * map_entries() - get the number of entries in the memory map
+ *
+ * @entries:	returns the number of entries
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int map_entries(efi_uintn_t *entries)
+{
+	efi_uintn_t map_size = 0;
+	efi_uintn_t map_key;
+	efi_uintn_t desc_size;
+	u32 desc_version;
+	efi_status_t ret;
+
+	ret = boottime->get_memory_map(&map_size, NULL, &map_key, &desc_size,
+				       &desc_version);
+	if (ret != EFI_BUFFER_TOO_SMALL) {
+		efi_st_error
+			("GetMemoryMap did not return EFI_BUFFER_TOO_SMALL\n");
+		return EFI_ST_FAILURE;
+	}
+	*entries = map_size / desc_size;
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * pool_type() - get the memory type to use for an allocation
+ *
+ * Alternate between two types so that neighbouring page allocations cannot be
+ * merged in the memory map.
+ *
+ * @i:		index of the allocation
+ * Return:	memory type
+ */
+static enum efi_memory_type pool_type(int i)
+{
+	return i & 1 ? EFI_BOOT_SERVICES_DATA : EFI_LOADER_DATA;
+}
+
+/**
+ * pool_size() - get the size to use for an allocation
+ *
+ * @i:		index of the allocation
+ * Return:	size in bytes
+ */
+static efi_uintn_t pool_size(int i)
+{
+	return 1 + (i * 37) % 400;
+}
+
+/**
+ * alloc_pool() - make small pool allocations and check them
+ *
+ * @added:	returns the number of memory map entries added
+ * @us:		returns the time taken to allocate, in microseconds
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int alloc_pool(efi_uintn_t *added, u32 *us)
+{
+	efi_uintn_t before, after;
+	efi_status_t ret;
+	ulong start;
+	u8 *buf;
+	efi_uintn_t j;
+	int i;
+
+	if (map_entries(&before) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	start = timer_get_us();
+	for (i = 0; i < EFI_ST_POOL_COUNT; i++) {
+		ret = boottime->allocate_pool(pool_type(i), pool_size(i),
+					      &bufs[i]);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("AllocatePool did not return EFI_SUCCESS\n");
+			return EFI_ST_FAILURE;
+		}
+		boottime->set_mem(bufs[i], pool_size(i), i);
+	}
+	*us = timer_get_us() - start;
+	if (map_entries(&after) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	*added = after - before;
+
+	/* Check that the allocations are aligned and do not overlap */
+	for (i = 0; i < EFI_ST_POOL_COUNT; i++) {
+		buf = bufs[i];
+		if ((uintptr_t)buf & 7) {
+			efi_st_error("Buffer %p is not 8-byte aligned\n", buf);
+			return EFI_ST_FAILURE;
+		}
+		for (j = 0; j < pool_size(i); j++) {
+			if (buf[j] != (u8)i) {
+				efi_st_error("Buffer %p was overwritten\n", buf);
+				return EFI_ST_FAILURE;
+			}
+		}
+	}
+
+	for (i = 0; i < EFI_ST_POOL_COUNT; i++) {
+		ret = boottime->free_pool(bufs[i]);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("FreePool did not return EFI_SUCCESS\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * alloc_pages() - make the same allocations using a page for each
+ *
+ * @added:	returns the number of memory map entries added
+ * @us:		returns the time taken to allocate, in microseconds
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int alloc_pages(efi_uintn_t *added, u32 *us)
+{
+	efi_uintn_t before, after;
+	efi_status_t ret;
+	ulong start;
+	u64 addr;
+	int i;
+
+	if (map_entries(&before) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	start = timer_get_us();
+	for (i = 0; i < EFI_ST_POOL_COUNT; i++) {
+		ret = boottime->allocate_pages(EFI_ALLOCATE_ANY_PAGES,
+					       pool_type(i), 1, &addr);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("AllocatePages did not return EFI_SUCCESS\n");
+			return EFI_ST_FAILURE;
+		}
+		bufs[i] = (void *)(uintptr_t)addr;
+		boottime->set_mem(bufs[i], pool_size(i), i);
+	}
+	*us = timer_get_us() - start;
+	if (map_entries(&after) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	*added = after - before;
+
+	for (i = 0; i < EFI_ST_POOL_COUNT; i++) {
+		ret = boottime->free_pages((uintptr_t)bufs[i], 1);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("FreePages did not return EFI_SUCCESS\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/*
+ * execute() - execute unit test
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int execute(void)
+{
+	efi_uintn_t pool_added, pages_added;
+	u32 pool_us, pages_us;
+
+	if (alloc_pool(&pool_added, &pool_us) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	if (alloc_pages(&pages_added, &pages_us) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	efi_st_printf("%u allocations\n", EFI_ST_POOL_COUNT);
+	efi_st_printf("pool:  %u memory map entries added, %u us\n",
+		      (u32)pool_added, pool_us);
+	efi_st_printf("pages: %u memory map entries added, %u us\n",
+		      (u32)pages_added, pages_us);
+
+	/* The pool should share pages between allocations */
+	if (pool_added * 4 > pages_added) {
+		efi_st_error("Pool allocations use too many map entries\n");
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+EFI_UNIT_TEST(pool) = {
+	.name = "pool allocation",
+	.phase = EFI_EXECUTE_BEFORE_BOOTTIME_EXIT,
+	.setup = setup,
+	.execute = execute,
+};
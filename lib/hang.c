@@ -28,6 +28,8 @@ void hang(void)
 	puts("### ERROR ### Please RESET the board ###\n");
 #endif
 	bootstage_error(BOOTSTAGE_ID_NEED_RESET);
+	/* Nothing drains the console from here on, so push it out now */
+	flush();
 	if (IS_ENABLED(CONFIG_SANDBOX))
 		os_exit(1);
 	for (;;)
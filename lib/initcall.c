@@ -3,6 +3,7 @@
  * Copyright (c) 2013 The Chromium OS Authors.
  */
 
+#include <bootprof.h>
 #include <efi.h>
 #include <initcall.h>
 #include <log.h>
@@ -51,6 +52,7 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 {
 	ulong reloc_ofs;
 	const init_fnc_t *ptr;
+	struct bootprof_ctx ctx;
 	enum event_t type;
 	init_fnc_t func;
 	int ret = 0;
@@ -71,7 +73,15 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 			debug("initcall: %p\n", (char *)func - reloc_ofs);
 		}
 
+		bootprof_start(&ctx);
 		ret = type ? event_notify_null(type) : func();
+		if (type)
+			bootprof_end_call(&ctx, BOOTPROFT_EVENT, type,
+					  CONFIG_IS_ENABLED(EVENT_DEBUG) ?
+					  event_type_name(type) : NULL);
+		else
+			bootprof_end_call(&ctx, BOOTPROFT_INITCALL,
+					  (ulong)func - reloc_ofs, NULL);
 		if (ret)
 			break;
 	}
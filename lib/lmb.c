@@ -73,16 +73,41 @@ static long lmb_regions_adjacent(struct alist *lmb_rgn_lst, unsigned long r1,
 	return lmb_addrs_adjacent(base1, size1, base2, size2);
 }
 
-static void lmb_remove_region(struct alist *lmb_rgn_lst, unsigned long r)
+/**
+ * lmb_first_region() - find the first region ending at or above an address
+ * @lmb_rgn_lst: LMB list to search
+ * @addr: Address to look for
+ *
+ * The regions in a list are sorted and do not overlap, so they can be searched
+ * with a binary search rather than being scanned one by one.
+ *
+ * Return: index of the region containing @addr, else of the lowest region
+ * above @addr, or the number of regions if there is none
+ */
+static unsigned long lmb_first_region(struct alist *lmb_rgn_lst,
+				      phys_addr_t addr)
 {
-	unsigned long i;
 	struct lmb_region *rgn = lmb_rgn_lst->data;
+	unsigned long lo = 0, hi = lmb_rgn_lst->count;
+
+	while (lo < hi) {
+		unsigned long mid = lo + (hi - lo) / 2;
 
-	for (i = r; i < lmb_rgn_lst->count - 1; i++) {
-		rgn[i].base = rgn[i + 1].base;
-		rgn[i].size = rgn[i + 1].size;
-		rgn[i].flags = rgn[i + 1].flags;
+		if (rgn[mid].base + rgn[mid].size - 1 < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+
+	return lo;
+}
+
+static void lmb_remove_region(struct alist *lmb_rgn_lst, unsigned long r)
+{
+	struct lmb_region *rgn = lmb_rgn_lst->data;
+
+	memmove(&rgn[r], &rgn[r + 1],
+		(lmb_rgn_lst->count - r - 1) * sizeof(*rgn));
 	lmb_rgn_lst->count--;
 }
 
@@ -146,6 +171,9 @@ static long lmb_resize_regions(struct alist *lmb_rgn_lst,
 				return -1;
 			rgn_cnt++;
 			idx_end = idx;
+		} else if (rgnbase > base) {
+			/* No later region can overlap */
+			break;
 		}
 		idx++;
 	}
@@ -193,8 +221,13 @@ static long lmb_add_region_flags(struct alist *lmb_rgn_lst, phys_addr_t base,
 	if (alist_err(lmb_rgn_lst))
 		return -1;
 
-	/* First try and coalesce this LMB with another. */
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
+	/*
+	 * First try and coalesce this LMB with another. Only the first region
+	 * which reaches @base, or ends just before it, can be adjacent to or
+	 * overlap it.
+	 */
+	for (i = lmb_first_region(lmb_rgn_lst, base ? base - 1 : 0);
+	     i < lmb_rgn_lst->count; i++) {
 		phys_addr_t rgnbase = rgn[i].base;
 		phys_size_t rgnsize = rgn[i].size;
 		u32 rgnflags = rgn[i].flags;
@@ -225,6 +258,10 @@ static long lmb_add_region_flags(struct alist *lmb_rgn_lst, phys_addr_t base,
 			break;
 
 			return -1;
+		} else {
+			/* The regions are sorted, so no later one can touch */
+			i = lmb_rgn_lst->count;
+			break;
 		}
 	}
 
@@ -281,16 +318,14 @@ static long _lmb_free(struct alist *lmb_rgn_lst, phys_addr_t base,
 
 	rgn = lmb_rgn_lst->data;
 	/* Find the region where (base, size) belongs to */
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
+	i = lmb_first_region(lmb_rgn_lst, base);
+	if (i < lmb_rgn_lst->count) {
 		rgnbegin = rgn[i].base;
 		rgnend = rgnbegin + rgn[i].size - 1;
-
-		if (rgnbegin <= base && end <= rgnend)
-			break;
 	}
 
 	/* Didn't find the region */
-	if (i == lmb_rgn_lst->count)
+	if (i == lmb_rgn_lst->count || rgnbegin > base || end > rgnend)
 		return -1;
 
 	/* Check to see if we are removing entire region */
@@ -327,15 +362,12 @@ static long lmb_overlaps_region(struct alist *lmb_rgn_lst, phys_addr_t base,
 	unsigned long i;
 	struct lmb_region *rgn = lmb_rgn_lst->data;
 
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
-		phys_addr_t rgnbase = rgn[i].base;
-		phys_size_t rgnsize = rgn[i].size;
+	i = lmb_first_region(lmb_rgn_lst, base);
+	if (i < lmb_rgn_lst->count &&
+	    lmb_addrs_overlap(base, size, rgn[i].base, rgn[i].size))
+		return i;
 
-		if (lmb_addrs_overlap(base, size, rgnbase, rgnsize))
-			break;
-	}
-
-	return (i < lmb_rgn_lst->count) ? i : -1;
+	return -1;
 }
 
 /*
@@ -749,16 +781,14 @@ phys_size_t lmb_get_free_size(phys_addr_t addr)
 	/* check if the requested address is in the memory regions */
 	rgn = lmb_overlaps_region(&lmb.available_mem, addr, 1);
 	if (rgn >= 0) {
-		for (i = 0; i < lmb.used_mem.count; i++) {
+		i = lmb_first_region(&lmb.used_mem, addr);
+		if (i < lmb.used_mem.count) {
 			if (addr < lmb_used[i].base) {
 				/* first reserved range > requested address */
 				return lmb_used[i].base - addr;
 			}
-			if (lmb_used[i].base +
-			    lmb_used[i].size > addr) {
-				/* requested addr is in this reserved range */
-				return 0;
-			}
+			/* requested addr is in this reserved range */
+			return 0;
 		}
 		/* if we come here: no reserved ranges above requested addr */
 		return lmb_memory[lmb.available_mem.count - 1].base +
@@ -772,12 +802,10 @@ int lmb_is_reserved_flags(phys_addr_t addr, int flags)
 	int i;
 	struct lmb_region *lmb_used = lmb.used_mem.data;
 
-	for (i = 0; i < lmb.used_mem.count; i++) {
-		phys_addr_t upper = lmb_used[i].base +
-			lmb_used[i].size - 1;
-		if (addr >= lmb_used[i].base && addr <= upper)
-			return (lmb_used[i].flags & flags) == flags;
-	}
+	i = lmb_first_region(&lmb.used_mem, addr);
+	if (i < lmb.used_mem.count && addr >= lmb_used[i].base)
+		return (lmb_used[i].flags & flags) == flags;
+
 	return 0;
 }
 
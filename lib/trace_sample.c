@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler
+ *
+ * Unlike function tracing, this does not instrument every function, so it
+ * does not distort the timing. Instead, schedule() records where it was
+ * called from, at most once per sampling period. Each sample is weighted by
+ * the time since the previous one, so the samples show roughly where the
+ * time goes. Code which runs for a long time without calling schedule() is
+ * charged to the next place which does call it.
+ *
+ * With CONFIG_TRACE_SAMPLE_FP, the call chain is recorded too, by following
+ * the frame pointers.
+ */
+
+#include <display_options.h>
+#include <time.h>
+#include <trace.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include <asm/global_data.h>
+#include <asm/sections.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	/* Largest stack frame which is followed when walking the stack */
+	MAX_FRAME_SIZE	= 0x10000,
+};
+
+/**
+ * struct sample_hdr - header at the start of the sample buffer
+ *
+ * @count: Number of samples taken. When this exceeds @size, the oldest
+ *	samples have been overwritten
+ * @size: Number of samples there is space for
+ * @last_us: Time of the previous sample, or 0 if none has been taken
+ * @locked: true while a sample is being taken, to detect recursion
+ * @samples: Ring buffer of samples
+ */
+struct sample_hdr {
+	ulong count;
+	ulong size;
+	ulong last_us;
+	bool locked;
+	struct trace_sample samples[];
+};
+
+/*
+ * Pointer to start of sample buffer. This is in .data since schedule() can be
+ * called before relocation, when BSS is not available
+ */
+static struct sample_hdr *hdr __section(".data");
+
+/**
+ * struct frame_rec - frame record pushed by a function prologue
+ *
+ * @next: Frame pointer of the calling function
+ * @ret: Return address into the calling function
+ */
+struct frame_rec {
+	ulong next;
+	ulong ret;
+};
+
+static ulong notrace pc_to_offset(ulong pc)
+{
+#ifdef CONFIG_SANDBOX
+	return pc - (ulong)_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		return pc - gd->relocaddr;
+	else
+		return pc - CONFIG_TEXT_BASE;
+#endif
+}
+
+/**
+ * frame_to_rec() - Get the frame record for a frame pointer
+ *
+ * @fp: Frame pointer
+ * Return: frame record
+ */
+static const struct frame_rec *notrace frame_to_rec(ulong fp)
+{
+#ifdef __riscv
+	/* RISC-V puts the record just below the frame pointer */
+	return (struct frame_rec *)fp - 1;
+#else
+	return (struct frame_rec *)fp;
+#endif
+}
+
+/**
+ * walk_stack() - Record the call chain of a sample
+ *
+ * The walk stops at the first return address outside U-Boot, or at a frame
+ * pointer which does not look like the caller's, so a corrupt or partial
+ * chain cannot take it outside the stack
+ *
+ * @pc: Address where the sample was taken
+ * @frame: Frame address of the function which took the sample
+ * @out: Returns the code offsets, innermost first
+ * Return: number of offsets written to @out
+ */
+static int notrace walk_stack(ulong pc, const void *frame, uint32_t *out)
+{
+	ulong fp = (ulong)frame;
+	int depth;
+
+	if (!IS_ENABLED(CONFIG_TRACE_SAMPLE_FP) || !fp) {
+		out[0] = pc_to_offset(pc);
+		return 1;
+	}
+
+	for (depth = 0; depth < TRACE_SAMPLE_DEPTH; depth++) {
+		const struct frame_rec *rec = frame_to_rec(fp);
+		ulong offset = pc_to_offset(rec->ret);
+
+		if (offset >= gd->mon_len)
+			break;
+		out[depth] = offset;
+		if (rec->next <= fp || rec->next - fp > MAX_FRAME_SIZE ||
+		    rec->next & (sizeof(ulong) - 1)) {
+			depth++;
+			break;
+		}
+		fp = rec->next;
+	}
+	if (!depth) {
+		out[0] = pc_to_offset(pc);
+		depth = 1;
+	}
+
+	return depth;
+}
+
+void notrace trace_sample(uintptr_t pc, const void *frame)
+{
+	struct trace_sample *smp;
+	ulong now;
+
+	if (!hdr || hdr->locked)
+		return;
+
+	/* Reading the timer before it is set up would probe it from here */
+	if (CONFIG_IS_ENABLED(TIMER) && !IS_ENABLED(CONFIG_TIMER_EARLY) &&
+	    !gd->timer)
+		return;
+
+	hdr->locked = true;
+	now = timer_get_us();
+	if (!hdr->last_us) {
+		/* this is the start of the first period */
+		hdr->last_us = now;
+	} else if (now - hdr->last_us >= CONFIG_TRACE_SAMPLE_PERIOD_US) {
+		smp = &hdr->samples[hdr->count % hdr->size];
+		smp->time_us = now - hdr->last_us;
+		smp->depth = walk_stack(pc, frame, smp->pc);
+		hdr->last_us = now;
+		hdr->count++;
+	}
+	hdr->locked = false;
+}
+
+int trace_list_samples(void *buff, size_t buff_size, size_t *needed)
+{
+	struct trace_output_hdr *output_hdr = NULL;
+	void *end, *ptr = buff;
+	ulong rec, first, count;
+	size_t upto;
+
+	if (!hdr)
+		return -ENOENT;
+	end = buff ? buff + buff_size : NULL;
+
+	/* Place some header information */
+	if (ptr + sizeof(struct trace_output_hdr) < end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	/* Add each sample, oldest first */
+	count = min(hdr->count, hdr->size);
+	first = hdr->count - count;
+	for (rec = upto = 0; rec < count; rec++) {
+		if (ptr + sizeof(struct trace_sample) <= end) {
+			memcpy(ptr, &hdr->samples[(first + rec) % hdr->size],
+			       sizeof(struct trace_sample));
+			upto++;
+		}
+		ptr += sizeof(struct trace_sample);
+	}
+
+	/* Update the header */
+	if (output_hdr) {
+		memset(output_hdr, '\0', sizeof(*output_hdr));
+		output_hdr->rec_count = upto;
+		output_hdr->type = TRACE_CHUNK_SAMPLES;
+		output_hdr->version = TRACE_VERSION;
+		output_hdr->text_base = CONFIG_TEXT_BASE;
+	}
+
+	/* Work out how much of the buffer we used */
+	*needed = ptr - buff;
+	if (ptr > end)
+		return -ENOSPC;
+
+	return 0;
+}
+
+void trace_sample_print_stats(void)
+{
+	if (!hdr) {
+		printf("Sampling is disabled\n");
+		return;
+	}
+	print_grouped_ull(hdr->count, 10);
+	puts(" samples");
+	if (hdr->count > hdr->size) {
+		printf(" (%lu overwritten due to overflow)",
+		       hdr->count - hdr->size);
+	}
+	printf("\n%15d us sampling period\n", CONFIG_TRACE_SAMPLE_PERIOD_US);
+	print_grouped_ull(hdr->size, 10);
+	puts(" max samples\n");
+}
+
+int notrace trace_sample_init(void *buff, size_t buff_size)
+{
+	struct sample_hdr *new_hdr = buff;
+
+	if (buff_size < sizeof(*new_hdr) + sizeof(struct trace_sample)) {
+		printf("trace: sample buffer size %zx bytes is too small\n",
+		       buff_size);
+		return -ENOSPC;
+	}
+	memset(new_hdr, '\0', sizeof(*new_hdr));
+	new_hdr->size = (buff_size - sizeof(*new_hdr)) /
+		sizeof(struct trace_sample);
+	hdr = new_hdr;
+
+	return 0;
+}
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Work queue for running jobs concurrently
+ *
+ * On sandbox the jobs are run by a pool of host threads, so that parallel
+ * code can be developed and measured on the host. Elsewhere there is no pool
+ * and each job runs when it is submitted.
+ */
+
+#include <errno.h>
+#include <os.h>
+#include <workq.h>
+
+/**
+ * struct workq_priv - state of the work queue
+ *
+ * @head: first job waiting to run, or NULL
+ * @tailp: where to link the next job submitted
+ * @ids: IDs of the threads, for os_thread_join()
+ * @threads: number of threads running jobs
+ * @started: true once workq_init() has been called
+ * @quit: true to tell the threads to exit
+ */
+struct workq_priv {
+	struct workq_job *head;
+	struct workq_job **tailp;
+	unsigned long ids[WORKQ_MAX_THREADS];
+	int threads;
+	bool started;
+	bool quit;
+};
+
+static struct workq_priv workq = {
+	.tailp = &workq.head,
+};
+
+static void workq_lock(void)
+{
+	if (IS_ENABLED(CONFIG_SANDBOX))
+		os_workq_lock();
+}
+
+static void workq_unlock(void)
+{
+	if (IS_ENABLED(CONFIG_SANDBOX))
+		os_workq_unlock();
+}
+
+static void workq_sleep(void)
+{
+	if (IS_ENABLED(CONFIG_SANDBOX))
+		os_workq_wait();
+}
+
+static void workq_wake(void)
+{
+	if (IS_ENABLED(CONFIG_SANDBOX))
+		os_workq_wake();
+}
+
+static void *workq_thread(void *arg)
+{
+	struct workq_job *job;
+
+	workq_lock();
+	while (1) {
+		while (!workq.head && !workq.quit)
+			workq_sleep();
+		job = workq.head;
+		if (!job)
+			break;
+		workq.head = job->next;
+		if (!workq.head)
+			workq.tailp = &workq.head;
+		workq_unlock();
+
+		job->func(job->arg);
+
+		workq_lock();
+		job->done = true;
+		workq_wake();
+	}
+	workq_unlock();
+
+	return NULL;
+}
+
+int workq_init(int threads)
+{
+	int ret;
+
+	if (workq.started)
+		return -EALREADY;
+	if (threads < 0 || threads > WORKQ_MAX_THREADS)
+		return -EINVAL;
+	workq.started = true;
+	workq.quit = false;
+	if (!IS_ENABLED(CONFIG_SANDBOX))
+		return 0;
+
+	for (workq.threads = 0; workq.threads < threads; workq.threads++) {
+		ret = os_thread_create(workq_thread, NULL,
+				       &workq.ids[workq.threads]);
+		if (ret) {
+			workq_uninit();
+			return ret;
+		}
+	}
+
+	return workq.threads;
+}
+
+void workq_uninit(void)
+{
+	int i;
+
+	workq_lock();
+	workq.quit = true;
+	workq_wake();
+	workq_unlock();
+
+	/* The threads run any jobs left in the queue before exiting */
+	if (IS_ENABLED(CONFIG_SANDBOX)) {
+		for (i = 0; i < workq.threads; i++)
+			os_thread_join(workq.ids[i]);
+	}
+	workq.threads = 0;
+	workq.started = false;
+}
+
+int workq_threads(void)
+{
+	return workq.threads;
+}
+
+void workq_submit(struct workq_job *job)
+{
+	if (!workq.started) {
+		int threads = 0;
+
+#ifdef CONFIG_SANDBOX_WORKQ_THREADS
+		threads = CONFIG_SANDBOX_WORKQ_THREADS;
+#endif
+		workq_init(threads);
+	}
+
+	job->next = NULL;
+	job->done = false;
+	if (!workq.threads) {
+		job->func(job->arg);
+		job->done = true;
+		return;
+	}
+
+	workq_lock();
+	*workq.tailp = job;
+	workq.tailp = &job->next;
+	workq_wake();
+	workq_unlock();
+}
+
+void workq_wait(struct workq_job *job)
+{
+	workq_lock();
+	while (!job->done)
+		workq_sleep();
+	workq_unlock();
+}
+
+/**
+ * struct workq_cpu - a call submitted by workq_run_all()
+ *
+ * @job: job which makes the call
+ * @func: function to call
+ * @arg: argument to pass to @func
+ * @cpu: CPU number to pass to @func
+ */
+struct workq_cpu {
+	struct workq_job job;
+	void (*func)(void *arg, int cpu);
+	void *arg;
+	int cpu;
+};
+
+static void workq_run_cpu(void *arg)
+{
+	struct workq_cpu *cpu = arg;
+
+	cpu->func(cpu->arg, cpu->cpu);
+}
+
+int workq_run_all(void (*func)(void *arg, int cpu), void *arg)
+{
+	struct workq_cpu cpus[WORKQ_MAX_THREADS];
+	int count, i;
+
+	if (!workq.threads) {
+		func(arg, 0);
+		return 1;
+	}
+
+	count = workq.threads;
+	for (i = 0; i < count; i++) {
+		cpus[i].func = func;
+		cpus[i].arg = arg;
+		cpus[i].cpu = i;
+		workq_job_init(&cpus[i].job, workq_run_cpu, &cpus[i]);
+		workq_submit(&cpus[i].job);
+	}
+	for (i = 0; i < count; i++)
+		workq_wait(&cpus[i].job);
+
+	return count;
+}
@@ -12,6 +12,8 @@
 #include <bootflow.h>
 #include <mapmem.h>
 #include <os.h>
+#include <time.h>
+#include <usb.h>
 #include <test/suites.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
@@ -398,7 +400,7 @@ static int bootdev_test_hunter(struct unit_test_state *uts)
 	ut_assert_console_end();
 
 	/* USB is 7th in the list, so bit 8 */
-	ut_asserteq(BIT(8), std->hunters_used);
+	ut_asserteq(BIT(USB_HUNTER), std->hunters_used);
 
 	return 0;
 }
@@ -559,6 +561,57 @@ static int bootdev_test_hunt_prio(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootdev_test_hunt_prio, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 
+/* Check a hunter which is run as a state machine */
+static int bootdev_test_hunt_poll(struct unit_test_state *uts)
+{
+	struct bootdev_hunter *usb;
+	struct bootstd_priv *std;
+	int ret;
+
+	bootstd_reset_usb();
+	ut_assertok(bootstd_get_priv(&std));
+	usb = BOOTDEV_HUNTER_GET(usb_bootdev_hunter);
+	ut_assertnonnull(usb->start);
+	ut_assertnonnull(usb->poll);
+
+	/*
+	 * starting powers the root-hub ports but does not wait for them.
+	 * Leave the power-good delay in place, but skip the others.
+	 */
+	test_set_skip_delays(false);
+	ut_assertok(usb->start(usb, false));
+	test_set_skip_delays(true);
+
+	/* the ports are not ready, so polling does nothing */
+	ut_asserteq(-EAGAIN, usb->poll(usb, false));
+	ut_asserteq(-EAGAIN, usb->poll(usb, false));
+	ut_assert_console_end();
+
+	/* once the ports are ready, polling scans them */
+	timer_test_add_offset(2000);
+	do {
+		ret = usb->poll(usb, false);
+	} while (ret == -EAGAIN);
+	ut_assertok(ret);
+	ut_assert_nextline(
+		"Bus usb@1: scanning bus usb@1 for devices... 5 USB Device(s) found");
+	ut_assertok(usb->poll(usb, false));
+	ut_assert_console_end();
+
+	/* the hunt started by bootdev_hunt() is polled until it is done */
+	ut_assertok(usb_stop());
+	ut_asserteq(0, std->hunters_used & BIT(USB_HUNTER));
+	ut_assertok(bootdev_hunt("usb", true));
+	ut_assert_nextline("Hunting with: usb");
+	ut_assert_nextline(
+		"Bus usb@1: scanning bus usb@1 for devices... 5 USB Device(s) found");
+	ut_assert_console_end();
+	ut_asserteq(BIT(USB_HUNTER), std->hunters_used & BIT(USB_HUNTER));
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_poll, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
+
 /* Check hunting for bootdevs with a particular label */
 static int bootdev_test_hunt_label(struct unit_test_state *uts)
 {
@@ -14,6 +14,7 @@
 #include <dm.h>
 #include <efi.h>
 #include <efi_loader.h>
+#include <env.h>
 #include <expo.h>
 #include <mapmem.h>
 #ifdef CONFIG_SANDBOX
@@ -270,6 +271,8 @@ BOOTSTD_TEST(bootflow_cmd_info, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 /* Check 'bootflow scan -b' to boot the first available bootdev */
 static int bootflow_scan_boot(struct unit_test_state *uts)
 {
+	/* Make sure that the full scan is used */
+	env_set("bootflow_last", NULL);
 	ut_assertok(inject_response(uts));
 	ut_assertok(run_command("bootflow scan -b", 0));
 	ut_assert_nextline(
@@ -288,6 +291,76 @@ static int bootflow_scan_boot(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootflow_scan_boot, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 
+/* Check that 'bootflow scan -b' tries the last bootflow first */
+static int bootflow_scan_remember(struct unit_test_state *uts)
+{
+	const char *last;
+
+	if (!IS_ENABLED(CONFIG_BOOTFLOW_REMEMBER))
+		return -EAGAIN;
+
+	/* A full scan records the bootflow before booting it */
+	env_set("bootflow_last", NULL);
+	ut_assertok(inject_response(uts));
+	ut_assertok(run_command("bootflow scan -b", 0));
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line("Boot failed (err=-14)");
+	ut_assert_console_end();
+
+	last = env_get("bootflow_last");
+	ut_assertnonnull(last);
+	ut_asserteq_strn("mmc1.bootdev 1 extlinux ", last);
+	ut_asserteq_str(" /extlinux/extlinux.conf", strrchr(last, ' '));
+
+	/*
+	 * The next scan tries it first. Since sandbox cannot boot it, the full
+	 * scan runs afterwards, but does not try it again. There is no other
+	 * bootflow, so nothing else is booted.
+	 */
+	ut_assertok(env_set("bootflow_last",
+			    "mmc1.bootdev 1 extlinux 1234 /extlinux/extlinux.conf"));
+	ut_assertok(inject_response(uts));
+	ut_assertok(run_command("bootflow scan -b", 0));
+	ut_assert_nextlinen("Using last bootflow 'mmc1.bootdev.part_1', found in ");
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line("Boot failed (err=-14)");
+	ut_assert_console_end();
+
+	/* The time of the original scan is kept */
+	ut_asserteq_str("mmc1.bootdev 1 extlinux 1234 /extlinux/extlinux.conf",
+			env_get("bootflow_last"));
+
+	/* If the filename changes, it is updated but the time is still kept */
+	ut_assertok(env_set("bootflow_last",
+			    "mmc1.bootdev 1 extlinux 1234 /boot/extlinux.conf"));
+	ut_assertok(inject_response(uts));
+	ut_assertok(run_command("bootflow scan -b", 0));
+	ut_assert_nextlinen("Using last bootflow 'mmc1.bootdev.part_1', found in ");
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line("Boot failed (err=-14)");
+	ut_assert_console_end();
+	ut_asserteq_str("mmc1.bootdev 1 extlinux 1234 /extlinux/extlinux.conf",
+			env_get("bootflow_last"));
+
+	/* A bootdev which does not exist is ignored */
+	ut_assertok(env_set("bootflow_last",
+			    "mmc9.bootdev 1 extlinux 0 /extlinux/extlinux.conf"));
+	ut_assertok(inject_response(uts));
+	ut_assertok(run_command("bootflow scan -b", 0));
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line("Boot failed (err=-14)");
+	ut_assert_console_end();
+
+	env_set("bootflow_last", NULL);
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_scan_remember, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
+
 /* Check iterating through available bootflows */
 static int bootflow_iter(struct unit_test_state *uts)
 {
@@ -58,15 +58,7 @@ static int vbe_simple_test_base(struct unit_test_state *uts)
 		fixup.tree = oftree_from_fdt(fdt_buf);
 	}
 
-	/*
-	 * It would be better to call image_setup_libfdt() here, but that
-	 * function does not allow passing an ofnode. We can pass fdt_buf but
-	 * when it comes to send the event, it creates an ofnode that uses the
-	 * control FDT, since it has no way of accessing the live tree created
-	 * here.
-	 *
-	 * Two fix this we need image_setup_libfdt() is updated to use ofnode
-	 */
+	/* See vbe_simple_test_setup() for a test using image_setup_libfdt() */
 	fixup.images = NULL;
 	ut_assertok(event_notify(EVT_FT_FIXUP, &fixup, sizeof(fixup)));
 
@@ -86,3 +78,53 @@ static int vbe_simple_test_base(struct unit_test_state *uts)
 	return 0;
 }
 BOOTSTD_TEST(vbe_simple_test_base, UTF_DM | UTF_SCAN_FDT);
+
+/*
+ * Test the VBE fixup via image_setup_libfdt()
+ *
+ * With a live tree the fixups are done on a live copy of the tree, which is
+ * then flattened, so check that the result is written back to the blob along
+ * with the memory reservations.
+ */
+static int vbe_simple_test_setup(struct unit_test_state *uts)
+{
+	struct bootm_headers images;
+	const char *version;
+	char fdt_buf[0x800];
+	u64 addr, size;
+	int node_ofs;
+	u32 vernum;
+
+	ut_assertok(bootstd_setup_for_tests());
+
+	ut_assertok(fdt_create_empty_tree(fdt_buf, sizeof(fdt_buf)));
+	ut_assertok(fdt_add_mem_rsv(fdt_buf, 0x1000, 0x200));
+	node_ofs = fdt_add_subnode(fdt_buf, 0, "chosen");
+	ut_assert(node_ofs > 0);
+
+	node_ofs = fdt_add_subnode(fdt_buf, node_ofs, "fwupd");
+	ut_assert(node_ofs > 0);
+
+	node_ofs = fdt_add_subnode(fdt_buf, node_ofs, "firmware0");
+	ut_assert(node_ofs > 0);
+
+	memset(&images, '\0', sizeof(images));
+	ut_assertok(image_setup_libfdt(&images, fdt_buf, false));
+
+	node_ofs = fdt_path_offset(fdt_buf, "/chosen/fwupd/firmware0");
+	ut_assert(node_ofs > 0);
+	version = fdt_getprop(fdt_buf, node_ofs, "cur-version", NULL);
+	ut_assertnonnull(version);
+	ut_asserteq_str(TEST_VERSION, version);
+	vernum = fdtdec_get_uint(fdt_buf, node_ofs, "cur-vernum", 0);
+	ut_asserteq(TEST_VERNUM, vernum);
+
+	/* The board may add its own reservations after ours */
+	ut_assert(fdt_num_mem_rsv(fdt_buf) >= 1);
+	ut_assertok(fdt_get_mem_rsv(fdt_buf, 0, &addr, &size));
+	ut_asserteq(0x1000, addr);
+	ut_asserteq(0x200, size);
+
+	return 0;
+}
+BOOTSTD_TEST(vbe_simple_test_setup, UTF_DM | UTF_SCAN_FDT);
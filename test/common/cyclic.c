@@ -37,3 +37,20 @@ static int dm_test_cyclic_running(struct unit_test_state *uts)
 	return 0;
 }
 COMMON_TEST(dm_test_cyclic_running, 0);
+
+/* Test unregistering a cyclic function which was already removed */
+static int dm_test_cyclic_unregister(struct unit_test_state *uts)
+{
+	cyclic_register(&cyclic_test.cyclic, test_cb, 10 * 1000, "cyclic_test");
+	ut_assertok(cyclic_unregister_all());
+	cyclic_unregister(&cyclic_test.cyclic);
+	ut_assertnull(cyclic_get_list()->first);
+
+	/* the function is no longer called */
+	cyclic_test.called = false;
+	schedule();
+	ut_asserteq(false, cyclic_test.called);
+
+	return 0;
+}
+COMMON_TEST(dm_test_cyclic_unregister, 0);
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for block-device benchmarking
+ */
+
+#include <blk.h>
+#include <blkbench.h>
+#include <dm.h>
+#include <malloc.h>
+#include <part.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Check that a result is consistent with the parameters used */
+static int check_result(struct unit_test_state *uts, struct blk_desc *desc,
+			struct blk_bench_params *params,
+			struct blk_bench_result *result)
+{
+	ut_asserteq(params->count, result->ops);
+	ut_asserteq((u64)params->count * params->blocks * desc->blksz,
+		    result->bytes);
+	ut_assert(result->min_us <= result->p50_us);
+	ut_assert(result->p50_us <= result->p90_us);
+	ut_assert(result->p90_us <= result->p99_us);
+	ut_assert(result->p99_us <= result->max_us);
+	ut_assert(result->max_us <= result->total_us);
+
+	return 0;
+}
+
+/* Run read benchmarks on every block device, to check each driver */
+static int dm_test_blk_bench_all(struct unit_test_state *uts)
+{
+	struct blk_bench_params params = {
+		.blocks	= 4,
+		.count	= 16,
+	};
+	struct blk_bench_result result;
+	struct blk_desc *desc;
+	struct udevice *dev;
+	int count = 0;
+	void *buf;
+
+	uclass_foreach_dev_probe(UCLASS_BLK, dev) {
+		desc = dev_get_uclass_plat(dev);
+		if (desc->lba < params.blocks)
+			continue;
+		buf = malloc(params.blocks * desc->blksz);
+		ut_assertnonnull(buf);
+
+		params.flags = 0;
+		ut_assertok(blk_bench_run(desc, &params, buf, &result));
+		ut_assertok(check_result(uts, desc, &params, &result));
+
+		params.flags = BLK_BENCH_RANDOM | BLK_BENCH_NOCACHE;
+		ut_assertok(blk_bench_run(desc, &params, buf, &result));
+		ut_assertok(check_result(uts, desc, &params, &result));
+		free(buf);
+		count++;
+	}
+	ut_assert(count > 0);
+
+	return 0;
+}
+DM_TEST(dm_test_blk_bench_all, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test writing and the checks on the parameters */
+static int dm_test_blk_bench_write(struct unit_test_state *uts)
+{
+	struct blk_bench_params params = {
+		.blocks	= 8,
+		.count	= 10,
+		.flags	= BLK_BENCH_WRITE | BLK_BENCH_RANDOM,
+	};
+	struct blk_bench_result result;
+	struct blk_desc *desc;
+	char buf[8 * 512];
+
+	ut_asserteq(0, blk_get_device_by_str("mmc", "0", &desc));
+	ut_asserteq(512, desc->blksz);
+	memset(buf, 'a', sizeof(buf));
+	ut_assertok(blk_bench_run(desc, &params, buf, &result));
+	ut_assertok(check_result(uts, desc, &params, &result));
+
+	/* a region which is too small for the transfers */
+	params.start = desc->lba - 4;
+	ut_asserteq(-EINVAL, blk_bench_run(desc, &params, buf, &result));
+	params.start = desc->lba;
+	ut_asserteq(-EINVAL, blk_bench_run(desc, &params, buf, &result));
+	params.start = 0;
+	params.region = desc->lba + 1;
+	ut_asserteq(-EINVAL, blk_bench_run(desc, &params, buf, &result));
+	params.region = 0;
+	params.count = 0;
+	ut_asserteq(-EINVAL, blk_bench_run(desc, &params, buf, &result));
+
+	return 0;
+}
+DM_TEST(dm_test_blk_bench_write, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test the 'blk bench' command */
+static int dm_test_blk_bench_cmd(struct unit_test_state *uts)
+{
+	ut_assertok(run_command("blk bench mmc 0 read seq 1000 0 8 4", 0));
+	ut_assert_nextline("mmc 0: read sequential, 4 x 8 blocks of 512 bytes");
+	ut_assert_nextlinen("16384 bytes in ");
+	ut_assert_nextlinen("latency us: min ");
+	ut_assert_console_end();
+
+	ut_assertok(run_command("blk bench mmc 0 read rand 1000 0 1 4 nocache",
+				0));
+	ut_assert_nextline("mmc 0: read random (no cache), 4 x 1 blocks of 512 bytes");
+	ut_assert_nextlinen("2048 bytes in ");
+	ut_assert_nextlinen("latency us: min ");
+	ut_assert_console_end();
+
+	ut_asserteq(1, run_command("blk bench mmc 0 read seq 1000 800 8 4", 0));
+	ut_assert_nextline("Invalid parameters: device has 2048 blocks");
+	ut_assert_console_end();
+
+	return 0;
+}
+DM_TEST(dm_test_blk_bench_cmd, UTF_SCAN_PDATA | UTF_SCAN_FDT | UTF_CONSOLE);
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the boot-time profiler
+ */
+
+#include <bloblist.h>
+#include <bootprof.h>
+#include <command.h>
+#include <dm.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <dm/device-internal.h>
+#include <dm/root.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define TEST_BLOBLIST_SIZE	(sizeof(struct bootprof_hdr) + \
+				 CONFIG_BOOTPROF_RECORDS * \
+				 sizeof(struct bootprof_rec) + 0x100)
+
+/**
+ * find_rec() - Find a profile record by type and name
+ *
+ * @hdr: Profile header
+ * @type: Record type
+ * @name: Record name
+ * Return: record, or NULL if not found
+ */
+static struct bootprof_rec *find_rec(struct bootprof_hdr *hdr,
+				     enum bootprof_type type, const char *name)
+{
+	struct bootprof_rec *rec = (struct bootprof_rec *)(hdr + 1);
+	int i;
+
+	for (i = 0; i < hdr->count; i++, rec++) {
+		if (rec->type == type && !strcmp(rec->name, name))
+			return rec;
+	}
+
+	return NULL;
+}
+
+/* Test that driver phases and commands are recorded */
+static int dm_test_bootprof(struct unit_test_state *uts)
+{
+	struct bootprof_rec *drv, *uc, *cmd;
+	struct bootprof_hdr *hdr;
+	struct udevice *dev;
+	void *buf;
+	int i;
+
+	buf = malloc(TEST_BLOBLIST_SIZE);
+	ut_assertnonnull(buf);
+	ut_assertok(bloblist_new(map_to_sysmem(buf), TEST_BLOBLIST_SIZE, 0, 0));
+
+	ut_assertok(device_bind(dm_root(), DM_DRIVER_GET(test_drv), "bootprof",
+				NULL, ofnode_null(), &dev));
+	ut_assertok(device_probe(dev));
+
+	/* this does nothing, so should not be recorded */
+	ut_assertok(device_probe(dev));
+
+	ut_assertok(run_command("echo", 0));
+	ut_assertok(run_command("echo", 0));
+
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_PROF, 0);
+	ut_assertnonnull(hdr);
+	ut_asserteq(BOOTPROF_VERSION, hdr->version);
+	ut_asserteq(CONFIG_BOOTPROF_RECORDS, hdr->max);
+	ut_asserteq(0, hdr->dropped);
+
+	drv = find_rec(hdr, BOOTPROFT_DRIVER, "test_drv");
+	ut_assertnonnull(drv);
+	ut_asserteq(UCLASS_TEST, drv->uclass_id);
+	ut_asserteq(1, drv->stat[BOOTPROFP_BIND].count);
+	ut_asserteq(1, drv->stat[BOOTPROFP_OF_TO_PLAT].count);
+	ut_asserteq(1, drv->stat[BOOTPROFP_PROBE].count);
+
+	/* probing includes of_to_plat, which is not part of its self time */
+	ut_assert(drv->stat[BOOTPROFP_PROBE].time_us >=
+		  drv->stat[BOOTPROFP_OF_TO_PLAT].time_us);
+
+	/* the uclass has the same times, since it has only one driver here */
+	uc = find_rec(hdr, BOOTPROFT_UCLASS, "test");
+	ut_assertnonnull(uc);
+	ut_asserteq(UCLASS_TEST, uc->uclass_id);
+	for (i = 0; i < BOOTPROFP_COUNT; i++) {
+		ut_asserteq(drv->stat[i].count, uc->stat[i].count);
+		ut_asserteq(drv->stat[i].time_us, uc->stat[i].time_us);
+		ut_asserteq(drv->stat[i].self_us, uc->stat[i].self_us);
+		ut_assert(drv->stat[i].self_us <= drv->stat[i].time_us);
+	}
+
+	cmd = find_rec(hdr, BOOTPROFT_CMD, "echo");
+	ut_assertnonnull(cmd);
+	ut_asserteq(2, cmd->stat[BOOTPROFP_CALL].count);
+
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_unbind(dev));
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_bootprof, UFT_BLOBLIST);
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for reading open files on a FAT filesystem
+ */
+
+#include <blk.h>
+#include <dm.h>
+#include <errno.h>
+#include <fs.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <os.h>
+#include <sandbox_host.h>
+#include <dm/device-internal.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Size of the test file, which spans many clusters */
+#define TEST_SIZE	0x2345
+
+/* Size of each read, chosen so that reads start and end within a cluster */
+#define CHUNK_SIZE	700
+
+/* Test reading a FAT file in chunks through an open file */
+static int dm_test_fat_file_read(struct unit_test_state *uts)
+{
+	loff_t actwrite, actread, pos;
+	struct udevice *dev, *blk;
+	struct blk_desc *desc;
+	struct fs_file *file;
+	ulong mem_start;
+	char fname[256];
+	char *data, *buf;
+	int i;
+
+	/* Attach a file created in test_ut_dm_init */
+	ut_assertok(os_persistent_file(fname, sizeof(fname), "1MB.fat32.img"));
+	ut_assertok(host_create_device("fat", true, DEFAULT_BLKSZ, &dev));
+	ut_assertok(host_attach_file(dev, fname));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+
+	data = malloc(TEST_SIZE);
+	ut_assertnonnull(data);
+	buf = malloc(TEST_SIZE);
+	ut_assertnonnull(buf);
+	for (i = 0; i < TEST_SIZE; i++)
+		data[i] = i ^ (i >> 8);
+
+	ut_assertok(fs_set_blk_dev_with_part(desc, 0));
+	ut_assertok(fs_write("/stream.bin", map_to_sysmem(data), 0, TEST_SIZE,
+			     &actwrite));
+	ut_asserteq(TEST_SIZE, actwrite);
+
+	mem_start = ut_check_delta(0);
+	ut_assertok(fs_set_blk_dev_with_part(desc, 0));
+	file = fs_file_open("/stream.bin");
+	ut_assertnonnull(file);
+	ut_asserteq(TEST_SIZE, file->size);
+
+	/* read the file in order, so each read continues along the chain */
+	memset(buf, '\0', TEST_SIZE);
+	for (pos = 0; pos < TEST_SIZE; pos += actread) {
+		ut_assertok(fs_file_read(file, buf + pos, pos, CHUNK_SIZE,
+					 &actread));
+		ut_asserteq(min((loff_t)CHUNK_SIZE, TEST_SIZE - pos), actread);
+	}
+	ut_asserteq_mem(data, buf, TEST_SIZE);
+
+	/* reading an earlier part must start from the beginning of the chain */
+	ut_assertok(fs_file_read(file, buf, 100, CHUNK_SIZE, &actread));
+	ut_asserteq(CHUNK_SIZE, actread);
+	ut_asserteq_mem(data + 100, buf, CHUNK_SIZE);
+
+	/* a length of 0 reads the whole file */
+	memset(buf, '\0', TEST_SIZE);
+	ut_assertok(fs_file_read(file, buf, 0, 0, &actread));
+	ut_asserteq(TEST_SIZE, actread);
+	ut_asserteq_mem(data, buf, TEST_SIZE);
+
+	/* reads stop at the end of the file */
+	ut_assertok(fs_file_read(file, buf, TEST_SIZE - 10, CHUNK_SIZE,
+				 &actread));
+	ut_asserteq(10, actread);
+	ut_asserteq_mem(data + TEST_SIZE - 10, buf, 10);
+	ut_assertok(fs_file_read(file, buf, TEST_SIZE, CHUNK_SIZE, &actread));
+	ut_asserteq(0, actread);
+	ut_assertok(fs_file_read(file, buf, TEST_SIZE + 0x1000, CHUNK_SIZE,
+				 &actread));
+	ut_asserteq(0, actread);
+
+	/* closing frees everything allocated by the open file */
+	fs_file_close(file);
+	fs_file_close(NULL);
+	ut_asserteq(0, ut_check_delta(mem_start));
+
+	ut_assertok(fs_set_blk_dev_with_part(desc, 0));
+	ut_assertnull(fs_file_open("/missing.bin"));
+	ut_asserteq(ENOENT, errno);
+
+	free(buf);
+	free(data);
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_fat_file_read, UTF_SCAN_FDT);
@@ -6,11 +6,15 @@
 #include <log.h>
 #include <serial.h>
 #include <dm.h>
+#include <time.h>
+#include <asm/global_data.h>
 #include <asm/serial.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static const char test_message[] =
 	"This is a test message\n"
 	"consisting of multiple lines\n";
@@ -88,3 +92,56 @@ static int dm_test_serial(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_serial, UTF_SCAN_FDT);
+
+/* Test that output is held in the TX buffer while the UART is busy */
+static int dm_test_serial_tx_buffer(struct unit_test_state *uts)
+{
+	size_t start, busy_written, flush_written, cyclic_written, len;
+	struct udevice *dev, *old_dev;
+	int i;
+
+	if (!CONFIG_IS_ENABLED(SERIAL_TX_BUFFER))
+		return -EAGAIN;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_SERIAL, "serial", &dev));
+
+	/* Each newline is sent as a carriage return and a newline */
+	for (i = 0, len = 0; test_message[i]; i++)
+		len += test_message[i] == '\n' ? 2 : 1;
+
+	/*
+	 * The console uses the device probed before the test, so switch to
+	 * the test device, which has its cyclic function registered
+	 */
+	old_dev = gd->cur_serial_dev;
+	gd->cur_serial_dev = dev;
+	sandbox_serial_endisable(false);
+
+	/* Nothing is sent while the UART is busy, then flush sends it all */
+	sandbox_serial_set_busy(true);
+	start = sandbox_serial_written();
+	serial_puts(test_message);
+	busy_written = sandbox_serial_written() - start;
+	sandbox_serial_set_busy(false);
+	serial_flush();
+	flush_written = sandbox_serial_written() - start;
+
+	/* The cyclic function sends it once the UART is ready */
+	sandbox_serial_set_busy(true);
+	start = sandbox_serial_written();
+	serial_puts(test_message);
+	sandbox_serial_set_busy(false);
+	timer_test_add_offset(10);
+	schedule();
+	cyclic_written = sandbox_serial_written() - start;
+
+	sandbox_serial_endisable(true);
+	gd->cur_serial_dev = old_dev;
+
+	ut_asserteq(0, busy_written);
+	ut_asserteq(len, flush_written);
+	ut_asserteq(len, cyclic_written);
+
+	return 0;
+}
+DM_TEST(dm_test_serial_tx_buffer, UTF_SCAN_FDT);
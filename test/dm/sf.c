@@ -101,3 +101,31 @@ static int dm_test_spi_flash_func(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_spi_flash_func, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test the read-throughput benchmark */
+static int dm_test_spi_flash_bench(struct unit_test_state *uts)
+{
+	ut_assertok(run_command_list("host save hostfs - 0 spi.bin 200000;"
+				     "sf probe", -1, 0));
+	console_record_reset_enable();
+
+	ut_assertok(run_command("sf bench 1000000 0 10000 2", 0));
+	ut_assert_nextline("device 0 offset 0x0, size 0x10000");
+	ut_assert_nextlinen("Read path: opcode ");
+	ut_assert_nextlinen("2 x 0x10000 bytes in ");
+	ut_assert_console_end();
+
+	/* reading past the end of the flash must fail */
+	ut_asserteq(1, run_command("sf bench 1000000 1ff000 2000", 0));
+	ut_assert_nextline("Size exceeds partition or device limit");
+	ut_assert_console_end();
+
+	/*
+	 * Since we are about to destroy all devices, we must tell sandbox
+	 * to forget the emulation device
+	 */
+	sandbox_sf_unbind_emul(state_get_current(), 0, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_spi_flash_bench, UTF_SCAN_PDATA | UTF_SCAN_FDT | UTF_CONSOLE);
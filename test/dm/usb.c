@@ -6,6 +6,7 @@
 #include <console.h>
 #include <dm.h>
 #include <part.h>
+#include <scsi.h>
 #include <usb.h>
 #include <asm/io.h>
 #include <asm/state.h>
@@ -84,6 +85,196 @@ static int dm_test_usb_flash(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_usb_flash, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Test a flash stick which uses USB Attached SCSI */
+static int dm_test_usb_uas(struct unit_test_state *uts)
+{
+	struct usb_device *udev;
+	struct udevice *dev, *blk;
+	char cmp[4096];
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 2, &dev));
+	udev = dev_get_parent_priv(dev);
+	ut_asserteq(2, udev->config.if_desc[0].num_altsetting);
+	ut_asserteq(1, udev->config.if_desc[0].act_altsetting);
+	ut_assertok(device_find_first_child_by_uclass(dev, UCLASS_BLK, &blk));
+
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(8, blk_read(blk, 0, 8, cmp));
+	ut_asserteq_str("this is a uas test", cmp);
+
+	strcpy(cmp + 512, "another test");
+	strcpy(cmp + 1024, "and another");
+	ut_asserteq(2, blk_write(blk, 1, 2, cmp + 512));
+
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(3, blk_read(blk, 0, 3, cmp));
+	ut_asserteq_str("this is a uas test", cmp);
+	ut_asserteq_str("another test", cmp + 512);
+	ut_asserteq_str("and another", cmp + 1024);
+
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(2, blk_write(blk, 1, 2, cmp));
+
+	ut_assertok(usb_stop());
+
+	return 0;
+}
+DM_TEST(dm_test_usb_uas, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test USB Attached SCSI at SuperSpeed, with commands queued on streams */
+static int dm_test_usb_uas_streams(struct unit_test_state *uts)
+{
+	struct udevice *bus, *emul, *dev, *blk;
+	struct usb_device *udev;
+	char cmp[4096];
+
+	ut_assertok(uclass_find_device_by_name(UCLASS_USB_EMUL, "flash-stick@2",
+					       &emul));
+	ut_assertok(sandbox_flash_set_superspeed(emul));
+
+	/* Limit transfers to two blocks, so reads need several commands */
+	ut_assertok(uclass_get_device_by_name(UCLASS_USB, "usb@1", &bus));
+	sandbox_usb_set_max_xfer_size(bus, 2 * 512);
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 2, &dev));
+	udev = dev_get_parent_priv(dev);
+	ut_asserteq(USB_SPEED_SUPER, udev->speed);
+	ut_asserteq(1, udev->config.if_desc[0].act_altsetting);
+	ut_assertok(device_find_first_child_by_uclass(dev, UCLASS_BLK, &blk));
+
+	/*
+	 * The Bulk-Only endpoints have no streams, so this only works if they
+	 * are taken from the UAS alternate setting
+	 */
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(8, blk_read(blk, 0, 8, cmp));
+	ut_asserteq_str("this is a uas test", cmp);
+	ut_asserteq(4, sandbox_flash_get_max_queued(emul));
+
+	strcpy(cmp + 512, "another test");
+	strcpy(cmp + 2048, "and another");
+	ut_asserteq(5, blk_write(blk, 1, 5, cmp + 512));
+
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(6, blk_read(blk, 0, 6, cmp));
+	ut_asserteq_str("this is a uas test", cmp);
+	ut_asserteq_str("another test", cmp + 512);
+	ut_asserteq_str("and another", cmp + 2048);
+
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(5, blk_write(blk, 1, 5, cmp));
+
+	ut_assertok(usb_stop());
+
+	return 0;
+}
+DM_TEST(dm_test_usb_uas_streams, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test queueing several bulk transfers and reaping them in order */
+static int dm_test_usb_bulk_queue(struct unit_test_state *uts)
+{
+	struct usb_bulk_xfer xfers[3];
+	struct umass_bbb_cbw cbw;
+	struct umass_bbb_csw csw;
+	struct usb_device *udev;
+	struct udevice *dev, *blk;
+	char data[1024], cmp[1024];
+	int actlen, i;
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 0, &dev));
+	ut_assertok(device_find_first_child_by_uclass(dev, UCLASS_BLK, &blk));
+	udev = dev_get_parent_priv(dev);
+	ut_asserteq(2, blk_read(blk, 0, 2, cmp));
+
+	/* Send a READ(10) of two blocks on the OUT endpoint */
+	memset(&cbw, '\0', sizeof(cbw));
+	cbw.dCBWSignature = CBWSIGNATURE;
+	cbw.dCBWTag = 0x1234;
+	cbw.dCBWDataTransferLength = sizeof(data);
+	cbw.bCBWFlags = CBWFLAGS_IN;
+	cbw.bCDBLength = 10;
+	cbw.CBWCDB[0] = SCSI_READ10;
+	cbw.CBWCDB[8] = 2;
+	ut_assertok(usb_bulk_msg(udev, usb_sndbulkpipe(udev, 1), &cbw,
+				 UMASS_BBB_CBW_SIZE, &actlen, 1000));
+
+	/* Queue each block and the CSW on the IN endpoint */
+	memset(data, '\0', sizeof(data));
+	memset(&csw, '\0', sizeof(csw));
+	xfers[0].data = data;
+	xfers[0].len = 512;
+	xfers[1].data = data + 512;
+	xfers[1].len = 512;
+	xfers[2].data = &csw;
+	xfers[2].len = UMASS_BBB_CSW_SIZE;
+	ut_assertok(usb_bulk_msg_queue(udev, usb_rcvbulkpipe(udev, 2), xfers,
+				       ARRAY_SIZE(xfers), 1000));
+	for (i = 0; i < ARRAY_SIZE(xfers); i++) {
+		ut_asserteq(0, xfers[i].status);
+		ut_asserteq(xfers[i].len, xfers[i].actual_length);
+	}
+	ut_asserteq_str("this is a test", data);
+	ut_asserteq_mem(cmp, data, sizeof(data));
+	ut_asserteq(CSWSIGNATURE, csw.dCSWSignature);
+	ut_asserteq(0x1234, csw.dCSWTag);
+	ut_asserteq(CSWSTATUS_GOOD, csw.bCSWStatus);
+
+	/* Too many transfers are rejected before any is made */
+	ut_asserteq(-EINVAL, usb_bulk_msg_queue(udev, usb_rcvbulkpipe(udev, 2),
+						xfers, USB_BULK_QUEUE_MAX + 1,
+						1000));
+
+	ut_assertok(usb_stop());
+
+	return 0;
+}
+DM_TEST(dm_test_usb_bulk_queue, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test that bulk transfers are counted for each endpoint */
+static int dm_test_usb_ep_stats(struct unit_test_state *uts)
+{
+	struct usb_ep_stats in, out, *stats;
+	struct usb_device *udev;
+	struct udevice *dev, *blk;
+	char cmp[1024];
+
+	if (!CONFIG_IS_ENABLED(USB_EP_STATS))
+		return -EAGAIN;
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 0, &dev));
+	ut_assertok(device_find_first_child_by_uclass(dev, UCLASS_BLK, &blk));
+	udev = dev_get_parent_priv(dev);
+
+	/* The flash stick uses endpoint 1 for OUT and endpoint 2 for IN */
+	in = udev->ep_stats[0][2];
+	out = udev->ep_stats[1][1];
+	ut_assert(in.xfers > 0);
+	ut_asserteq(0, in.errors);
+
+	/* One command: the CBW goes out, then the data and CSW come in */
+	ut_asserteq(2, blk_read(blk, 200, 2, cmp));
+	stats = &udev->ep_stats[1][1];
+	ut_asserteq(out.xfers + 1, stats->xfers);
+	ut_asserteq(out.bytes + UMASS_BBB_CBW_SIZE, stats->bytes);
+	stats = &udev->ep_stats[0][2];
+	ut_asserteq(in.xfers + 2, stats->xfers);
+	ut_asserteq(in.bytes + 1024 + UMASS_BBB_CSW_SIZE, stats->bytes);
+	ut_asserteq(0, stats->errors);
+
+	ut_assertok(usb_stop());
+
+	return 0;
+}
+DM_TEST(dm_test_usb_ep_stats, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* test that we can handle multiple storage devices */
 static int dm_test_usb_multi(struct unit_test_state *uts)
 {
@@ -230,6 +230,119 @@ static int dm_test_video_chars(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_chars, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Test tracking of the damaged area and the statistics */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_stats *stats;
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+	ulong synced;
+	int bytes;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		return -EAGAIN;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	ut_assertok(vidconsole_select_font(con, "8x16", 0));
+	priv = dev_get_uclass_priv(dev);
+	bytes = VNBYTES(priv->bpix);
+	ut_assertok(video_sync(dev, true));
+	video_reset_stats(dev);
+	stats = video_get_stats(dev);
+
+	/* a filled area is tracked exactly */
+	ut_assertok(video_fill_part(dev, 10, 20, 30, 25, priv->colour_fg));
+	ut_asserteq(10, priv->damage.x0);
+	ut_asserteq(20, priv->damage.y0);
+	ut_asserteq(30, priv->damage.x1);
+	ut_asserteq(25, priv->damage.y1);
+	ut_asserteq(20 * 5 * bytes, stats->copy_bytes);
+
+	/* the area is extended to cover everything drawn before the sync */
+	ut_assertok(video_fill_part(dev, 40, 10, 50, 12, priv->colour_fg));
+	ut_asserteq(10, priv->damage.x0);
+	ut_asserteq(10, priv->damage.y0);
+	ut_asserteq(50, priv->damage.x1);
+	ut_asserteq(25, priv->damage.y1);
+
+	ut_assertok(video_sync(dev, true));
+	ut_asserteq(1, stats->syncs);
+	ut_asserteq(40 * 15 * bytes, stats->sync_bytes);
+	ut_asserteq(priv->damage.x0, priv->damage.x1);
+
+	/* nothing is synced if nothing has changed */
+	ut_assertok(video_sync(dev, true));
+	ut_asserteq(2, stats->syncs);
+	ut_asserteq(40 * 15 * bytes, stats->sync_bytes);
+
+	/* text only dirties the rows it is on */
+	synced = stats->sync_bytes;
+	vidconsole_put_string(con, "ab");
+	ut_assertok(video_sync(dev, true));
+	ut_assert(stats->sync_bytes > synced);
+	ut_assert(stats->sync_bytes - synced <= 16 * priv->line_length);
+
+	/* the cursor is tracked exactly */
+	if (IS_ENABLED(CONFIG_EXPO)) {
+		ut_assertok(vidconsole_set_cursor_visible(con, true, 40, 32, 1));
+		ut_asserteq(48, priv->damage.x0);
+		ut_asserteq(32, priv->damage.y0);
+		ut_asserteq(48 + VIDCONSOLE_CURSOR_WIDTH, priv->damage.x1);
+		ut_asserteq(48, priv->damage.y1);
+		ut_assertok(video_sync(dev, true));
+	}
+
+	/* areas off the display are ignored */
+	video_damage(dev, priv->xsize, 0, 10, 10);
+	video_damage(dev, 0, -10, 10, 10);
+	ut_asserteq(priv->damage.x0, priv->damage.x1);
+
+	/* everything is synced if the frame buffer may be written directly */
+	synced = stats->sync_bytes;
+	priv->damage_all = true;
+	ut_assertok(video_fill_part(dev, 0, 0, 4, 4, priv->colour_fg));
+	ut_assertok(video_sync(dev, true));
+	ut_asserteq(synced + priv->ysize * priv->line_length,
+		    stats->sync_bytes);
+	ut_assertok(video_sync(dev, true));
+	ut_asserteq(synced + 2 * priv->ysize * priv->line_length,
+		    stats->sync_bytes);
+	priv->damage_all = false;
+	ut_asserteq(priv->damage.x0, priv->damage.x1);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test the 'video stats' command */
+static int dm_test_video_cmd_stats(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	priv = dev_get_uclass_priv(dev);
+	ut_assertok(run_command("video stats -r", 0));
+	ut_assertok(video_fill_part(dev, 0, 0, 4, 4, priv->colour_fg));
+	ut_assertok(video_sync(dev, true));
+
+	ut_assertok(run_command("video stats", 0));
+	ut_assert_nextlinen("Time:");
+	ut_assert_nextline("Syncs:    1");
+	ut_assert_nextlinen("Synced:   %d bytes,",
+			    IS_ENABLED(CONFIG_VIDEO_DAMAGE) ?
+			    16 * VNBYTES(priv->bpix) : priv->fb_size);
+	ut_assert_nextlinen("Copied:   %d bytes,",
+			    IS_ENABLED(CONFIG_VIDEO_COPY) ?
+			    16 * VNBYTES(priv->bpix) : 0);
+	ut_assert_console_end();
+
+	return 0;
+}
+DM_TEST(dm_test_video_cmd_stats, UTF_SCAN_PDATA | UTF_SCAN_FDT | UTF_CONSOLE);
+
 #ifdef CONFIG_VIDEO_ANSI
 #define ANSI_ESC "\x1b"
 /* Test handling of ANSI escape sequences */
@@ -603,3 +716,29 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_video_truetype_bs, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test that TrueType glyphs drawn from the cache match the originals */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	struct udevice *dev, *con;
+	const char *test_string = "Some see private enterprise as a predatory target to be shot, others as a cow to be milked, but few are those who see it as a sturdy horse pulling the wagon.\n";
+	int size;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+
+	/* the first time, the glyphs are rendered and added to the cache */
+	vidconsole_set_cursor_pos(con, 0, 0);
+	vidconsole_put_string(con, test_string);
+	size = compress_frame_buffer(uts, dev);
+	ut_assert(size > 0);
+
+	/* the second time, they come from the cache */
+	video_clear(dev);
+	vidconsole_set_cursor_pos(con, 0, 0);
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(size, compress_frame_buffer(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, UTF_SCAN_PDATA | UTF_SCAN_FDT);
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for coalescing the reads of FIT images in SPL
+ */
+
+#include <image.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <spl.h>
+#include <test/spl.h>
+#include <test/ut.h>
+
+/* Size of the kernel image, which is small so that it sits within the gap */
+#define KERNEL_SIZE	16
+
+/**
+ * struct fit_test_img - an image in the test FIT
+ *
+ * @name: Node name of the image
+ * @type: Image type
+ * @size: Size of the image data
+ * @load: Load address
+ */
+struct fit_test_img {
+	const char *name;
+	const char *type;
+	int size;
+	ulong load;
+};
+
+/*
+ * Images in the order their data is stored. The kernel is listed in the
+ * configuration but SPL does not load it since there is a firmware image, so
+ * it must not be part of a run
+ */
+static const struct fit_test_img fit_imgs[] = {
+	{ "u-boot", "firmware", SPL_TEST_DATA_SIZE, CONFIG_TEXT_BASE },
+	{ "atf", "firmware", SPL_TEST_DATA_SIZE, 0x1000000 },
+	{ "kernel", "kernel", KERNEL_SIZE, 0x1100000 },
+	{ "tee", "tee", SPL_TEST_DATA_SIZE, 0x1200000 },
+};
+
+static int fit_reads;
+
+static ulong spl_test_fit_read(struct spl_load_info *load, ulong sector,
+			       ulong count, void *buf)
+{
+	fit_reads++;
+	memcpy(buf, load->priv + sector, count);
+
+	return count;
+}
+
+/**
+ * create_multi_fit() - Create a FIT with several external-data images
+ *
+ * @dst: Place to put the FIT
+ * @size: Size of the space at @dst
+ * @offsets: Returns the offset of each image's data from the start of @dst
+ * Return: total size of the FIT including the data, or 0 on error
+ */
+static size_t create_multi_fit(void *dst, size_t size, ulong offsets[])
+{
+	size_t fit_size = 0x800;
+	ulong data_offset = 0;
+	int i;
+
+	if (fdt_create(dst, fit_size) || fdt_finish_reservemap(dst) ||
+	    fdt_begin_node(dst, "") ||
+	    fdt_property_u32(dst, FIT_TIMESTAMP_PROP, 0) ||
+	    fdt_property_u32(dst, "#address-cells", 1) ||
+	    fdt_begin_node(dst, FIT_IMAGES_PATH + 1))
+		return 0;
+
+	for (i = 0; i < ARRAY_SIZE(fit_imgs); i++) {
+		const struct fit_test_img *img = &fit_imgs[i];
+
+		if (fdt_begin_node(dst, img->name) ||
+		    fdt_property_string(dst, FIT_TYPE_PROP, img->type) ||
+		    fdt_property_string(dst, FIT_COMP_PROP, "none") ||
+		    fdt_property_string(dst, FIT_OS_PROP, "tee") ||
+		    fdt_property_u32(dst, FIT_DATA_OFFSET_PROP, data_offset) ||
+		    fdt_property_u32(dst, FIT_DATA_SIZE_PROP, img->size) ||
+		    fdt_property_u32(dst, FIT_LOAD_PROP, img->load) ||
+		    fdt_end_node(dst))
+			return 0;
+		offsets[i] = fit_size + data_offset;
+		data_offset += ALIGN(img->size, 4);
+	}
+	if (fdt_end_node(dst) || /* images */
+	    fdt_begin_node(dst, FIT_CONFS_PATH + 1) ||
+	    fdt_property_string(dst, FIT_DEFAULT_PROP, "config-1") ||
+	    fdt_begin_node(dst, "config-1") ||
+	    fdt_property_string(dst, FIT_FIRMWARE_PROP, "u-boot") ||
+	    fdt_property_string(dst, FIT_KERNEL_PROP, "kernel") ||
+	    fdt_property(dst, FIT_LOADABLE_PROP, "atf\0tee", 8) ||
+	    fdt_end_node(dst) || /* config-1 */
+	    fdt_end_node(dst) || /* configurations */
+	    fdt_end_node(dst) || /* root */
+	    fdt_finish(dst))
+		return 0;
+	if (fdt_totalsize(dst) > fit_size)
+		return 0;
+	fdt_set_totalsize(dst, fit_size);
+	if (fit_size + data_offset > size)
+		return 0;
+
+	return fit_size + data_offset;
+}
+
+/* Test that adjacent images are read together, stopping at a skipped one */
+static int spl_test_fit_coalesce(struct unit_test_state *uts)
+{
+	ulong offsets[ARRAY_SIZE(fit_imgs)];
+	struct spl_image_info info = { };
+	struct spl_load_info load;
+	size_t size = 0x8000;
+	void *fit;
+	int i;
+
+	fit = calloc(size, 1);
+	ut_assertnonnull(fit);
+	ut_assert(create_multi_fit(fit, size, offsets));
+	for (i = 0; i < ARRAY_SIZE(fit_imgs); i++)
+		generate_data(fit + offsets[i], fit_imgs[i].size,
+			      fit_imgs[i].name);
+
+	fit_reads = 0;
+	spl_load_init(&load, spl_test_fit_read, fit, 1);
+	ut_assertok(spl_load_simple_fit(&info, &load, 0, fit));
+
+	/*
+	 * One read for the FIT itself, one for u-boot and atf together and one
+	 * for tee, since the run stops at the kernel, which is not loaded
+	 */
+	ut_asserteq(3, fit_reads);
+	ut_asserteq(CONFIG_TEXT_BASE, info.load_addr);
+
+	for (i = 0; i < ARRAY_SIZE(fit_imgs); i++) {
+		const struct fit_test_img *img = &fit_imgs[i];
+
+		if (!strcmp(img->name, "kernel"))
+			continue;
+		ut_asserteq_mem(fit + offsets[i],
+				map_sysmem(img->load, img->size), img->size);
+	}
+	free(fit);
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_coalesce, 0);
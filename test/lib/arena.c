@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the arena allocator
+ */
+
+#include <arena.h>
+#include <malloc.h>
+#include <string.h>
+#include <time.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Test arena_init() and arena_uninit() */
+static int lib_test_arena_init(struct unit_test_state *uts)
+{
+	struct arena arena;
+	ulong start;
+
+	start = ut_check_free();
+
+	/* no memory should be used until the first allocation */
+	memset(&arena, '\xff', sizeof(arena));
+	arena_init(&arena, 0);
+	ut_asserteq(ARENA_CHUNK_SIZE, arena.chunk_size);
+	ut_asserteq(0, arena_chunk_count(&arena));
+	ut_asserteq(0, arena_used(&arena));
+	ut_assert(!arena_err(&arena));
+	ut_assertok(ut_check_delta(start));
+
+	ut_assertnonnull(arena_alloc(&arena, 10));
+	ut_asserteq(1, arena_chunk_count(&arena));
+	ut_asserteq(ARENA_ALIGN, arena_used(&arena));
+
+	/* uninit should free everything and leave the arena usable */
+	arena_uninit(&arena);
+	ut_asserteq(ARENA_CHUNK_SIZE, arena.chunk_size);
+	ut_asserteq(0, arena_chunk_count(&arena));
+	ut_asserteq(0, arena_used(&arena));
+	ut_assertok(ut_check_delta(start));
+
+	arena_init(&arena, 256);
+	ut_asserteq(256, arena.chunk_size);
+	arena_uninit(&arena);
+
+	return 0;
+}
+LIB_TEST(lib_test_arena_init, 0);
+
+/* Test arena_alloc() and friends */
+static int lib_test_arena_alloc(struct unit_test_state *uts)
+{
+	char *ptr, *ptr2, *str;
+	struct arena arena;
+	ulong start;
+	int i;
+
+	start = ut_check_free();
+	arena_init(&arena, 256);
+
+	/* allocations should be aligned and come from the same chunk */
+	ptr = arena_alloc(&arena, 1);
+	ptr2 = arena_alloc(&arena, 3);
+	ut_assertnonnull(ptr);
+	ut_asserteq(0, (ulong)ptr % ARENA_ALIGN);
+	ut_asserteq_ptr(ptr + ARENA_ALIGN, ptr2);
+	ut_asserteq(1, arena_chunk_count(&arena));
+
+	/* a large allocation gets its own chunk, not the current one */
+	ptr = arena_alloc(&arena, 200);
+	ut_assertnonnull(ptr);
+	ut_asserteq(2, arena_chunk_count(&arena));
+	ptr = arena_alloc(&arena, 1);
+	ut_asserteq_ptr(ptr2 + ARENA_ALIGN, ptr);
+
+	/* fill the current chunk so that another is needed */
+	for (i = 0; i < 256 / ARENA_ALIGN; i++)
+		ut_assertnonnull(arena_alloc(&arena, 1));
+	ut_asserteq(3, arena_chunk_count(&arena));
+
+	ptr = arena_zalloc(&arena, 40);
+	for (i = 0; i < 40; i++)
+		ut_asserteq(0, ptr[i]);
+
+	str = arena_strdup(&arena, "hello");
+	ut_asserteq_str("hello", str);
+	str = arena_strndup(&arena, "hello there", 5);
+	ut_asserteq_str("hello", str);
+	str = arena_strndup(&arena, "hi", 5);
+	ut_asserteq_str("hi", str);
+
+	/* use an impossible size */
+	ut_assertnull(arena_alloc(&arena, CONFIG_SYS_MALLOC_LEN));
+	ut_assert(arena_err(&arena));
+
+	arena_uninit(&arena);
+	ut_assert(!arena_err(&arena));
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_arena_alloc, 0);
+
+/*
+ * Compare the arena with malloc() for a parser-like workload, where many small
+ * temporaries are freed together but are interleaved with a few allocations
+ * which live on. With malloc() each long-lived allocation leaves a hole behind
+ * it once the temporaries are freed.
+ */
+static int lib_test_arena_bench(struct unit_test_state *uts)
+{
+	enum {
+		COUNT		= 1024,
+		KEEP_EVERY	= 16,
+		SIZE		= 32,
+	};
+	ulong start, malloc_us, arena_us;
+	int base, malloc_frag, arena_frag;
+	void *tmp[COUNT], *keep[COUNT / KEEP_EVERY];
+	struct arena arena;
+	int i;
+
+	start = ut_check_free();
+
+	base = mallinfo().ordblks;
+	malloc_us = timer_get_us();
+	for (i = 0; i < COUNT; i++) {
+		tmp[i] = malloc(SIZE);
+		ut_assertnonnull(tmp[i]);
+		if (!(i % KEEP_EVERY))
+			keep[i / KEEP_EVERY] = malloc(SIZE);
+	}
+	for (i = 0; i < COUNT; i++)
+		free(tmp[i]);
+	malloc_us = timer_get_us() - malloc_us;
+	malloc_frag = mallinfo().ordblks - base;
+	for (i = 0; i < COUNT / KEEP_EVERY; i++)
+		free(keep[i]);
+	ut_assertok(ut_check_delta(start));
+
+	base = mallinfo().ordblks;
+	arena_us = timer_get_us();
+	arena_init(&arena, 0);
+	for (i = 0; i < COUNT; i++) {
+		ut_assertnonnull(arena_alloc(&arena, SIZE));
+		if (!(i % KEEP_EVERY))
+			keep[i / KEEP_EVERY] = malloc(SIZE);
+	}
+	arena_uninit(&arena);
+	arena_us = timer_get_us() - arena_us;
+	arena_frag = mallinfo().ordblks - base;
+	for (i = 0; i < COUNT / KEEP_EVERY; i++)
+		free(keep[i]);
+	ut_assertok(ut_check_delta(start));
+
+	printf("malloc: %lu us, %d free fragments\n", malloc_us, malloc_frag);
+	printf("arena:  %lu us, %d free fragments\n", arena_us, arena_frag);
+	ut_assert(arena_frag < malloc_frag);
+
+	return 0;
+}
+LIB_TEST(lib_test_arena_bench, 0);
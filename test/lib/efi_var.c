@@ -0,0 +1,292 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the store of UEFI variables and the file holding them
+ */
+
+#include <blk.h>
+#include <charset.h>
+#include <dm.h>
+#include <efi_loader.h>
+#include <efi_variable.h>
+#include <fs.h>
+#include <malloc.h>
+#include <os.h>
+#include <sandbox_host.h>
+#include <dm/device-internal.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Number of variables added to the index */
+#define TEST_VAR_COUNT		200
+
+/* Size of the variable which makes up most of the snapshot in the file */
+#define TEST_BIG_SIZE		512
+
+#define TEST_VOLATILE_ATTR	EFI_VARIABLE_BOOTSERVICE_ACCESS
+#define TEST_NV_ATTR		(EFI_VARIABLE_NON_VOLATILE | \
+				 EFI_VARIABLE_BOOTSERVICE_ACCESS | \
+				 EFI_VARIABLE_RUNTIME_ACCESS)
+
+static const efi_guid_t test_guid =
+	EFI_GUID(0x0f6f9ba1, 0x3a7e, 0x4c2d,
+		 0x9a, 0x31, 0x6e, 0x55, 0x2b, 0x8c, 0x40, 0x17);
+static const efi_guid_t other_guid =
+	EFI_GUID(0x0f6f9ba1, 0x3a7e, 0x4c2d,
+		 0x9a, 0x31, 0x6e, 0x55, 0x2b, 0x8c, 0x40, 0x18);
+
+/**
+ * check_var() - check that a variable is found in memory with a value
+ *
+ * @uts: Test state
+ * @name: Variable name
+ * @val: Expected value
+ * @nextp: Returns the variable after it in the buffer, or NULL if none
+ * Return: 0 if OK, -EBADF on failure
+ */
+static int check_var(struct unit_test_state *uts, const u16 *name, u32 val,
+		     struct efi_var_entry **nextp)
+{
+	struct efi_var_entry *var;
+	u16 *data;
+
+	var = efi_var_mem_find(&test_guid, name, nextp);
+	ut_assertnonnull(var);
+	ut_assertok(u16_strcmp(name, var->name));
+	ut_asserteq(sizeof(val), var->length);
+	data = var->name + u16_strlen(var->name) + 1;
+	ut_asserteq_mem(&val, data, sizeof(val));
+
+	return 0;
+}
+
+/* Test looking up variables through the index */
+static int lib_test_efi_var_index(struct unit_test_state *uts)
+{
+	struct efi_var_entry *var, *next, *prev;
+	u16 name[16];
+	u32 i;
+
+	ut_assertok(efi_init_obj_list());
+
+	for (i = 0; i < TEST_VAR_COUNT; i++) {
+		efi_create_indexed_name(name, sizeof(name), "Test", i);
+		ut_assertok(efi_var_mem_ins(name, &test_guid,
+					    TEST_VOLATILE_ATTR, sizeof(i), &i,
+					    0, NULL, 0));
+	}
+
+	/* each lookup finds the right variable and the one after it */
+	prev = NULL;
+	for (i = 0; i < TEST_VAR_COUNT; i++) {
+		efi_create_indexed_name(name, sizeof(name), "Test", i);
+		ut_assertok(check_var(uts, name, i, &next));
+		if (prev)
+			ut_asserteq_ptr(prev, efi_var_mem_find(&test_guid,
+							       name, NULL));
+		prev = next;
+	}
+	ut_assertnull(next);
+
+	/* the GUID is part of the key */
+	efi_create_indexed_name(name, sizeof(name), "Test", 0);
+	ut_assertnull(efi_var_mem_find(&other_guid, name, NULL));
+	ut_assertnull(efi_var_mem_find(&test_guid, u"Test", NULL));
+
+	/* deleting moves the remaining variables, which must still be found */
+	for (i = 0; i < TEST_VAR_COUNT; i += 2) {
+		efi_create_indexed_name(name, sizeof(name), "Test", i);
+		var = efi_var_mem_find(&test_guid, name, NULL);
+		ut_assertnonnull(var);
+		efi_var_mem_del(var);
+	}
+	for (i = 0; i < TEST_VAR_COUNT; i++) {
+		efi_create_indexed_name(name, sizeof(name), "Test", i);
+		if (i & 1)
+			ut_assertok(check_var(uts, name, i, NULL));
+		else
+			ut_assertnull(efi_var_mem_find(&test_guid, name, NULL));
+	}
+
+	for (i = 1; i < TEST_VAR_COUNT; i += 2) {
+		efi_create_indexed_name(name, sizeof(name), "Test", i);
+		efi_var_mem_del(efi_var_mem_find(&test_guid, name, NULL));
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_var_index, 0);
+
+#ifdef CONFIG_EFI_VARIABLE_FILE_JOURNAL
+/**
+ * file_size() - get the size of the file holding the variables
+ *
+ * @desc: Block device holding the file
+ * Return: size of file, or -1 on error
+ */
+static loff_t file_size(struct blk_desc *desc)
+{
+	loff_t size;
+
+	if (fs_set_blk_dev_with_part(desc, 0) ||
+	    fs_size(EFI_VAR_FILE_NAME, &size))
+		return -1;
+
+	return size;
+}
+
+/**
+ * rec_len() - get the length of the journal record for a variable
+ *
+ * @name: Variable name
+ * Return: length of the record for the variable's current value, or of the
+ *	record for deleting it if it does not exist
+ */
+static loff_t rec_len(const u16 *name)
+{
+	struct efi_var_entry *var;
+
+	var = efi_var_mem_find(&test_guid, name, NULL);
+	if (var)
+		return sizeof(struct efi_var_journal) + efi_var_entry_len(var);
+
+	return sizeof(struct efi_var_journal) +
+		ALIGN(sizeof(*var) + sizeof(u16) * (u16_strlen(name) + 1), 8);
+}
+
+/**
+ * set_var() - set a non-volatile variable, which writes it to the file
+ *
+ * @name: Variable name
+ * @val: Value, or NULL to delete the variable
+ * Return: status code
+ */
+static efi_status_t set_var(const u16 *name, u32 *val)
+{
+	return efi_set_variable_int(name, &test_guid, TEST_NV_ATTR,
+				    val ? sizeof(*val) : 0, val, false);
+}
+
+/* Test appending to, replaying and compacting the journal */
+static int lib_test_efi_var_journal(struct unit_test_state *uts)
+{
+	struct efi_system_partition old_esp = efi_system_partition;
+	struct udevice *dev, *blk;
+	loff_t vars, size, expect;
+	struct efi_var_file *buf;
+	struct blk_desc *desc;
+	char fname[256];
+	bool compacted;
+	efi_uintn_t len;
+	u8 *big;
+	u32 val;
+	int i;
+
+	ut_assertok(efi_init_obj_list());
+
+	/* Use a file created in test_ut_dm_init as the EFI system partition */
+	ut_assertok(os_persistent_file(fname, sizeof(fname), "1MB.fat32.img"));
+	ut_assertok(host_create_device("efivar", true, DEFAULT_BLKSZ, &dev));
+	ut_assertok(host_attach_file(dev, fname));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+	efi_system_partition.uclass_id = desc->uclass_id;
+	efi_system_partition.devnum = desc->devnum;
+	efi_system_partition.part = 0;
+
+	/* start with a snapshot which is larger than a few records */
+	big = malloc(TEST_BIG_SIZE);
+	ut_assertnonnull(big);
+	memset(big, 0xa5, TEST_BIG_SIZE);
+	ut_assertok(efi_set_variable_int(u"Big", &test_guid, TEST_NV_ATTR,
+					 TEST_BIG_SIZE, big, false));
+	ut_assertok(efi_var_to_file());
+	vars = file_size(desc);
+	ut_assert(vars > 0);
+
+	/* each change is appended to the file */
+	expect = vars;
+	val = 1;
+	ut_assertok(set_var(u"Journal1", &val));
+	expect += rec_len(u"Journal1");
+	ut_asserteq(expect, file_size(desc));
+
+	val = 2;
+	ut_assertok(set_var(u"Journal1", &val));
+	expect += rec_len(u"Journal1");
+	ut_asserteq(expect, file_size(desc));
+
+	val = 3;
+	ut_assertok(set_var(u"Journal2", &val));
+	expect += rec_len(u"Journal2");
+	ut_asserteq(expect, file_size(desc));
+
+	ut_assertok(set_var(u"Journal2", NULL));
+	expect += rec_len(u"Journal2");
+	ut_asserteq(expect, file_size(desc));
+
+	/*
+	 * Simulate a reset: lose the variables from memory, keeping a stale
+	 * Journal2 which the last record deletes, then read the file again
+	 */
+	efi_var_mem_del(efi_var_mem_find(&test_guid, u"Journal1", NULL));
+	efi_var_mem_del(efi_var_mem_find(&test_guid, u"Big", NULL));
+	val = 3;
+	ut_assertok(efi_var_mem_ins(u"Journal2", &test_guid, TEST_NV_ATTR,
+				    sizeof(val), &val, 0, NULL, 0));
+	ut_assertok(efi_var_from_file());
+
+	ut_assertok(check_var(uts, u"Journal1", 2, NULL));
+	ut_assertnull(efi_var_mem_find(&test_guid, u"Journal2", NULL));
+	len = TEST_BIG_SIZE;
+	memset(big, '\0', TEST_BIG_SIZE);
+	ut_asserteq(EFI_SUCCESS,
+		    efi_get_variable_int(u"Big", &test_guid, NULL, &len, big,
+					 NULL));
+	ut_asserteq(TEST_BIG_SIZE, len);
+	for (i = 0; i < TEST_BIG_SIZE; i++)
+		ut_asserteq(0xa5, big[i]);
+
+	/*
+	 * Appending continues after the replay, until the journal would be
+	 * larger than the snapshot, when the file is rewritten
+	 */
+	compacted = false;
+	for (i = 0; i < TEST_BIG_SIZE / 16 && !compacted; i++) {
+		val = 100 + i;
+		ut_assertok(set_var(u"Journal1", &val));
+		size = file_size(desc);
+		if (size < expect) {
+			compacted = true;
+		} else {
+			expect += rec_len(u"Journal1");
+			ut_asserteq(expect, size);
+		}
+		ut_assert(size - vars <= vars + rec_len(u"Journal1"));
+	}
+	ut_assert(compacted);
+
+	/* the compacted file holds just the variables, with no records */
+	ut_assertok(efi_var_collect(&buf, &expect, EFI_VARIABLE_NON_VOLATILE));
+	ut_asserteq(expect, size);
+	free(buf);
+
+	/* the value set when compacting is the one read back */
+	efi_var_mem_del(efi_var_mem_find(&test_guid, u"Journal1", NULL));
+	ut_assertok(efi_var_from_file());
+	ut_assertok(check_var(uts, u"Journal1", val, NULL));
+
+	ut_assertok(set_var(u"Journal1", NULL));
+	ut_assertok(efi_set_variable_int(u"Big", &test_guid, TEST_NV_ATTR, 0,
+					 NULL, false));
+	free(big);
+
+	efi_system_partition = old_esp;
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_var_journal, 0);
+#endif
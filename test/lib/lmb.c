@@ -8,6 +8,7 @@
 #include <lmb.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
 #include <dm/test.h>
 #include <test/lib.h>
 #include <test/test.h>
@@ -823,3 +824,60 @@ static int lib_test_lmb_flags(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_test_lmb_flags, 0);
+
+/*
+ * Stress the region lists with many small reservations which cannot be
+ * coalesced, as made by the EFI loader for pool pages and loaded images
+ */
+static int lib_test_lmb_bench(struct unit_test_state *uts)
+{
+	enum {
+		COUNT	= 1024,
+		SIZE	= 0x1000,
+	};
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t ram_size = 0x20000000;
+	ulong alloc_us, query_us, free_us;
+	struct alist *mem_lst, *used_lst;
+	phys_addr_t addr[COUNT];
+	struct lmb store;
+	int i, pass;
+
+	ut_assertok(setup_lmb_test(uts, &store, &mem_lst, &used_lst));
+	ut_assertok(lmb_add(ram, ram_size));
+
+	/* alternate the flags so that neighbouring regions stay separate */
+	alloc_us = timer_get_us();
+	for (i = 0; i < COUNT; i++) {
+		addr[i] = lmb_alloc_base(SIZE, SIZE, LMB_ALLOC_ANYWHERE,
+					 i & 1 ? LMB_NOOVERWRITE : LMB_NONE);
+		ut_assert(addr[i]);
+	}
+	alloc_us = timer_get_us() - alloc_us;
+	ut_asserteq(COUNT, used_lst->count);
+
+	query_us = timer_get_us();
+	for (i = 0; i < COUNT; i++) {
+		ut_asserteq(i & 1, lmb_is_reserved_flags(addr[i],
+							 LMB_NOOVERWRITE));
+		ut_asserteq(0, lmb_get_free_size(addr[i] + SIZE - 1));
+	}
+	query_us = timer_get_us() - query_us;
+
+	/* free the even regions first, then the odd ones */
+	free_us = timer_get_us();
+	for (pass = 0; pass < 2; pass++) {
+		for (i = pass; i < COUNT; i += 2)
+			ut_assertok(lmb_free(addr[i], SIZE));
+	}
+	free_us = timer_get_us() - free_us;
+	ut_asserteq(0, used_lst->count);
+
+	printf("%d regions: alloc %lu us, query %lu us, free %lu us\n",
+	       COUNT, alloc_us, query_us, free_us);
+
+	lmb_pop(&store);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_bench, 0);
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the work queue
+ */
+
+#include <malloc.h>
+#include <time.h>
+#include <workq.h>
+#include <linux/sizes.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+#define WORKQ_TEST_JOBS		64
+#define WORKQ_TEST_CHUNK	SZ_64K
+
+/**
+ * struct workq_test - a chunk of data to checksum
+ *
+ * @job: job which checksums the chunk
+ * @buf: start of the chunk
+ * @crc: returns the CRC32 of the chunk
+ */
+struct workq_test {
+	struct workq_job job;
+	const u8 *buf;
+	u32 crc;
+};
+
+static void workq_test_crc(void *arg)
+{
+	struct workq_test *test = arg;
+
+	test->crc = crc32(0, test->buf, WORKQ_TEST_CHUNK);
+}
+
+/**
+ * workq_test_run() - checksum a buffer in chunks using the work queue
+ *
+ * @uts: test state
+ * @buf: buffer of WORKQ_TEST_JOBS chunks
+ * @tests: returns the checksum of each chunk
+ * Return: 0 if OK, -ve on failure
+ */
+static int workq_test_run(struct unit_test_state *uts, const u8 *buf,
+			  struct workq_test *tests)
+{
+	int i;
+
+	for (i = 0; i < WORKQ_TEST_JOBS; i++) {
+		tests[i].buf = buf + i * WORKQ_TEST_CHUNK;
+		tests[i].crc = 0;
+		workq_job_init(&tests[i].job, workq_test_crc, &tests[i]);
+		workq_submit(&tests[i].job);
+	}
+	for (i = 0; i < WORKQ_TEST_JOBS; i++) {
+		workq_wait(&tests[i].job);
+		ut_asserteq(crc32(0, tests[i].buf, WORKQ_TEST_CHUNK),
+			    tests[i].crc);
+	}
+
+	return 0;
+}
+
+/* Test running jobs without threads */
+static int lib_test_workq_inline(struct unit_test_state *uts)
+{
+	struct workq_test test;
+	u8 *buf;
+
+	buf = malloc(WORKQ_TEST_CHUNK);
+	ut_assertnonnull(buf);
+	workq_uninit();
+	ut_asserteq(0, workq_init(0));
+	ut_asserteq(-EALREADY, workq_init(0));
+	ut_asserteq(0, workq_threads());
+
+	/* the job should be finished as soon as it is submitted */
+	memset(buf, 0xa5, WORKQ_TEST_CHUNK);
+	test.buf = buf;
+	workq_job_init(&test.job, workq_test_crc, &test);
+	workq_submit(&test.job);
+	ut_assert(test.job.done);
+	workq_wait(&test.job);
+	ut_asserteq(crc32(0, buf, WORKQ_TEST_CHUNK), test.crc);
+
+	workq_uninit();
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_workq_inline, 0);
+
+/* Test running jobs on host threads */
+static int lib_test_workq_threads(struct unit_test_state *uts)
+{
+	struct workq_test *tests;
+	ulong start, inline_ms, threads_ms;
+	u8 *buf;
+	int i;
+
+	buf = malloc(WORKQ_TEST_JOBS * WORKQ_TEST_CHUNK);
+	ut_assertnonnull(buf);
+	tests = calloc(WORKQ_TEST_JOBS, sizeof(*tests));
+	ut_assertnonnull(tests);
+	for (i = 0; i < WORKQ_TEST_JOBS * WORKQ_TEST_CHUNK; i++)
+		buf[i] = i * 7 + (i >> 12);
+
+	workq_uninit();
+	ut_asserteq(0, workq_init(0));
+	start = get_timer(0);
+	ut_assertok(workq_test_run(uts, buf, tests));
+	inline_ms = get_timer(start);
+	workq_uninit();
+
+	ut_asserteq(-EINVAL, workq_init(WORKQ_MAX_THREADS + 1));
+	ut_asserteq(4, workq_init(4));
+	ut_asserteq(4, workq_threads());
+	start = get_timer(0);
+	ut_assertok(workq_test_run(uts, buf, tests));
+	threads_ms = get_timer(start);
+	workq_uninit();
+	ut_asserteq(0, workq_threads());
+
+	/* Only report the timing, since it depends on the host */
+	printf("%d x %d KiB CRC32: inline %lu ms, 4 threads %lu ms\n",
+	       WORKQ_TEST_JOBS, WORKQ_TEST_CHUNK / 1024, inline_ms,
+	       threads_ms);
+
+	free(tests);
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_workq_threads, 0);
+
+static void workq_test_cpu(void *arg, int cpu)
+{
+	int *calls = arg;
+
+	calls[cpu]++;
+}
+
+/* Test workq_run_all() */
+static int lib_test_workq_run_all(struct unit_test_state *uts)
+{
+	int calls[WORKQ_MAX_THREADS] = {};
+	int i;
+
+	workq_uninit();
+	ut_asserteq(0, workq_init(0));
+	ut_asserteq(1, workq_run_all(workq_test_cpu, calls));
+	ut_asserteq(1, calls[0]);
+	workq_uninit();
+
+	calls[0] = 0;
+	ut_asserteq(3, workq_init(3));
+	ut_asserteq(3, workq_run_all(workq_test_cpu, calls));
+	for (i = 0; i < WORKQ_MAX_THREADS; i++)
+		ut_asserteq(i < 3, calls[i]);
+	workq_uninit();
+
+	return 0;
+}
+LIB_TEST(lib_test_workq_run_all, 0);
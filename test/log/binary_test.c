@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the binary log driver
+ */
+
+#include <bloblist.h>
+#include <log.h>
+#include <log_binary.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <test/log.h>
+#include <test/ut.h>
+
+#define TEST_BLOBLIST_SIZE	(CONFIG_LOG_BINARY_SIZE + 0x100)
+
+static const char test_fmt[] = "val %d %5s %lx %c%%%.3s\n";
+
+/**
+ * setup_binary() - Set up a bloblist and enable the binary log driver
+ *
+ * @uts: Test state
+ * @bufp: Returns the buffer used for the bloblist
+ * @filtp: Returns the filter added to the driver, to allow debug records
+ * Return: 0 if OK, -ve on error
+ */
+static int setup_binary(struct unit_test_state *uts, void **bufp, int *filtp)
+{
+	*bufp = malloc(TEST_BLOBLIST_SIZE);
+	ut_assertnonnull(*bufp);
+	ut_assertok(bloblist_new(map_to_sysmem(*bufp), TEST_BLOBLIST_SIZE, 0,
+				 0));
+	ut_assertok(log_device_set_enable(LOG_GET_DRIVER(binary), true));
+
+	/* Record debug messages, which do not go to the console */
+	*filtp = log_add_filter("binary", NULL, LOGL_MAX, NULL);
+	ut_assert(*filtp >= 0);
+
+	return 0;
+}
+
+/* Test that records are stored with their raw arguments */
+static int log_test_binary(struct unit_test_state *uts)
+{
+	struct log_bin_rec *brec;
+	struct log_bin_hdr *hdr;
+	void *buf;
+	char *str;
+	u64 *arg;
+	int filt;
+
+	ut_assertok(setup_binary(uts, &buf, &filt));
+	log(LOGC_BOOT, LOGL_DEBUG, test_fmt, -5, "abc", 0x1234abcdUL, 'x',
+	    "defgh");
+	ut_assertok(log_remove_filter("binary", filt));
+
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_LOG,
+			    sizeof(*hdr) + CONFIG_LOG_BINARY_SIZE);
+	ut_assertnonnull(hdr);
+	ut_asserteq(LOG_BIN_MAGIC, hdr->magic);
+	ut_asserteq(1, hdr->count);
+	ut_asserteq(0, hdr->dropped);
+
+	brec = (void *)(hdr + 1) + hdr->tail;
+	ut_asserteq(LOGL_DEBUG, brec->level);
+	ut_asserteq(LOGC_BOOT, brec->cat);
+	ut_asserteq(0, brec->flags);
+	ut_asserteq_ptr(test_fmt, log_bin_anchor + brec->fmt);
+	if (IS_ENABLED(CONFIG_LOGF_FUNC))
+		ut_asserteq_str(__func__, log_bin_anchor + brec->func);
+	ut_asserteq_str(__FILE__, log_bin_anchor + brec->file);
+
+	/* -5, then "abc" padded to 8 bytes, then 0x1234abcd, 'x' and "def" */
+	arg = (u64 *)(brec + 1);
+	ut_asserteq(-5, (int)arg[0]);
+	ut_asserteq_str("abc", (char *)&arg[1]);
+	ut_asserteq(0x1234abcd, arg[2]);
+	ut_asserteq('x', arg[3]);
+	str = (char *)&arg[4];
+	ut_asserteq_str("def", str);
+	ut_asserteq(sizeof(*brec) + 5 * sizeof(u64), brec->size);
+
+	free(buf);
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_binary, UFT_BLOBLIST);
+
+/* Test that a message is stored formatted if its arguments cannot be */
+static int log_test_binary_msg(struct unit_test_state *uts)
+{
+	struct log_bin_rec *brec;
+	struct log_bin_hdr *hdr;
+	phys_addr_t addr = 0x1234;
+	void *buf;
+	int filt;
+
+	ut_assertok(setup_binary(uts, &buf, &filt));
+	log(LOGC_BOOT, LOGL_DEBUG, "addr %pa\n", &addr);
+	ut_assertok(log_remove_filter("binary", filt));
+
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_LOG,
+			    sizeof(*hdr) + CONFIG_LOG_BINARY_SIZE);
+	ut_assertnonnull(hdr);
+	ut_asserteq(1, hdr->count);
+	brec = (void *)(hdr + 1) + hdr->tail;
+	ut_asserteq(LOG_BINF_MSG, brec->flags);
+	ut_asserteq(0, brec->fmt);
+	ut_asserteq_strn("addr 0x", (char *)(brec + 1));
+
+	free(buf);
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_binary_msg, UFT_BLOBLIST);
+
+/* Test that a format string outside the image is stored formatted */
+static int log_test_binary_heap(struct unit_test_state *uts)
+{
+	struct log_bin_rec *brec;
+	struct log_bin_hdr *hdr;
+	void *buf;
+	char *fmt;
+	int filt;
+
+	ut_assertok(setup_binary(uts, &buf, &filt));
+	fmt = strdup("heap %d\n");
+	ut_assertnonnull(fmt);
+	log(LOGC_BOOT, LOGL_DEBUG, fmt, 42);
+	ut_assertok(log_remove_filter("binary", filt));
+	free(fmt);
+
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_LOG,
+			    sizeof(*hdr) + CONFIG_LOG_BINARY_SIZE);
+	ut_assertnonnull(hdr);
+	ut_asserteq(1, hdr->count);
+	brec = (void *)(hdr + 1) + hdr->tail;
+	ut_asserteq(LOG_BINF_MSG, brec->flags);
+	ut_asserteq(0, brec->fmt);
+	ut_asserteq_str("heap 42\n", (char *)(brec + 1));
+	ut_asserteq_str(__FILE__, log_bin_anchor + brec->file);
+
+	free(buf);
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_binary_heap, UFT_BLOBLIST);
+
+/* Test that the oldest records are dropped when the ring is full */
+static int log_test_binary_wrap(struct unit_test_state *uts)
+{
+	struct log_bin_rec *brec;
+	struct log_bin_hdr *hdr;
+	uint pos, seq;
+	void *buf;
+	int filt, i;
+
+	ut_assertok(setup_binary(uts, &buf, &filt));
+	for (i = 0; i < 1000; i++)
+		log(LOGC_BOOT, LOGL_DEBUG, "record %d %s\n", i,
+		    i & 1 ? "odd" : "a longer string for even records");
+	ut_assertok(log_remove_filter("binary", filt));
+
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_LOG,
+			    sizeof(*hdr) + CONFIG_LOG_BINARY_SIZE);
+	ut_assertnonnull(hdr);
+	ut_assert(hdr->count > 1);
+	ut_asserteq(1000, hdr->count + hdr->dropped);
+
+	/* Walk the ring from the oldest record, which must be in order */
+	pos = hdr->tail;
+	seq = hdr->dropped;
+	for (i = 0; i < hdr->count; i++) {
+		brec = (void *)(hdr + 1) + pos;
+		if (pos == hdr->size || !brec->size) {
+			pos = 0;
+			brec = (void *)(hdr + 1);
+		}
+		ut_asserteq(seq, brec->seq);
+		ut_asserteq(seq, *(u64 *)(brec + 1));
+		pos += brec->size;
+		ut_assert(pos <= hdr->size);
+		seq++;
+	}
+	ut_asserteq(hdr->head, pos);
+	ut_asserteq(hdr->seq, seq);
+
+	free(buf);
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_binary_wrap, UFT_BLOBLIST);
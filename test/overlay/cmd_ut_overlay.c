@@ -23,6 +23,7 @@
 extern u32 __dtb_test_fdt_base_begin;
 extern u32 __dtbo_test_fdt_overlay_begin;
 extern u32 __dtbo_test_fdt_overlay_stacked_begin;
+extern u32 __dtbo_test_fdt_overlay_batch_begin;
 
 static void *fdt;
 
@@ -210,6 +211,180 @@ static int fdt_overlay_stacked(struct unit_test_state *uts)
 }
 OVERLAY_TEST(fdt_overlay_stacked, 0);
 
+/* Check that applying the overlays as a batch gives the same tree */
+static int fdt_overlay_batch(struct unit_test_state *uts)
+{
+	void *fdt_base = &__dtb_test_fdt_base_begin;
+	void *fdt_overlay = &__dtbo_test_fdt_overlay_begin;
+	void *fdt_overlay_stacked = &__dtbo_test_fdt_overlay_stacked_begin;
+	struct fdt_overlay_batch batch;
+	void *base, *ov;
+
+	base = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(base);
+	ov = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(ov);
+	ut_assertok(fdt_open_into(fdt_base, base, FDT_COPY_SIZE));
+
+	fdt_overlay_batch_init(&batch);
+	ut_assertok(fdt_open_into(fdt_overlay, ov, FDT_COPY_SIZE));
+	ut_assertok(fdt_overlay_batch_apply(&batch, base, ov));
+
+	/* Resizing the tree between overlays is allowed */
+	ut_assertok(fdt_pack(base));
+	ut_assertok(fdt_open_into(base, base, FDT_COPY_SIZE));
+
+	ut_assertok(fdt_open_into(fdt_overlay_stacked, ov, FDT_COPY_SIZE));
+	ut_assertok(fdt_overlay_batch_apply(&batch, base, ov));
+	fdt_overlay_batch_uninit(&batch);
+
+	/* Compare everything except the free space at the end */
+	ut_asserteq(fdt_totalsize(fdt), fdt_totalsize(base));
+	ut_asserteq_mem(fdt, base,
+			fdt_off_dt_strings(fdt) + fdt_size_dt_strings(fdt));
+
+	free(ov);
+	free(base);
+
+	return CMD_RET_SUCCESS;
+}
+OVERLAY_TEST(fdt_overlay_batch, 0);
+
+/**
+ * apply_overlay() - Apply a copy of an overlay to a base tree
+ *
+ * @uts: Test state
+ * @batch: Batch to use, or NULL to use fdt_overlay_apply()
+ * @base: Base tree
+ * @ov: Buffer of FDT_COPY_SIZE bytes for the copy of the overlay
+ * @src: Overlay to apply
+ * Return: 0 if OK, -ve on error
+ */
+static int apply_overlay(struct unit_test_state *uts,
+			 struct fdt_overlay_batch *batch, void *base, void *ov,
+			 const void *src)
+{
+	ut_assertok(fdt_open_into(src, ov, FDT_COPY_SIZE));
+	if (batch)
+		ut_assertok(fdt_overlay_batch_apply(batch, base, ov));
+	else
+		ut_assertok(fdt_overlay_apply(base, ov));
+
+	return 0;
+}
+
+/**
+ * apply_phandle_overlays() - Apply overlays which replace an existing phandle
+ *
+ * @uts: Test state
+ * @batch: Batch to use, or NULL to use fdt_overlay_apply()
+ * @base: Buffer of FDT_COPY_SIZE bytes for the tree
+ * @ov: Buffer of FDT_COPY_SIZE bytes for each overlay
+ * Return: 0 if OK, -ve on error
+ */
+static int apply_phandle_overlays(struct unit_test_state *uts,
+				  struct fdt_overlay_batch *batch, void *base,
+				  void *ov)
+{
+	bool indexed = batch && CONFIG_IS_ENABLED(OF_LIBFDT_OVERLAY_BATCH);
+
+	ut_assertok(fdt_open_into(&__dtb_test_fdt_base_begin, base,
+				  FDT_COPY_SIZE));
+	ut_assertok(apply_overlay(uts, batch, base, ov,
+				  &__dtbo_test_fdt_overlay_begin));
+	ut_assertok(apply_overlay(uts, batch, base, ov,
+				  &__dtbo_test_fdt_overlay_stacked_begin));
+
+	/* The labels used so far are cached for the next overlay */
+	if (indexed) {
+		ut_assert(batch->valid);
+		ut_asserteq(2, batch->symbols.count);
+	}
+
+	/* This uses the cached 'test' label, then replaces a phandle */
+	ut_assertok(apply_overlay(uts, batch, base, ov,
+				  &__dtbo_test_fdt_overlay_batch_begin));
+	if (indexed)
+		ut_assert(!batch->valid);
+
+	/* The indexes are built again, with the new phandle */
+	ut_assertok(apply_overlay(uts, batch, base, ov,
+				  &__dtbo_test_fdt_overlay_batch_begin));
+
+	return 0;
+}
+
+/* Check replacing an existing phandle and reusing labels in a batch */
+static int fdt_overlay_batch_phandle(struct unit_test_state *uts)
+{
+	struct fdt_overlay_batch batch;
+	void *expect, *base, *ov;
+
+	expect = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(expect);
+	base = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(base);
+	ov = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(ov);
+
+	ut_assertok(apply_phandle_overlays(uts, NULL, expect, ov));
+
+	fdt_overlay_batch_init(&batch);
+	ut_assertok(apply_phandle_overlays(uts, &batch, base, ov));
+	fdt_overlay_batch_uninit(&batch);
+
+	ut_asserteq(fdt_totalsize(expect), fdt_totalsize(base));
+	ut_asserteq_mem(expect, base,
+			fdt_off_dt_strings(expect) + fdt_size_dt_strings(expect));
+
+	free(ov);
+	free(base);
+	free(expect);
+
+	return CMD_RET_SUCCESS;
+}
+OVERLAY_TEST(fdt_overlay_batch_phandle, 0);
+
+/* Check that libfdt is used if the indexes cannot be allocated */
+static int fdt_overlay_batch_nomem(struct unit_test_state *uts)
+{
+	struct fdt_overlay_batch batch;
+	void *base, *ov;
+	int ret;
+
+	if (!CONFIG_IS_ENABLED(OF_LIBFDT_OVERLAY_BATCH))
+		return -EAGAIN;
+
+	base = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(base);
+	ov = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(ov);
+	ut_assertok(fdt_open_into(&__dtb_test_fdt_base_begin, base,
+				  FDT_COPY_SIZE));
+
+	fdt_overlay_batch_init(&batch);
+	malloc_enable_testing(0);
+	ret = apply_overlay(uts, &batch, base, ov,
+			    &__dtbo_test_fdt_overlay_begin);
+	if (!ret)
+		ret = apply_overlay(uts, &batch, base, ov,
+				    &__dtbo_test_fdt_overlay_stacked_begin);
+	malloc_disable_testing();
+	ut_assertok(ret);
+	ut_assert(!batch.valid);
+	fdt_overlay_batch_uninit(&batch);
+
+	ut_asserteq(fdt_totalsize(fdt), fdt_totalsize(base));
+	ut_asserteq_mem(fdt, base,
+			fdt_off_dt_strings(fdt) + fdt_size_dt_strings(fdt));
+
+	free(ov);
+	free(base);
+
+	return CMD_RET_SUCCESS;
+}
+OVERLAY_TEST(fdt_overlay_batch_nomem, 0);
+
 int do_ut_overlay(struct unit_test_state *uts, struct cmd_tbl *cmdtp, int flag,
 		  int argc, char *const argv[])
 {
@@ -1,6 +1,7 @@
 # SPDX-License-Identifier: GPL-2.0
 # Copyright (C) 2020 Sean Anderson
 
+import re
 import pytest
 
 @pytest.mark.buildconfigspec('cmd_dm')
@@ -82,3 +83,24 @@ def test_dm_uclass(u_boot_console):
 @pytest.mark.buildconfigspec("cmd_dm")
 def test_dm_devres(u_boot_console):
     response = u_boot_console.run_command("dm devres")
+
+@pytest.mark.buildconfigspec('cmd_dm')
+@pytest.mark.buildconfigspec('bootprof')
+def test_dm_profile(u_boot_console):
+    """Test that the boot profile holds the drivers used on this boot"""
+    response = u_boot_console.run_command('dm profile')
+    assert 'No profile data' not in response
+
+    # The first table lists each driver, under a 'Driver' heading
+    lines = response.splitlines()
+    assert lines[0].split()[0] == 'Driver'
+    drivers = []
+    for line in lines[1:]:
+        if not line.strip():
+            break
+        drivers.append(line.split()[0])
+    assert drivers
+
+    m = re.search(r'(\d+) records, (\d+) dropped', response)
+    assert m
+    assert int(m.group(1)) > len(drivers)
@@ -8,6 +8,7 @@ This tests U-Boot logging. It uses the 'log test' command with various options
 and checks that the output is correct.
 """
 
+import re
 import pytest
 
 @pytest.mark.buildconfigspec('cmd_log')
@@ -40,6 +41,19 @@ def test_log_format(u_boot_console):
         run_with_format('lm', 'NOTICE. msg')
         run_with_format('m', 'msg')
 
+@pytest.mark.buildconfigspec('cmd_log')
+@pytest.mark.buildconfigspec('cmd_bloblist')
+@pytest.mark.buildconfigspec('log_binary')
+def test_log_binary(u_boot_console):
+    """Test that the binary log has room in the bloblist set up at boot"""
+    cons = u_boot_console
+    cons.run_command('log rec arch notice file.c 123 func msg')
+    output = cons.run_command('bloblist list')
+
+    # The buffer follows a 32-byte header
+    size = int(cons.config.buildconfig.get('config_log_binary_size'), 16)
+    assert re.search(r'\s%x\s+\w+ Binary log' % (size + 32), output)
+
 @pytest.mark.buildconfigspec('debug_uart')
 @pytest.mark.boardspec('sandbox')
 def test_log_dropped(u_boot_console):
@@ -299,6 +299,52 @@ def check_flamegraph(cons, fname, proftool, map_fname, trace_fg):
                 total += count
     return total
 
+
+def check_samples(cons, proftool, map_fname, trace_fg):
+    """Check that the samples give a flamegraph with a caller of schedule()
+
+    Args:
+        cons (ConsoleBase): U-Boot console
+        proftool (str): Filename of proftool
+        map_fname (str): Filename of System.map
+        trace_fg (str): Filename of output file
+    """
+    out = cons.run_command('trace stats')
+
+    # The output is something like this:
+    #     16,203 samples (1640 overwritten due to overflow)
+    #       1000 us sampling period
+    #     14,563 max samples
+    lines = [line.split(maxsplit=1) for line in out.splitlines() if line]
+    samples = [val.replace(',', '') for val, key in lines
+               if key.startswith('samples')]
+    assert int(samples[0]) > 0
+
+    # Read out the samples
+    addr = 0x02000000
+    size = 0x01000000
+    out = cons.run_command(f'trace samples {addr:x} {size:x}')
+    assert 'Samples dumped to' in out
+    fname = os.path.join(TMPDIR, 'samples')
+    out = cons.run_command(
+        'host save hostfs - %x %s ${profoffset}' % (addr, fname))
+
+    out = util.run_and_log(
+        cons, [proftool, '-t', fname, '-o', trace_fg, '-m', map_fname,
+               'dump-flamegraph'])
+
+    # Each line is a call stack ending with the caller of schedule(), then the
+    # number of samples. The console calls schedule() from fgetc() while it
+    # waits for input, e.g.:
+    #    cli_loop;...;cli_readline_into_buffer;getchar;fgetc 1043
+    found = 0
+    with open(trace_fg, 'r') as fd:
+        for line in fd:
+            stack, count = line.split()
+            if stack.split(';')[-1] == 'fgetc':
+                found += int(count)
+    assert found > 0
+
 check_flamegraph
 @pytest.mark.slow
 @pytest.mark.boardspec('sandbox')
@@ -334,3 +380,18 @@ def test_trace(u_boot_console):
     # Check that the trace buffer can be wiped
     numcalls = wipe_and_collect_trace(cons)
     assert numcalls == 0
+
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('trace_sample')
+def test_trace_samples(u_boot_console):
+    """Test we can collect samples and make a flamegraph from them"""
+    cons = u_boot_console
+
+    if not os.path.exists(TMPDIR):
+        os.mkdir(TMPDIR)
+    proftool = os.path.join(cons.config.build_dir, 'tools', 'proftool')
+    map_fname = os.path.join(cons.config.build_dir, 'System.map')
+    trace_fg = os.path.join(TMPDIR, 'samples.fg')
+
+    check_samples(cons, proftool, map_fname, trace_fg)
@@ -0,0 +1,126 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+# Test attaching UBI to an MTD partition, both by scanning and from a fastmap.
+# The partition is erased, a volume is created and filled with random data,
+# then the partition is attached again and the volume read back and checked
+# against the CRC32 of the data written.
+
+import pytest
+import u_boot_utils
+
+"""
+This test relies on boardenv_* to name an MTD partition which the test may
+erase. For example:
+
+env__ubi_config = {
+    # MTD partition to erase and attach UBI to
+    'partition': 'ubi-test',
+    # Size of the test volume in bytes, default 1MiB
+    'size': 0x100000,
+}
+
+Fastmap is only used on partitions of more than 64 eraseblocks, so the
+fastmap test needs one at least that large.
+"""
+
+def ubi_attach(u_boot_console, partition):
+    """Detach UBI and attach it to a partition again
+
+    Args:
+        u_boot_console: A U-Boot console connection.
+        partition: Name of the MTD partition.
+
+    Returns:
+        The output of 'ubi info'.
+    """
+    u_boot_console.run_command('ubi detach')
+    output = u_boot_console.run_command('ubi part %s' % partition)
+    assert 'UBI error' not in output
+    output = u_boot_console.run_command('ubi info')
+    assert 'MTD device name:            "%s"' % partition in output
+    return output
+
+def ubi_prepare(u_boot_console, env__ubi_config):
+    """Erase the partition, attach UBI and create a volume of random data
+
+    Args:
+        u_boot_console: A U-Boot console connection.
+        env__ubi_config: The UBI configuration; see the file-level comment.
+
+    Returns:
+        Tuple: the address of the data written, its size in bytes and its
+        CRC32.
+    """
+    partition = env__ubi_config['partition']
+    size = env__ubi_config.get('size', 0x100000)
+    addr = u_boot_utils.find_ram_base(u_boot_console)
+
+    u_boot_console.run_command('ubi detach')
+    output = u_boot_console.run_command('mtd erase %s' % partition)
+    assert 'Failure' not in output
+
+    # An erased partition can only be attached by scanning
+    ubi_attach(u_boot_console, partition)
+    output = u_boot_console.run_command('ubi create test %x' % size)
+    assert 'Creating dynamic volume test' in output
+
+    output = u_boot_console.run_command('random %x %x' % (addr, size))
+    assert '%d bytes filled with random data' % size in output
+    output = u_boot_console.run_command('ubi write %x test %x' % (addr, size))
+    assert '%d bytes written to volume test' % size in output
+    return addr, size, u_boot_utils.crc32(u_boot_console, addr, size)
+
+def ubi_check_read(u_boot_console, addr, size, crc):
+    """Read the test volume and check that it holds the data written
+
+    Args:
+        u_boot_console: A U-Boot console connection.
+        addr: Address to read the data to.
+        size: Size of the data in bytes.
+        crc: CRC32 of the data written.
+    """
+    u_boot_console.run_command('mw.b %x 0 %x' % (addr, size))
+    output = u_boot_console.run_command('ubi read %x test %x' % (addr, size))
+    assert 'Read %d bytes from volume test' % size in output
+    assert u_boot_utils.crc32(u_boot_console, addr, size) == crc
+
+@pytest.mark.buildconfigspec('cmd_ubi')
+@pytest.mark.buildconfigspec('cmd_mtd')
+@pytest.mark.buildconfigspec('cmd_random')
+@pytest.mark.buildconfigspec('cmd_memory')
+@pytest.mark.buildconfigspec('cmd_crc32')
+def test_ubi_attach_scan(u_boot_console, env__ubi_config):
+    """Test reading volumes after attaching by scanning
+
+    Without fastmap, each attach reads the headers of every eraseblock with
+    ubi_io_read_hdrs(). With fastmap, this covers attaching from the
+    fastmap written by the previous attach.
+    """
+    partition = env__ubi_config['partition']
+    addr, size, crc = ubi_prepare(u_boot_console, env__ubi_config)
+    output = ubi_attach(u_boot_console, partition)
+    assert 'number of user volumes:     1' in output
+    ubi_check_read(u_boot_console, addr, size, crc)
+
+@pytest.mark.buildconfigspec('cmd_ubi')
+@pytest.mark.buildconfigspec('cmd_mtd')
+@pytest.mark.buildconfigspec('cmd_random')
+@pytest.mark.buildconfigspec('cmd_memory')
+@pytest.mark.buildconfigspec('cmd_crc32')
+@pytest.mark.buildconfigspec('mtd_ubi_fastmap')
+def test_ubi_fastmap_at_attach(u_boot_console, env__ubi_config):
+    """Test that a fastmap is written when attaching by scanning
+
+    The fastmap must be written by the attach itself, so that the next boot
+    can use it even if UBI is never detached, e.g. because an OS is booted.
+    """
+    partition = env__ubi_config['partition']
+    addr, size, crc = ubi_prepare(u_boot_console, env__ubi_config)
+
+    # Restart without detaching, so any fastmap was written while attaching
+    u_boot_console.restart_uboot()
+    output = ubi_attach(u_boot_console, partition)
+    if 'fastmap:                    disabled' in output:
+        pytest.skip('Partition is too small for fastmap')
+    assert 'fastmap:                    present' in output
+    ubi_check_read(u_boot_console, addr, size, crc)
@@ -0,0 +1,117 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+# Test loading files from UBIFS on sandbox, with bulk-read enabled. A UBIFS
+# image is created on the host, written to a UBI volume on the sandbox NAND
+# chip set aside for UBI, then each file is loaded and checked against the
+# CRC32 of the data on the host.
+
+import os
+import re
+import zlib
+import pytest
+import u_boot_utils
+
+# nand2 in test.dts: 2KiB pages, 128KiB eraseblocks. UBI uses a page for each
+# of its two headers, so each LEB is two pages shorter than an eraseblock.
+MTD_NAME = 'nand2'
+MIN_IO_SIZE = 2048
+LEB_SIZE = 128 * 1024 - 2 * MIN_IO_SIZE
+MAX_LEB_CNT = 256
+VOLUME_SIZE = 0x1000000
+
+def make_files(src_dir):
+    """Create the files to put in the image
+
+    Args:
+        src_dir: Directory to create the files in.
+
+    Returns:
+        dict: file contents, keyed by filename
+    """
+    files = {
+        # Stored uncompressed, and not a whole number of blocks
+        'random': os.urandom(0x100000 + 100),
+        # Compressed
+        'text': b'UBIFS bulk-read test\n' * 16000,
+        # Zeroes in the middle, which mkfs.ubifs may leave out as a hole
+        'sparse': os.urandom(0x10000) + bytes(0x10000) + os.urandom(0x10000),
+        # Shorter than one block
+        'small': b'small file\n',
+    }
+    os.makedirs(src_dir, exist_ok=True)
+    for fname, data in files.items():
+        with open(os.path.join(src_dir, fname), 'wb') as outf:
+            outf.write(data)
+    return files
+
+def crc32(data):
+    """Get the CRC32 of some data, in the form printed by U-Boot
+
+    Args:
+        data (bytes): Data to check.
+
+    Returns:
+        str: CRC32 as eight hex digits
+    """
+    return '%08x' % (zlib.crc32(data) & 0xffffffff)
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_ubifs')
+@pytest.mark.buildconfigspec('ubifs_bulk_read')
+@pytest.mark.buildconfigspec('cmd_mtd')
+@pytest.mark.buildconfigspec('cmd_memory')
+@pytest.mark.buildconfigspec('cmd_crc32')
+@pytest.mark.requiredtool('mkfs.ubifs')
+def test_ubifs_bulk_read(u_boot_console):
+    """Test loading whole files and the start of a file with bulk-read"""
+    cons = u_boot_console
+    src_dir = os.path.join(cons.config.persistent_data_dir, 'ubifs')
+    img = os.path.join(cons.config.persistent_data_dir, 'ubifs.img')
+    files = make_files(src_dir)
+    u_boot_utils.run_and_log(cons, ['mkfs.ubifs', '-m', str(MIN_IO_SIZE),
+                                    '-e', str(LEB_SIZE), '-c',
+                                    str(MAX_LEB_CNT), '-r', src_dir, '-o',
+                                    img])
+    img_size = os.path.getsize(img)
+
+    addr = u_boot_utils.find_ram_base(cons)
+    load_addr = addr + 0x400000
+
+    cons.run_command('ubi detach')
+    output = cons.run_command('mtd erase %s' % MTD_NAME)
+    assert 'Failure' not in output
+    output = cons.run_command('ubi part %s' % MTD_NAME)
+    assert 'UBI error' not in output
+    output = cons.run_command('ubi create test %x' % VOLUME_SIZE)
+    assert 'Creating dynamic volume test' in output
+
+    output = cons.run_command('host load hostfs - %x %s' % (addr, img))
+    assert '%d bytes read' % img_size in output
+    output = cons.run_command('ubi write %x test %x' % (addr, img_size))
+    assert '%d bytes written to volume test' % img_size in output
+
+    output = cons.run_command('ubifsmount ubi0:test')
+    assert 'UBIFS error' not in output
+    output = cons.run_command('ubifsls')
+    for fname in files:
+        assert fname in output
+
+    for fname, data in files.items():
+        cons.run_command('mw.b %x 0 %x' % (load_addr, len(data)))
+        output = cons.run_command('ubifsload %x %s' % (load_addr, fname))
+        assert 'Done' in output
+        assert u_boot_utils.crc32(cons, load_addr, len(data)) == crc32(data)
+
+    # Load the start of a file, ending part-way through a block. Nothing after
+    # the requested size may be written.
+    data = files['random']
+    size = 100000
+    cons.run_command('mw.b %x 55 %x' % (load_addr, len(data)))
+    output = cons.run_command('ubifsload %x random %x' % (load_addr, size))
+    assert 'Done' in output
+    assert u_boot_utils.crc32(cons, load_addr, size) == crc32(data[:size])
+    output = cons.run_command('md.b %x 1' % (load_addr + size))
+    assert re.search(': 55 ', output)
+
+    cons.run_command('ubifsumount')
+    cons.run_command('ubi detach')
@@ -516,6 +516,13 @@ def test_ut_dm_init(u_boot_console):
         with open(fn, 'wb') as fh:
             fh.write(data)
 
+    fn = u_boot_console.config.source_dir + '/testflash2.bin'
+    if not os.path.exists(fn):
+        data = b'this is a uas test'
+        data += b'\x00' * ((4 * 1024 * 1024) - len(data))
+        with open(fn, 'wb') as fh:
+            fh.write(data)
+
     fn = u_boot_console.config.source_dir + '/spi.bin'
     if not os.path.exists(fn):
         data = b'\x00' * (2 * 1024 * 1024)
@@ -16,6 +16,7 @@ from OpenSSL import crypto
 
 # U-Boot variable store format (version 1)
 UBOOT_EFI_VAR_FILE_MAGIC = 0x0161566966456255
+UBOOT_EFI_VAR_JOURNAL_MAGIC = 0x016a566966456255
 
 # UEFI variable attributes
 EFI_VARIABLE_NON_VOLATILE = 0x1
@@ -54,6 +55,9 @@ class EfiStruct:
     # struct efi_var_file
     var_file_fmt = '<QQLL'
     var_file_size = struct.calcsize(var_file_fmt)
+    # struct efi_var_journal
+    var_journal_fmt = '<QLL'
+    var_journal_size = struct.calcsize(var_journal_fmt)
     # struct efi_var_entry
     var_entry_fmt = '<LLQ16s'
     var_entry_size = struct.calcsize(var_entry_fmt)
@@ -86,21 +90,56 @@ class EfiVariableStore:
         if os.path.exists(self.infile) and os.stat(self.infile).st_size > self.efi.var_file_size:
             with open(self.infile, 'rb') as f:
                 buf = f.read()
-                self._check_header(buf)
-                self.ents = buf[self.efi.var_file_size:]
+                length = self._check_header(buf)
+                self.ents = buf[self.efi.var_file_size:length]
+                self._replay(buf[length:])
         else:
             self.ents = bytearray()
 
     def _check_header(self, buf):
         hdr = struct.unpack_from(self.efi.var_file_fmt, buf, 0)
-        magic, crc32 = hdr[1], hdr[3]
+        magic, length, crc32 = hdr[1], hdr[2], hdr[3]
 
         if magic != UBOOT_EFI_VAR_FILE_MAGIC:
             print("err: invalid magic number: %s"%hex(magic))
             exit(1)
-        if crc32 != calc_crc32(buf[self.efi.var_file_size:]):
+        if length > len(buf):
+            print("err: invalid length: %d"%length)
+            exit(1)
+        if crc32 != calc_crc32(buf[self.efi.var_file_size:length]):
             print("err: invalid crc32: %s"%hex(crc32))
             exit(1)
+        return length
+
+    def _replay(self, journal):
+        # apply the records which U-Boot appends when a variable changes
+        offs = 0
+        while offs < len(journal):
+            if len(journal) - offs < self.efi.var_journal_size:
+                break
+            magic, length, crc32 = struct.unpack_from(self.efi.var_journal_fmt,
+                                                      journal, offs)
+            ent = journal[offs + self.efi.var_journal_size:offs + length]
+            if (magic != UBOOT_EFI_VAR_JOURNAL_MAGIC or
+                    length < self.efi.var_journal_size + self.efi.var_entry_size or
+                    offs + length > len(journal) or crc32 != calc_crc32(ent)):
+                break
+            var, _ = self._next_var(0, ent)
+            self._remove_var(var.guid, var.name)
+            if var.size:
+                self.ents += ent
+            offs += length
+        if offs != len(journal):
+            print("warning: ignoring damaged journal at offset %d"%offs)
+
+    def _remove_var(self, guid, name):
+        offs = 0
+        while offs < len(self.ents):
+            var, loffs = self._next_var(offs)
+            if var.name == name and var.guid == guid:
+                self.ents = self.ents[:offs] + self.ents[loffs:]
+                return
+            offs = loffs
 
     def _get_var_name(self, buf):
         name = ''
@@ -110,13 +149,15 @@ class EfiVariableStore:
             name += chr(buf[i])
         return ''.join([chr(x) for x in name.encode('utf_16_le') if x]), i + 2
 
-    def _next_var(self, offs=0):
-        size, attrs, time, guid = struct.unpack_from(self.efi.var_entry_fmt, self.ents, offs)
+    def _next_var(self, offs=0, ents=None):
+        if ents is None:
+            ents = self.ents
+        size, attrs, time, guid = struct.unpack_from(self.efi.var_entry_fmt, ents, offs)
         data_fmt = str(size)+"s"
         offs += self.efi.var_entry_size
-        name, namelen = self._get_var_name(self.ents[offs:])
+        name, namelen = self._get_var_name(ents[offs:])
         offs += namelen
-        data = struct.unpack_from(data_fmt, self.ents, offs)[0]
+        data = struct.unpack_from(data_fmt, ents, offs)[0]
         # offset to next 8-byte aligned variable entry
         offs = (offs + len(data) + 7) & ~7
         return EfiVariable(size, attrs, time, uuid.UUID(bytes_le=guid), name, data), offs
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+
+"""
+Decode the binary log buffer written by U-Boot's 'binary' log driver
+
+The buffer holds the raw arguments of each log record. The format strings,
+file names and function names are read from the U-Boot ELF file, which must be
+the one that wrote the buffer. See include/log_binary.h for the format.
+
+The input can be the buffer itself or any memory dump containing it, such as
+the whole bloblist.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_BIN_MAGIC = 0x42474f4c
+LOG_BIN_VERSION = 1
+
+# struct log_bin_hdr and struct log_bin_rec
+HDR_FMT = 'IIIIIIII'
+REC_FMT = 'HBBHHIiQii'
+
+# enum log_rec_flags and enum log_bin_flags
+LOGRECF_CONT = 1 << 1
+LOG_BINF_MSG = 1 << 6
+LOG_BINF_TRUNC = 1 << 7
+
+LEVEL_NAMES = ['EMERG', 'ALERT', 'CRIT', 'ERR', 'WARNING', 'NOTICE', 'INFO',
+               'DEBUG', 'CONTENT', 'IO']
+
+# Conversion in a format string, as parsed by log_bin_encode()
+RE_CONV = re.compile(
+    r'%([-+ #0]*)(\*|\d*)(?:\.(\*|\d*))?(hh|h|ll|l|L|q|z|Z|t)?(.)', re.S)
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 2
+
+
+class Elf:
+    """Minimal ELF reader, to look up symbols and read strings
+
+    Properties:
+        is64: True for a 64-bit ELF file
+        endian: '<' for little-endian, '>' for big-endian
+    """
+    def __init__(self, fname):
+        with open(fname, 'rb') as inf:
+            self._data = inf.read()
+        data = self._data
+        if data[:4] != b'\x7fELF':
+            raise ValueError(f"'{fname}' is not an ELF file")
+        self.is64 = data[4] == 2
+        self.endian = '<' if data[5] == 1 else '>'
+        if self.is64:
+            shoff, = self._unpack('Q', 0x28)
+            shentsize, shnum, shstrndx = self._unpack('HHH', 0x3a)
+            shdr_fmt = 'IIQQQQIIQQ'
+        else:
+            shoff, = self._unpack('I', 0x20)
+            shentsize, shnum, shstrndx = self._unpack('HHH', 0x2e)
+            shdr_fmt = 'IIIIIIIIII'
+
+        shdrs = [self._unpack(shdr_fmt, shoff + i * shentsize)
+                 for i in range(shnum)]
+        self._sections = []
+        self._symbols = {}
+        for (_, stype, flags, addr, offset, size, link, _, _,
+             entsize) in shdrs:
+            if flags & SHF_ALLOC and stype != SHT_NOBITS:
+                self._sections.append((addr, size, offset))
+            elif stype == SHT_SYMTAB:
+                self._read_symbols(offset, size, entsize, shdrs[link][4])
+
+    def _unpack(self, fmt, offset):
+        return struct.unpack_from(self.endian + fmt, self._data, offset)
+
+    def _read_symbols(self, offset, size, entsize, stroff):
+        for pos in range(offset, offset + size, entsize):
+            if self.is64:
+                name, _, _, _, value, _ = self._unpack('IBBHQQ', pos)
+            else:
+                name, value, _, _, _, _ = self._unpack('IIIBBH', pos)
+            end = self._data.index(b'\0', stroff + name)
+            self._symbols[self._data[stroff + name:end].decode()] = value
+
+    def symbol(self, name):
+        """Get the address of a symbol
+
+        Args:
+            name (str): Symbol name
+
+        Returns:
+            int: Address of the symbol
+
+        Raises:
+            KeyError: Symbol is not present
+        """
+        return self._symbols[name]
+
+    def read_str(self, addr):
+        """Read a nul-terminated string from the loaded image
+
+        Args:
+            addr (int): Address of the string
+
+        Returns:
+            str: String, or None if the address is not in the image
+        """
+        for start, size, offset in self._sections:
+            if start <= addr < start + size:
+                pos = offset + addr - start
+                end = self._data.index(b'\0', pos)
+                return self._data[pos:end].decode(errors='replace')
+        return None
+
+
+class Args:
+    """Reads the arguments stored after a record
+
+    Properties:
+        truncated: True if an argument was requested beyond the end
+    """
+    def __init__(self, data, endian):
+        self._data = data
+        self._endian = endian
+        self._pos = 0
+        self.truncated = False
+
+    def num(self):
+        """Read an integer or pointer argument"""
+        if self._pos + 8 > len(self._data):
+            self.truncated = True
+            return 0
+        val, = struct.unpack_from(self._endian + 'Q', self._data, self._pos)
+        self._pos += 8
+        return val
+
+    def string(self):
+        """Read a string argument"""
+        end = self._data.find(b'\0', self._pos)
+        if end < 0:
+            self.truncated = True
+            return ''
+        val = self._data[self._pos:end].decode(errors='replace')
+        self._pos += (end - self._pos + 8) // 8 * 8
+        return val
+
+
+def to_int(val, bits, signed):
+    """Convert a stored argument to the value that was passed"""
+    val &= (1 << bits) - 1
+    if signed and val & (1 << (bits - 1)):
+        val -= 1 << bits
+    return val
+
+
+def format_msg(fmt, args, long_bits):
+    """Rebuild a message from its format string and stored arguments
+
+    Args:
+        fmt (str): Format string
+        args (Args): Stored arguments
+        long_bits (int): Number of bits in a long
+
+    Returns:
+        str: Formatted message
+    """
+    out = []
+    last = 0
+    for mat in RE_CONV.finditer(fmt):
+        out.append(fmt[last:mat.start()])
+        last = mat.end()
+        flags, width, prec, qual, conv = mat.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if width == '*':
+            width = str(to_int(args.num(), 32, True))
+        if prec == '*':
+            prec = str(to_int(args.num(), 32, True))
+        spec = '%' + flags + width + ('' if prec is None else '.' + prec)
+
+        if conv == 's':
+            out.append((spec + 's') % args.string())
+        elif conv == 'p':
+            if not width:
+                spec = f'%0{long_bits // 4}'
+            out.append((spec + 'x') % args.num())
+        elif conv in 'cdiouxX':
+            bits = {'l': long_bits, 'z': long_bits, 'Z': long_bits,
+                    't': long_bits, 'll': 64, 'L': 64, 'q': 64}.get(qual, 32)
+            val = to_int(args.num(), bits, conv in 'di')
+            if conv == 'c':
+                out.append((spec + 'c') % chr(val & 0xff))
+            else:
+                out.append((spec + conv.replace('u', 'd')) % val)
+        else:
+            out.append(mat.group(0))
+    out.append(fmt[last:])
+    return ''.join(out)
+
+
+def find_hdr(data, endian):
+    """Find the binary log header in a memory dump
+
+    Returns:
+        int: Offset of the header, or -1 if not found
+    """
+    magic = struct.pack(endian + 'I', LOG_BIN_MAGIC)
+    pos = data.find(magic)
+    while pos >= 0:
+        if not pos % 8:
+            version, = struct.unpack_from(endian + 'I', data, pos + 4)
+            if version == LOG_BIN_VERSION:
+                return pos
+        pos = data.find(magic, pos + 1)
+    return -1
+
+
+def decode(elf, data, outf):
+    """Decode the records in a binary log buffer
+
+    Args:
+        elf (Elf): U-Boot ELF file
+        data (bytes): Memory dump containing the buffer
+        outf (file): File to write the messages to
+
+    Returns:
+        int: 0 if OK, 1 on error
+    """
+    endian = elf.endian
+    long_bits = 64 if elf.is64 else 32
+    anchor = elf.symbol('log_bin_anchor')
+
+    def get_str(offset):
+        if not offset:
+            return '?'
+        return elf.read_str(anchor + offset) or '?'
+
+    pos = find_hdr(data, endian)
+    if pos < 0:
+        print('No binary log found', file=sys.stderr)
+        return 1
+    hdr_size = struct.calcsize(endian + HDR_FMT)
+    (_, _, size, head, tail, count, seq,
+     dropped) = struct.unpack_from(endian + HDR_FMT, data, pos)
+    ring = data[pos + hdr_size:pos + hdr_size + size]
+    if len(ring) != size:
+        print('Binary log is truncated', file=sys.stderr)
+        return 1
+
+    rec_size = struct.calcsize(endian + REC_FMT)
+    pos = tail
+    for _ in range(count):
+        if pos + rec_size > size or not ring[pos] | ring[pos + 1]:
+            pos = 0
+        (rsize, level, flags, cat, line, rseq, fmt, time_us, file,
+         func) = struct.unpack_from(endian + REC_FMT, ring, pos)
+        if rsize < rec_size or pos + rsize > size:
+            print(f'Corrupt record at {pos:#x}', file=sys.stderr)
+            return 1
+        args = Args(ring[pos + rec_size:pos + rsize], endian)
+        pos += rsize
+
+        if flags & LOG_BINF_MSG:
+            msg = args.string()
+        else:
+            msg = format_msg(get_str(fmt), args, long_bits)
+        if flags & LOG_BINF_TRUNC or args.truncated:
+            msg = msg.rstrip('\n') + ' <truncated>\n'
+        if flags & LOGRECF_CONT:
+            outf.write(msg)
+            continue
+        name = LEVEL_NAMES[level] if level < len(LEVEL_NAMES) else str(level)
+        outf.write(f'{time_us // 1000000:5d}.{time_us % 1000000:06d} '
+                   f'{rseq:6d} {name:<7} {cat:3d} {get_str(file)}:{line}-'
+                   f'{get_str(func)}() {msg}')
+    if count and not msg.endswith('\n'):
+        outf.write('\n')
+    print(f'{count} records, {dropped} dropped, next sequence {seq}',
+          file=sys.stderr)
+    return 0
+
+
+def main(argv):
+    """Run the program"""
+    parser = argparse.ArgumentParser(
+        description='Decode the binary log buffer written by U-Boot')
+    parser.add_argument('-e', '--elf', required=True,
+                        help='U-Boot ELF file which wrote the log')
+    parser.add_argument('-o', '--output', help='Output file (default stdout)')
+    parser.add_argument('dump', help='File containing the binary log buffer')
+    args = parser.parse_args(argv)
+
+    elf = Elf(args.elf)
+    with open(args.dump, 'rb') as inf:
+        data = inf.read()
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8') as outf:
+            return decode(elf, data, outf)
+    return decode(elf, data, sys.stdout)
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -254,6 +254,8 @@ struct func_info *func_list;
 int func_count;			/* number of functions */
 struct trace_call *call_list;	/* list of all calls in the input trace file */
 int call_count;			/* number of calls */
+struct trace_sample *sample_list; /* list of samples in the input trace file */
+int sample_count;		/* number of samples */
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 ulong text_offset;		/* text address of first function */
 ulong text_base;		/* CONFIG_TEXT_BASE from trace file */
@@ -301,7 +303,10 @@ static void usage(void)
 		"\n"
 		"Subtypes for dump-flamegraph\n"
 		"   calls - create a flamegraph of stack frames\n"
-		"   timing - create a flamegraph of microseconds for each stack frame\n");
+		"   timing - create a flamegraph of microseconds for each stack frame\n"
+		"\n"
+		"If the trace data has samples (from U-Boot 'trace samples'), the\n"
+		"flamegraph is made from those, counting samples or microseconds\n");
 	exit(EXIT_FAILURE);
 }
 
@@ -483,6 +488,38 @@ static int read_calls(FILE *fin, size_t count)
 	return 0;
 }
 
+/**
+ * read_samples() - Read the list of samples from the trace data
+ *
+ * The samples are stored consecutively in the trace output produced by U-Boot
+ *
+ * @fin: File to read from
+ * @count: Number of samples to read
+ * Returns: 0 if OK, -1 on error
+ */
+static int read_samples(FILE *fin, size_t count)
+{
+	struct trace_sample *smp;
+	int i;
+
+	notice("sample count: %zu\n", count);
+	sample_list = calloc(count, sizeof(*smp));
+	if (!sample_list) {
+		error("Cannot allocate sample_list\n");
+		return -1;
+	}
+	sample_count = count;
+
+	smp = sample_list;
+	for (i = 0; i < count; i++, smp++) {
+		if (read_data(fin, smp, sizeof(*smp)))
+			return -1;
+		if (smp->depth > TRACE_SAMPLE_DEPTH)
+			smp->depth = TRACE_SAMPLE_DEPTH;
+	}
+	return 0;
+}
+
 /**
  * read_trace() - Read the U-Boot trace file
  *
@@ -515,6 +552,11 @@ static int read_trace(FILE *fin)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -1635,6 +1677,38 @@ static struct flame_node *create_node(const char *msg)
 	return node;
 }
 
+/**
+ * get_child() - Find or create the child node for a function
+ *
+ * @state: Current flamegraph state
+ * @node: Parent node
+ * @func: Function called from @node
+ * Returns: child node, or NULL if out of memory
+ */
+static struct flame_node *get_child(struct flame_state *state,
+				    struct flame_node *node,
+				    struct func_info *func)
+{
+	struct flame_node *child;
+
+	/* see if we have this as a child node already */
+	list_for_each_entry(child, &node->child_head, sibling_node) {
+		if (child->func == func)
+			return child;
+	}
+
+	/* create a new node */
+	child = create_node("child");
+	if (!child)
+		return NULL;
+	list_add_tail(&child->sibling_node, &node->child_head);
+	child->func = func;
+	child->parent = node;
+	state->nodes++;
+
+	return child;
+}
+
 /**
  * process_call(): Add a call to the flamegraph info
  *
@@ -1658,26 +1732,11 @@ static int process_call(struct flame_state *state, bool entry, ulong timestamp,
 	int stack_ptr = state->stack_ptr;
 
 	if (entry) {
-		struct flame_node *child, *chd;
-
-		/* see if we have this as a child node already */
-		child = NULL;
-		list_for_each_entry(chd, &node->child_head, sibling_node) {
-			if (chd->func == func) {
-				child = chd;
-				break;
-			}
-		}
-		if (!child) {
-			/* create a new node */
-			child = create_node("child");
-			if (!child)
-				return -1;
-			list_add_tail(&child->sibling_node, &node->child_head);
-			child->func = func;
-			child->parent = node;
-			state->nodes++;
-		}
+		struct flame_node *child;
+
+		child = get_child(state, node, func);
+		if (!child)
+			return -1;
 		debug("entry %s: move from %s to %s\n", func->name,
 		      node->func ? node->func->name : "(root)",
 		      child->func->name);
@@ -1725,6 +1784,47 @@ static int process_call(struct flame_state *state, bool entry, ulong timestamp,
 	return 0;
 }
 
+/**
+ * process_sample() - Add a sample to the flamegraph info
+ *
+ * This finds the node for the sample's call stack, creating nodes as needed,
+ * and adds the sample to its count and duration
+ *
+ * @state: Current flamegraph state
+ * @tree: Root of the tree
+ * @smp: Sample to add
+ * Returns: 0 on success, -ve on error
+ */
+static int process_sample(struct flame_state *state, struct flame_node *tree,
+			  const struct trace_sample *smp)
+{
+	struct flame_node *node = tree;
+	int i;
+
+	/* the outermost caller is last */
+	for (i = smp->depth - 1; i >= 0; i--) {
+		struct func_info *func;
+
+		/*
+		 * Each entry is a return address, so look up the byte before
+		 * it, in case the call is the last instruction of a function
+		 */
+		func = find_caller_by_offset(smp->pc[i] - 1);
+		if (!func) {
+			warn("Cannot find function at %lx\n",
+			     text_offset + smp->pc[i]);
+			continue;
+		}
+		node = get_child(state, node, func);
+		if (!node)
+			return -1;
+	}
+	node->count++;
+	node->duration += smp->time_us;
+
+	return 0;
+}
+
 /**
  * make_flame_tree() - Create a tree of stack traces
  *
@@ -1753,7 +1853,14 @@ static int make_flame_tree(enum out_format_t out_format,
 	state.node = tree;
 	state.nodes = 0;
 
-	for (i = 0, call = call_list; i < call_count; i++, call++) {
+	for (i = 0; i < sample_count; i++) {
+		if (process_sample(&state, tree, &sample_list[i]))
+			return -1;
+	}
+
+	/* use the samples in preference to the calls, if there are any */
+	for (i = 0, call = sample_count ? NULL : call_list;
+	     call && i < call_count; i++, call++) {
 		bool entry = TRACE_CALL_TYPE(call) == FUNCF_ENTRY;
 		ulong timestamp = call->flags & FUNCF_TIMESTAMP_MASK;
 		struct func_info *func;